@@ -0,0 +1,142 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+#include <memory>
+
+namespace core {
+
+/**
+ * Bounded queue
+ * =============
+ * Lock-free FIFO ring of fixed capacity. Producers and consumers claim positions with a
+ * single compare-and-swap on the tail and head counters respectively, and each cell holds
+ * a sequence number telling which position it currently belongs to and whether it is full.
+ *
+ * Notes:
+ * - The capacity does not need to be a power of two, so it can match guest-visible limits.
+ * - Any number of producers and consumers is supported. Consumers can claim several
+ *   consecutive elements at once, paying for a single compare-and-swap.
+ * - Elements are copied in and out, so T should be trivially copyable.
+ */
+template <typename T>
+class BoundedQueue {
+    struct Cell {
+        std::atomic<U64> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    const U64 m_capacity;
+
+    // Counters are kept apart to avoid false sharing between producers and consumers.
+    // Padding is used instead of alignas(64), since over-aligned types cannot be
+    // allocated with new before C++17: any two members 64 bytes apart never share a line.
+    char m_pad0[64];
+    std::atomic<U64> m_head;
+    char m_pad1[64 - sizeof(std::atomic<U64>)];
+    std::atomic<U64> m_tail;
+    char m_pad2[64 - sizeof(std::atomic<U64>)];
+
+    Cell& getCell(U64 position) {
+        return m_cells[position % m_capacity];
+    }
+
+public:
+    explicit BoundedQueue(U32 capacity) : m_cells(new Cell[capacity]), m_capacity(capacity), m_head(0), m_tail(0) {
+        for (U32 i = 0; i < capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * Append an element to the queue
+     * @param[in]  value  Element to append
+     * @return            False if the queue was full
+     */
+    bool push(const T& value) {
+        U64 position = m_tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &getCell(position);
+            const U64 sequence = cell->sequence.load(std::memory_order_acquire);
+            const S64 diff = S64(sequence - position);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove up to a number of elements from the front of the queue
+     * @param[out]  values  Array receiving the elements
+     * @param[in]   count   Maximum number of elements to remove
+     * @return              Number of elements removed, 0 if the queue was empty
+     */
+    U32 pop(T* values, U32 count) {
+        U64 position = m_head.load(std::memory_order_relaxed);
+        while (count) {
+            // Count the consecutive full cells starting at this position
+            U32 ready = 0;
+            while (ready < count) {
+                const U64 sequence = getCell(position + ready).sequence.load(std::memory_order_acquire);
+                if (sequence != position + ready + 1) {
+                    if (ready == 0 && S64(sequence - (position + 1)) < 0) {
+                        return 0;
+                    }
+                    break;
+                }
+                ready++;
+            }
+            if (ready == 0) {
+                position = m_head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (m_head.compare_exchange_weak(position, position + ready, std::memory_order_relaxed)) {
+                for (U32 i = 0; i < ready; i++) {
+                    Cell& cell = getCell(position + i);
+                    values[i] = cell.data;
+                    cell.sequence.store(position + i + m_capacity, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+        return 0;
+    }
+
+    // Remove the element at the front of the queue, returning false if it was empty
+    bool pop(T& value) {
+        return pop(&value, 1) != 0;
+    }
+
+    // Approximate number of elements in the queue
+    U32 size() const {
+        const U64 head = m_head.load(std::memory_order_relaxed);
+        const U64 tail = m_tail.load(std::memory_order_relaxed);
+        return (tail > head) ? U32(tail - head) : 0;
+    }
+
+    U32 capacity() const {
+        return U32(m_capacity);
+    }
+};
+
+}  // namespace core
@@ -6,6 +6,7 @@
 #include "config.h"
 #include "nucleus/filesystem/filesystem_host.h"
 
+#include <cstdlib>
 #include <cstring>
 
 // Global configuration object
@@ -15,10 +16,16 @@ Config::Config() {
     // Default settings
     console = false;
     debugger = false;
+    perfMap = false;
+    jitdump = false;
+    spuWorkers = 6;
+    hostPriority = HOST_PRIORITY_NICE;
 
     language = LANGUAGE_DEFAULT;
     ppuTranslator = CPU_TRANSLATOR_FUNCTION;
     spuTranslator = CPU_TRANSLATOR_FUNCTION;
+    cpuPipeline = CPU_PIPELINE_BALANCED;
+    ppuFPSCR = CPU_FPSCR_NONE;
     graphicsBackend = GRAPHICS_BACKEND_DIRECT3D12;
     audioBackend = AUDIO_BACKEND_XAUDIO2;
 }
@@ -32,6 +39,60 @@ void Config::parseArguments(int argc, char** argv) {
         if (!strcmp(argv[i], "--debugger")) {
             debugger = true;
         }
+        if (!strcmp(argv[i], "--cpu-pipeline=fast")) {
+            cpuPipeline = CPU_PIPELINE_FAST;
+        }
+        if (!strcmp(argv[i], "--cpu-pipeline=balanced")) {
+            cpuPipeline = CPU_PIPELINE_BALANCED;
+        }
+        if (!strcmp(argv[i], "--cpu-pipeline=max")) {
+            cpuPipeline = CPU_PIPELINE_MAX;
+        }
+        if (!strcmp(argv[i], "--ppu-fpscr=exact")) {
+            ppuFPSCR = CPU_FPSCR_EXACT;
+        }
+        if (!strcmp(argv[i], "--ppu-fpscr=sticky")) {
+            ppuFPSCR = CPU_FPSCR_STICKY;
+        }
+        if (!strcmp(argv[i], "--ppu-fpscr=none")) {
+            ppuFPSCR = CPU_FPSCR_NONE;
+        }
+        if (!strncmp(argv[i], "--pass-report=", strlen("--pass-report="))) {
+            passReport = argv[i] + strlen("--pass-report=");
+        }
+        if (!strncmp(argv[i], "--hle-report=", strlen("--hle-report="))) {
+            hleReport = argv[i] + strlen("--hle-report=");
+        }
+        if (!strcmp(argv[i], "--perf-map")) {
+            perfMap = true;
+        }
+        if (!strcmp(argv[i], "--jitdump")) {
+            jitdump = true;
+        }
+        if (!strncmp(argv[i], "--spu-workers=", strlen("--spu-workers="))) {
+            spuWorkers = strtoul(argv[i] + strlen("--spu-workers="), nullptr, 10);
+        }
+        if (!strcmp(argv[i], "--host-priority=none")) {
+            hostPriority = HOST_PRIORITY_NONE;
+        }
+        if (!strcmp(argv[i], "--host-priority=nice")) {
+            hostPriority = HOST_PRIORITY_NICE;
+        }
+        if (!strcmp(argv[i], "--host-priority=realtime")) {
+            hostPriority = HOST_PRIORITY_REALTIME;
+        }
+        if (!strncmp(argv[i], "--ppu-affinity=", strlen("--ppu-affinity="))) {
+            ppuAffinity = argv[i] + strlen("--ppu-affinity=");
+        }
+        if (!strncmp(argv[i], "--spu-affinity=", strlen("--spu-affinity="))) {
+            spuAffinity = argv[i] + strlen("--spu-affinity=");
+        }
+        if (!strncmp(argv[i], "--rsx-affinity=", strlen("--rsx-affinity="))) {
+            rsxAffinity = argv[i] + strlen("--rsx-affinity=");
+        }
+        if (!strncmp(argv[i], "--compiler-affinity=", strlen("--compiler-affinity="))) {
+            compilerAffinity = argv[i] + strlen("--compiler-affinity=");
+        }
     }
 
     // Check if booting an executable was requested
@@ -31,6 +31,24 @@ enum ConfigCpuTranslator {
     CPU_TRANSLATOR_IS_AOT       = CPU_TRANSLATOR_MODULE,
 };
 
+enum ConfigCpuPipeline {
+    CPU_PIPELINE_FAST,      // Mandatory passes only
+    CPU_PIPELINE_BALANCED,  // Cheap optimization passes
+    CPU_PIPELINE_MAX,       // All optimization passes
+};
+
+enum ConfigCpuFPSCR {
+    CPU_FPSCR_EXACT,   // Exception flags, FPRF result class and FR/FI rounding bits
+    CPU_FPSCR_STICKY,  // Invalid and overflow flags derived from the result, no FPRF/FR/FI
+    CPU_FPSCR_NONE,    // FPSCR is only modified by the move-to-FPSCR instructions
+};
+
+enum ConfigHostPriority {
+    HOST_PRIORITY_NONE,      // Host threads keep the default priority
+    HOST_PRIORITY_NICE,      // Guest priorities are mapped to host nice values
+    HOST_PRIORITY_REALTIME,  // PPU and RSX threads use the host real-time class, if privileged
+};
+
 // Graphics Settings
 enum ConfigGraphicsBackend {
     GRAPHICS_BACKEND_NULL,
@@ -54,11 +72,23 @@ public:
     std::string boot;       // Boot the specified file automatically
     bool console;           // Run Nucleus in console-only mode, preventing UI or GPU backends from running
     bool debugger;          // Start Nerve debugging server
+    std::string passReport; // Save a JSON report of the HIR pass costs to this path at shutdown
+    std::string hleReport;  // Save a report of the HLE call statistics to this path at shutdown (CSV if *.csv, otherwise JSON)
+    bool perfMap;           // Write /tmp/perf-<pid>.map entries for generated code
+    bool jitdump;           // Write a /tmp/jit-<pid>.dump file for generated code
+    unsigned spuWorkers;    // Host threads running SPU threads, or 0 for one host thread per SPU thread
+    ConfigHostPriority hostPriority;  // Mapping of guest thread priorities to the host scheduler
+    std::string ppuAffinity;          // Host cores for PPU threads (e.g. "0-3,8"), or empty for any core
+    std::string spuAffinity;          // Host cores for SPU threads and SPU workers
+    std::string rsxAffinity;          // Host cores for RSX threads
+    std::string compilerAffinity;     // Host cores for compiler threads
 
     // Saved settings
     ConfigLanguage language;
     ConfigCpuTranslator ppuTranslator;
     ConfigCpuTranslator spuTranslator;
+    ConfigCpuPipeline cpuPipeline;
+    ConfigCpuFPSCR ppuFPSCR;
     ConfigGraphicsBackend graphicsBackend;
     ConfigAudioBackend audioBackend;
 
@@ -0,0 +1,82 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "fiber.h"
+#include "nucleus/logger/logger.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#endif
+
+namespace core {
+
+constexpr Size Fiber::DEFAULT_STACK_SIZE;
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+
+Fiber::Fiber() : threadFiber(true) {
+    handle = ConvertThreadToFiber(nullptr);
+    if (!handle) {
+        logger.error(LOG_COMMON, "Could not convert thread to fiber");
+    }
+}
+
+Fiber::Fiber(std::function<void()> entry, Size stackSize) : entry(std::move(entry)) {
+    handle = CreateFiber(stackSize, trampoline, this);
+    if (!handle) {
+        logger.error(LOG_COMMON, "Could not create fiber");
+    }
+}
+
+Fiber::~Fiber() {
+    if (threadFiber) {
+        ConvertFiberToThread();
+    } else if (handle) {
+        DeleteFiber(handle);
+    }
+}
+
+void __stdcall Fiber::trampoline(void* param) {
+    static_cast<Fiber*>(param)->entry();
+}
+
+void Fiber::switchTo(Fiber& from, Fiber& to) {
+    SwitchToFiber(to.handle);
+}
+
+#else
+
+Fiber::Fiber() {
+    getcontext(&context);
+}
+
+Fiber::Fiber(std::function<void()> entry, Size stackSize) : entry(std::move(entry)) {
+    stack = std::make_unique<U08[]>(stackSize);
+    getcontext(&context);
+    context.uc_stack.ss_sp = stack.get();
+    context.uc_stack.ss_size = stackSize;
+    context.uc_link = nullptr;
+
+    // Arguments of makecontext are ints, the pointer is split in two halves
+    const U64 self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&context, reinterpret_cast<void(*)()>(trampoline), 2,
+        static_cast<unsigned int>(self >> 32), static_cast<unsigned int>(self));
+}
+
+Fiber::~Fiber() {
+}
+
+void Fiber::trampoline(unsigned int hi, unsigned int lo) {
+    const U64 self = (U64(hi) << 32) | lo;
+    reinterpret_cast<Fiber*>(static_cast<uintptr_t>(self))->entry();
+}
+
+void Fiber::switchTo(Fiber& from, Fiber& to) {
+    swapcontext(&from.context, &to.context);
+}
+
+#endif
+
+}  // namespace core
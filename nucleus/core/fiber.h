@@ -0,0 +1,70 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <functional>
+#include <memory>
+
+#if !defined(NUCLEUS_TARGET_WINDOWS)
+#include <ucontext.h>
+#endif
+
+namespace core {
+
+/**
+ * Fiber
+ * =====
+ * Execution context with its own stack, switched cooperatively in user mode. Implemented
+ * with Win32 fibers on Windows and ucontext elsewhere.
+ *
+ * Notes:
+ * - A host thread must create a fiber with the default constructor, representing itself,
+ *   before switching to other fibers, and must destroy it on the same thread.
+ * - The entry function must never return: it has to switch to another fiber when done.
+ * - Fibers can be resumed on any host thread. Code running on a fiber must not keep
+ *   pointers to thread-local storage across a switch.
+ */
+class Fiber {
+    std::function<void()> entry;
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    void* handle = nullptr;
+    bool threadFiber = false;
+    static void __stdcall trampoline(void* param);
+#else
+    ucontext_t context;
+    std::unique_ptr<U08[]> stack;
+    static void trampoline(unsigned int hi, unsigned int lo);
+#endif
+
+public:
+    static constexpr Size DEFAULT_STACK_SIZE = 0x100000;
+
+    // Create a fiber representing the calling host thread
+    Fiber();
+
+    /**
+     * Create a fiber that runs the given function the first time it is switched to
+     * @param[in]  entry      Function to run, must never return
+     * @param[in]  stackSize  Size of the fiber stack in bytes
+     */
+    Fiber(std::function<void()> entry, Size stackSize = DEFAULT_STACK_SIZE);
+    ~Fiber();
+
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    /**
+     * Save the current context in one fiber and resume another one
+     * @param[in]  from  Fiber currently running on the calling host thread
+     * @param[in]  to    Fiber to resume
+     */
+    static void switchTo(Fiber& from, Fiber& to);
+};
+
+}  // namespace core
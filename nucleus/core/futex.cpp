@@ -0,0 +1,95 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "futex.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(NUCLEUS_TARGET_LINUX)
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace core {
+
+#if !defined(NUCLEUS_TARGET_WINDOWS) && !defined(NUCLEUS_TARGET_LINUX)
+namespace {
+
+// Waiters are distributed over a fixed set of buckets, hashed by address
+struct FutexBucket {
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+FutexBucket futexBuckets[64];
+
+FutexBucket& getBucket(const void* addr) {
+    return futexBuckets[(reinterpret_cast<uintptr_t>(addr) >> 2) % 64];
+}
+
+}  // anonymous namespace
+#endif
+
+bool futexWait(std::atomic<U32>& word, U32 expected, U64 timeout) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    const DWORD ms = timeout ? DWORD((timeout + 999) / 1000) : INFINITE;
+    if (!WaitOnAddress(&word, &expected, sizeof(U32), ms)) {
+        return GetLastError() != ERROR_TIMEOUT;
+    }
+    return true;
+#elif defined(NUCLEUS_TARGET_LINUX)
+    timespec ts;
+    timespec* tsp = nullptr;
+    if (timeout) {
+        ts.tv_sec = timeout / 1000000;
+        ts.tv_nsec = (timeout % 1000000) * 1000;
+        tsp = &ts;
+    }
+    const long ret = syscall(SYS_futex, reinterpret_cast<U32*>(&word), FUTEX_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+    return !(ret == -1 && errno == ETIMEDOUT);
+#else
+    auto& bucket = getBucket(&word);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (word.load() != expected) {
+        return true;
+    }
+    if (timeout) {
+        return bucket.cv.wait_for(lock, std::chrono::microseconds(timeout)) == std::cv_status::no_timeout;
+    }
+    bucket.cv.wait(lock);
+    return true;
+#endif
+}
+
+void futexWake(std::atomic<U32>& word, U32 count) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    if (count == 1) {
+        WakeByAddressSingle(&word);
+    } else {
+        WakeByAddressAll(&word);
+    }
+#elif defined(NUCLEUS_TARGET_LINUX)
+    syscall(SYS_futex, reinterpret_cast<U32*>(&word), FUTEX_WAKE_PRIVATE, count > INT_MAX ? INT_MAX : int(count), nullptr, nullptr, 0);
+#else
+    // Buckets are shared between addresses, so every waiter has to re-check its word
+    auto& bucket = getBucket(&word);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.cv.notify_all();
+#endif
+}
+
+void futexWakeAll(std::atomic<U32>& word) {
+    futexWake(word, U32(-1));
+}
+
+}  // namespace core
@@ -0,0 +1,46 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+
+namespace core {
+
+/**
+ * Futex
+ * =====
+ * Address-based waiting on 32-bit atomic words, mapped to the native primitive of the host:
+ * futex(2) on Linux, WaitOnAddress on Windows, and a hashed table of condition variables
+ * elsewhere. Waiting threads are parked in the host kernel and consume no CPU time.
+ *
+ * Notes:
+ * - Waits can return spuriously, callers must re-check their condition in a loop.
+ * - Use the "event counter" pattern to avoid lost wake-ups: read the word, check the
+ *   condition, then wait on the value read. Writers must modify the word before waking.
+ */
+
+/**
+ * Block the calling thread while the word holds the expected value
+ * @param[in]  word      Atomic word to wait on
+ * @param[in]  expected  Value the word is expected to hold
+ * @param[in]  timeout   Maximum time to wait in microseconds, or 0 to wait indefinitely
+ * @return               False if the wait timed out, true otherwise
+ */
+bool futexWait(std::atomic<U32>& word, U32 expected, U64 timeout = 0);
+
+/**
+ * Wake up threads waiting on the word
+ * @param[in]  word   Atomic word threads are waiting on
+ * @param[in]  count  Maximum number of threads to wake up
+ */
+void futexWake(std::atomic<U32>& word, U32 count = 1);
+
+// Wake up all threads waiting on the word
+void futexWakeAll(std::atomic<U32>& word);
+
+}  // namespace core
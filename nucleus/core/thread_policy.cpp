@@ -0,0 +1,343 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "thread_policy.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#elif defined(NUCLEUS_TARGET_LINUX)
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+namespace core {
+
+namespace {
+
+// Range of LV2 PPU thread priorities, and priority of the primary PPU thread of most titles
+constexpr S32 PPU_PRIORITY_HIGHEST = 0;
+constexpr S32 PPU_PRIORITY_LOWEST = 3071;
+constexpr S32 PPU_PRIORITY_NORMAL = 1000;
+
+// RSX threads are scheduled as PPU threads of this guest priority
+constexpr S32 RSX_PRIORITY = 600;
+
+struct HostThread {
+    std::thread::id id;
+    ThreadRole role;
+    S32 priority;
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    HANDLE handle;
+#elif defined(NUCLEUS_TARGET_LINUX)
+    pid_t tid;
+#endif
+};
+
+struct PolicyState {
+    std::mutex mutex;
+    ConfigHostPriority mode = HOST_PRIORITY_NONE;
+    std::vector<U32> affinity[THREAD_ROLE_COUNT];
+    std::vector<HostThread*> threads;
+
+    // Statistics of exited threads
+    ThreadRoleStatistics exited[THREAD_ROLE_COUNT];
+    U64 rejected = 0;
+};
+
+PolicyState& getState() {
+    static PolicyState state;
+    return state;
+}
+
+// Add the scheduling times of a thread to the statistics of its role
+void readTimes(const HostThread& thread, ThreadRoleStatistics& stats) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(thread.handle, &creation, &exit, &kernel, &user)) {
+        const U64 kernelTime = (U64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+        const U64 userTime = (U64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+        stats.runTime += (kernelTime + userTime) * 100;
+    }
+#elif defined(NUCLEUS_TARGET_LINUX)
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", int(thread.tid));
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return;
+    }
+    unsigned long long runTime, waitTime, timeslices;
+    if (fscanf(file, "%llu %llu %llu", &runTime, &waitTime, &timeslices) == 3) {
+        stats.runTime += runTime;
+        stats.waitTime += waitTime;
+        stats.timeslices += timeslices;
+    }
+    fclose(file);
+#endif
+}
+
+void setHostName(const std::string& name) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    // Available since Windows 10 1607
+    using SetThreadDescriptionFunc = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+    static const auto setThreadDescription = reinterpret_cast<SetThreadDescriptionFunc>(
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+    if (setThreadDescription) {
+        const std::wstring wideName(name.begin(), name.end());
+        setThreadDescription(GetCurrentThread(), wideName.c_str());
+    }
+#elif defined(NUCLEUS_TARGET_LINUX)
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+}
+
+// Apply a scheduling class and priority, returns false if the host refused it
+bool applyPriority(const HostThread& thread, const HostPriority& priority) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    int level = THREAD_PRIORITY_NORMAL;
+    if (priority.type == HostPriority::CLASS_REALTIME) {
+        level = THREAD_PRIORITY_HIGHEST;
+    } else if (priority.value <= -5) {
+        level = THREAD_PRIORITY_HIGHEST;
+    } else if (priority.value < 0) {
+        level = THREAD_PRIORITY_ABOVE_NORMAL;
+    } else if (priority.value >= 10) {
+        level = THREAD_PRIORITY_LOWEST;
+    } else if (priority.value > 0) {
+        level = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    return SetThreadPriority(thread.handle, level) != 0;
+#elif defined(NUCLEUS_TARGET_LINUX)
+    sched_param param = {};
+    if (priority.type == HostPriority::CLASS_REALTIME) {
+        param.sched_priority = priority.value;
+        return sched_setscheduler(thread.tid, SCHED_RR, &param) == 0;
+    }
+    const int policy = (priority.type == HostPriority::CLASS_BATCH) ? SCHED_BATCH : SCHED_OTHER;
+    if (sched_setscheduler(thread.tid, policy, &param) != 0) {
+        return false;
+    }
+    return setpriority(PRIO_PROCESS, thread.tid, priority.value) == 0;
+#else
+    return true;
+#endif
+}
+
+bool applyAffinity(const HostThread& thread, const std::vector<U32>& cpus) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    // Only the processor group of the process is addressable
+    DWORD_PTR mask = 0;
+    for (U32 cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) {
+            mask |= DWORD_PTR(1) << cpu;
+        }
+    }
+    return mask && SetThreadAffinityMask(thread.handle, mask) != 0;
+#elif defined(NUCLEUS_TARGET_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (U32 cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(thread.tid, sizeof(set), &set) == 0;
+#else
+    return true;
+#endif
+}
+
+// Apply the current policy to a thread, must be called with the state locked
+void applyPolicy(PolicyState& state, const HostThread& thread) {
+    if (state.mode != HOST_PRIORITY_NONE) {
+        const auto priority = ThreadPolicy::getHostPriority(state.mode, thread.role, thread.priority);
+        if (!applyPriority(thread, priority)) {
+            HostPriority fallback;
+            fallback.type = HostPriority::CLASS_NORMAL;
+            fallback.value = 0;
+            applyPriority(thread, fallback);
+            state.rejected += 1;
+        }
+    }
+    const auto& cpus = state.affinity[thread.role];
+    if (!cpus.empty() && !applyAffinity(thread, cpus)) {
+        state.rejected += 1;
+    }
+}
+
+void unregisterThread(HostThread* thread) {
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.threads.erase(std::remove(state.threads.begin(), state.threads.end(), thread), state.threads.end());
+    readTimes(*thread, state.exited[thread->role]);
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    CloseHandle(thread->handle);
+#endif
+}
+
+// Registration of the calling thread, removed when the thread exits
+struct ThreadRegistration {
+    std::unique_ptr<HostThread> thread;
+
+    ~ThreadRegistration() {
+        if (thread) {
+            unregisterThread(thread.get());
+        }
+    }
+};
+
+thread_local ThreadRegistration t_registration;
+
+}  // anonymous namespace
+
+void ThreadPolicy::setPriorityMode(ConfigHostPriority mode) {
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.mode = mode;
+}
+
+bool ThreadPolicy::parseCpuList(const std::string& text, std::vector<U32>& cpus) {
+    std::vector<U32> result;
+    const char* p = text.c_str();
+    while (*p) {
+        char* end;
+        const unsigned long first = strtoul(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        unsigned long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtoul(p + 1, &end, 10);
+            if (end == p + 1 || last < first) {
+                return false;
+            }
+            p = end;
+        }
+        if (last >= 4096) {
+            return false;
+        }
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            result.push_back(U32(cpu));
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return false;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    cpus = std::move(result);
+    return true;
+}
+
+bool ThreadPolicy::setAffinity(ThreadRole role, const std::string& cpus) {
+    std::vector<U32> list;
+    if (!parseCpuList(cpus, list)) {
+        return false;
+    }
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.affinity[role] = std::move(list);
+    return true;
+}
+
+HostPriority ThreadPolicy::getHostPriority(ConfigHostPriority mode, ThreadRole role, S32 priority) {
+    HostPriority result;
+    if (mode == HOST_PRIORITY_NONE) {
+        return result;
+    }
+    switch (role) {
+    case THREAD_ROLE_RSX:
+    case THREAD_ROLE_TIMER:
+        priority = (role == THREAD_ROLE_RSX) ? RSX_PRIORITY : PPU_PRIORITY_HIGHEST;
+        // Fallthrough
+    case THREAD_ROLE_PPU:
+        priority = std::min(std::max(priority, PPU_PRIORITY_HIGHEST), PPU_PRIORITY_LOWEST);
+        if (mode == HOST_PRIORITY_REALTIME) {
+            result.type = HostPriority::CLASS_REALTIME;
+            result.value = 1 + (PPU_PRIORITY_LOWEST - priority) * 48 / PPU_PRIORITY_LOWEST;
+        } else {
+            result.type = HostPriority::CLASS_NORMAL;
+            result.value = (priority - PPU_PRIORITY_NORMAL) / 200;
+        }
+        break;
+    case THREAD_ROLE_COMPILER:
+        result.type = HostPriority::CLASS_BATCH;
+        result.value = 10;
+        break;
+    default:
+        result.type = HostPriority::CLASS_NORMAL;
+        result.value = 0;
+    }
+    return result;
+}
+
+void ThreadPolicy::registerThread(ThreadRole role, const std::string& name, S32 priority) {
+    auto& registration = t_registration;
+    const bool registered = (registration.thread != nullptr);
+    if (!registered) {
+        auto thread = std::make_unique<HostThread>();
+        thread->id = std::this_thread::get_id();
+#if defined(NUCLEUS_TARGET_WINDOWS)
+        DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(),
+            &thread->handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+#elif defined(NUCLEUS_TARGET_LINUX)
+        thread->tid = pid_t(syscall(SYS_gettid));
+#endif
+        registration.thread = std::move(thread);
+    }
+    setHostName(name);
+
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto& thread = *registration.thread;
+    thread.role = role;
+    thread.priority = priority;
+    if (!registered) {
+        state.threads.push_back(&thread);
+    }
+    applyPolicy(state, thread);
+}
+
+bool ThreadPolicy::setPriority(std::thread::id id, S32 priority) {
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto* thread : state.threads) {
+        if (thread->id == id) {
+            thread->priority = priority;
+            applyPolicy(state, *thread);
+            return true;
+        }
+    }
+    return false;
+}
+
+ThreadPolicyStatistics ThreadPolicy::getStatistics() {
+    ThreadPolicyStatistics stats;
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (U32 i = 0; i < THREAD_ROLE_COUNT; i++) {
+        stats.roles[i] = state.exited[i];
+        stats.roles[i].threads = 0;
+    }
+    for (const auto* thread : state.threads) {
+        stats.roles[thread->role].threads += 1;
+        readTimes(*thread, stats.roles[thread->role]);
+    }
+    stats.rejected = state.rejected;
+    return stats;
+}
+
+}  // namespace core
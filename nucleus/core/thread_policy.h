@@ -0,0 +1,128 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/core/config.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+enum ThreadRole {
+    THREAD_ROLE_PPU,       // Guest PPU threads
+    THREAD_ROLE_SPU,       // Guest SPU threads and SPU pool workers
+    THREAD_ROLE_RSX,       // RSX command processing
+    THREAD_ROLE_COMPILER,  // Background compilation
+    THREAD_ROLE_TIMER,     // Timer wheel, firing guest timeouts
+    THREAD_ROLE_COUNT,
+};
+
+// Scheduling class and priority requested to the host for a thread
+struct HostPriority {
+    enum Class {
+        CLASS_DEFAULT,   // Leave the thread untouched
+        CLASS_NORMAL,    // Time-sharing, value is a nice value in [-20, 19]
+        CLASS_BATCH,     // Time-sharing for throughput-bound work, value is a nice value
+        CLASS_REALTIME,  // Round-robin real-time, value is a priority in [1, 99]
+    };
+    Class type = CLASS_DEFAULT;
+    S32 value = 0;
+};
+
+struct ThreadRoleStatistics {
+    U32 threads = 0;     // Host threads currently registered with this role
+    U64 runTime = 0;     // Nanoseconds spent running on a core
+    U64 waitTime = 0;    // Nanoseconds spent runnable in a runqueue, waiting for a core
+    U64 timeslices = 0;  // Times the threads were given a core
+};
+
+struct ThreadPolicyStatistics {
+    ThreadRoleStatistics roles[THREAD_ROLE_COUNT];
+    U64 rejected = 0;    // Priority or affinity requests refused by the host
+};
+
+/**
+ * Thread policy
+ * =============
+ * Host scheduling policy of the emulator threads. Each thread registers itself with a role,
+ * a name and, for guest threads, the guest priority, and the policy sets its host name,
+ * scheduling class, priority and allowed cores accordingly.
+ *
+ * Priorities (see ThreadPolicy::getHostPriority):
+ * - HOST_PRIORITY_NICE: PPU threads get a nice value proportional to their guest priority,
+ *   from -5 (guest priority 0) through 0 (guest priority 1000) to 10 (guest priority 3071).
+ *   SPU threads get 0 and compiler threads 10 in the batch class.
+ * - HOST_PRIORITY_REALTIME: PPU threads use round-robin real-time priorities, from 49 (guest
+ *   priority 0) to 1 (guest priority 3071). Other roles are handled as in HOST_PRIORITY_NICE.
+ * - RSX threads are handled as PPU threads of guest priority 600, and the timer thread as a
+ *   PPU thread of guest priority 0, since timeouts are as urgent as the most urgent guest thread.
+ * - Requests refused by the host (raising priorities usually requires privileges) fall back
+ *   to a nice value of 0 and are counted in ThreadPolicyStatistics::rejected.
+ *
+ * Notes:
+ * - Affinity plans assign a set of host cores to each role. Threads may run on any core of
+ *   their role and the host balances them within it. Roles without a plan run anywhere.
+ * - Runqueue statistics are read from /proc/self/task/<tid>/schedstat on Linux. On Windows
+ *   only the running time is available. Threads add their totals when they unregister.
+ */
+class ThreadPolicy {
+public:
+    /**
+     * Select how guest priorities are mapped to the host
+     * @param[in]  mode  Priority mapping, applied to threads registered from now on
+     */
+    static void setPriorityMode(ConfigHostPriority mode);
+
+    /**
+     * Set the cores that threads of a role are allowed to run on
+     * @param[in]  role  Thread role
+     * @param[in]  cpus  List of cores and ranges, e.g. "0-3,8,10-11", or empty for any core
+     * @return           False if the list is malformed, in which case the plan is unchanged
+     */
+    static bool setAffinity(ThreadRole role, const std::string& cpus);
+
+    /**
+     * Parse a list of cores and ranges
+     * @param[in]   text  List of cores and ranges, e.g. "0-3,8,10-11"
+     * @param[out]  cpus  Sorted core indices without duplicates
+     * @return            False if the list is malformed
+     */
+    static bool parseCpuList(const std::string& text, std::vector<U32>& cpus);
+
+    /**
+     * Map a guest priority to the host scheduling class and priority for a role
+     * @param[in]  mode      Priority mapping
+     * @param[in]  role      Thread role
+     * @param[in]  priority  Guest priority, lower values are higher priorities
+     * @return               Host scheduling class and priority
+     */
+    static HostPriority getHostPriority(ConfigHostPriority mode, ThreadRole role, S32 priority);
+
+    /**
+     * Register the calling thread, applying its name, priority and affinity.
+     * Calling it again updates the registration. The thread is unregistered when it exits.
+     * @param[in]  role      Thread role
+     * @param[in]  name      Host thread name, truncated to 15 characters on Linux
+     * @param[in]  priority  Guest priority, lower values are higher priorities
+     */
+    static void registerThread(ThreadRole role, const std::string& name, S32 priority = 0);
+
+    /**
+     * Change the guest priority of a registered thread, from any thread
+     * @param[in]  id        Identifier of the host thread
+     * @param[in]  priority  Guest priority, lower values are higher priorities
+     * @return               False if the thread is not registered
+     */
+    static bool setPriority(std::thread::id id, S32 priority);
+
+    // Get a snapshot of the scheduling statistics of the registered and exited threads
+    static ThreadPolicyStatistics getStatistics();
+};
+
+}  // namespace core
@@ -0,0 +1,209 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "timebase.h"
+
+#if defined(NUCLEUS_ARCH_X86)
+#if defined(NUCLEUS_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace core {
+
+// Calibration window at construction and bounds of the refinement interval, in nanoseconds
+static constexpr U64 CALIBRATION_TIME = 2000000;
+static constexpr U64 REFINE_INTERVAL_MIN = 16000000;
+static constexpr U64 REFINE_INTERVAL_MAX = 1000000000;
+
+// Maximum relative rate adjustment applied while slewing away accumulated error
+static constexpr F64 SLEW_LIMIT = 500e-6;
+
+// Compute the 64 low bits of (value * multiplier) >> 32, using a 128-bit product
+static U64 mulShift32(U64 value, U64 multiplier) {
+#if defined(NUCLEUS_COMPILER_MSVC) && defined(NUCLEUS_ARCH_X86_64BITS)
+    U64 hi;
+    U64 lo = _umul128(value, multiplier, &hi);
+    return (hi << 32) | (lo >> 32);
+#elif defined(__SIZEOF_INT128__)
+    return static_cast<U64>((static_cast<unsigned __int128>(value) * multiplier) >> 32);
+#else
+    // Split into 32-bit halves: only the lowest partial product has bits below the shift
+    const U64 a0 = value & 0xFFFFFFFF, a1 = value >> 32;
+    const U64 b0 = multiplier & 0xFFFFFFFF, b1 = multiplier >> 32;
+    return ((a1 * b1) << 32) + a1 * b0 + a0 * b1 + ((a0 * b0) >> 32);
+#endif
+}
+
+Timebase::Timebase(U64 frequency) : frequency(frequency), sequence(0) {
+    refining.clear();
+    useTSC = hasInvariantTSC();
+
+    const U64 wallNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    hostStart = sampleClocks(tscStart);
+    wallStart = wallNow;
+
+    tscBase = tscStart;
+    tickBase = 0;
+    multiplier = 0;
+    nextRefine = ~0ULL;
+    refineInterval = REFINE_INTERVAL_MIN;
+    if (!useTSC) {
+        return;
+    }
+
+    // Initial estimate of the TSC rate, refined later over a longer baseline
+    std::this_thread::sleep_for(std::chrono::nanoseconds(CALIBRATION_TIME));
+    U64 tsc;
+    const U64 host = sampleClocks(tsc);
+    if (tsc <= tscStart || host <= hostStart) {
+        useTSC = false;
+        return;
+    }
+    const F64 cyclesPerNs = F64(tsc - tscStart) / F64(host - hostStart);
+    tscBase = tsc;
+    tickBase = nanosecondsToTicks(host - hostStart);
+    multiplier = U64(F64(frequency) / (cyclesPerNs * 1e9) * 4294967296.0);
+    nextRefine = tsc + U64(refineInterval * cyclesPerNs);
+}
+
+Timebase& Timebase::get() {
+    static Timebase timebase;
+    return timebase;
+}
+
+bool Timebase::hasInvariantTSC() {
+#if defined(NUCLEUS_ARCH_X86)
+    U32 regs[4] = {};
+#if defined(NUCLEUS_COMPILER_MSVC)
+    int data[4];
+    __cpuid(data, 0x80000000);
+    if (U32(data[0]) < 0x80000007) {
+        return false;
+    }
+    __cpuid(data, 0x80000007);
+    regs[3] = data[3];
+#else
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+    return (regs[3] >> 8) & 1;
+#else
+    return false;
+#endif
+}
+
+U64 Timebase::readTSC() {
+#if defined(NUCLEUS_ARCH_X86)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+U64 Timebase::readHostClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+U64 Timebase::sampleClocks(U64& tsc) {
+    // Keep the sample whose host clock read was bracketed most tightly by the TSC
+    U64 bestHost = 0;
+    U64 bestWidth = ~0ULL;
+    for (int i = 0; i < 3; i++) {
+        const U64 tsc0 = readTSC();
+        const U64 host = readHostClock();
+        const U64 tsc1 = readTSC();
+        if (tsc1 - tsc0 < bestWidth) {
+            bestWidth = tsc1 - tsc0;
+            bestHost = host;
+            tsc = tsc0 + (tsc1 - tsc0) / 2;
+        }
+    }
+    return bestHost;
+}
+
+U64 Timebase::nanosecondsToTicks(U64 ns) const {
+    const U64 sec = ns / 1000000000;
+    const U64 rem = ns % 1000000000;
+    return sec * frequency + rem * frequency / 1000000000;
+}
+
+void Timebase::refine() {
+    U64 tsc;
+    const U64 host = sampleClocks(tsc);
+    if (tsc <= tscStart || host <= hostStart) {
+        return;
+    }
+
+    // Continue the current line from this instant, so the counter never steps
+    const U64 base = tscBase.load(std::memory_order_relaxed);
+    const U64 current = tickBase.load(std::memory_order_relaxed) +
+        mulShift32(tsc > base ? tsc - base : 0, multiplier.load(std::memory_order_relaxed));
+
+    // Aim to meet the host clock at the end of the next interval, with a bounded rate change
+    refineInterval = std::min(refineInterval * 2, REFINE_INTERVAL_MAX);
+    const F64 cyclesPerNs = F64(tsc - tscStart) / F64(host - hostStart);
+    const F64 intervalCycles = F64(refineInterval) * cyclesPerNs;
+    const F64 nominal = F64(frequency) / (cyclesPerNs * 1e9);
+    const F64 target = F64(nanosecondsToTicks(host - hostStart + refineInterval));
+    F64 rate = (target - F64(current)) / intervalCycles;
+    rate = std::max(nominal * (1.0 - SLEW_LIMIT), std::min(nominal * (1.0 + SLEW_LIMIT), rate));
+
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    tscBase.store(tsc, std::memory_order_relaxed);
+    tickBase.store(current, std::memory_order_relaxed);
+    multiplier.store(U64(rate * 4294967296.0), std::memory_order_relaxed);
+    sequence.fetch_add(1, std::memory_order_release);
+    nextRefine.store(tsc + U64(intervalCycles), std::memory_order_relaxed);
+}
+
+U64 Timebase::getTicks() {
+    if (!useTSC) {
+        return nanosecondsToTicks(readHostClock() - hostStart);
+    }
+
+    U64 tsc = readTSC();
+    if (tsc >= nextRefine.load(std::memory_order_relaxed)) {
+        if (!refining.test_and_set(std::memory_order_acquire)) {
+            refine();
+            refining.clear(std::memory_order_release);
+        }
+        tsc = readTSC();
+    }
+
+    U64 base, ticks, mul;
+    U32 seq;
+    do {
+        seq = sequence.load(std::memory_order_acquire);
+        base = tscBase.load(std::memory_order_relaxed);
+        ticks = tickBase.load(std::memory_order_relaxed);
+        mul = multiplier.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+
+    return ticks + mulShift32(tsc > base ? tsc - base : 0, mul);
+}
+
+void Timebase::getTime(U64& sec, U64& nsec) {
+    const U64 ticks = getTicks();
+    const U64 elapsed = (ticks / frequency) * 1000000000 + (ticks % frequency) * 1000000000 / frequency;
+    const U64 now = wallStart + elapsed;
+    sec = now / 1000000000;
+    nsec = now % 1000000000;
+}
+
+}  // namespace core
@@ -0,0 +1,110 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+
+namespace core {
+
+/**
+ * Timebase
+ * ========
+ * Monotonic tick counter running at a fixed guest frequency. If the host has an invariant
+ * TSC, ticks are computed from RDTSC with a 32.32 fixed-point multiply, otherwise from the
+ * host monotonic clock.
+ *
+ * Notes:
+ * - The TSC rate is calibrated against the host monotonic clock at construction, and the
+ *   estimate is refined while ticks are being read, over an increasingly long baseline.
+ *   Refinements never step the counter: the remaining error is slewed away by adjusting
+ *   the multiplier, so the counter does not drift from the host monotonic clock.
+ * - Readers are lock-free. The conversion parameters are protected by a sequence lock,
+ *   and only one thread at a time performs a refinement.
+ */
+class Timebase {
+    // Frequency of the guest timebase in Hz
+    U64 frequency;
+
+    // Whether the TSC is used as source, i.e. it is available and invariant
+    bool useTSC;
+
+    // Host monotonic clock and wall clock (in nanoseconds) when ticks started counting
+    U64 hostStart;
+    U64 wallStart;
+    U64 tscStart;
+
+    // Conversion parameters: ticks = tickBase + ((tsc - tscBase) * multiplier) >> 32
+    std::atomic<U32> sequence;
+    std::atomic<U64> tscBase;
+    std::atomic<U64> tickBase;
+    std::atomic<U64> multiplier;
+
+    // Refinement state
+    std::atomic<U64> nextRefine;
+    std::atomic_flag refining;
+    U64 refineInterval;
+
+    /**
+     * Sample the host monotonic clock and the TSC at the same instant
+     * @param[out]  tsc  TSC value at the midpoint of the host clock read
+     * @return           Host monotonic clock in nanoseconds
+     */
+    static U64 sampleClocks(U64& tsc);
+
+    // Re-estimate the TSC rate and update the conversion parameters
+    void refine();
+
+    // Convert nanoseconds of the host monotonic clock into ticks
+    U64 nanosecondsToTicks(U64 ns) const;
+
+public:
+    static constexpr U64 DEFAULT_FREQUENCY = 79800000;
+
+    /**
+     * Create a timebase, calibrating the TSC if available
+     * @param[in]  frequency  Tick frequency in Hz
+     */
+    Timebase(U64 frequency = DEFAULT_FREQUENCY);
+
+    Timebase(const Timebase&) = delete;
+    Timebase& operator=(const Timebase&) = delete;
+
+    // Process-wide timebase running at the default frequency
+    static Timebase& get();
+
+    // Whether the host has an invariant TSC
+    static bool hasInvariantTSC();
+
+    // Read the host TSC, or 0 if unavailable
+    static U64 readTSC();
+
+    // Read the host monotonic clock in nanoseconds
+    static U64 readHostClock();
+
+    /**
+     * Get the number of ticks elapsed since the timebase was created
+     * @return  Tick count
+     */
+    U64 getTicks();
+
+    /**
+     * Get the current wall-clock time, advancing with the tick counter
+     * @param[out]  sec   Seconds since the Unix epoch
+     * @param[out]  nsec  Nanoseconds within the current second
+     */
+    void getTime(U64& sec, U64& nsec);
+
+    U64 getFrequency() const {
+        return frequency;
+    }
+    bool isUsingTSC() const {
+        return useTSC;
+    }
+};
+
+}  // namespace core
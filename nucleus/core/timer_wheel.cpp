@@ -0,0 +1,396 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "timer_wheel.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/core/thread_policy.h"
+#include "nucleus/core/timebase.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(NUCLEUS_TARGET_LINUX)
+#include <ctime>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+namespace core {
+
+namespace {
+
+constexpr U64 NEVER = ~0ULL;
+
+}  // anonymous namespace
+
+TimerWheel::TimerWheel() : m_wakeTime(0), statFired(0), statLateness(0), statLatenessMax(0) {
+    m_tick = Timebase::readHostClock() >> TICK_SHIFT;
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer) {
+        // High-resolution timers are available since Windows 10 1803
+        timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+    m_hostTimer = reinterpret_cast<intptr_t>(timer);
+#elif defined(NUCLEUS_TARGET_LINUX)
+    m_hostTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+#endif
+    m_thread = std::thread([this]{
+        threadLoop();
+    });
+}
+
+TimerWheel::~TimerWheel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        armHost(0);
+    }
+    m_thread.join();
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    CloseHandle(reinterpret_cast<HANDLE>(m_hostTimer));
+#elif defined(NUCLEUS_TARGET_LINUX)
+    close(int(m_hostTimer));
+#endif
+    auto release = [](std::vector<Timer*>& timers) {
+        for (Timer* timer : timers) {
+            delete timer;
+        }
+    };
+    for (auto& level : m_slots) {
+        for (auto& slot : level) {
+            release(slot);
+        }
+    }
+    release(m_overflow);
+    release(m_pending);
+}
+
+TimerWheel& TimerWheel::get() {
+    static TimerWheel wheel;
+    return wheel;
+}
+
+U64 TimerWheel::add(U64 deadline, U64 period, Callback callback) {
+    auto* timer = new Timer();
+    timer->deadline = deadline;
+    timer->period = period;
+    timer->callback = std::move(callback);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    timer->id = m_nextId++;
+    m_timers[timer->id] = timer;
+    m_entries += 1;
+    insert(timer);
+
+    // Wake up the thread earlier if it is sleeping or spinning past this deadline
+    const U64 target = (deadline > SPIN_TAIL) ? deadline - SPIN_TAIL : 0;
+    if (target < m_wakeTime.load(std::memory_order_relaxed)) {
+        m_wakeTime.store(target, std::memory_order_relaxed);
+        armHost(target);
+    }
+    return timer->id;
+}
+
+bool TimerWheel::cancel(U64 id) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_timers.find(id);
+    const bool found = (it != m_timers.end());
+    if (found) {
+        // Cancelled timers are released once the wheel reaches them
+        it->second->cancelled = true;
+        m_timers.erase(it);
+    }
+    if (std::this_thread::get_id() != m_thread.get_id()) {
+        m_runningDone.wait(lock, [&]{ return !m_running || m_running->id != id; });
+    }
+    return found;
+}
+
+void TimerWheel::sleepUntil(U64 deadline) {
+    if (deadline > Timebase::readHostClock() + SPIN_TAIL) {
+        std::atomic<U32> expired(0);
+        const U64 id = add(deadline, 0, [&expired](U64) {
+            expired.store(1, std::memory_order_release);
+            futexWake(expired);
+        });
+        while (!expired.load(std::memory_order_acquire)) {
+            futexWait(expired, 0);
+        }
+        cancel(id);
+    }
+    while (Timebase::readHostClock() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+bool TimerWheel::waitUntil(std::atomic<U32>& word, U32 expected, U64 deadline) {
+    U64 now = Timebase::readHostClock();
+    if (deadline <= now + SPIN_TAIL) {
+        while (now < deadline && word.load(std::memory_order_acquire) == expected) {
+            std::this_thread::yield();
+            now = Timebase::readHostClock();
+        }
+        return now < deadline;
+    }
+    const U64 id = add(deadline, 0, [&word](U64) {
+        futexWakeAll(word);
+    });
+    futexWait(word, expected, (deadline - now) / 1000 + 1);
+    cancel(id);
+    return Timebase::readHostClock() < deadline;
+}
+
+void TimerWheel::insert(Timer* timer) {
+    const U64 tick = timer->deadline >> TICK_SHIFT;
+    if (tick <= m_tick) {
+        m_pending.push_back(timer);
+        std::push_heap(m_pending.begin(), m_pending.end(), [](Timer* a, Timer* b) {
+            return a->deadline > b->deadline;
+        });
+        return;
+    }
+    const U64 diff = tick - m_tick;
+    for (U32 level = 0; level < LEVELS; level++) {
+        if (diff < (1ULL << (SLOT_BITS * (level + 1)))) {
+            m_slots[level][(tick >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+            return;
+        }
+    }
+    m_overflow.push_back(timer);
+}
+
+void TimerWheel::advance(U64 now) {
+    const U64 target = now >> TICK_SHIFT;
+    while (m_tick < target) {
+        // Nothing left in the slots, skip the remaining ticks
+        if (m_entries == m_pending.size()) {
+            m_tick = target;
+            return;
+        }
+        m_tick += 1;
+
+        // Move the timers of the slots reached in higher levels down
+        auto cascade = [this](std::vector<Timer*>& slot) {
+            std::vector<Timer*> timers;
+            timers.swap(slot);
+            for (Timer* timer : timers) {
+                if (timer->cancelled) {
+                    m_entries -= 1;
+                    delete timer;
+                } else {
+                    insert(timer);
+                }
+            }
+        };
+        if ((m_tick & ((1ULL << (SLOT_BITS * LEVELS)) - 1)) == 0) {
+            cascade(m_overflow);
+        }
+        for (U32 level = 1; level < LEVELS; level++) {
+            const U32 shift = SLOT_BITS * level;
+            if ((m_tick & ((1ULL << shift) - 1)) != 0) {
+                break;
+            }
+            cascade(m_slots[level][(m_tick >> shift) & (SLOTS - 1)]);
+        }
+        cascade(m_slots[0][m_tick & (SLOTS - 1)]);
+    }
+}
+
+U64 TimerWheel::nextWakeTime(bool& precise) const {
+    U64 wakeTime = NEVER;
+    precise = false;
+    if (!m_pending.empty()) {
+        wakeTime = m_pending.front()->deadline;
+        precise = true;
+    }
+
+    // Timers of level 0 are woken up for at their deadline, higher levels at their cascade
+    for (U32 level = 0; level < LEVELS; level++) {
+        const U32 shift = SLOT_BITS * level;
+        const U64 current = m_tick >> shift;
+        for (U32 i = 1; i <= SLOTS; i++) {
+            const auto& slot = m_slots[level][(current + i) & (SLOTS - 1)];
+            if (slot.empty()) {
+                continue;
+            }
+            if (level == 0) {
+                for (const Timer* timer : slot) {
+                    if (timer->deadline < wakeTime) {
+                        wakeTime = timer->deadline;
+                        precise = true;
+                    }
+                }
+            } else {
+                const U64 start = ((current + i) << shift) << TICK_SHIFT;
+                if (start < wakeTime) {
+                    wakeTime = start;
+                    precise = false;
+                }
+            }
+            break;
+        }
+    }
+    if (!m_overflow.empty()) {
+        const U32 shift = SLOT_BITS * LEVELS;
+        const U64 start = (((m_tick >> shift) + 1) << shift) << TICK_SHIFT;
+        if (start < wakeTime) {
+            wakeTime = start;
+            precise = false;
+        }
+    }
+    return wakeTime;
+}
+
+void TimerWheel::fire(std::unique_lock<std::mutex>& lock, U64 now) {
+    auto later = [](Timer* a, Timer* b) {
+        return a->deadline > b->deadline;
+    };
+    while (!m_pending.empty() && m_pending.front()->deadline <= now) {
+        std::pop_heap(m_pending.begin(), m_pending.end(), later);
+        Timer* timer = m_pending.back();
+        m_pending.pop_back();
+        if (timer->cancelled) {
+            m_entries -= 1;
+            delete timer;
+            continue;
+        }
+        if (!timer->period) {
+            m_timers.erase(timer->id);
+        }
+
+        m_running = timer;
+        lock.unlock();
+        timer->callback(timer->deadline);
+        const U64 end = Timebase::readHostClock();
+        lock.lock();
+        m_running = nullptr;
+        m_runningDone.notify_all();
+
+        const U64 lateness = end - timer->deadline;
+        statFired.fetch_add(1, std::memory_order_relaxed);
+        statLateness.fetch_add(lateness, std::memory_order_relaxed);
+        if (lateness > statLatenessMax.load(std::memory_order_relaxed)) {
+            statLatenessMax.store(lateness, std::memory_order_relaxed);
+        }
+
+        if (timer->period && !timer->cancelled) {
+            timer->deadline += timer->period;
+            if (timer->deadline <= end) {
+                timer->deadline += ((end - timer->deadline) / timer->period + 1) * timer->period;
+            }
+            insert(timer);
+        } else {
+            m_entries -= 1;
+            delete timer;
+        }
+    }
+}
+
+void TimerWheel::armHost(U64 wakeTime) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    HANDLE timer = reinterpret_cast<HANDLE>(m_hostTimer);
+    if (wakeTime == NEVER) {
+        CancelWaitableTimer(timer);
+        return;
+    }
+    // Relative due times in 100-nanosecond units, negative by convention
+    const U64 now = Timebase::readHostClock();
+    LARGE_INTEGER due;
+    due.QuadPart = -std::max<S64>(S64((wakeTime > now) ? (wakeTime - now) / 100 : 0), 1);
+    SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE);
+#elif defined(NUCLEUS_TARGET_LINUX)
+    itimerspec spec = {};
+    if (wakeTime != NEVER) {
+        // Convert to CLOCK_MONOTONIC, with 0 meaning disarmed
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const S64 delta = S64(wakeTime - Timebase::readHostClock());
+        const S64 absolute = std::max<S64>(S64(now.tv_sec) * 1000000000 + now.tv_nsec + delta, 1);
+        spec.it_value.tv_sec = absolute / 1000000000;
+        spec.it_value.tv_nsec = absolute % 1000000000;
+    }
+    timerfd_settime(int(m_hostTimer), TFD_TIMER_ABSTIME, &spec, nullptr);
+#else
+    m_hostEvent.notify_one();
+#endif
+}
+
+void TimerWheel::sleepHost(std::unique_lock<std::mutex>& lock) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    lock.unlock();
+    WaitForSingleObject(reinterpret_cast<HANDLE>(m_hostTimer), INFINITE);
+    lock.lock();
+#elif defined(NUCLEUS_TARGET_LINUX)
+    lock.unlock();
+    U64 expirations;
+    if (read(int(m_hostTimer), &expirations, sizeof(expirations)) < 0) {
+        // Interrupted, the caller re-evaluates its deadlines anyway
+    }
+    lock.lock();
+#else
+    const U64 wakeTime = m_wakeTime.load(std::memory_order_relaxed);
+    if (wakeTime == NEVER) {
+        m_hostEvent.wait(lock);
+    } else {
+        const U64 now = Timebase::readHostClock();
+        m_hostEvent.wait_for(lock, std::chrono::nanoseconds((wakeTime > now) ? wakeTime - now : 0));
+    }
+#endif
+}
+
+void TimerWheel::threadLoop() {
+    ThreadPolicy::registerThread(THREAD_ROLE_TIMER, "Timer Wheel");
+#if defined(NUCLEUS_TARGET_LINUX)
+    prctl(PR_SET_TIMERSLACK, 1UL);
+#endif
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        U64 now = Timebase::readHostClock();
+        advance(now);
+        fire(lock, now);
+
+        now = Timebase::readHostClock();
+        advance(now);
+        if (m_stopping || (!m_pending.empty() && m_pending.front()->deadline <= now)) {
+            continue;
+        }
+
+        bool precise;
+        const U64 wakeTime = nextWakeTime(precise);
+        if (precise && wakeTime <= now + SPIN_TAIL) {
+            // Spin until the deadline, unless an earlier timer is added meanwhile
+            m_wakeTime.store(wakeTime, std::memory_order_relaxed);
+            lock.unlock();
+            while (Timebase::readHostClock() < wakeTime && m_wakeTime.load(std::memory_order_relaxed) == wakeTime) {
+                std::this_thread::yield();
+            }
+            lock.lock();
+        } else {
+            const U64 target = (precise && wakeTime != NEVER) ? wakeTime - SPIN_TAIL : wakeTime;
+            m_wakeTime.store(target, std::memory_order_relaxed);
+            armHost(target);
+            sleepHost(lock);
+        }
+        m_wakeTime.store(0, std::memory_order_relaxed);
+    }
+}
+
+TimerWheelStatistics TimerWheel::getStatistics() const {
+    TimerWheelStatistics stats;
+    stats.fired = statFired.load(std::memory_order_relaxed);
+    stats.lateness = statLateness.load(std::memory_order_relaxed);
+    stats.latenessMax = statLatenessMax.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace core
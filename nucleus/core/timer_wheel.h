@@ -0,0 +1,157 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace core {
+
+struct TimerWheelStatistics {
+    U64 fired = 0;        // Callbacks invoked
+    U64 lateness = 0;     // Accumulated time from deadline to callback, in nanoseconds
+    U64 latenessMax = 0;  // Longest time from deadline to callback, in nanoseconds
+};
+
+/**
+ * Timer wheel
+ * ===========
+ * Single host thread invoking callbacks at deadlines of the host monotonic clock (see
+ * Timebase::readHostClock), serving all timeouts and periodic timers of the emulator.
+ *
+ * Timers are kept in a hierarchical wheel of LEVELS levels with SLOTS slots each. A slot of
+ * level 0 spans one tick of 2^TICK_SHIFT nanoseconds and a slot of level N spans SLOTS^N
+ * ticks. Timers are placed in the lowest level whose range covers their deadline, and move
+ * down a level (cascade) whenever the wheel reaches their slot, so that inserting and
+ * cancelling timers costs O(1) regardless of how many are pending.
+ *
+ * Notes:
+ * - The thread sleeps until SPIN_TAIL nanoseconds before the next deadline using an absolute
+ *   timerfd on Linux and a high-resolution waitable timer on Windows, and spins the rest of
+ *   the way, so callbacks run within a few microseconds of their deadline.
+ * - Callbacks run on the wheel thread without any lock held, and must not block nor take
+ *   locks that are held while calling TimerWheel::cancel. Typically they modify an atomic
+ *   word and wake up its futex.
+ */
+class TimerWheel {
+public:
+    // Callback invoked with the deadline it was scheduled for
+    using Callback = std::function<void(U64 deadline)>;
+
+    static constexpr U32 TICK_SHIFT = 16;
+    static constexpr U32 SLOT_BITS = 6;
+    static constexpr U32 SLOTS = 1 << SLOT_BITS;
+    static constexpr U32 LEVELS = 4;
+
+    // Deadlines closer than this are waited for by spinning, in nanoseconds
+    static constexpr U64 SPIN_TAIL = 50000;
+
+private:
+    struct Timer {
+        U64 id;
+        U64 deadline;
+        U64 period;
+        Callback callback;
+        bool cancelled = false;
+    };
+
+    std::mutex m_mutex;
+    std::thread m_thread;
+    bool m_stopping = false;
+
+    // Wheel state, protected by the mutex
+    U64 m_tick;
+    U64 m_nextId = 1;
+    Size m_entries = 0;
+    std::vector<Timer*> m_slots[LEVELS][SLOTS];
+    std::vector<Timer*> m_overflow;
+    std::vector<Timer*> m_pending;  // Timers of elapsed ticks, as a min-heap by deadline
+    std::unordered_map<U64, Timer*> m_timers;
+
+    // Timer whose callback is running, waited for by TimerWheel::cancel
+    Timer* m_running = nullptr;
+    std::condition_variable m_runningDone;
+
+    // Time at which the wheel thread will wake up next, or 0 while it is awake
+    std::atomic<U64> m_wakeTime;
+
+    // Host sleeping primitive: timerfd on Linux, waitable timer on Windows
+    intptr_t m_hostTimer;
+    std::condition_variable m_hostEvent;
+
+    // Statistics
+    std::atomic<U64> statFired;
+    std::atomic<U64> statLateness;
+    std::atomic<U64> statLatenessMax;
+
+    void insert(Timer* timer);
+    void advance(U64 now);
+    U64 nextWakeTime(bool& precise) const;
+    void fire(std::unique_lock<std::mutex>& lock, U64 now);
+
+    // Make the wheel thread wake up at the given host time, must be called with the lock held
+    void armHost(U64 wakeTime);
+    void sleepHost(std::unique_lock<std::mutex>& lock);
+
+    void threadLoop();
+
+public:
+    TimerWheel();
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Process-wide timer wheel
+    static TimerWheel& get();
+
+    /**
+     * Schedule a callback
+     * @param[in]  deadline  Host time of the first invocation in nanoseconds
+     * @param[in]  period    Interval between invocations in nanoseconds, or 0 for a single one.
+     *                       Periods missed while the wheel was late are skipped.
+     * @param[in]  callback  Function to invoke on the wheel thread
+     * @return               Timer identifier, never 0
+     */
+    U64 add(U64 deadline, U64 period, Callback callback);
+
+    /**
+     * Cancel a timer, waiting for its callback to return if it is running
+     * @param[in]  id  Timer identifier
+     * @return         False if the timer did not exist or already fired its last time
+     */
+    bool cancel(U64 id);
+
+    /**
+     * Block the calling thread until the given host time
+     * @param[in]  deadline  Host time in nanoseconds
+     */
+    void sleepUntil(U64 deadline);
+
+    /**
+     * Block the calling thread while the word holds the expected value, at most until the
+     * given host time. The wheel wakes up all waiters on the word at the deadline, and a
+     * futex timeout bounds the wait in case that wakeup comes before the wait starts.
+     * As with core::futexWait, the caller must re-check its condition in a loop.
+     * @param[in]  word      Atomic word to wait on
+     * @param[in]  expected  Value the word is expected to hold
+     * @param[in]  deadline  Host time in nanoseconds
+     * @return               False if the deadline passed
+     */
+    bool waitUntil(std::atomic<U32>& word, U32 expected, U64 deadline);
+
+    // Get a snapshot of the timer statistics
+    TimerWheelStatistics getStatistics() const;
+};
+
+}  // namespace core
@@ -0,0 +1,270 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "code_arena.h"
+#include "nucleus/logger/logger.h"
+
+#ifdef NUCLEUS_TARGET_WINDOWS
+#include <Windows.h>
+#endif
+#if defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#ifdef NUCLEUS_TARGET_OSX
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+namespace cpu {
+namespace backend {
+
+constexpr Size CodeArena::ALIGNMENT;
+constexpr Size CodeArena::CLASS_MAX;
+constexpr Size CodeArena::CLASS_COUNT;
+
+namespace {
+
+// Every block starts with a header of ALIGNMENT bytes holding the total size of the block
+struct BlockHeader {
+    Size size;
+};
+
+// Smallest remainder worth splitting from a large free block
+constexpr Size SPLIT_MIN = 4 * CodeArena::ALIGNMENT;
+
+}  // anonymous namespace
+
+CodeArena::CodeArena(Size capacity) {
+    if (!mapDual(capacity)) {
+        logger.warning(LOG_CPU, "Could not create a dual mapping for the code arena, using RWX memory");
+        mapSingle(capacity);
+    }
+    stats.capacity = this->capacity;
+}
+
+CodeArena::~CodeArena() {
+    unmap();
+}
+
+bool CodeArena::mapDual(Size size) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_EXECUTE_READWRITE,
+        DWORD(U64(size) >> 32), DWORD(size), nullptr);
+    if (!mapping) {
+        return false;
+    }
+    void* exec = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size);
+    void* write = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+    if (!exec || !write) {
+        if (exec) UnmapViewOfFile(exec);
+        if (write) UnmapViewOfFile(write);
+        CloseHandle(mapping);
+        return false;
+    }
+    handle = mapping;
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    int fd = -1;
+#if defined(NUCLEUS_TARGET_LINUX)
+    fd = memfd_create("nucleus-code", MFD_CLOEXEC);
+#endif
+    if (fd < 0) {
+        // Anonymous POSIX shared memory object, unlinked right after creation
+        char name[64];
+        snprintf(name, sizeof(name), "/nucleus-code-%d", int(getpid()));
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        shm_unlink(name);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return false;
+    }
+    void* exec = mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+    void* write = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (exec == MAP_FAILED || write == MAP_FAILED) {
+        if (exec != MAP_FAILED) munmap(exec, size);
+        if (write != MAP_FAILED) munmap(write, size);
+        close(fd);
+        return false;
+    }
+    handle = fd;
+#else
+    return false;
+#endif
+    execBase = static_cast<U08*>(exec);
+    writeBase = static_cast<U08*>(write);
+    capacity = size;
+    return true;
+}
+
+void CodeArena::mapSingle(Size size) {
+    void* addr = nullptr;
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    addr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        addr = nullptr;
+    }
+#endif
+    if (!addr) {
+        logger.error(LOG_CPU, "Could not allocate %d bytes of executable memory", size);
+        return;
+    }
+    execBase = static_cast<U08*>(addr);
+    writeBase = static_cast<U08*>(addr);
+    capacity = size;
+}
+
+void CodeArena::unmap() {
+    if (!execBase) {
+        return;
+    }
+    const bool dual = (execBase != writeBase);
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    if (dual) {
+        UnmapViewOfFile(execBase);
+        UnmapViewOfFile(writeBase);
+        CloseHandle(handle);
+    } else {
+        VirtualFree(execBase, 0, MEM_RELEASE);
+    }
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    munmap(execBase, capacity);
+    if (dual) {
+        munmap(writeBase, capacity);
+        close(handle);
+    }
+#endif
+    execBase = nullptr;
+    writeBase = nullptr;
+}
+
+Size CodeArena::takeLarge(Size& blockSize) {
+    // First fit among large blocks, splitting off the remainder
+    for (auto it = freeLarge.begin(); it != freeLarge.end(); ++it) {
+        if (it->size < blockSize) {
+            continue;
+        }
+        const Size offset = it->offset;
+        const Size remainder = it->size - blockSize;
+        freeLarge.erase(it);
+        stats.free -= blockSize + remainder;
+        stats.reused += 1;
+        if (remainder >= SPLIT_MIN) {
+            const Size rest = offset + blockSize;
+            reinterpret_cast<BlockHeader*>(writeBase + rest)->size = remainder;
+            if (remainder <= CLASS_MAX) {
+                freeLists[remainder / ALIGNMENT - 1].push_back(rest);
+            } else {
+                freeLarge.push_back({ rest, remainder });
+            }
+            stats.free += remainder;
+        } else {
+            blockSize += remainder;
+        }
+        return offset;
+    }
+    return capacity;
+}
+
+void* CodeArena::tryAlloc(Size blockSize) {
+    Size offset = capacity;
+
+    // Reuse evicted blocks first: exact size class for small blocks, first fit for large ones
+    if (blockSize <= CLASS_MAX) {
+        auto& list = freeLists[blockSize / ALIGNMENT - 1];
+        if (!list.empty()) {
+            offset = list.back();
+            list.pop_back();
+            stats.free -= blockSize;
+            stats.reused += 1;
+        }
+    } else {
+        offset = takeLarge(blockSize);
+    }
+
+    // Bump pointer, and as last resort split a large block for a small allocation
+    if (offset == capacity && blockSize <= capacity - top) {
+        offset = top;
+        top += blockSize;
+        stats.top = top;
+    }
+    if (offset == capacity && blockSize <= CLASS_MAX) {
+        offset = takeLarge(blockSize);
+    }
+    if (offset == capacity) {
+        return nullptr;
+    }
+
+    reinterpret_cast<BlockHeader*>(writeBase + offset)->size = blockSize;
+    stats.used += blockSize;
+    stats.allocations += 1;
+    return execBase + offset + ALIGNMENT;
+}
+
+void* CodeArena::alloc(Size size) {
+    const Size blockSize = ALIGNMENT + ((size + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+
+    EvictionHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (void* addr = tryAlloc(blockSize)) {
+            return addr;
+        }
+        handler = evictionHandler;
+    }
+
+    // Let the owner release code without holding the lock, then retry once
+    if (handler) {
+        handler(*this);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (void* addr = tryAlloc(blockSize)) {
+            return addr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.failures += 1;
+    logger.error(LOG_CPU, "Code arena is full, could not allocate %d bytes", size);
+    return nullptr;
+}
+
+void CodeArena::free(void* addr) {
+    if (!addr) {
+        return;
+    }
+    const Size offset = static_cast<U08*>(addr) - execBase - ALIGNMENT;
+    const Size blockSize = reinterpret_cast<const BlockHeader*>(writeBase + offset)->size;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (blockSize <= CLASS_MAX) {
+        freeLists[blockSize / ALIGNMENT - 1].push_back(offset);
+    } else {
+        freeLarge.push_back({ offset, blockSize });
+    }
+    stats.used -= blockSize;
+    stats.free += blockSize;
+    stats.evictions += 1;
+}
+
+void CodeArena::setEvictionHandler(EvictionHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    evictionHandler = std::move(handler);
+}
+
+CodeArenaStatistics CodeArena::getStatistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,153 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace cpu {
+namespace backend {
+
+struct CodeArenaStatistics {
+    Size capacity = 0;     // Size of the arena in bytes
+    Size used = 0;         // Bytes held by live allocations, including headers
+    Size free = 0;         // Bytes held by the free lists
+    Size top = 0;          // Bytes handed out by the bump pointer
+    U64 allocations = 0;   // Successful allocations
+    U64 reused = 0;        // Allocations served from the free lists
+    U64 evictions = 0;     // Blocks returned with CodeArena::free
+    U64 failures = 0;      // Allocations that could not be served
+
+    // Fraction of the arena held by live code
+    double occupancy() const {
+        return capacity ? double(used) / double(capacity) : 0.0;
+    }
+    // Fraction of the bump-allocated space that is free but not contiguous with the top
+    double fragmentation() const {
+        return top ? double(free) / double(top) : 0.0;
+    }
+};
+
+/**
+ * Code Arena
+ * ==========
+ * Thread-safe allocator of executable memory for generated code. The arena is a single
+ * shared memory object mapped twice: once readable and executable, where code runs, and
+ * once readable and writable, where code is written (W^X). No page is ever writable and
+ * executable through the same mapping, and protections are never changed afterwards.
+ *
+ * Allocation:
+ * - Blocks are carved from the arena with a bump pointer. Each block starts with a header
+ *   holding its size, followed by the code, aligned to CodeArena::ALIGNMENT.
+ * - Evicted blocks go to a free list: blocks up to CodeArena::CLASS_MAX bytes are kept in
+ *   exact size classes, larger ones in a single first-fit list. Free lists are checked
+ *   before bumping the pointer.
+ * - When the arena is full, the eviction handler (if any) is invoked so that its owner
+ *   can free code that no thread can reach anymore, and the allocation is retried once.
+ *
+ * Notes:
+ * - CodeArena::alloc returns addresses in the executable view. Use CodeArena::getWritable
+ *   to obtain the address where the code has to be written.
+ * - There is no way to discard all code at once: guest threads run their whole lifetime
+ *   inside generated code, so blocks can only be freed by owners that know them unreachable.
+ * - If the host does not allow dual mappings, the arena falls back to a single RWX mapping.
+ */
+class CodeArena {
+public:
+    static constexpr Size ALIGNMENT = 16;
+    static constexpr Size CLASS_MAX = 4096;
+
+    using EvictionHandler = std::function<void(CodeArena& arena)>;
+
+private:
+    static constexpr Size CLASS_COUNT = CLASS_MAX / ALIGNMENT;
+
+    struct FreeBlock {
+        Size offset;
+        Size size;
+    };
+
+    // Views of the arena memory
+    U08* execBase = nullptr;
+    U08* writeBase = nullptr;
+    Size capacity = 0;
+
+    // Host handle of the shared memory object
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    void* handle = nullptr;
+#else
+    int handle = -1;
+#endif
+
+    std::mutex mutex;
+    Size top = 0;
+    std::vector<Size> freeLists[CLASS_COUNT];
+    std::vector<FreeBlock> freeLarge;
+    EvictionHandler evictionHandler;
+    CodeArenaStatistics stats;
+
+    // Map the arena memory, returns false if no dual mapping could be created
+    bool mapDual(Size size);
+    void mapSingle(Size size);
+    void unmap();
+
+    // Take a block from the large free list, returns the arena capacity if none fits
+    Size takeLarge(Size& blockSize);
+
+    // Try to allocate a block with the arena lock held
+    void* tryAlloc(Size blockSize);
+
+public:
+    // Constructor
+    CodeArena(Size capacity = 64 * 1024 * 1024);
+    ~CodeArena();
+
+    /**
+     * Allocate executable memory
+     * @param[in]  size  Number of bytes to allocate
+     * @return           Executable address aligned to CodeArena::ALIGNMENT, or nullptr if full
+     */
+    void* alloc(Size size);
+
+    /**
+     * Return executable memory to the free lists, e.g. after evicting its code
+     * @param[in]  addr  Address returned by CodeArena::alloc
+     */
+    void free(void* addr);
+
+    /**
+     * Translate an executable address into the writable view of the same memory
+     * @param[in]  addr  Address inside the arena
+     * @return           Writable address of the same byte
+     */
+    void* getWritable(void* addr) const {
+        return writeBase + (static_cast<U08*>(addr) - execBase);
+    }
+
+    /**
+     * Check whether an executable address belongs to this arena
+     * @param[in]  addr  Address to check
+     * @return           True if the address is inside the executable view
+     */
+    bool contains(const void* addr) const {
+        return execBase <= addr && addr < execBase + capacity;
+    }
+
+    /**
+     * Set the function called when an allocation does not fit in the arena
+     * @param[in]  handler  Callback that should free unreachable code
+     */
+    void setEvictionHandler(EvictionHandler handler);
+
+    // Get a snapshot of the usage statistics
+    CodeArenaStatistics getStatistics();
+};
+
+}  // namespace backend
+}  // namespace cpu
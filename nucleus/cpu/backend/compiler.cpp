@@ -4,20 +4,9 @@
  */
 
 #include "compiler.h"
+#include "nucleus/cpu/hir/passes.h"
 #include "nucleus/logger/logger.h"
 
-#ifdef NUCLEUS_TARGET_WINDOWS
-#include <Windows.h>
-#endif
-#ifdef NUCLEUS_TARGET_LINUX
-#include <unistd.h>
-#include <sys/mman.h>
-#endif
-#ifdef NUCLEUS_TARGET_OSX
-#include <sys/mman.h>
-#define MAP_ANONYMOUS MAP_ANON
-#endif
-
 namespace cpu {
 namespace backend {
 
@@ -34,46 +23,44 @@ Compiler::Compiler(const Settings& settings) : settings(settings) {
 }
 
 bool Compiler::optimize(Function* function) {
-    // TODO: Run passes in parallel
-    std::lock_guard<std::mutex> lock(pass_mutex);
-    for (auto& pass : passes) {
-        if (!pass->run(function)) {
-            logger.error(LOG_CPU, "Could not run pass: %s", pass->name());
-            return false;
-        }
-    }
-    return true;
+    return passManager.run(function);
 }
 
 void Compiler::addPass(std::unique_ptr<Pass> pass) {
-    passes.push_back(std::move(pass));
+    passManager.addPass(std::move(pass));
 }
 
-void* Compiler::allocRWXMemory(Size size) {
-    void* addr = malloc(size);
+void Compiler::setPipeline(ConfigCpuPipeline pipeline) {
+    passManager.clearPasses();
 
-    // Enable execution permissions
-#ifdef NUCLEUS_TARGET_WINDOWS
-    DWORD oldProtect;
-    if (!VirtualProtect(addr, size, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        logger.error(LOG_CPU, "Could not allocate %d bytes of RWX memory", size);
-        return nullptr;
-    }
-#endif
-#ifdef NUCLEUS_TARGET_LINUX
-    size_t pageSize = sysconf(_SC_PAGESIZE);
-    size_t iaddr = reinterpret_cast<size_t>(addr);
-    size_t roundedAddr = iaddr & ~(pageSize - 1);
-    if (!mprotect(reinterpret_cast<void*>(roundedAddr), size + (iaddr - roundedAddr), PROT_READ | PROT_WRITE | PROT_EXEC)) {
-        logger.error(LOG_CPU, "Could not allocate %d bytes of RWX memory", size);
-        return nullptr;
+    // Optimization passes
+    switch (pipeline) {
+    case CPU_PIPELINE_FAST:
+        break;
+    case CPU_PIPELINE_BALANCED:
+        addPass(std::make_unique<passes::GlobalValueNumberingPass>());
+        break;
+    case CPU_PIPELINE_MAX:
+        addPass(std::make_unique<passes::GlobalValueNumberingPass>());
+        addPass(std::make_unique<passes::DeadCodeEliminationPass>());
+        break;
+    default:
+        logger.warning(LOG_CPU, "Unknown pipeline preset");
     }
-#endif
-    return addr;
+
+    // Mandatory passes
+    addPass(std::make_unique<passes::RegisterAllocationPass>(targetInfo));
 }
 
-void Compiler::freeRWXMemory(void* addr) {
-    free(addr);
+void Compiler::release(Function* function) {
+    // Extern functions point to host code outside the arena
+    if (!codeArena.contains(function->nativeAddress)) {
+        return;
+    }
+    codeArena.free(function->nativeAddress);
+    function->nativeAddress = nullptr;
+    function->nativeSize = 0;
+    function->flags &= ~FUNCTION_IS_COMPILED;
 }
 
 }  // namespace backend
@@ -6,26 +6,32 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/core/config.h"
+#include "nucleus/cpu/backend/code_arena.h"
+#include "nucleus/cpu/backend/perf_map.h"
 #include "nucleus/cpu/backend/settings.h"
 #include "nucleus/cpu/backend/target.h"
 #include "nucleus/cpu/hir/block.h"
 #include "nucleus/cpu/hir/function.h"
 #include "nucleus/cpu/hir/module.h"
 #include "nucleus/cpu/hir/pass.h"
+#include "nucleus/cpu/hir/pass_manager.h"
 #include "nucleus/cpu/hir/value.h"
 
 #include <memory>
-#include <mutex>
 #include <vector>
 
 namespace cpu {
 namespace backend {
 
+/**
+ * Compiler
+ * ========
+ * Optimizes HIR functions and generates native code for them. Several functions can be
+ * compiled concurrently from different threads: passes keep their state per run and
+ * executable memory is obtained from a thread-safe W^X arena.
+ */
 class Compiler {
-    // Compiler passes
-    std::vector<std::unique_ptr<hir::Pass>> passes;
-    std::mutex pass_mutex;
-
 protected:
     // Optimize HIR
     virtual bool optimize(hir::Function* function);
@@ -37,6 +43,15 @@ public:
     // Generic target information
     TargetInfo targetInfo;
 
+    // Compiler passes
+    hir::PassManager passManager;
+
+    // Executable memory for generated code
+    CodeArena codeArena;
+
+    // Profiler output for generated code (optional)
+    std::unique_ptr<PerfMap> perfMap;
+
     // Constructor
     Compiler();
     Compiler(const Settings& settings);
@@ -44,11 +59,23 @@ public:
     // Add optimization passes
     virtual void addPass(std::unique_ptr<hir::Pass> pass);
 
+    /**
+     * Replace the current passes with a predefined pipeline
+     * @param[in]  pipeline  Pipeline preset
+     */
+    virtual void setPipeline(ConfigCpuPipeline pipeline);
+
     // Compile HIR
     virtual bool compile(hir::Block* block) = 0;
     virtual bool compile(hir::Function* function) = 0;
     virtual bool compile(hir::Module* module) = 0;
 
+    /**
+     * Return the generated code of a function to the code arena
+     * @param[in]  function  Compiled function, whose code no thread can reach anymore
+     */
+    void release(hir::Function* function);
+
     /**
      * Runs a compiled function
      * @param[in]  function   Function to be called
@@ -56,10 +83,6 @@ public:
      * @param[in]  arguments  Arguments as an array of constant values
      */
     virtual bool call(hir::Function* function, void* state, const std::vector<hir::Value*>& args = {}) = 0;
-
-    // Manage RWX memory
-    void* allocRWXMemory(Size size);
-    void freeRWXMemory(void* addr);
 };
 
 }  // namespace backend
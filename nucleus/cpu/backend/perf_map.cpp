@@ -0,0 +1,197 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "perf_map.h"
+#include "nucleus/format.h"
+#include "nucleus/logger/logger.h"
+
+#ifdef NUCLEUS_TARGET_LINUX
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cstring>
+#include <vector>
+
+namespace cpu {
+namespace backend {
+
+#ifdef NUCLEUS_TARGET_LINUX
+namespace {
+
+// Jitdump format (see: tools/perf/Documentation/jitdump-specification.txt in Linux sources)
+enum : U32 {
+    JITDUMP_MAGIC    = 0x4A695444,  // "JiTD"
+    JITDUMP_VERSION  = 1,
+};
+
+enum JitdumpRecordType : U32 {
+    JIT_CODE_LOAD   = 0,
+    JIT_CODE_CLOSE  = 3,
+};
+
+struct JitdumpHeader {
+    U32 magic;
+    U32 version;
+    U32 totalSize;
+    U32 elfMach;
+    U32 pad1;
+    U32 pid;
+    U64 timestamp;
+    U64 flags;
+};
+
+struct JitdumpRecordHeader {
+    U32 id;
+    U32 totalSize;
+    U64 timestamp;
+};
+
+struct JitdumpCodeLoad {
+    JitdumpRecordHeader header;
+    U32 pid;
+    U32 tid;
+    U64 vma;
+    U64 codeAddr;
+    U64 codeSize;
+    U64 codeIndex;
+    // Followed by the null-terminated name and the code bytes
+};
+
+// Timestamps must match the clock used by `perf record -k mono`
+U64 getTimestamp() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return U64(ts.tv_sec) * 1000000000ULL + U64(ts.tv_nsec);
+}
+
+}  // anonymous namespace
+#endif
+
+PerfMap::PerfMap(bool enableMap, bool enableJitdump) {
+#ifdef NUCLEUS_TARGET_LINUX
+    if (enableMap) {
+        openMap();
+    }
+    if (enableJitdump) {
+        openJitdump();
+    }
+#else
+    if (enableMap || enableJitdump) {
+        logger.warning(LOG_CPU, "Perf map and jitdump outputs are only available on Linux");
+    }
+#endif
+}
+
+PerfMap::~PerfMap() {
+    if (mapFile) {
+        fclose(mapFile);
+    }
+    closeJitdump();
+}
+
+void PerfMap::openMap() {
+#ifdef NUCLEUS_TARGET_LINUX
+    const std::string path = format("/tmp/perf-%d.map", int(getpid()));
+    mapFile = fopen(path.c_str(), "w");
+    if (!mapFile) {
+        logger.warning(LOG_CPU, "Could not create perf map: %s", path.c_str());
+    }
+#endif
+}
+
+void PerfMap::openJitdump() {
+#ifdef NUCLEUS_TARGET_LINUX
+    const std::string path = format("/tmp/jit-%d.dump", int(getpid()));
+    dumpFile = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0666);
+    if (dumpFile < 0) {
+        logger.warning(LOG_CPU, "Could not create jitdump: %s", path.c_str());
+        return;
+    }
+
+    // Perf finds the dump through an executable mapping of the file recorded in the trace
+    dumpMarkerSize = sysconf(_SC_PAGESIZE);
+    dumpMarker = mmap(nullptr, dumpMarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, dumpFile, 0);
+    if (dumpMarker == MAP_FAILED) {
+        dumpMarker = nullptr;
+        logger.warning(LOG_CPU, "Could not map jitdump marker: %s", path.c_str());
+    }
+
+    JitdumpHeader header = {};
+    header.magic = JITDUMP_MAGIC;
+    header.version = JITDUMP_VERSION;
+    header.totalSize = sizeof(JitdumpHeader);
+#if defined(NUCLEUS_ARCH_X86_64BITS)
+    header.elfMach = 62;  // EM_X86_64
+#elif defined(NUCLEUS_ARCH_X86_32BITS)
+    header.elfMach = 3;   // EM_386
+#endif
+    header.pid = getpid();
+    header.timestamp = getTimestamp();
+    if (write(dumpFile, &header, sizeof(header)) != sizeof(header)) {
+        logger.warning(LOG_CPU, "Could not write jitdump header: %s", path.c_str());
+    }
+#endif
+}
+
+void PerfMap::closeJitdump() {
+#ifdef NUCLEUS_TARGET_LINUX
+    if (dumpFile < 0) {
+        return;
+    }
+    JitdumpRecordHeader record = {};
+    record.id = JIT_CODE_CLOSE;
+    record.totalSize = sizeof(record);
+    record.timestamp = getTimestamp();
+    write(dumpFile, &record, sizeof(record));
+    if (dumpMarker) {
+        munmap(dumpMarker, dumpMarkerSize);
+    }
+    close(dumpFile);
+    dumpFile = -1;
+#endif
+}
+
+void PerfMap::addFunction(const void* addr, Size size, const std::string& name) {
+#ifdef NUCLEUS_TARGET_LINUX
+    if (!mapFile && dumpFile < 0) {
+        return;
+    }
+    const U64 start = reinterpret_cast<U64>(addr);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mapFile) {
+        fprintf(mapFile, "%llx %llx %s\n", (unsigned long long)start, (unsigned long long)size, name.c_str());
+        fflush(mapFile);
+    }
+    if (dumpFile >= 0) {
+        JitdumpCodeLoad record = {};
+        record.header.id = JIT_CODE_LOAD;
+        record.header.totalSize = U32(sizeof(record) + name.size() + 1 + size);
+        record.header.timestamp = getTimestamp();
+        record.pid = getpid();
+        record.tid = U32(syscall(SYS_gettid));
+        record.vma = start;
+        record.codeAddr = start;
+        record.codeSize = size;
+        record.codeIndex = dumpCodeIndex++;
+
+        // Write the whole record at once, so that readers never see partial records
+        std::vector<U08> buffer(record.header.totalSize);
+        memcpy(&buffer[0], &record, sizeof(record));
+        memcpy(&buffer[sizeof(record)], name.c_str(), name.size() + 1);
+        memcpy(&buffer[sizeof(record) + name.size() + 1], addr, size);
+        if (write(dumpFile, buffer.data(), buffer.size()) != ssize_t(buffer.size())) {
+            logger.warning(LOG_CPU, "Could not write jitdump record for: %s", name.c_str());
+        }
+    }
+#endif
+}
+
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,63 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace cpu {
+namespace backend {
+
+/**
+ * Perf Map
+ * ========
+ * Publishes the location of generated code to the Linux `perf` profiler, so that host
+ * samples in translated code are attributed to the corresponding guest function.
+ * Two outputs are available:
+ * - Perf map: Text file at /tmp/perf-<pid>.map with one "<start> <size> <name>" line per
+ *   function. Read by `perf report` directly.
+ * - Jitdump: Binary file at /tmp/jit-<pid>.dump that also contains the generated code,
+ *   allowing annotation. Requires `perf record -k mono` followed by `perf inject --jit`.
+ *
+ * Notes:
+ * - Only available on Linux, on other platforms this class does nothing.
+ * - Functions can be registered concurrently from several compiler threads.
+ */
+class PerfMap {
+    std::mutex mutex;
+
+    // Perf map output
+    FILE* mapFile = nullptr;
+
+    // Jitdump output
+    int dumpFile = -1;
+    void* dumpMarker = nullptr;
+    Size dumpMarkerSize = 0;
+    U64 dumpCodeIndex = 0;
+
+    void openMap();
+    void openJitdump();
+    void closeJitdump();
+
+public:
+    // Constructor
+    PerfMap(bool enableMap, bool enableJitdump);
+    ~PerfMap();
+
+    /**
+     * Register the location of a compiled function
+     * @param[in]  addr  Executable address of the generated code
+     * @param[in]  size  Size in bytes of the generated code
+     * @param[in]  name  Symbol name of the function
+     */
+    void addFunction(const void* addr, Size size, const std::string& name);
+};
+
+}  // namespace backend
+}  // namespace cpu
@@ -585,7 +585,7 @@ void PPCAssembler::vctsxs(RegVR vd, RegVR vb, U08 uimm) { emitFormVX(0x100003CA,
 void PPCAssembler::vctuxs(RegVR vd, RegVR vb, U08 uimm) { emitFormVX(0x1000038A, vd, uimm, vb); }
 void PPCAssembler::vexptefp(RegVR vd, RegVR vb) { emitFormVX(0x1000018A, vd, 0, vb); }
 void PPCAssembler::vlogefp(RegVR vd, RegVR vb) { emitFormVX(0x100001CA, vd, 0, vb); }
-void PPCAssembler::vmaddfp(RegVR vd, RegVR va, RegVR vb, RegVR vc) { emitFormVA(0x1000002E, vd, va, vb, vc); }
+void PPCAssembler::vmaddfp(RegVR vd, RegVR va, RegVR vc, RegVR vb) { emitFormVA(0x1000002E, vd, va, vb, vc); }
 void PPCAssembler::vmaxfp(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x1000040A, vd, va, vb); }
 void PPCAssembler::vmaxsb(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000102, vd, va, vb); }
 void PPCAssembler::vmaxsh(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000142, vd, va, vb); }
@@ -623,7 +623,7 @@ void PPCAssembler::vmulosb(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000108
 void PPCAssembler::vmulosh(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000148, vd, va, vb); }
 void PPCAssembler::vmuloub(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000008, vd, va, vb); }
 void PPCAssembler::vmulouh(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000048, vd, va, vb); }
-void PPCAssembler::vnmsubfp(RegVR vd, RegVR va, RegVR vb, RegVR vc) { emitFormVA(0x1000002F, vd, va, vb, vc); }
+void PPCAssembler::vnmsubfp(RegVR vd, RegVR va, RegVR vc, RegVR vb) { emitFormVA(0x1000002F, vd, va, vb, vc); }
 void PPCAssembler::vnor(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000504, vd, va, vb); }
 void PPCAssembler::vor(RegVR vd, RegVR va, RegVR vb) { emitFormVX(0x10000484, vd, va, vb); }
 void PPCAssembler::vperm(RegVR vd, RegVR va, RegVR vb, RegVR vc) { emitFormVA(0x1000002B, vd, va, vb, vc); }
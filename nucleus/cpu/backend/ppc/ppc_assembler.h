@@ -550,7 +550,7 @@ public:
     void vctuxs(RegVR vd, RegVR vb, U08 uimm);
     void vexptefp(RegVR vd, RegVR vb);
     void vlogefp(RegVR vd, RegVR vb);
-    void vmaddfp(RegVR vd, RegVR va, RegVR vb, RegVR vc);
+    void vmaddfp(RegVR vd, RegVR va, RegVR vc, RegVR vb);
     void vmaxfp(RegVR vd, RegVR va, RegVR vb);
     void vmaxsb(RegVR vd, RegVR va, RegVR vb);
     void vmaxsh(RegVR vd, RegVR va, RegVR vb);
@@ -588,7 +588,7 @@ public:
     void vmulosh(RegVR vd, RegVR va, RegVR vb);
     void vmuloub(RegVR vd, RegVR va, RegVR vb);
     void vmulouh(RegVR vd, RegVR va, RegVR vb);
-    void vnmsubfp(RegVR vd, RegVR va, RegVR vb, RegVR vc);
+    void vnmsubfp(RegVR vd, RegVR va, RegVR vc, RegVR vb);
     void vnor(RegVR vd, RegVR va, RegVR vb);
     void vor(RegVR vd, RegVR va, RegVR vb);
     void vperm(RegVR vd, RegVR va, RegVR vb, RegVR vc);
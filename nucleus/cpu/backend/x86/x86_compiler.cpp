@@ -5,6 +5,7 @@
 
 #include "x86_compiler.h"
 #include "nucleus/emulator.h"
+#include "nucleus/format.h"
 #include "nucleus/logger/logger.h"
 #include "nucleus/cpu/backend/x86/x86_sequences.h"
 
@@ -12,6 +13,7 @@
 #include <intrin.h>
 #endif
 
+#include <atomic>
 #include <cstring>
 #include <queue>
 
@@ -39,6 +41,7 @@ void X86Compiler::init() {
     int data[4];
     __cpuid(data, 0x00000001);
     extensions |= ((data[2] >> 28) & 1) ? X86Extension::AVX : 0;
+    extensions |= ((data[2] >> 12) & 1) ? X86Extension::FMA : 0;
     extensions |= 0 ? X86Extension::AVX2 : 0;
     extensions |= 0 ? X86Extension::BMI2 : 0;
     __cpuid(data, 0x80000001);
@@ -118,11 +121,23 @@ bool X86Compiler::compile(Function* function) {
 
     // Copy emitted code
     const auto codeSize = e.getSize();
-    function->nativeSize = codeSize;
-    function->nativeAddress = allocRWXMemory(codeSize);
-    memcpy(function->nativeAddress, e.getCode(), codeSize);
+    void* nativeAddress = codeArena.alloc(codeSize);
+    if (!nativeAddress) {
+        return false;
+    }
+    memcpy(codeArena.getWritable(nativeAddress), e.getCode(), codeSize);
 
+    // Publish the code only after it is complete, since other threads might call it through Function::nativeAddress
+    std::atomic_thread_fence(std::memory_order_release);
+    function->nativeSize = codeSize;
+    function->nativeAddress = nativeAddress;
     function->flags |= FUNCTION_IS_COMPILED;
+
+    if (perfMap) {
+        const std::string name = function->name.empty()
+            ? format("hir_%p", function) : function->name;
+        perfMap->addFunction(nativeAddress, codeSize, name);
+    }
     return true;
 }
 
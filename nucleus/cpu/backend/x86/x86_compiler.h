@@ -22,6 +22,7 @@ enum X86Extension {
     LZCNT  = (1 << 4),  // Leading Zeros Count
     MOVBE  = (1 << 5),  // Move Data After Swapping Bytes
     SSSE3  = (1 << 6),  // Supplemental Streaming SIMD Extensions 3
+    FMA    = (1 << 7),  // Fused Multiply-Add (FMA3)
 };
 
 class X86Compiler : public Compiler {
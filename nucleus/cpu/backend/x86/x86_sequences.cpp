@@ -2066,6 +2066,54 @@ struct FDIV_F64 : Sequence<FDIV_F64, I<OPCODE_FDIV, F64Op, F64Op, F64Op>> {
     }
 };
 
+/**
+ * Opcode: FMA
+ */
+template <typename InstrType, typename FuncFMA, typename FuncMul, typename FuncAdd>
+static void emitFusedXmmOp(X86Emitter& e, InstrType& i, FuncFMA fma, FuncMul mul, FuncAdd add) {
+    // Constant factors are loaded into xmm0, or into the destination if both are constant
+    Xbyak::Xmm lhs = i.src1.isConstant ? e.xmm0 : i.src1.reg;
+    Xbyak::Xmm rhs = i.src2.isConstant ? (i.src1.isConstant ? i.dest.reg : e.xmm0) : i.src2.reg;
+
+    // Accumulate in xmm1, since the destination might alias any operand
+    if (i.src3.isConstant) {
+        getXmmConstant(e, e.xmm1, i.src3.constant());
+    } else {
+        e.vmovaps(e.xmm1, i.src3);
+    }
+    if (i.src1.isConstant) {
+        getXmmConstant(e, lhs, i.src1.constant());
+    }
+    if (i.src2.isConstant) {
+        getXmmConstant(e, rhs, i.src2.constant());
+    }
+
+    // Hosts without FMA3 round the product separately
+    if (e.isExtensionAvailable(X86Extension::FMA)) {
+        fma(e, e.xmm1, lhs, rhs);
+    } else {
+        mul(e, e.xmm0, lhs, rhs);
+        add(e, e.xmm1, e.xmm0, e.xmm1);
+    }
+    e.vmovaps(i.dest, e.xmm1);
+}
+struct FMA_F32 : Sequence<FMA_F32, I<OPCODE_FMA, F32Op, F32Op, F32Op, F32Op>> {
+    static void emit(X86Emitter& e, InstrType& i) {
+        emitFusedXmmOp(e, i,
+            [](X86Emitter& e, auto acc, auto lhs, auto rhs) { e.vfmadd231ss(acc, lhs, rhs); },
+            [](X86Emitter& e, auto dest, auto lhs, auto rhs) { e.vmulss(dest, lhs, rhs); },
+            [](X86Emitter& e, auto dest, auto lhs, auto rhs) { e.vaddss(dest, lhs, rhs); });
+    }
+};
+struct FMA_F64 : Sequence<FMA_F64, I<OPCODE_FMA, F64Op, F64Op, F64Op, F64Op>> {
+    static void emit(X86Emitter& e, InstrType& i) {
+        emitFusedXmmOp(e, i,
+            [](X86Emitter& e, auto acc, auto lhs, auto rhs) { e.vfmadd231sd(acc, lhs, rhs); },
+            [](X86Emitter& e, auto dest, auto lhs, auto rhs) { e.vmulsd(dest, lhs, rhs); },
+            [](X86Emitter& e, auto dest, auto lhs, auto rhs) { e.vaddsd(dest, lhs, rhs); });
+    }
+};
+
 /**
  * Opcode: FNEG
  */
@@ -2112,6 +2160,9 @@ struct VADD_V128 : Sequence<VADD_V128, I<OPCODE_VADD, V128Op, V128Op, V128Op>> {
                 e.vpaddw(i.dest, i.src1, i.src2);
             }
             break;
+        case COMPONENT_F32:
+            e.vaddps(i.dest, i.src1, i.src2);
+            break;
         default:
             assert_always("Unimplemented");
         }
@@ -2148,6 +2199,24 @@ struct VSUB_V128 : Sequence<VSUB_V128, I<OPCODE_VSUB, V128Op, V128Op, V128Op>> {
                 e.vpsubw(i.dest, i.src1, i.src2);
             }
             break;
+        case COMPONENT_F32:
+            e.vsubps(i.dest, i.src1, i.src2);
+            break;
+        default:
+            assert_always("Unimplemented");
+        }
+    }
+};
+
+/**
+ * Opcode: VMUL
+ */
+struct VMUL_V128 : Sequence<VMUL_V128, I<OPCODE_VMUL, V128Op, V128Op, V128Op>> {
+    static void emit(X86Emitter& e, InstrType& i) {
+        switch (COMPONENT_TYPE) {
+        case COMPONENT_F32:
+            e.vmulps(i.dest, i.src1, i.src2);
+            break;
         default:
             assert_always("Unimplemented");
         }
@@ -2210,6 +2279,58 @@ struct VABS_V128 : Sequence<VABS_V128, I<OPCODE_VABS, V128Op, V128Op>> {
     }
 };
 
+/**
+ * Opcode: VPACK
+ */
+struct VPACK_V128 : Sequence<VPACK_V128, I<OPCODE_VPACK, V128Op, V128Op, V128Op>> {
+    static void emit(X86Emitter& e, InstrType& i) {
+        bool isUnsigned = i.instr->flags & ARITHMETIC_UNSIGNED;
+        switch (COMPONENT_TYPE) {
+        case COMPONENT_I16:
+            if (isUnsigned) {
+                e.vpackuswb(i.dest, i.src1, i.src2);
+            } else {
+                e.vpacksswb(i.dest, i.src1, i.src2);
+            }
+            break;
+        case COMPONENT_I32:
+            if (isUnsigned) {
+                e.vpackusdw(i.dest, i.src1, i.src2);
+            } else {
+                e.vpackssdw(i.dest, i.src1, i.src2);
+            }
+            break;
+        default:
+            assert_always("Unimplemented");
+        }
+    }
+};
+
+/**
+ * Opcode: VFLUSH
+ */
+struct VFLUSH_V128 : Sequence<VFLUSH_V128, I<OPCODE_VFLUSH, V128Op, V128Op, V128Op>> {
+    static void emit(X86Emitter& e, InstrType& i) {
+        switch (COMPONENT_TYPE) {
+        case COMPONENT_F32:
+            // Components with a zero exponent, restricted to the mask
+            getXmmConstant(e, e.xmm0, V128::from_u32(0x7F800000, 0x7F800000, 0x7F800000, 0x7F800000));
+            e.vpand(e.xmm0, i.src1, e.xmm0);
+            e.vpxor(e.xmm1, e.xmm1);
+            e.vpcmpeqd(e.xmm0, e.xmm1);
+            e.vpand(e.xmm0, i.src2);
+
+            // Clear everything but the sign in those components
+            getXmmConstant(e, e.xmm1, V128::from_u32(0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF));
+            e.vpand(e.xmm0, e.xmm1);
+            e.vpandn(i.dest, e.xmm0, i.src1);
+            break;
+        default:
+            assert_always("Unimplemented");
+        }
+    }
+};
+
 /**
  * x86 Sequences
  */
@@ -2257,10 +2378,14 @@ void X86Sequences::init() {
         registerSequence<FSUB_F32, FSUB_F64>();
         registerSequence<FMUL_F32, FMUL_F64>();
         registerSequence<FDIV_F32, FDIV_F64>();
+        registerSequence<FMA_F32, FMA_F64>();
         registerSequence<FNEG_F32, FNEG_F64>();
         registerSequence<VADD_V128>();
         registerSequence<VSUB_V128>();
+        registerSequence<VMUL_V128>();
         registerSequence<VABS_V128>();
+        registerSequence<VPACK_V128>();
+        registerSequence<VFLUSH_V128>();
 #endif
     }
 }
@@ -8,6 +8,12 @@
 namespace cpu {
 
 Cell::Cell(std::shared_ptr<mem::Memory> memory) : CPU(std::move(memory)) {
+    spu_cache = std::make_unique<frontend::spu::ProgramCache>(this);
+
+    // Make room for new code by evicting SPU programs no thread has loaded
+    compiler->codeArena.setEvictionHandler([this](backend::CodeArena&) {
+        spu_cache->evict();
+    });
 }
 
 }  // namespace cpu
@@ -7,6 +7,9 @@
 
 #include "nucleus/common.h"
 #include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/spu/spu_cache.h"
+
+#include <memory>
 
 namespace cpu {
 
@@ -20,6 +23,9 @@ public:
     std::vector<frontend::ppu::Module*> ppu_modules;
     std::vector<frontend::spu::Module*> spu_modules;
 
+    // SPU programs shared across SPU threads and thread groups
+    std::unique_ptr<frontend::spu::ProgramCache> spu_cache;
+
     Cell(std::shared_ptr<mem::Memory> memory);
 };
 
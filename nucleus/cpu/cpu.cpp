@@ -4,8 +4,9 @@
  */
 
 #include "cpu.h"
+#include "nucleus/core/config.h"
+#include "nucleus/core/futex.h"
 #include "nucleus/cpu/thread.h"
-#include "nucleus/cpu/hir/passes.h"
 #include "nucleus/logger/logger.h"
 
 // Backends
@@ -16,12 +17,13 @@
 #include "nucleus/cpu/frontend/spu/spu_thread.h"
 
 #include <algorithm>
+#include <chrono>
 
 namespace cpu {
 
 thread_local Thread* gCurrentThread = nullptr;
 
-CPU::CPU(std::shared_ptr<mem::Memory> memory) : memory(std::move(memory)) {
+CPU::CPU(std::shared_ptr<mem::Memory> memory) : pausedThreads(0), pauseLatency(0), memory(std::move(memory)) {
 #if defined(NUCLEUS_ARCH_X86)
     compiler = std::make_unique<backend::x86::X86Compiler>();
 #elif defined(NUCLEUS_ARCH_ARM)
@@ -31,7 +33,17 @@ CPU::CPU(std::shared_ptr<mem::Memory> memory) : memory(std::move(memory)) {
 #endif
 
     // Compiler passes
-    compiler->addPass(std::make_unique<hir::passes::RegisterAllocationPass>(compiler->targetInfo));
+    compiler->setPipeline(config.cpuPipeline);
+
+    // Profiler output
+    if (config.perfMap || config.jitdump) {
+        compiler->perfMap = std::make_unique<backend::PerfMap>(config.perfMap, config.jitdump);
+    }
+
+    // SPU thread pool
+    if (config.spuWorkers) {
+        scheduler = std::make_unique<Scheduler>(config.spuWorkers);
+    }
 }
 
 Thread* CPU::addThread(ThreadType type) {
@@ -82,12 +94,44 @@ void CPU::run() {
     }
 }
 
-void CPU::pause() {
+bool CPU::pause(U64 timeout) {
+    using namespace std::chrono;
     std::lock_guard<std::mutex> lock(mutex);
 
+    // Post the request to all threads first, so that they acknowledge it concurrently
+    U32 expected = 0;
+    const auto start = steady_clock::now();
     for (Thread* thread : threads) {
+        const auto status = thread->getStatus();
+        if (status == NUCLEUS_STATUS_RUNNING || status == NUCLEUS_STATUS_PAUSED) {
+            expected += 1;
+        }
         thread->pause();
     }
+
+    // Wait for the acknowledgements
+    while (true) {
+        const U32 paused = pausedThreads.load();
+        if (paused >= expected) {
+            break;
+        }
+        U64 remaining = 0;
+        if (timeout) {
+            const U64 elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+            if (elapsed >= timeout) {
+                return false;
+            }
+            remaining = timeout - elapsed;
+        }
+        core::futexWait(pausedThreads, paused, remaining);
+    }
+    pauseLatency = duration_cast<microseconds>(steady_clock::now() - start).count();
+    return true;
+}
+
+void CPU::notifyPaused(S32 delta) {
+    pausedThreads.fetch_add(delta);
+    core::futexWakeAll(pausedThreads);
 }
 
 void CPU::stop() {
@@ -8,8 +8,10 @@
 #include "nucleus/common.h"
 #include "nucleus/memory/memory.h"
 #include "nucleus/cpu/thread.h"
+#include "nucleus/cpu/scheduler.h"
 #include "nucleus/cpu/backend/compiler.h"
 
+#include <atomic>
 #include <mutex>
 
 namespace cpu {
@@ -17,11 +19,20 @@ namespace cpu {
 class CPU {
     std::mutex mutex;
 
+    // Threads that acknowledged a pause request
+    std::atomic<U32> pausedThreads;
+
+    // Time taken by the last pause request to be acknowledged in microseconds
+    std::atomic<U64> pauseLatency;
+
 public:
     std::shared_ptr<mem::Memory> memory;
 
     std::unique_ptr<backend::Compiler> compiler;
 
+    // Host thread pool running SPU threads, or nullptr if each one has a dedicated thread
+    std::unique_ptr<Scheduler> scheduler;
+
     std::vector<Thread*> threads;
 
     // Constructor
@@ -37,8 +48,23 @@ public:
 
     // Manage execution state of all threads
     void run();
-    void pause();
     void stop();
+
+    /**
+     * Request all threads to pause and wait until the running ones acknowledge it.
+     * Threads blocked outside of translated code acknowledge it once they resume.
+     * @param[in]  timeout  Maximum time to wait in microseconds, or 0 to wait indefinitely
+     * @return              False if some thread did not acknowledge the request in time
+     */
+    bool pause(U64 timeout = 0);
+
+    // Called by threads entering (delta=1) or leaving (delta=-1) the paused state
+    void notifyPaused(S32 delta);
+
+    // Get the time taken by the last pause request to be acknowledged in microseconds
+    U64 getPauseLatency() const {
+        return pauseLatency.load();
+    }
 };
 
 }  // namespace cpu
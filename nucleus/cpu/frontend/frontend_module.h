@@ -6,9 +6,12 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/format.h"
 #include "nucleus/cpu/cpu.h"
 
 #include <map>
+#include <string>
+#include <unordered_map>
 
 namespace cpu {
 namespace frontend {
@@ -37,6 +40,9 @@ public:
     // List of functions
     std::map<TAddr, Function<TAddr>*> functions;
 
+    // Symbol names of known function addresses (e.g. exports named by the PRX loader)
+    std::unordered_map<TAddr, std::string> symbols;
+
     // Constructor
     Module(CPU* parent) : parent(parent) {
         hirModule = new hir::Module();
@@ -53,6 +59,15 @@ public:
         const TAddr to = address + size;
         return from <= addr && addr < to;
     }
+
+    // Get the symbol name of a function, or a generic name based on its address
+    std::string getSymbolName(TAddr addr) const {
+        const auto it = symbols.find(addr);
+        if (it != symbols.end()) {
+            return it->second;
+        }
+        return format("func_%08X", addr);
+    }
 };
 
 }  // namespace frontend
@@ -244,6 +244,7 @@ void Function::declare()
 
     // Declare function in module
     hirFunction = new hir::Function(hirModule, result, params);
+    hirFunction->name = name;
 }
 
 void Function::recompile()
@@ -272,6 +273,9 @@ void Function::recompile()
 
         // Recompile block instructions
         builder.setInsertPoint(recompiler.blocks[block.address]);
+        if (block.address == address) {
+            recompiler.createInterruptCheck();
+        }
 
         // Get function (TODO: This gets loaded multiple times into the module)
         //hir::Function* logFunc = builder.getExternFunction(reinterpret_cast<void*>(nucleusLog));
@@ -326,7 +330,7 @@ Function* Module::addFunction(U32 addr)
 
     // Create the function otherwise
     Function* function = new Function(this);
-    function->name = format("func_%08X", addr);
+    function->name = getSymbolName(addr);
     function->address = addr;
     function->declare();
     function->createPlaceholder();
@@ -521,9 +525,11 @@ void Module::recompile()
     backend::Generate(static_cast<frontend::Module<U32>*>(this));*/
 }
 
-void Module::hook(U32 funcAddr, U32 fnid) {
+void Module::hook(U32 funcAddr, Syscall* function, U32 fnid) {
     if (functions.find(funcAddr) == functions.end()) {
         auto* func = new Function(this);
+        func->name = getSymbolName(funcAddr);
+        func->address = funcAddr;
         func->declare();
         functions[funcAddr] = func;
     }
@@ -535,8 +541,10 @@ void Module::hook(U32 funcAddr, U32 fnid) {
     block->flags |= hir::BLOCK_IS_ENTRY;
     builder.setInsertPoint(block);
 
-    hir::Function* hookFunc = builder.getExternFunction(reinterpret_cast<void*>(nucleusHook));
-    builder.createCall(hookFunc, { builder.getConstantI32(fnid) }, hir::CALL_EXTERN);
+    hir::Function* hookFunc = builder.getExternFunction(reinterpret_cast<void*>(nucleusHookDirect));
+    builder.createCall(hookFunc, {
+        builder.getConstantI64(reinterpret_cast<U64>(function)),
+        builder.getConstantI32(fnid) }, hir::CALL_EXTERN);
     builder.createRet();
 
     parent->compiler->compile(hirFunc);
@@ -20,6 +20,9 @@
 #include <string>
 #include <vector>
 
+// Forward declarations
+class Syscall;
+
 namespace cpu {
 namespace frontend {
 namespace ppu {
@@ -102,8 +105,8 @@ public:
     // Recompile each of the functions
     void recompile();
 
-    // Replace a function with a HLE hook
-    void hook(U32 funcAddr, U32 fnid);
+    // Replace a function with a direct call to its HLE implementation
+    void hook(U32 funcAddr, Syscall* function, U32 fnid);
 };
 
 }  // namespace ppu
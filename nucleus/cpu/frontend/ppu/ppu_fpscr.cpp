@@ -0,0 +1,193 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "ppu_fpscr.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_state.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
+
+#include <cfenv>
+#include <cmath>
+#include <cstring>
+
+namespace cpu {
+namespace frontend {
+namespace ppu {
+
+static bool isSignalingNaN(F64 value) {
+    U64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return std::isnan(value) && !(bits & 0x0008000000000000ULL);
+}
+
+static U32 classify(F64 value, bool single) {
+    const int type = single ? std::fpclassify(static_cast<F32>(value)) : std::fpclassify(value);
+    const bool negative = std::signbit(value);
+    switch (type) {
+    case FP_NAN:
+        return FPR_FPRF_QNAN;
+    case FP_INFINITE:
+        return negative ? FPR_FPRF_NINF : FPR_FPRF_PINF;
+    case FP_ZERO:
+        return negative ? FPR_FPRF_NZ : FPR_FPRF_PZ;
+    case FP_SUBNORMAL:
+        return negative ? FPR_FPRF_ND : FPR_FPRF_PD;
+    default:
+        return negative ? FPR_FPRF_NN : FPR_FPRF_PN;
+    }
+}
+
+// Invalid operation causes that depend on the operands rather than on the result
+static U32 getInvalidCauses(U32 op, F64 a, F64 b, F64 c) {
+    U32 causes = 0;
+    if (isSignalingNaN(a) || isSignalingNaN(b) || isSignalingNaN(c)) {
+        causes |= FPSCR_VXSNAN;
+    }
+    switch (op & FP_OP_MASK) {
+    case FP_OP_ADD:
+        if (std::isinf(a) && std::isinf(b) && std::signbit(a) != std::signbit(b)) {
+            causes |= FPSCR_VXISI;
+        }
+        break;
+    case FP_OP_SUB:
+        if (std::isinf(a) && std::isinf(b) && std::signbit(a) == std::signbit(b)) {
+            causes |= FPSCR_VXISI;
+        }
+        break;
+    case FP_OP_MUL:
+        if ((std::isinf(a) && b == 0.0) || (a == 0.0 && std::isinf(b))) {
+            causes |= FPSCR_VXIMZ;
+        }
+        break;
+    case FP_OP_DIV:
+        if (std::isinf(a) && std::isinf(b)) {
+            causes |= FPSCR_VXIDI;
+        }
+        if (a == 0.0 && b == 0.0) {
+            causes |= FPSCR_VXZDZ;
+        }
+        break;
+    case FP_OP_MADD:
+    case FP_OP_MSUB:
+    case FP_OP_NMADD:
+    case FP_OP_NMSUB: {
+        if ((std::isinf(a) && b == 0.0) || (a == 0.0 && std::isinf(b))) {
+            causes |= FPSCR_VXIMZ;
+        }
+        const bool subtract = (op & FP_OP_MASK) == FP_OP_MSUB || (op & FP_OP_MASK) == FP_OP_NMSUB;
+        const F64 product = a * b;
+        if (std::isinf(product) && std::isinf(c) && (std::signbit(product) != std::signbit(c)) != subtract) {
+            causes |= FPSCR_VXISI;
+        }
+        break;
+    }
+    case FP_OP_SQRT:
+    case FP_OP_RSQRTE:
+        if (a < 0.0) {
+            causes |= FPSCR_VXSQRT;
+        }
+        break;
+    }
+    return causes;
+}
+
+static F64 execute(U32 op, F64 a, F64 b, F64 c) {
+    // Prevent the compiler from folding or reordering the operations across fenv calls
+    volatile F64 va = a, vb = b, vc = c;
+    F64 result;
+    switch (op & FP_OP_MASK) {
+    case FP_OP_ADD:    result = va + vb; break;
+    case FP_OP_SUB:    result = va - vb; break;
+    case FP_OP_MUL:    result = va * vb; break;
+    case FP_OP_DIV:    result = va / vb; break;
+    case FP_OP_MADD:   result = std::fma(va, vb, vc); break;
+    case FP_OP_MSUB:   result = std::fma(va, vb, -vc); break;
+    case FP_OP_NMADD:  result = -std::fma(va, vb, vc); break;
+    case FP_OP_NMSUB:  result = -std::fma(va, vb, -vc); break;
+    case FP_OP_SQRT:   result = std::sqrt(va); break;
+    case FP_OP_RES:    result = 1.0 / va; break;
+    case FP_OP_RSQRTE: result = 1.0 / std::sqrt(va); break;
+    case FP_OP_RSP:    result = va; break;
+    default:
+        result = va;
+    }
+    if (op & FP_OP_SINGLE || (op & FP_OP_MASK) == FP_OP_RSP) {
+        volatile F32 single = static_cast<F32>(result);
+        result = single;
+    }
+    return result;
+}
+
+static const int roundingModes[4] = {
+    FE_TONEAREST,   // FPSCR_RN_NEAR
+    FE_TOWARDZERO,  // FPSCR_RN_ZERO
+    FE_UPWARD,      // FPSCR_RN_PINF
+    FE_DOWNWARD,    // FPSCR_RN_MINF
+};
+
+U32 computeFPSCR(U32 fpscr, U32 op, F64 a, F64 b, F64 c) {
+    PPU_FPSCR reg;
+    reg.FPSCR = fpscr;
+
+    // Run the operation on the host with the guest rounding mode, collecting exceptions
+    const int hostRounding = std::fegetround();
+    std::fesetround(roundingModes[reg.RN]);
+    std::feclearexcept(FE_ALL_EXCEPT);
+    const F64 result = execute(op, a, b, c);
+    const int raised = std::fetestexcept(FE_OVERFLOW | FE_UNDERFLOW | FE_DIVBYZERO | FE_INEXACT);
+
+    // Inexact results were rounded up in magnitude if truncating them gives a different value
+    bool rounded = false;
+    if ((raised & FE_INEXACT) && reg.RN != FPSCR_RN_ZERO) {
+        std::fesetround(FE_TOWARDZERO);
+        rounded = std::fabs(execute(op, a, b, c)) != std::fabs(result);
+    }
+    std::fesetround(hostRounding);
+
+    U32 exceptions = getInvalidCauses(op, a, b, c);
+    if (raised & FE_OVERFLOW) {
+        exceptions |= FPSCR_OX;
+    }
+    if (raised & FE_UNDERFLOW) {
+        exceptions |= FPSCR_UX;
+    }
+    if ((raised & FE_DIVBYZERO) && !(exceptions & FPSCR_VXZDZ)) {
+        exceptions |= FPSCR_ZX;
+    }
+    if (raised & FE_INEXACT) {
+        exceptions |= FPSCR_XX;
+    }
+
+    // Enabled invalid or zero-divide exceptions leave the target register and FPRF untouched
+    const bool invalid = (exceptions & ~(FPSCR_OX | FPSCR_UX | FPSCR_ZX | FPSCR_XX)) != 0;
+    const bool trapped = (invalid && reg.VE) || ((exceptions & FPSCR_ZX) && reg.ZE);
+    if (exceptions) {
+        reg.setException(exceptions);
+    }
+    reg.FR = (rounded && !trapped) ? 1 : 0;
+    reg.FI = ((raised & FE_INEXACT) && !trapped) ? 1 : 0;
+    if (!trapped) {
+        reg.FPRF = classify(result, (op & FP_OP_SINGLE) != 0);
+    }
+
+    // Summary bits
+    reg.VX = (reg.FPSCR & (FPSCR_VXSNAN | FPSCR_VXISI | FPSCR_VXIDI | FPSCR_VXZDZ | FPSCR_VXIMZ |
+        FPSCR_VXVC | FPSCR_VXSOFT | FPSCR_VXSQRT | FPSCR_VXCVI)) ? 1 : 0;
+    reg.FEX = ((reg.VX & reg.VE) | (reg.OX & reg.OE) | (reg.UX & reg.UE) | (reg.ZX & reg.ZE) | (reg.XX & reg.XE));
+    return reg.FPSCR;
+}
+
+void nucleusUpdateFPSCR(U64 op, U64 a, U64 b, U64 c) {
+    auto* state = static_cast<PPUThread*>(CPU::getCurrentThread())->state.get();
+    F64 fa, fb, fc;
+    std::memcpy(&fa, &a, sizeof(fa));
+    std::memcpy(&fb, &b, sizeof(fb));
+    std::memcpy(&fc, &c, sizeof(fc));
+    state->fpscr.FPSCR = computeFPSCR(state->fpscr.FPSCR, U32(op), fa, fb, fc);
+}
+
+}  // namespace ppu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,55 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+namespace cpu {
+namespace frontend {
+namespace ppu {
+
+// Floating-point operations whose FPSCR side effects are emulated
+enum FPOperation {
+    FP_OP_ADD,
+    FP_OP_SUB,
+    FP_OP_MUL,
+    FP_OP_DIV,
+    FP_OP_MADD,
+    FP_OP_MSUB,
+    FP_OP_NMADD,
+    FP_OP_NMSUB,
+    FP_OP_SQRT,
+    FP_OP_RES,
+    FP_OP_RSQRTE,
+    FP_OP_RSP,
+
+    // Flags
+    FP_OP_MASK    = 0xFF,
+    FP_OP_SINGLE  = 0x100,  // Result is rounded to single-precision
+};
+
+/**
+ * Compute the FPSCR resulting from a floating-point operation, following the IEEE 754
+ * semantics described in the section 3.3.6 of the Programming Environments Manual.
+ * Exception bits are sticky, FPRF/FR/FI are replaced and the FX/VX/FEX summaries are updated.
+ * @param[in]  fpscr  FPSCR value before the operation, providing the rounding mode
+ * @param[in]  op     Operation as FPOperation, optionally with FP_OP_SINGLE
+ * @param[in]  a      First operand (frA, or frB for unary operations)
+ * @param[in]  b      Second operand (frB for arithmetic, frC for multiplications)
+ * @param[in]  c      Third operand (frB for multiply-add operations)
+ * @return            FPSCR value after the operation
+ */
+U32 computeFPSCR(U32 fpscr, U32 op, F64 a, F64 b = 0.0, F64 c = 0.0);
+
+/**
+ * Update the FPSCR of the current PPU thread after a floating-point operation. Called by
+ * translated code when exact FPSCR emulation is enabled, with operands passed as raw bits.
+ */
+void nucleusUpdateFPSCR(U64 op, U64 a, U64 b, U64 c);
+
+}  // namespace ppu
+}  // namespace frontend
+}  // namespace cpu
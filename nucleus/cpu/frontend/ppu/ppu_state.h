@@ -286,6 +286,7 @@ public:
     // Vector/SIMD Registers
     V128 v[32];     // Vector Register
     PPU_VSCR vscr;
+    V128 vscr_nj;   // All-ones if VSCR[NJ] is set, used to flush vector float operands
 
     // VEA Registers
     PPU_TB tb;
@@ -297,6 +298,9 @@ public:
     // Program Counter
     U32 pc;
 
+    // Pending control events, polled by translated code (see cpu::Thread::handleEvents)
+    U32 interrupt;
+
 public:
     // Register read
     U32 getCR();
@@ -5,6 +5,7 @@
 
 #include "ppu_thread.h"
 #include "nucleus/core/config.h"
+#include "nucleus/core/thread_policy.h"
 #include "nucleus/cpu/cell.h"
 #include "nucleus/cpu/frontend/ppu/ppu_state.h"
 #include "nucleus/cpu/frontend/ppu/ppu_decoder.h"
@@ -15,10 +16,16 @@ namespace ppu {
 
 PPUThread::PPUThread(CPU* parent) : Thread(parent) {
     state = std::make_unique<PPUState>();
+    m_interrupt = &state->interrupt;
+
+    // Vector units start in non-Java mode
+    state->vscr.NJ = 1;
+    state->vscr_nj = V128::from_u32(~0U, ~0U, ~0U, ~0U);
 }
 
 void PPUThread::start() {
     m_thread = std::thread([&](){
+        core::ThreadPolicy::registerThread(core::THREAD_ROLE_PPU, m_name.empty() ? "PPU Thread" : m_name, priority);
         parent->setCurrentThread(this);
         m_status = NUCLEUS_STATUS_RUNNING;
         task();
@@ -29,17 +36,8 @@ void PPUThread::task() {
     if (config.ppuTranslator & CPU_TRANSLATOR_INSTRUCTION) {
         while (true) {
             // Handle events
-            if (m_event) {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                if (m_event == NUCLEUS_EVENT_PAUSE) {
-                    m_status = NUCLEUS_STATUS_PAUSED;
-                    m_cv.wait(lock, [&]{ return m_event == NUCLEUS_EVENT_RUN; });
-                    m_status = NUCLEUS_STATUS_RUNNING;
-                }
-                if (m_event == NUCLEUS_EVENT_STOP) {
-                    break;
-                }
-                m_event = NUCLEUS_EVENT_NONE;
+            if (state->interrupt && !handleEvents()) {
+                break;
             }
             // Callback finished
             if (state->pc == 0) {
@@ -85,21 +83,51 @@ void PPUThread::task() {
 
 void PPUThread::run()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_RUN;
-    m_cv.notify_one();
+    postEvent(NUCLEUS_EVENT_RUN);
 }
 
 void PPUThread::pause()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_PAUSE;
+    postEvent(NUCLEUS_EVENT_PAUSE);
 }
 
 void PPUThread::stop()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_STOP;
+    postEvent(NUCLEUS_EVENT_STOP);
+}
+
+void PPUThread::setPriority(S32 priority) {
+    this->priority = priority;
+    core::ThreadPolicy::setPriority(m_thread.get_id(), priority);
+}
+
+/**
+ * Reservation helpers
+ */
+U32 nucleusLoadReserve32(U64 addr) {
+    auto* thread = static_cast<PPUThread*>(CPU::getCurrentThread());
+    U32 value;
+    thread->reservation.acquire(U32(addr), thread->parent->memory->ptr(U32(addr)), &value, sizeof(U32));
+    return SE32(value);
+}
+
+U64 nucleusLoadReserve64(U64 addr) {
+    auto* thread = static_cast<PPUThread*>(CPU::getCurrentThread());
+    U64 value;
+    thread->reservation.acquire(U32(addr), thread->parent->memory->ptr(U32(addr)), &value, sizeof(U64));
+    return SE64(value);
+}
+
+U32 nucleusStoreConditional32(U64 addr, U32 value) {
+    auto* thread = static_cast<PPUThread*>(CPU::getCurrentThread());
+    const U32 data = SE32(value);
+    return thread->reservation.store(U32(addr), thread->parent->memory->ptr(U32(addr)), &data, sizeof(U32));
+}
+
+U32 nucleusStoreConditional64(U64 addr, U64 value) {
+    auto* thread = static_cast<PPUThread*>(CPU::getCurrentThread());
+    const U64 data = SE64(value);
+    return thread->reservation.store(U32(addr), thread->parent->memory->ptr(U32(addr)), &data, sizeof(U64));
 }
 
 }  // namespace ppu
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/cpu/reservation.h"
 #include "nucleus/cpu/thread.h"
 
 namespace cpu {
@@ -19,6 +20,15 @@ class PPUThread : public Thread {
 public:
     std::unique_ptr<PPUState> state;
 
+    // Thread ID assigned by the guest kernel, stored as owner by synchronization primitives
+    U32 id = 0;
+
+    // Scheduling priority assigned by the guest kernel, lower values are higher priorities
+    S32 priority = 0;
+
+    // Reservation held by lwarx/ldarx
+    Reservation reservation;
+
     PPUThread(CPU* parent = nullptr);
     ~PPUThread();
 
@@ -29,8 +39,23 @@ public:
     virtual void run() override;
     virtual void pause() override;
     virtual void stop() override;
+
+    /**
+     * Change the guest priority, updating the host priority if the thread is started
+     * @param[in]  priority  Guest priority, lower values are higher priorities
+     */
+    void setPriority(S32 priority);
 };
 
+/**
+ * Reservation helpers called from translated code (lwarx, ldarx, stwcx., stdcx.).
+ * Values are passed in host byte order. Store helpers return 1 on success, 0 otherwise.
+ */
+U32 nucleusLoadReserve32(U64 addr);
+U64 nucleusLoadReserve64(U64 addr);
+U32 nucleusStoreConditional32(U64 addr, U32 value);
+U32 nucleusStoreConditional64(U64 addr, U64 value);
+
 }  // namespace ppu
 }  // namespace frontend
 }  // namespace cpu
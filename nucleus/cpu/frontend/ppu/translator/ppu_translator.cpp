@@ -4,6 +4,8 @@
  */
 
 #include "ppu_translator.h"
+#include "nucleus/cpu/util.h"
+#include "nucleus/cpu/frontend/ppu/ppu_fpscr.h"
 #include "nucleus/cpu/frontend/ppu/ppu_state.h"
 #include "nucleus/memory/memory.h"
 #include "nucleus/core/config.h"
@@ -16,7 +18,7 @@ namespace ppu {
 
 using namespace cpu::hir;
 
-Translator::Translator(CPU* parent, ppu::Function* function) : parent(parent), IRecompiler<U32>(function) {
+Translator::Translator(CPU* parent, ppu::Function* function) : IRecompiler<U32>(function), parent(parent) {
 }
 
 void Translator::createProlog() {
@@ -107,6 +109,28 @@ Value* Translator::getGPR(int index, Type type) {
     return value;
 }
 
+bool Translator::getConstantGPR(int index, U64& value) {
+    const U32 offset = offsetof(PPUState, r[index]);
+
+    // Walk back to the last store to the register, giving up on calls that might change it
+    hir::Block* block = builder.getInsertBlock();
+    auto it = builder.getInsertPoint();
+    while (it != block->instructions.begin()) {
+        const hir::Instruction* instr = *--it;
+        if (instr->opcode == OPCODE_CALL || instr->opcode == OPCODE_CALLCOND) {
+            return false;
+        }
+        if (instr->opcode == OPCODE_CTXSTORE && instr->src1.immediate == offset) {
+            if (!instr->src2.value->isConstant()) {
+                return false;
+            }
+            value = instr->src2.value->constant.i64;
+            return true;
+        }
+    }
+    return false;
+}
+
 Value* Translator::getFPR(int index, Type type) {
     const U32 offset = offsetof(PPUState, f[index]);
 
@@ -424,9 +448,126 @@ void Translator::updateCR1(Value* value) {
 void Translator::updateCR6(Value* value) {
 }
 
+Value* Translator::flushDenormals(Value* value) {
+    Value* mask = builder.createCtxLoad(offsetof(PPUState, vscr_nj), TYPE_V128);
+    return builder.createVFlush(value, mask, COMPONENT_F32);
+}
+
+void Translator::classifySpecial(Value* value, Value*& isNaN, Value*& isInf) {
+    Value* bits;
+    Value* expMask;
+    Value* fracMask;
+    Value* zero;
+    if (value->type == TYPE_F32) {
+        bits = builder.createCast(value, TYPE_I32);
+        expMask = builder.getConstantI32(0x7F800000);
+        fracMask = builder.getConstantI32(0x007FFFFF);
+        zero = builder.getConstantI32(0);
+    } else {
+        bits = builder.createCast(value, TYPE_I64);
+        expMask = builder.getConstantI64(0x7FF0000000000000ULL);
+        fracMask = builder.getConstantI64(0x000FFFFFFFFFFFFFULL);
+        zero = builder.getConstantI64(0);
+    }
+    Value* special = builder.createCmpEQ(builder.createAnd(bits, expMask), expMask);
+    Value* fraction = builder.createAnd(bits, fracMask);
+    isNaN = builder.createAnd(special, builder.createCmpNE(fraction, zero));
+    isInf = builder.createAnd(special, builder.createCmpEQ(fraction, zero));
+}
+
+void Translator::updateFPSCR(U32 op, Value* result, Value* a, Value* b, Value* c) {
+    switch (config.ppuFPSCR) {
+    case CPU_FPSCR_NONE:
+        return;
+
+    // Raise VX for NaN results and OX/ZX for infinite results, using only integer operations.
+    // Special results propagated from special operands are not exceptions.
+    case CPU_FPSCR_STICKY: {
+        Value* isNaN;
+        Value* isInf;
+        classifySpecial(result, isNaN, isInf);
+
+        Value* anyNaN = builder.getConstantI8(0);
+        Value* anyInf = builder.getConstantI8(0);
+        for (Value* operand : { a, b, c }) {
+            if (operand) {
+                Value* operandNaN;
+                Value* operandInf;
+                classifySpecial(operand, operandNaN, operandInf);
+                anyNaN = builder.createOr(anyNaN, operandNaN);
+                anyInf = builder.createOr(anyInf, operandInf);
+            }
+        }
+        Value* invalid = builder.createAnd(isNaN, builder.createXor(anyNaN, builder.getConstantI8(1)));
+        Value* infinite = builder.createAnd(isInf, builder.createXor(builder.createOr(anyNaN, anyInf), builder.getConstantI8(1)));
+
+        // Infinite results of finite divisions are caused by a zero divisor
+        Value* divisor = nullptr;
+        switch (op & FP_OP_MASK) {
+        case FP_OP_DIV:
+            divisor = b;
+            break;
+        case FP_OP_RES:
+        case FP_OP_RSQRTE:
+            divisor = a;
+            break;
+        }
+        Value* infiniteFlags = builder.getConstantI32(FPSCR_FX | FPSCR_OX);
+        if (divisor) {
+            Value* divisorZero = builder.createCmpEQ(divisor, divisor->type == TYPE_F32
+                ? builder.getConstantF32(0.0f) : builder.getConstantF64(0.0));
+            infiniteFlags = builder.createSelect(divisorZero, builder.getConstantI32(FPSCR_FX | FPSCR_ZX), infiniteFlags);
+        }
+
+        Value* flags = builder.createOr(
+            builder.createSelect(invalid, builder.getConstantI32(FPSCR_FX | FPSCR_VX), builder.getConstantI32(0)),
+            builder.createSelect(infinite, infiniteFlags, builder.getConstantI32(0)));
+        setFPSCR(builder.createOr(getFPSCR(), flags));
+        return;
+    }
+
+    // Recompute the operation on the host with the guest rounding mode and inspect its exceptions
+    case CPU_FPSCR_EXACT: {
+        auto toBits = [&](Value* operand) -> Value* {
+            if (!operand) {
+                return builder.getConstantI64(0);
+            }
+            if (operand->type == TYPE_F32) {
+                operand = builder.createConvert(operand, TYPE_F64);
+            }
+            return builder.createCast(operand, TYPE_I64);
+        };
+        hir::Function* fpscrFunc = builder.getExternFunction(
+            reinterpret_cast<void*>(nucleusUpdateFPSCR),
+            TYPE_VOID, { TYPE_I64, TYPE_I64, TYPE_I64, TYPE_I64 });
+        builder.createCall(fpscrFunc, { builder.getConstantI64(op), toBits(a), toBits(b), toBits(c) }, CALL_EXTERN);
+        return;
+    }
+    }
+}
+
 /**
  * Branching
  */
+void Translator::createInterruptCheck() {
+    Value* interrupt = builder.createCtxLoad(offsetof(PPUState, interrupt), TYPE_I32);
+    Value* pending = builder.createCmpNE(interrupt, builder.getConstantI32(0));
+
+    // Events are handled out of line, leaving through the epilog if the thread was stopped
+    hir::Block* current = builder.getInsertBlock();
+    hir::Block* resume = new hir::Block(function->hirFunction, current);
+    hir::Block* handler = new hir::Block(function->hirFunction);
+    builder.createBrCond(pending, handler, resume);
+
+    builder.setInsertPoint(handler);
+    hir::Function* eventsFunc = builder.getExternFunction(reinterpret_cast<void*>(nucleusHandleEvents));
+    Value* result = builder.createCall(eventsFunc, {}, CALL_EXTERN);
+    builder.createBrCond(builder.createCmpEQ(result, builder.getConstantI32(0)), epilog, resume);
+    builder.createBr(resume);
+
+    builder.setInsertPoint(resume);
+}
+
 void Translator::createFunctionCall(U32 nia, Value* condition) {
     auto* module = function->parent;
     auto& targetFunc = static_cast<Function&>(*module->functions.at(nia));
@@ -477,6 +618,9 @@ void Translator::createFunctionCall(U32 nia, Value* condition) {
         setVR(2, result);
         break;
     }
+
+    // Callees return early when the thread is stopped, the caller must not continue
+    createInterruptCheck();
 }
 
 }  // namespace ppu
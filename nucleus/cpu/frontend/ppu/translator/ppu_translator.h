@@ -36,6 +36,14 @@ private:
     hir::Value* getCTR();
     hir::Value* getFPSCR();
 
+    /**
+     * Get the value of a GPR if the current block stored a constant into it
+     * @param[in]   index  GPR index
+     * @param[out]  value  Constant value of the register
+     * @return             True if the value is known at translation time
+     */
+    bool getConstantGPR(int index, U64& value);
+
     // Register write
     void setGPR(int index, hir::Value* value);
     void setFPR(int index, hir::Value* value);
@@ -62,10 +70,33 @@ private:
     void updateCR1(hir::Value* value); // Floating-Point instructions with RC bit
     void updateCR6(hir::Value* value); // Vector instructions with RC bit
 
+    /**
+     * Update FPSCR after a floating-point operation, as precisely as config.ppuFPSCR requires
+     * @param[in]  op      Operation as FPOperation, optionally with FP_OP_SINGLE
+     * @param[in]  result  Result of the operation as computed by the translated code
+     * @param[in]  a       Operands in the order expected by computeFPSCR
+     */
+    void updateFPSCR(U32 op, hir::Value* result, hir::Value* a, hir::Value* b = nullptr, hir::Value* c = nullptr);
+
+    // Get whether a floating-point value is a NaN or an infinity, as I8 values
+    void classifySpecial(hir::Value* value, hir::Value*& isNaN, hir::Value*& isInf);
+
+    /**
+     * Flush the denormal components of a vector of floats to zero if VSCR[NJ] is set.
+     * Applied to the operands and results of vector floating-point instructions only,
+     * since the scalar unit is not affected by VSCR[NJ].
+     * @param[in]  value  Vector of F32 components
+     */
+    hir::Value* flushDenormals(hir::Value* value);
+
     // Branching
     void createFunctionCall(U32 nia, hir::Value* condition = nullptr);
 
 public:
+    // Poll the thread interrupt flag, handling control events if it is set and returning
+    // early if the thread was stopped
+    void createInterruptCheck();
+
     hir::Builder builder;
 
     Translator(CPU* parent, Function* function);
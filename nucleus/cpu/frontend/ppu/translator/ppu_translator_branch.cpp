@@ -8,6 +8,11 @@
 #include "nucleus/cpu/util.h"
 #include "nucleus/assert.h"
 
+#if !defined(NUCLEUS_BUILD_TEST)
+#include "nucleus/emulator.h"
+#include "nucleus/system/scei/cellos/lv2.h"
+#endif
+
 namespace cpu {
 namespace frontend {
 namespace ppu {
@@ -34,6 +39,9 @@ void Translator::bx(Instruction code)
 
     // Unconditional branch
     else {
+        if (targetAddr <= currentAddress) {
+            createInterruptCheck();
+        }
         hir::Block* targetBlock = blocks.at(targetAddr);
         builder.createBr(targetBlock);
     }
@@ -91,6 +99,9 @@ void Translator::bcx(Instruction code)
 
     // Unconditional/conditional branch
     else {
+        if (targetAddr <= currentAddress) {
+            createInterruptCheck();
+        }
         if (cond) {
             builder.createBrCond(cond, blocks.at(targetAddr), blocks.at(nextAddr));
         } else {
@@ -122,6 +133,7 @@ void Translator::bcctrx(Instruction code)
             } else {
                 builder.createCall(proxyFunc, {targetAddr}, hir::CALL_EXTERN);
             }
+            createInterruptCheck();
         }
     }
 
@@ -279,6 +291,19 @@ void Translator::mcrf(Instruction code)
 
 void Translator::sc(Instruction code)
 {
+#if !defined(NUCLEUS_BUILD_TEST)
+    // Syscall IDs known at translation time are called directly, skipping the table and binder
+    U64 id;
+    if (getConstantGPR(11, id)) {
+        auto* lv2 = static_cast<sys::LV2*>(nucleus.sys.get());
+        if (auto thunk = lv2->getThunk(static_cast<U32>(id))) {
+            hir::Function* thunkFunc = builder.getExternFunction(reinterpret_cast<void*>(thunk), TYPE_VOID, {TYPE_I32});
+            builder.createCall(thunkFunc, { builder.getConstantI32(static_cast<U32>(id)) }, CALL_EXTERN);
+            return;
+        }
+    }
+#endif
+
     hir::Function* syscallFunc = builder.getExternFunction(reinterpret_cast<void*>(nucleusSysCall));
 
     // TODO: Use code.lev fields
@@ -115,7 +115,7 @@ void Translator::mftb(Instruction code)
         break;
 
     case 0x10D:
-        setGPR(code.rd, builder.createShl(timestamp, 32));
+        setGPR(code.rd, builder.createShr(timestamp, 32));
         break;
 
     default:
@@ -4,6 +4,7 @@
  */
 
 #include "ppu_translator.h"
+#include "nucleus/cpu/frontend/ppu/ppu_fpscr.h"
 #include "nucleus/assert.h"
 
 namespace cpu {
@@ -37,6 +38,7 @@ void Translator::faddx(Instruction code)
     Value* frd;
 
     frd = builder.createFAdd(fra, frb);
+    updateFPSCR(FP_OP_ADD, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -53,6 +55,7 @@ void Translator::faddsx(Instruction code)
 
     frd = builder.createFAdd(fra, frb);
     frd = builder.createConvert(frd, TYPE_F32);
+    updateFPSCR(FP_OP_ADD | FP_OP_SINGLE, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -167,6 +170,7 @@ void Translator::fdivx(Instruction code)
     Value* frd;
 
     frd = builder.createFDiv(fra, frb);
+    updateFPSCR(FP_OP_DIV, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -182,6 +186,7 @@ void Translator::fdivsx(Instruction code)
     Value* frd;
 
     frd = builder.createFDiv(fra, frb);
+    updateFPSCR(FP_OP_DIV | FP_OP_SINGLE, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -197,8 +202,8 @@ void Translator::fmaddx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFAdd(frd, frb);
+    frd = builder.createFMA(fra, frc, frb);
+    updateFPSCR(FP_OP_MADD, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -214,8 +219,8 @@ void Translator::fmaddsx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFAdd(frd, frb);
+    frd = builder.createFMA(fra, frc, frb);
+    updateFPSCR(FP_OP_MADD | FP_OP_SINGLE, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -245,9 +250,8 @@ void Translator::fmsubx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    // TEST: Is negating frb and calling llvm::Intrinsic::fmuladd faster?
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFSub(frd, frb);
+    frd = builder.createFMA(fra, frc, builder.createFNeg(frb));
+    updateFPSCR(FP_OP_MSUB, frd, fra, frc, frb);
     if (code.rc) {
         // TODO: CR1 update
     }
@@ -262,9 +266,8 @@ void Translator::fmsubsx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    // TEST: Is negating frb and calling llvm::Intrinsic::fmuladd faster?
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFSub(frd, frb);
+    frd = builder.createFMA(fra, frc, builder.createFNeg(frb));
+    updateFPSCR(FP_OP_MSUB | FP_OP_SINGLE, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -280,6 +283,7 @@ void Translator::fmulx(Instruction code)
     Value* frd;
 
     frd = builder.createFMul(fra, frc);
+    updateFPSCR(FP_OP_MUL, frd, fra, frc);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -295,6 +299,7 @@ void Translator::fmulsx(Instruction code)
     Value* frd;
 
     frd = builder.createFMul(fra, frc);
+    updateFPSCR(FP_OP_MUL | FP_OP_SINGLE, frd, fra, frc);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -339,9 +344,9 @@ void Translator::fnmaddx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFAdd(frd, frb);
+    frd = builder.createFMA(fra, frc, frb);
     frd = builder.createFNeg(frd);
+    updateFPSCR(FP_OP_NMADD, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -357,9 +362,9 @@ void Translator::fnmaddsx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFAdd(frd, frb);
+    frd = builder.createFMA(fra, frc, frb);
     frd = builder.createFNeg(frd);
+    updateFPSCR(FP_OP_NMADD | FP_OP_SINGLE, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -375,10 +380,9 @@ void Translator::fnmsubx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    // TEST: Is negating frb and calling llvm::Intrinsic::fmuladd faster?
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFSub(frd, frb);
+    frd = builder.createFMA(fra, frc, builder.createFNeg(frb));
     frd = builder.createFNeg(frd);
+    updateFPSCR(FP_OP_NMSUB, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -394,10 +398,9 @@ void Translator::fnmsubsx(Instruction code)
     Value* frb = getFPR(code.frb);
     Value* frd;
 
-    // TEST: Is negating frb and calling llvm::Intrinsic::fmuladd faster?
-    frd = builder.createFMul(fra, frc);
-    frd = builder.createFSub(frd, frb);
+    frd = builder.createFMA(fra, frc, builder.createFNeg(frb));
     frd = builder.createFNeg(frd);
+    updateFPSCR(FP_OP_NMSUB | FP_OP_SINGLE, frd, fra, frc, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -413,6 +416,7 @@ void Translator::fresx(Instruction code)
 
     frd = builder.createFDiv(builder.getConstantF32(1.0f), frb);
     frd = builder.createConvert(frd, TYPE_F64);
+    updateFPSCR(FP_OP_RES | FP_OP_SINGLE, frd, frb);
     if (code.rc) {
         //assert_always("Unimplemented");
         // TODO: CR1 update
@@ -428,6 +432,7 @@ void Translator::frspx(Instruction code)
 
     frd = builder.createConvert(frb, TYPE_F32);
     frd = builder.createConvert(frd, TYPE_F64);
+    updateFPSCR(FP_OP_RSP, frd, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -443,6 +448,7 @@ void Translator::frsqrtex(Instruction code)
 
     frd = builder.createSqrt(frb);
     frd = builder.createFDiv(builder.getConstantF64(1.0), frd);
+    updateFPSCR(FP_OP_RSQRTE, frd, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -474,6 +480,7 @@ void Translator::fsqrtx(Instruction code)
     Value* frd;
 
     frd = builder.createSqrt(frb);
+    updateFPSCR(FP_OP_SQRT, frd, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -488,6 +495,7 @@ void Translator::fsqrtsx(Instruction code)
     Value* frd;
 
     frd = builder.createSqrt(frb);
+    updateFPSCR(FP_OP_SQRT | FP_OP_SINGLE, frd, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -503,6 +511,7 @@ void Translator::fsubx(Instruction code)
     Value* frd;
 
     frd = builder.createFSub(fra, frb);
+    updateFPSCR(FP_OP_SUB, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
@@ -518,6 +527,7 @@ void Translator::fsubsx(Instruction code)
     Value* frd;
 
     frd = builder.createFSub(fra, frb);
+    updateFPSCR(FP_OP_SUB | FP_OP_SINGLE, frd, fra, frb);
     if (code.rc) {
         assert_always("Unimplemented");
         // TODO: CR1 update
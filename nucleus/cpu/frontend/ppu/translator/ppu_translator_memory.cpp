@@ -5,6 +5,7 @@
 
 #include "ppu_translator.h"
 #include "nucleus/assert.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 
 namespace cpu {
 namespace frontend {
@@ -101,9 +102,9 @@ void Translator::ldarx(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    rd = readMemory(addr, TYPE_I64);
+    hir::Function* reserveFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(nucleusLoadReserve64), TYPE_I64, {TYPE_I64});
+    rd = builder.createCall(reserveFunc, {addr}, CALL_EXTERN);
     setGPR(code.rd, rd);
 }
 
@@ -410,9 +411,9 @@ void Translator::lwarx(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    rd = readMemory(addr, TYPE_I32);
+    hir::Function* reserveFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(nucleusLoadReserve32), TYPE_I32, {TYPE_I64});
+    rd = builder.createCall(reserveFunc, {addr}, CALL_EXTERN);
     setGPR(code.rd, rd);
 }
 
@@ -570,12 +571,12 @@ void Translator::stdcx_(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    // TODO: Is this correct?
-    setCRField(0, builder.getConstantI8(2));
-
-    writeMemory(addr, rs);
+    // CR0 = 0b00 || success || XER[SO]
+    hir::Function* storeFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(nucleusStoreConditional64), TYPE_I32, {TYPE_I64, TYPE_I64});
+    Value* success = builder.createCall(storeFunc, {addr, rs}, CALL_EXTERN);
+    Value* cr0 = builder.createShl(builder.createTrunc(success, TYPE_I8), 1);
+    setCRField(0, builder.createOr(cr0, getXER_SO()));
 }
 
 void Translator::stdu(Instruction code)
@@ -812,12 +813,12 @@ void Translator::stwcx_(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    // TODO: Is this correct?
-    setCRField(0, builder.getConstantI8(2));
-
-    writeMemory(addr, rs);
+    // CR0 = 0b00 || success || XER[SO]
+    hir::Function* storeFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(nucleusStoreConditional32), TYPE_I32, {TYPE_I64, TYPE_I32});
+    Value* success = builder.createCall(storeFunc, {addr, rs}, CALL_EXTERN);
+    Value* cr0 = builder.createShl(builder.createTrunc(success, TYPE_I8), 1);
+    setCRField(0, builder.createOr(cr0, getXER_SO()));
 }
 
 void Translator::stwu(Instruction code)
@@ -4,6 +4,8 @@
  */
 
 #include "ppu_translator.h"
+#include "nucleus/cpu/frontend/ppu/ppu_state.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/assert.h"
 
 namespace cpu {
@@ -100,12 +102,23 @@ void Translator::lvxl(Instruction code)
 
 void Translator::mfvscr(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* vscr = builder.createCtxLoad(offsetof(PPUState, vscr), TYPE_I32);
+
+    // VSCR is placed in the low-order word, which is the first host word
+    setVR(code.vd, builder.getConstantV128(V128::from_u32(0, 0, 0, 0)));
+    builder.createCtxStore(offsetof(PPUState, v) + code.vd * sizeof(V128), vscr);
 }
 
 void Translator::mtvscr(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* vscr = builder.createCtxLoad(offsetof(PPUState, v) + code.vb * sizeof(V128), TYPE_I32);
+    builder.createCtxStore(offsetof(PPUState, vscr), vscr);
+
+    // Expand VSCR[NJ] into the mask used by vector floating-point instructions
+    Value* nj = builder.createShrA(builder.createShl(vscr, U08(15)), U08(31));
+    for (U32 i = 0; i < 4; i++) {
+        builder.createCtxStore(offsetof(PPUState, vscr_nj) + i * sizeof(U32), nj);
+    }
 }
 
 void Translator::stvebx(Instruction code)
@@ -169,22 +182,22 @@ void Translator::vaddcuw(Instruction code)
 
 void Translator::vaddfp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vb = flushDenormals(getVR(code.vb));
     Value* vd;
 
     vd = builder.createVAdd(va, vb, COMPONENT_F32);
 
-    setVR(code.vd, vd);
+    setVR(code.vd, flushDenormals(vd));
 }
 
 void Translator::vaddsbs(Instruction code)
 {
     Value* va = getVR(code.va);
     Value* vb = getVR(code.vb);
-    Value* vd = va; // TODO: This is wrong. Just a temporary fix
+    Value* vd;
 
-    // TODO: ? I8
+    vd = builder.createVAdd(va, vb, COMPONENT_I8 | ARITHMETIC_SATURATE);
 
     setVR(code.vd, vd);
 }
@@ -193,9 +206,9 @@ void Translator::vaddshs(Instruction code)
 {
     Value* va = getVR(code.va);
     Value* vb = getVR(code.vb);
-    Value* vd = va; // TODO: This is wrong. Just a temporary fix
+    Value* vd;
 
-    // TODO: ? I16
+    vd = builder.createVAdd(va, vb, COMPONENT_I16 | ARITHMETIC_SATURATE);
 
     setVR(code.vd, vd);
 }
@@ -226,10 +239,9 @@ void Translator::vaddubs(Instruction code)
 {
     Value* va = getVR(code.va);
     Value* vb = getVR(code.vb);
-    Value* vd = va; // TODO: This is wrong. Just a temporary fix
+    Value* vd;
 
     vd = builder.createVAdd(va, vb, COMPONENT_I8 | ARITHMETIC_UNSIGNED | ARITHMETIC_SATURATE);
-    // TODO: ? I8
 
     setVR(code.vd, vd);
 }
@@ -249,9 +261,9 @@ void Translator::vadduhs(Instruction code)
 {
     Value* va = getVR(code.va);
     Value* vb = getVR(code.vb);
-    Value* vd = va; // TODO: This is wrong. Just a temporary fix
+    Value* vd;
 
-    // TODO: ? I16
+    vd = builder.createVAdd(va, vb, COMPONENT_I16 | ARITHMETIC_UNSIGNED | ARITHMETIC_SATURATE);
 
     setVR(code.vd, vd);
 }
@@ -390,8 +402,8 @@ void Translator::vcmpbfp_(Instruction code)
 
 void Translator::vcmpeqfp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vb = flushDenormals(getVR(code.vb));
 
     auto result = builder.createVCmpEQ(va, vb, COMPONENT_F32);
     auto vd = builder.createSExt(result, TYPE_I32);
@@ -458,8 +470,8 @@ void Translator::vcmpequw_(Instruction code)
 
 void Translator::vcmpgefp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vb = flushDenormals(getVR(code.vb));
 
     auto result = builder.createVCmpFGE(va, vb, COMPONENT_F32);
     auto vd = builder.createSExt(result, TYPE_I32);
@@ -475,8 +487,8 @@ void Translator::vcmpgefp_(Instruction code)
 
 void Translator::vcmpgtfp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vb = flushDenormals(getVR(code.vb));
 
     auto result = builder.createVCmpFGT(va, vb, COMPONENT_F32);
     auto vd = builder.createSExt(result, TYPE_I32);
@@ -626,15 +638,15 @@ void Translator::vlogefp(Instruction code)
 
 void Translator::vmaddfp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vc = getVR(code.vc);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vc = flushDenormals(getVR(code.vc));
+    Value* vb = flushDenormals(getVR(code.vb));
     Value* vd;
 
     vd = builder.createVMul(va, vc, COMPONENT_F32);
     vd = builder.createVAdd(vd, vb, COMPONENT_F32);
 
-    setVR(code.vd, vd);
+    setVR(code.vd, flushDenormals(vd));
 }
 
 void Translator::vmaxfp(Instruction code)
@@ -824,16 +836,16 @@ void Translator::vmulouh(Instruction code)
 
 void Translator::vnmsubfp(Instruction code)
 {
-    Value* va = getVR(code.va);
-    Value* vc = getVR(code.vc);
-    Value* vb = getVR(code.vb);
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vc = flushDenormals(getVR(code.vc));
+    Value* vb = flushDenormals(getVR(code.vb));
     Value* vd;
 
     // NOTE: vb-(va*vc) = -((va*vc)-vb)
     vd = builder.createVMul(va, vc, COMPONENT_F32);
     vd = builder.createVSub(vb, vd, COMPONENT_F32);
 
-    setVR(code.vd, vd);
+    setVR(code.vd, flushDenormals(vd));
 }
 
 void Translator::vnor(Instruction code)
@@ -871,22 +883,47 @@ void Translator::vpkpx(Instruction code)
 
 void Translator::vpkshss(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    // Guest elements are reversed in host registers, so vB fills the lower half
+    vd = builder.createVPack(vb, va, COMPONENT_I16);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vpkshus(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVPack(vb, va, COMPONENT_I16 | ARITHMETIC_UNSIGNED);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vpkswss(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVPack(vb, va, COMPONENT_I32);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vpkswus(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVPack(vb, va, COMPONENT_I32 | ARITHMETIC_UNSIGNED);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vpkuhum(Instruction code)
@@ -1066,17 +1103,35 @@ void Translator::vsubcuw(Instruction code)
 
 void Translator::vsubfp(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = flushDenormals(getVR(code.va));
+    Value* vb = flushDenormals(getVR(code.vb));
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_F32);
+
+    setVR(code.vd, flushDenormals(vd));
 }
 
 void Translator::vsubsbs(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I8 | ARITHMETIC_SATURATE);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsubshs(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I16 | ARITHMETIC_SATURATE);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsubsws(Instruction code)
@@ -1086,22 +1141,46 @@ void Translator::vsubsws(Instruction code)
 
 void Translator::vsububm(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I8);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsububs(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I8 | ARITHMETIC_UNSIGNED | ARITHMETIC_SATURATE);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsubuhm(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I16);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsubuhs(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* va = getVR(code.va);
+    Value* vb = getVR(code.vb);
+    Value* vd;
+
+    vd = builder.createVSub(va, vb, COMPONENT_I16 | ARITHMETIC_UNSIGNED | ARITHMETIC_SATURATE);
+
+    setVR(code.vd, vd);
 }
 
 void Translator::vsubuwm(Instruction code)
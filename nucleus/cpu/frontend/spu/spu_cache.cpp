@@ -0,0 +1,113 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_cache.h"
+#include "nucleus/cpu/cell.h"
+#include "nucleus/cpu/frontend/spu/spu_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+namespace {
+
+// Hash a program with the 64-bit Fowler/Noll/Vo FNV-1a hash code, word by word
+U64 hashProgram(const U08* code, U32 lsStart, U32 size) {
+    U64 hash = 0xCBF29CE484222325ULL;
+    auto mix = [&](U64 value) {
+        hash ^= value;
+        hash *= 0x100000001B3ULL;
+    };
+    mix((U64(lsStart) << 32) | size);
+    Size offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        U64 value;
+        memcpy(&value, code + offset, 8);
+        mix(value);
+    }
+    for (; offset < size; offset++) {
+        mix(code[offset]);
+    }
+    return hash;
+}
+
+}  // anonymous namespace
+
+ProgramCache::ProgramCache(Cell* cell) : cell(cell) {
+}
+
+Module* ProgramCache::getModule(const U08* code, U32 lsStart, U32 size) {
+    const U64 hash = hashProgram(code, lsStart, size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = modules.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++) {
+        Module* module = it->second;
+        if (module->address == lsStart && module->image.size() == size &&
+            !memcmp(module->image.data(), code, size)) {
+            module->users += 1;
+            stats.hits += 1;
+            return module;
+        }
+        stats.collisions += 1;
+    }
+
+    // Create a new module with a private copy of the program
+    auto* module = new Module(cell);
+    module->address = lsStart;
+    module->size = size;
+    module->image.assign(code, code + size);
+    module->users = 1;
+    modules.emplace(hash, module);
+    cell->spu_modules.push_back(module);
+    stats.misses += 1;
+    return module;
+}
+
+void ProgramCache::release(Module* module) {
+    std::lock_guard<std::mutex> lock(mutex);
+    module->users -= 1;
+}
+
+U32 ProgramCache::evict() {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& compiler = *cell->compiler;
+    U32 count = 0;
+    for (auto it = modules.begin(); it != modules.end();) {
+        Module* module = it->second;
+        if (module->users) {
+            it++;
+            continue;
+        }
+
+        // No thread holds the module, so none of its code is on any stack
+        for (auto* function : module->hirModule->functions) {
+            compiler.release(function);
+        }
+        for (void* code : module->staleCode) {
+            compiler.codeArena.free(code);
+        }
+        auto& owned = cell->spu_modules;
+        owned.erase(std::remove(owned.begin(), owned.end(), module), owned.end());
+        delete module;
+
+        it = modules.erase(it);
+        stats.evictions += 1;
+        count += 1;
+    }
+    return count;
+}
+
+ProgramCacheStatistics ProgramCache::getStatistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,88 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cpu {
+
+// Forward declarations
+class Cell;
+
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class Module;
+
+struct ProgramCacheStatistics {
+    U64 hits = 0;       // Lookups that reused an existing module
+    U64 misses = 0;     // Lookups that created a new module
+    U64 collisions = 0; // Lookups whose hash matched a module with different contents
+    U64 evictions = 0;  // Unused modules whose code was freed when the code arena was full
+};
+
+/**
+ * SPU Program Cache
+ * =================
+ * Shares SPU modules, and the functions compiled from them, between all SPU threads and
+ * thread groups. Modules are keyed by a hash of the program contents and its LS start
+ * address, so the same program loaded into different SPUs (or relaunched later) is only
+ * analyzed and compiled once.
+ *
+ * Notes:
+ * - The LS start address is part of the key because translations are not position
+ *   independent: function entries, branch targets and link values are absolute LS addresses.
+ * - Modules are immutable: they hold a private copy of the program. When code is overwritten
+ *   in local storage, the thread drops its reference to the stale module and looks up the
+ *   new contents, which may hit another cached module (see SPUThread::getModule).
+ * - Modules are owned by the Cell (Cell::spu_modules). SPU threads hold a reference to the
+ *   modules they have loaded, and modules nobody holds stay cached for later launches until
+ *   the code arena runs out of memory, when they are evicted and their code freed.
+ */
+class ProgramCache {
+    Cell* cell;
+
+    std::mutex mutex;
+    std::unordered_multimap<U64, Module*> modules;
+    ProgramCacheStatistics stats;
+
+public:
+    ProgramCache(Cell* cell);
+
+    /**
+     * Get the module for a program, creating it if it was not seen before
+     * @param[in]  code     Host pointer to the program code
+     * @param[in]  lsStart  Local storage address where the program is loaded
+     * @param[in]  size     Size of the program in bytes
+     * @return              Module shared by all SPUs running this program, the caller holds
+     *                      a reference to it until it calls ProgramCache::release
+     */
+    Module* getModule(const U08* code, U32 lsStart, U32 size);
+
+    /**
+     * Drop a reference obtained with ProgramCache::getModule
+     * @param[in]  module   Module no longer loaded by the caller
+     */
+    void release(Module* module);
+
+    /**
+     * Delete the modules no SPU thread holds, returning their code to the code arena
+     * @return              Number of modules evicted
+     */
+    U32 evict();
+
+    // Get a snapshot of the cache statistics
+    ProgramCacheStatistics getStatistics();
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
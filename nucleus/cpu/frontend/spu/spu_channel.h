@@ -0,0 +1,224 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/cpu/scheduler.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Event
+ * =========
+ * Event counter used to park threads until the state they wait for changes. Waiters read
+ * the counter, check their condition, and wait on the value read. Writers change the state,
+ * then call SPUEvent::notify. Wake-ups are only issued when a thread is actually waiting.
+ * SPU threads running on the scheduler pool park their fiber instead of the host thread.
+ */
+class SPUEvent {
+    std::atomic<U32> counter;
+    std::atomic<U32> waiters;
+
+public:
+    SPUEvent() : counter(0), waiters(0) {}
+
+    // Get the current value of the counter, to be passed to SPUEvent::wait
+    U32 get() const {
+        return counter.load(std::memory_order_acquire);
+    }
+
+    // Block until the counter changes from the given value
+    void wait(U32 value) {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (counter.load(std::memory_order_seq_cst) == value) {
+            if (!Scheduler::park(counter, value)) {
+                core::futexWait(counter, value);
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Advance the counter and wake up all waiters
+    void notify() {
+        counter.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_seq_cst)) {
+            core::futexWakeAll(counter);
+            Scheduler::unpark(counter);
+        }
+    }
+};
+
+/**
+ * SPU Channel
+ * ===========
+ * FIFO of 32-bit values with a fixed capacity, used for mailboxes. Reading from an empty
+ * channel or writing to a full one parks the calling thread until the other side acts.
+ * After SPUChannel::abort, blocking operations return immediately. Blocking operations take
+ * an optional poll function, called before every wait, that stops waiting if it returns false.
+ */
+template <Size N>
+class SPUChannel {
+    std::mutex mutex;
+    U32 values[N] = {};
+    Size head = 0;
+    std::atomic<U32> count;
+    std::atomic<bool> aborted;
+    SPUEvent event;
+
+public:
+    SPUChannel() : count(0), aborted(false) {}
+
+    // Get the number of values in the channel
+    U32 getCount() const {
+        return count.load();
+    }
+
+    // Get the number of free entries in the channel
+    U32 getFree() const {
+        return U32(N) - count.load();
+    }
+
+    // Append a value, returns false if the channel is full
+    bool tryPush(U32 value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const U32 n = count.load();
+            if (n >= N) {
+                return false;
+            }
+            values[(head + n) % N] = value;
+            count.store(n + 1);
+        }
+        event.notify();
+        return true;
+    }
+
+    // Remove the oldest value, returns false if the channel is empty
+    bool tryPop(U32& value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const U32 n = count.load();
+            if (n == 0) {
+                return false;
+            }
+            value = values[head];
+            head = (head + 1) % N;
+            count.store(n - 1);
+        }
+        event.notify();
+        return true;
+    }
+
+    // Append a value, waiting until an entry is free
+    template <typename Poll>
+    void push(U32 value, Poll poll) {
+        while (true) {
+            const U32 e = event.get();
+            if (tryPush(value) || aborted || !poll()) {
+                return;
+            }
+            event.wait(e);
+        }
+    }
+    void push(U32 value) {
+        push(value, []{ return true; });
+    }
+
+    // Remove the oldest value, waiting until one is available. Returns 0 if aborted.
+    template <typename Poll>
+    U32 pop(Poll poll) {
+        U32 value = 0;
+        while (true) {
+            const U32 e = event.get();
+            if (tryPop(value) || aborted || !poll()) {
+                return value;
+            }
+            event.wait(e);
+        }
+    }
+    U32 pop() {
+        return pop([]{ return true; });
+    }
+
+    // Wake up all waiting threads, so that they call their poll function again
+    void wake() {
+        event.notify();
+    }
+
+    // Release all waiting threads and make further waits return immediately
+    void abort() {
+        aborted = true;
+        event.notify();
+    }
+};
+
+/**
+ * SPU Signal
+ * ==========
+ * Signal notification register. Writes either overwrite the register or are combined with
+ * a logical OR. Reading a zero register parks the calling thread, reading clears it.
+ * As with SPUChannel, blocking reads take an optional poll function.
+ */
+class SPUSignal {
+    std::atomic<U32> value;
+    std::atomic<bool> aborted;
+    SPUEvent event;
+
+public:
+    SPUSignal() : value(0), aborted(false) {}
+
+    // Check whether the register holds a pending signal
+    bool isPending() const {
+        return value.load() != 0;
+    }
+
+    // Write the register, waking up the reader
+    void write(U32 data, bool orMode) {
+        if (orMode) {
+            value.fetch_or(data);
+        } else {
+            value.store(data);
+        }
+        event.notify();
+    }
+
+    // Read and clear the register, waiting until it is non-zero. Returns 0 if aborted.
+    template <typename Poll>
+    U32 read(Poll poll) {
+        while (true) {
+            const U32 e = event.get();
+            const U32 data = value.exchange(0);
+            if (data || aborted || !poll()) {
+                return data;
+            }
+            event.wait(e);
+        }
+    }
+    U32 read() {
+        return read([]{ return true; });
+    }
+
+    // Wake up all waiting threads, so that they call their poll function again
+    void wake() {
+        event.notify();
+    }
+
+    // Release all waiting threads and make further waits return immediately
+    void abort() {
+        aborted = true;
+        event.notify();
+    }
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
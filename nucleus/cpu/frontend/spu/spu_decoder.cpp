@@ -24,19 +24,37 @@ namespace spu {
 
 void nucleusTranslateSPU(void* guestFunc, U64 guestAddr) {
     auto* function = static_cast<frontend::spu::Function*>(guestFunc);
-    function->analyze_cfg();
-    function->recompile();
-
+    auto* module = static_cast<frontend::spu::Module*>(function->parent);
     auto* hirFunction = function->hirFunction;
     auto* cpu = CPU::getCurrentThread()->parent;
+
+    // Modules are shared by SPU threads running the same program, translate only once
+    {
+        std::lock_guard<std::recursive_mutex> lock(module->mutex);
+        if (!function->translated) {
+            function->analyze_cfg();
+            for (const auto& item : function->blocks) {
+                module->markCode(item.second->address, item.second->size);
+            }
+            function->recompile();
+
+            // The placeholder is still running on the stack of this thread, so it can only be freed later
+            void* placeholder = hirFunction->nativeAddress;
+            if (cpu->compiler->compile(hirFunction) && hirFunction->nativeAddress != placeholder) {
+                module->staleCode.push_back(placeholder);
+            }
+            function->translated = true;
+        }
+    }
+
     auto* state = static_cast<frontend::spu::SPUThread*>(CPU::getCurrentThread())->state.get();
-    cpu->compiler->compile(hirFunction);
     cpu->compiler->call(hirFunction, state);
 }
 
 void nucleusLogSPU(U64 guestAddr) {
-    auto* state = static_cast<frontend::spu::SPUThread*>(CPU::getCurrentThread())->state.get();
-    frontend::spu::Instruction instr { CPU::getCurrentThread()->parent->memory->read32(guestAddr) };
+    auto* thread = static_cast<frontend::spu::SPUThread*>(CPU::getCurrentThread());
+    const U32 lsAddr = thread->mfc->getLocalStorage() + U32(guestAddr);
+    frontend::spu::Instruction instr { thread->parent->memory->read32(lsAddr) };
     printf("> [%08X] %s\n", U32(guestAddr), frontend::spu::get_entry(instr).name);
     int a = 0;
     a += 1;
@@ -48,7 +66,7 @@ void nucleusLogSPU(U64 guestAddr) {
 bool Block::is_split() const
 {
     Instruction lastInstr;
-    lastInstr.value = parent->parent->parent->memory->read32(address + size - 4);
+    lastInstr.value = static_cast<Module*>(parent->parent)->read32(address + size - 4);
     if (!lastInstr.is_branch() || lastInstr.is_call()/* || (lastInstr.opcode == 0x13 && lastInstr.op19 == 0x210) /*bcctr*/) {
         return true;
     }
@@ -108,7 +126,7 @@ bool Function::analyze_cfg()
     // Control Flow Graph generation
     while (!labels.empty()) {
         U32 addr = labels.front();
-        code.value = parent->parent->memory->read32(addr);
+        code.value = static_cast<Module*>(parent)->read32(addr);
 
         // Check if block was already processed
         if (blocks.find(addr) != blocks.end()) {
@@ -147,7 +165,7 @@ bool Function::analyze_cfg()
         while ((!code.is_branch() || code.is_call()) && (current.size < maxSize)) {
             addr += 4;
             current.size += 4;
-            code.value = parent->parent->memory->read32(addr);
+            code.value = static_cast<Module*>(parent)->read32(addr);
         }
 
         // Push new labels
@@ -266,6 +284,7 @@ void Function::declare()
 
     // Declare function in module
     hirFunction = new hir::Function(hirModule, result, params);
+    hirFunction->name = name;
 }
 
 void Function::recompile() {
@@ -292,6 +311,10 @@ void Function::recompile() {
 
         // Recompile block instructions
         builder.setInsertPoint(recompiler.blocks[block.address]);
+        if (block.address == address) {
+            recompiler.currentAddress = address;
+            recompiler.createInterruptCheck();
+        }
 
         // Get function (TODO: This gets loaded multiple times into the module)
         hir::Function* logFunc = builder.getExternFunction(
@@ -300,7 +323,7 @@ void Function::recompile() {
         for (U32 offset = 0; offset < block.size; offset += 4) {
             recompiler.currentAddress = block.address + offset;
             Instruction instr;
-            instr.value = parent->parent->memory->read32(recompiler.currentAddress);
+            instr.value = static_cast<Module*>(parent)->read32(recompiler.currentAddress);
             auto method = get_entry(instr).recompile;
             builder.createCall(logFunc, {builder.getConstantI64(recompiler.currentAddress)}, hir::CALL_EXTERN);
             (recompiler.*method)(instr);
@@ -336,10 +359,37 @@ void Function::createPlaceholder() {
 /**
  * SPU Module methods
  */
-Module::Module(CPU* parent) : frontend::Module<U32>(parent) {
+Module::Module(CPU* parent) : frontend::Module<U32>(parent), codePages(0) {
+}
+
+U32 Module::read32(U32 addr) const {
+    if (addr < address || addr + 4 > address + image.size()) {
+        return 0;
+    }
+    return SE32(*reinterpret_cast<const U32*>(&image[addr - address]));
+}
+
+void Module::markCode(U32 addr, U32 size) {
+    static_assert(MFC::LS_PAGE_COUNT <= 64, "Code pages must fit in Module::codePages");
+    if (!size) {
+        return;
+    }
+    const U32 first = (addr & (MFC::LS_SIZE - 1)) / MFC::LS_PAGE_SIZE;
+    const U32 last = ((addr + size - 1) & (MFC::LS_SIZE - 1)) / MFC::LS_PAGE_SIZE;
+    U64 mask = 0;
+    for (U32 page = first; ; page = (page + 1) % MFC::LS_PAGE_COUNT) {
+        mask |= 1ULL << page;
+        if (page == last) {
+            break;
+        }
+    }
+    codePages.fetch_or(mask, std::memory_order_release);
 }
 
 Function* Module::addFunction(U32 addr) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    markCode(addr, 4);
+
     // Return function if already present
     if (functions.find(addr) != functions.end()) {
         return static_cast<Function*>(functions[addr]);
@@ -347,7 +397,7 @@ Function* Module::addFunction(U32 addr) {
 
     // Create the function otherwise
     Function* function = new Function(this);
-    function->name = format("func_%08X", addr);
+    function->name = getSymbolName(addr);
     function->address = addr;
     function->declare();
     function->createPlaceholder();
@@ -368,7 +418,7 @@ void Module::analyze() {
     U32 currentBlock = 0;
     for (U32 i = address; i < (address + size); i += 4) {
         Instruction instr;
-        instr.value = parent->memory->read32(i);
+        instr.value = read32(i);
 
         // New block appeared
         if (currentBlock == 0 && instr.is_valid()) {
@@ -428,6 +478,8 @@ void Module::recompile() {
 void Module::hook(U32 funcAddr, U32 fnid) {
     if (functions.find(funcAddr) == functions.end()) {
         auto* func = new Function(this);
+        func->name = getSymbolName(funcAddr);
+        func->address = funcAddr;
         func->declare();
         functions[funcAddr] = func;
     }
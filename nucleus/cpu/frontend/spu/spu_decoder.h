@@ -16,7 +16,9 @@
 #include "nucleus/cpu/frontend/frontend_module.h"
 //#include "nucleus/cpu/frontend/spu/analyzer/spu_analyzer.h"
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -71,6 +73,9 @@ public:
     FunctionTypeOut type_out;
     std::vector<FunctionTypeIn> type_in;
 
+    // Whether the function was translated, replacing its placeholder
+    bool translated = false;
+
     Function(Module* seg) {
         parent = reinterpret_cast<frontend::Module<U32>*>(seg);
     }
@@ -89,8 +94,36 @@ public:
     void recompile();
 };
 
+/**
+ * SPU Module
+ * ==========
+ * Program loaded into the local storage of one or more SPUs. Addresses are relative to the
+ * local storage, and instructions are read from a private copy of the program, so that a
+ * module can be shared by any SPU running the same code, wherever its local storage is mapped.
+ */
 class Module : public frontend::Module<U32> {
 public:
+    // Copy of the program code, starting at Module::address
+    std::vector<U08> image;
+
+    // Serializes the analysis and translation of functions shared by several SPU threads
+    std::recursive_mutex mutex;
+
+    // Bitmask of the local storage pages (of MFC::LS_PAGE_SIZE bytes) containing discovered code
+    std::atomic<U64> codePages;
+
+    // Placeholder code replaced by translated functions, freed when the module is evicted
+    std::vector<void*> staleCode;
+
+    // Number of SPU threads holding this module, protected by the program cache mutex
+    U32 users = 0;
+
+    // Read an instruction from the program image, returns 0 outside the module
+    U32 read32(U32 addr) const;
+
+    // Mark a range of local storage as containing code of this module
+    void markCode(U32 addr, U32 size);
+
     Function* addFunction(U32 addr);
 
     // Constructor
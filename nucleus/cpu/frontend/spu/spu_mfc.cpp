@@ -0,0 +1,494 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_mfc.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
+
+#if defined(NUCLEUS_ARCH_X86)
+#include <emmintrin.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+constexpr Size MFC::QUEUE_SIZE;
+constexpr Size MFC::TAG_COUNT;
+constexpr Size MFC::LS_SIZE;
+constexpr Size MFC::LS_PAGE_SIZE;
+constexpr Size MFC::LS_PAGE_COUNT;
+constexpr Size MFC::RESERVATION_SIZE;
+
+namespace {
+
+// Copy data with 128-bit accesses, unrolled for the large transfers typical of DMA
+void copyWide(U08* dst, const U08* src, Size size) {
+#if defined(NUCLEUS_ARCH_X86)
+    if (size >= 64 && !((reinterpret_cast<uintptr_t>(dst) | reinterpret_cast<uintptr_t>(src)) & 15)) {
+        for (; size >= 64; size -= 64, src += 64, dst += 64) {
+            const __m128i v0 = _mm_load_si128(reinterpret_cast<const __m128i*>(src) + 0);
+            const __m128i v1 = _mm_load_si128(reinterpret_cast<const __m128i*>(src) + 1);
+            const __m128i v2 = _mm_load_si128(reinterpret_cast<const __m128i*>(src) + 2);
+            const __m128i v3 = _mm_load_si128(reinterpret_cast<const __m128i*>(src) + 3);
+            _mm_store_si128(reinterpret_cast<__m128i*>(dst) + 0, v0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(dst) + 1, v1);
+            _mm_store_si128(reinterpret_cast<__m128i*>(dst) + 2, v2);
+            _mm_store_si128(reinterpret_cast<__m128i*>(dst) + 3, v3);
+        }
+    }
+#endif
+    memcpy(dst, src, size);
+}
+
+// Valid DMA sizes are 1, 2, 4, 8 and multiples of 16 up to 16 KB
+bool isValidSize(U32 size) {
+    if (size == 1 || size == 2 || size == 4 || size == 8) {
+        return true;
+    }
+    return size && size <= 0x4000 && !(size & 15);
+}
+
+// Timebase ticks elapsed since an arbitrary origin, used by the decrementer
+U64 getTimebase() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() * 798 / 10000;
+}
+
+}  // anonymous namespace
+
+MFC::MFC(mem::Memory* memory, SPUState& state) : memory(memory), state(state), watchedCode(nullptr), stopping(false),
+    statCommands(0), statBytesGet(0), statBytesPut(0), statListElements(0),
+    statAtomicSuccess(0), statAtomicFailure(0), statQueueStalls(0) {
+    for (auto& version : pageVersion) {
+        version.store(0, std::memory_order_relaxed);
+    }
+}
+
+MFC::~MFC() {
+    stop();
+}
+
+void MFC::setLocalStorage(U32 addr) {
+    lsBase = addr;
+}
+
+void MFC::touchLS(U32 lsa, U32 size) {
+    const U32 first = (lsa & (LS_SIZE - 1)) / LS_PAGE_SIZE;
+    const U32 count = ((lsa & (LS_PAGE_SIZE - 1)) + size + LS_PAGE_SIZE - 1) / LS_PAGE_SIZE;
+    U64 written = 0;
+    for (U32 i = 0; i < count && i < LS_PAGE_COUNT; i++) {
+        pageVersion[(first + i) % LS_PAGE_COUNT].fetch_add(1, std::memory_order_release);
+        written |= 1ULL << ((first + i) % LS_PAGE_COUNT);
+    }
+
+    // Translated code polls the flag at function entries, see SPUThread::enterFunction
+    const auto* codePages = watchedCode.load(std::memory_order_acquire);
+    if (codePages && (codePages->load(std::memory_order_acquire) & written)) {
+        reinterpret_cast<std::atomic<U32>*>(&state.interrupt)->store(1, std::memory_order_release);
+    }
+}
+
+U08* MFC::getLS(U32 lsa) const {
+    return memory->ptr<U08>(lsBase + (lsa & (LS_SIZE - 1)));
+}
+
+U08* MFC::getEA(U32 ea) const {
+    return memory->ptr<U08>(ea);
+}
+
+void MFC::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+        for (auto& pending : tagPending) {
+            pending = 0;
+        }
+    }
+    inMbox.abort();
+    outMbox.abort();
+    outIntrMbox.abort();
+    signal[0].abort();
+    signal[1].abort();
+}
+
+void MFC::interrupt() {
+    inMbox.wake();
+    outMbox.wake();
+    outIntrMbox.wake();
+    signal[0].wake();
+    signal[1].wake();
+}
+
+bool MFC::pollEvents() {
+    Thread* thread = CPU::getCurrentThread();
+    if (!thread || !thread->hasPendingEvents()) {
+        return true;
+    }
+    const bool running = thread->handleEvents();
+
+    // The flag might also signal overwritten code, so that must be checked at the next function entry
+    reinterpret_cast<std::atomic<U32>*>(&state.interrupt)->store(1, std::memory_order_release);
+    return running;
+}
+
+void MFC::sync() {
+    std::unique_lock<std::mutex> lock(mutex);
+    runQueue(lock, [&]{ return queue.empty(); });
+}
+
+template <typename Predicate>
+void MFC::runQueue(std::unique_lock<std::mutex>& lock, Predicate done) {
+    while (!queue.empty() && !done() && !stopping) {
+        // Commands stay in the queue while running, so that they count as pending
+        const Command command = queue.front();
+        lock.unlock();
+        execute(command);
+        lock.lock();
+
+        // The queue is only emptied meanwhile if the MFC was stopped
+        if (!queue.empty()) {
+            queue.pop_front();
+            tagPending[command.tag] -= 1;
+        }
+    }
+}
+
+/**
+ * Command queue
+ */
+void MFC::enqueue(const Command& command) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.size() >= QUEUE_SIZE) {
+        statQueueStalls += 1;
+        runQueue(lock, [&]{ return queue.size() < QUEUE_SIZE; });
+    }
+    if (stopping) {
+        return;
+    }
+    queue.push_back(command);
+    tagPending[command.tag] += 1;
+
+    // Translated code polls the flag at function entries, where the queue is drained
+    reinterpret_cast<std::atomic<U32>*>(&state.interrupt)->store(1, std::memory_order_release);
+}
+
+void MFC::execute(const Command& command) {
+    const U32 cmd = command.cmd & ~(MFC_BARRIER_ENABLE | MFC_FENCE_ENABLE);
+    switch (cmd) {
+    case MFC_PUT_CMD:
+    case MFC_GET_CMD:
+        transfer(cmd, command.lsa, command.ea, command.size);
+        break;
+    case MFC_PUTL_CMD:
+    case MFC_GETL_CMD:
+        transferList(command);
+        break;
+    case MFC_SNDSIG_CMD:
+        sendSignal(command);
+        break;
+    case MFC_BARRIER_CMD:
+    case MFC_EIEIO_CMD:
+    case MFC_SYNC_CMD:
+        // Commands are executed in order, nothing to do
+        break;
+    default:
+        logger.warning(LOG_CPU, "Unsupported MFC command: 0x%X", command.cmd);
+    }
+}
+
+void MFC::transfer(U32 cmd, U32 lsa, U32 ea, U32 size) {
+    if (!isValidSize(size)) {
+        logger.error(LOG_CPU, "Invalid MFC transfer size: 0x%X", size);
+        return;
+    }
+    if (cmd == MFC_GET_CMD) {
+        copyWide(getLS(lsa), getEA(ea), size);
+        statBytesGet += size;
+        touchLS(lsa, size);
+    } else {
+        copyWide(getEA(ea), getLS(lsa), size);
+        statBytesPut += size;
+    }
+}
+
+void MFC::transferList(const Command& command) {
+    const U32 cmd = command.cmd & ~MFC_LIST_ENABLE;
+    U32 lsa = command.lsa;
+
+    // The list is stored in local storage at EAL, as 8-byte big-endian elements
+    const U32 listAddr = command.ea & 0x3FFF8;
+    const U32 listSize = command.size & ~7;
+    for (U32 offset = 0; offset < listSize; offset += 8) {
+        const U32 elementSize = memory->read32(lsBase + ((listAddr + offset + 0) & (LS_SIZE - 1))) & 0x7FFF;
+        const U32 elementAddr = memory->read32(lsBase + ((listAddr + offset + 4) & (LS_SIZE - 1)));
+        if (elementSize) {
+            transfer(cmd, lsa, elementAddr, elementSize);
+        }
+        statListElements += 1;
+
+        // Each element starts at the next quadword of local storage
+        lsa = (lsa + elementSize + 15) & ~15;
+    }
+}
+
+void MFC::sendSignal(const Command& command) {
+    if (command.size != 4) {
+        logger.error(LOG_CPU, "Invalid MFC signal size: 0x%X", command.size);
+        return;
+    }
+    const U32 value = memory->read32(lsBase + (command.lsa & (LS_SIZE - 1)));
+    if (!signalHandler || !signalHandler(command.ea, value)) {
+        logger.warning(LOG_CPU, "No signal notification register at 0x%08X", command.ea);
+    }
+}
+
+/**
+ * Atomic commands
+ */
+void MFC::executeAtomic(const Command& command) {
+    const U32 ea = command.ea & ~U32(RESERVATION_SIZE - 1);
+    U08* ls = getLS(command.lsa & ~U32(RESERVATION_SIZE - 1));
+    U08* data = getEA(ea);
+
+    U32 status = 0;
+    switch (command.cmd) {
+    case MFC_GETLLAR_CMD:
+        reservation.acquire(ea, data, ls, RESERVATION_SIZE);
+        touchLS(command.lsa & ~U32(RESERVATION_SIZE - 1), RESERVATION_SIZE);
+        status = MFC_GETLLAR_STATUS;
+        break;
+    case MFC_PUTLLC_CMD:
+        if (reservation.store(ea, data, ls, RESERVATION_SIZE)) {
+            statAtomicSuccess += 1;
+        } else {
+            status = MFC_PUTLLC_STATUS;
+            statAtomicFailure += 1;
+        }
+        break;
+    case MFC_PUTLLUC_CMD:
+    case MFC_PUTQLLUC_CMD:
+        Reservation::storeLine(ea, data, ls);
+        reservation.clear();
+        status = MFC_PUTLLUC_STATUS;
+        break;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    atomicStatus = status;
+    atomicStatusValid = true;
+}
+
+U32 MFC::readTagStatus() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const U32 mask = state.mfcTagMask;
+    auto getCompleted = [&]() -> U32 {
+        U32 completed = 0;
+        for (U32 tag = 0; tag < TAG_COUNT; tag++) {
+            if ((mask & (1 << tag)) && !tagPending[tag]) {
+                completed |= (1 << tag);
+            }
+        }
+        return completed;
+    };
+
+    // Immediate polls run the commands too, otherwise nothing would ever complete them
+    if (tagUpdate == MFC_TAG_UPDATE_ANY) {
+        runQueue(lock, [&]{ return !mask || getCompleted(); });
+    } else {
+        runQueue(lock, [&]{ return getCompleted() == mask; });
+    }
+    return getCompleted();
+}
+
+/**
+ * SPU channel interface
+ */
+U32 MFC::readChannel(U32 ch) {
+    switch (ch) {
+    case MFC_RdTagMask:
+        return state.mfcTagMask;
+    case MFC_RdTagStat:
+        return readTagStatus();
+    case MFC_RdAtomicStat: {
+        std::lock_guard<std::mutex> lock(mutex);
+        atomicStatusValid = false;
+        return atomicStatus;
+    }
+    case MFC_RdListStallStat:
+        return 0;
+    // The other side might be waiting for pending commands before writing these channels
+    case SPU_RdInMbox:
+        sync();
+        return inMbox.pop([this]{ return pollEvents(); });
+    case SPU_RdSigNotify1:
+        sync();
+        return signal[0].read([this]{ return pollEvents(); });
+    case SPU_RdSigNotify2:
+        sync();
+        return signal[1].read([this]{ return pollEvents(); });
+    case SPU_RdDec:
+        return decValue - U32(getTimebase() - decStart);
+    default:
+        logger.warning(LOG_CPU, "Unsupported SPU channel read: %d", ch);
+        return 0;
+    }
+}
+
+void MFC::writeChannel(U32 ch, U32 value) {
+    switch (ch) {
+    case MFC_LSA:
+        state.mfcLSA = value;
+        break;
+    case MFC_EAH:
+        state.mfcEAH = value;
+        break;
+    case MFC_EAL:
+        state.mfcEAL = value;
+        break;
+    case MFC_Size:
+        state.mfcSize = value;
+        break;
+    case MFC_TagID:
+        state.mfcTagID = value;
+        break;
+    case MFC_WrTagMask:
+        state.mfcTagMask = value;
+        break;
+    case MFC_WrTagUpdate: {
+        std::lock_guard<std::mutex> lock(mutex);
+        tagUpdate = value;
+        break;
+    }
+    case MFC_Cmd: {
+        Command command;
+        command.cmd = value & 0xFF;
+        command.lsa = state.mfcLSA;
+        command.ea = state.mfcEAL;
+        command.size = state.mfcSize;
+        command.tag = state.mfcTagID & (TAG_COUNT - 1);
+        statCommands += 1;
+        switch (command.cmd) {
+        case MFC_GETLLAR_CMD:
+        case MFC_PUTLLC_CMD:
+        case MFC_PUTLLUC_CMD:
+        case MFC_PUTQLLUC_CMD:
+            executeAtomic(command);
+            break;
+        default:
+            enqueue(command);
+        }
+        break;
+    }
+    case MFC_WrListStallAck:
+        break;
+    case SPU_WrOutMbox:
+        sync();
+        outMbox.push(value, [this]{ return pollEvents(); });
+        break;
+    case SPU_WrOutIntrMbox:
+        sync();
+        outIntrMbox.push(value, [this]{ return pollEvents(); });
+        break;
+    case SPU_WrDec:
+        decValue = value;
+        decStart = getTimebase();
+        break;
+    default:
+        logger.warning(LOG_CPU, "Unsupported SPU channel write: %d", ch);
+    }
+}
+
+U32 MFC::getChannelCount(U32 ch) {
+    switch (ch) {
+    case MFC_Cmd: {
+        // Make room if the queue is full, so that programs polling for a free entry progress
+        std::unique_lock<std::mutex> lock(mutex);
+        runQueue(lock, [&]{ return queue.size() < QUEUE_SIZE; });
+        return U32(QUEUE_SIZE - queue.size());
+    }
+    case MFC_RdAtomicStat: {
+        std::lock_guard<std::mutex> lock(mutex);
+        return atomicStatusValid ? 1 : 0;
+    }
+    case SPU_RdInMbox:
+        return inMbox.getCount();
+    case SPU_WrOutMbox:
+        return outMbox.getFree();
+    case SPU_WrOutIntrMbox:
+        return outIntrMbox.getFree();
+    case SPU_RdSigNotify1:
+        return signal[0].isPending() ? 1 : 0;
+    case SPU_RdSigNotify2:
+        return signal[1].isPending() ? 1 : 0;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * PPU-side interface
+ */
+bool MFC::writeInMbox(U32 value) {
+    return inMbox.tryPush(value);
+}
+
+bool MFC::readOutMbox(U32& value) {
+    return outMbox.tryPop(value);
+}
+
+bool MFC::readOutIntrMbox(U32& value) {
+    return outIntrMbox.tryPop(value);
+}
+
+void MFC::writeSignal(U32 index, U32 value, bool orMode) {
+    signal[index & 1].write(value, orMode);
+}
+
+MFCStatistics MFC::getStatistics() const {
+    MFCStatistics stats;
+    stats.commands = statCommands.load();
+    stats.bytesGet = statBytesGet.load();
+    stats.bytesPut = statBytesPut.load();
+    stats.listElements = statListElements.load();
+    stats.atomicSuccess = statAtomicSuccess.load();
+    stats.atomicFailure = statAtomicFailure.load();
+    stats.queueStalls = statQueueStalls.load();
+    return stats;
+}
+
+/**
+ * Channel helpers called from translated code
+ */
+U32 nucleusSPUReadChannel(U32 ch) {
+    auto* thread = static_cast<SPUThread*>(CPU::getCurrentThread());
+    const U32 value = thread->mfc->readChannel(ch);
+
+    // Programs often spin on channels (tag status, decrementer, events), let other SPUs run
+    Scheduler::yield();
+    return value;
+}
+
+void nucleusSPUWriteChannel(U32 ch, U32 value) {
+    auto* thread = static_cast<SPUThread*>(CPU::getCurrentThread());
+    thread->mfc->writeChannel(ch, value);
+}
+
+U32 nucleusSPUChannelCount(U32 ch) {
+    auto* thread = static_cast<SPUThread*>(CPU::getCurrentThread());
+    const U32 count = thread->mfc->getChannelCount(ch);
+    Scheduler::yield();
+    return count;
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,321 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/cpu/reservation.h"
+#include "nucleus/cpu/frontend/spu/spu_channel.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class SPUState;
+
+// SPU channels
+enum SPUChannelId {
+    SPU_RdEventStat      = 0,
+    SPU_WrEventMask      = 1,
+    SPU_WrEventAck       = 2,
+    SPU_RdSigNotify1     = 3,
+    SPU_RdSigNotify2     = 4,
+    SPU_WrDec            = 7,
+    SPU_RdDec            = 8,
+    MFC_WrMSSyncReq      = 9,
+    SPU_RdEventMask      = 11,
+    MFC_RdTagMask        = 12,
+    SPU_RdMachStat       = 13,
+    SPU_WrSRR0           = 14,
+    SPU_RdSRR0           = 15,
+    MFC_LSA              = 16,
+    MFC_EAH              = 17,
+    MFC_EAL              = 18,
+    MFC_Size             = 19,
+    MFC_TagID            = 20,
+    MFC_Cmd              = 21,
+    MFC_WrTagMask        = 22,
+    MFC_WrTagUpdate      = 23,
+    MFC_RdTagStat        = 24,
+    MFC_RdListStallStat  = 25,
+    MFC_WrListStallAck   = 26,
+    MFC_RdAtomicStat     = 27,
+    SPU_WrOutMbox        = 28,
+    SPU_RdInMbox         = 29,
+    SPU_WrOutIntrMbox    = 30,
+};
+
+// MFC commands
+enum MFCCommand : U32 {
+    // Command modifiers
+    MFC_BARRIER_ENABLE   = 0x01,
+    MFC_FENCE_ENABLE     = 0x02,
+    MFC_LIST_ENABLE      = 0x04,
+
+    // DMA commands
+    MFC_PUT_CMD          = 0x20,
+    MFC_PUTB_CMD         = 0x21,
+    MFC_PUTF_CMD         = 0x22,
+    MFC_PUTL_CMD         = 0x24,
+    MFC_PUTLB_CMD        = 0x25,
+    MFC_PUTLF_CMD        = 0x26,
+    MFC_GET_CMD          = 0x40,
+    MFC_GETB_CMD         = 0x41,
+    MFC_GETF_CMD         = 0x42,
+    MFC_GETL_CMD         = 0x44,
+    MFC_GETLB_CMD        = 0x45,
+    MFC_GETLF_CMD        = 0x46,
+
+    // Atomic commands
+    MFC_GETLLAR_CMD      = 0xD0,
+    MFC_PUTLLC_CMD       = 0xB4,
+    MFC_PUTLLUC_CMD      = 0xB0,
+    MFC_PUTQLLUC_CMD     = 0xB8,
+
+    // Synchronization commands
+    MFC_SNDSIG_CMD       = 0xA0,
+    MFC_BARRIER_CMD      = 0xC0,
+    MFC_EIEIO_CMD        = 0xC8,
+    MFC_SYNC_CMD         = 0xCC,
+};
+
+// Conditions for MFC_RdTagStat, written to MFC_WrTagUpdate
+enum MFCTagUpdate {
+    MFC_TAG_UPDATE_IMMEDIATE  = 0,
+    MFC_TAG_UPDATE_ANY        = 1,
+    MFC_TAG_UPDATE_ALL        = 2,
+};
+
+// Bits of MFC_RdAtomicStat
+enum MFCAtomicStatus {
+    MFC_PUTLLC_STATUS    = 1,  // PUTLLC failed: the reservation was lost
+    MFC_PUTLLUC_STATUS   = 2,  // PUTLLUC completed
+    MFC_GETLLAR_STATUS   = 4,  // GETLLAR completed
+};
+
+struct MFCStatistics {
+    U64 commands = 0;       // Commands accepted through MFC_Cmd
+    U64 bytesGet = 0;       // Bytes transferred from main memory to local storage
+    U64 bytesPut = 0;       // Bytes transferred from local storage to main memory
+    U64 listElements = 0;   // List elements processed by GETL/PUTL commands
+    U64 atomicSuccess = 0;  // Successful PUTLLC commands
+    U64 atomicFailure = 0;  // Failed PUTLLC commands
+    U64 queueStalls = 0;    // Commands that waited for a free queue entry
+};
+
+/**
+ * Memory Flow Controller
+ * ======================
+ * Executes the DMA commands of an SPU, moving data between its local storage and main
+ * memory, and handles the remaining SPU channels (tag groups, atomics, mailboxes, signals).
+ *
+ * Queue:
+ * - DMA commands are placed in a queue of MFC::QUEUE_SIZE entries and are executed later
+ *   by the issuing SPU thread itself, so no host thread is spawned per MFC. Pending commands
+ *   run when the SPU reads MFC_RdTagStat, needs a free queue entry, writes an outbound
+ *   mailbox, blocks on an inbound mailbox or signal, or leaves its program.
+ * - Enqueuing a command also raises the interrupt flag, so that the queue is drained at the
+ *   next function entry (see SPUThread::enterFunction) while the SPU keeps computing.
+ * - Commands are executed in order, so fence and barrier modifiers are always satisfied.
+ * - Atomic commands (GETLLAR, PUTLLC, PUTLLUC) are executed immediately, as on hardware.
+ *   Reservations go through the global reservation table shared with PPU lwarx/stwcx.
+ *
+ * Blocking:
+ * - Channels that cannot be accessed yet (empty mailboxes and signals, full mailboxes)
+ *   park the SPU host thread on a futex. Writers on the other side wake it immediately,
+ *   so idle SPUs use no host CPU time.
+ * - Blocked channels also wake up on MFC::interrupt, to handle the pause and stop requests
+ *   of the SPU thread. Paused SPU threads on the scheduler pool park their fiber there.
+ *
+ * Notes:
+ * - Translated code stores MFC parameters (MFC_LSA ... MFC_WrTagMask) in SPUState directly,
+ *   the MFC reads them when MFC_Cmd is written.
+ * - Writes to local storage (GET, GETL, GETLLAR) advance the version of the affected pages,
+ *   after the data is copied.
+ * - List stall-and-notify is not emulated: stall flags in list elements are ignored.
+ */
+class MFC {
+public:
+    static constexpr Size QUEUE_SIZE = 16;
+    static constexpr Size TAG_COUNT = 32;
+    static constexpr Size LS_SIZE = 0x40000;
+    static constexpr Size LS_PAGE_SIZE = 0x1000;
+    static constexpr Size LS_PAGE_COUNT = LS_SIZE / LS_PAGE_SIZE;
+    static constexpr Size RESERVATION_SIZE = Reservation::LINE_SIZE;
+
+private:
+    struct Command {
+        U32 cmd;
+        U32 lsa;
+        U32 ea;
+        U32 size;
+        U32 tag;
+    };
+
+    mem::Memory* memory;
+    SPUState& state;
+    U32 lsBase = 0;
+
+    // Version of each page of local storage, advanced after it is written by a command
+    std::atomic<U32> pageVersion[LS_SIZE / LS_PAGE_SIZE];
+
+    // Code pages of the program being executed (see MFC::watchCode)
+    std::atomic<const std::atomic<U64>*> watchedCode;
+
+    std::mutex mutex;
+    std::atomic<bool> stopping;
+
+    // Command queue
+    std::deque<Command> queue;
+    U32 tagPending[TAG_COUNT] = {};
+    U32 tagUpdate = MFC_TAG_UPDATE_IMMEDIATE;
+
+    // Atomic commands
+    U32 atomicStatus = 0;
+    bool atomicStatusValid = false;
+    Reservation reservation;
+
+    // Mailboxes and signal notification
+    std::function<bool(U32, U32)> signalHandler;
+    SPUChannel<4> inMbox;
+    SPUChannel<1> outMbox;
+    SPUChannel<1> outIntrMbox;
+    SPUSignal signal[2];
+
+    // Decrementer
+    U32 decValue = 0;
+    U64 decStart = 0;
+
+    // Statistics
+    std::atomic<U64> statCommands;
+    std::atomic<U64> statBytesGet;
+    std::atomic<U64> statBytesPut;
+    std::atomic<U64> statListElements;
+    std::atomic<U64> statAtomicSuccess;
+    std::atomic<U64> statAtomicFailure;
+    std::atomic<U64> statQueueStalls;
+
+    // Get host pointers to local storage and main memory
+    U08* getLS(U32 lsa) const;
+    U08* getEA(U32 ea) const;
+
+    // Advance the version of the local storage pages in the given range, and interrupt
+    // the SPU if they hold code it is executing
+    void touchLS(U32 lsa, U32 size);
+
+    // Execute queued commands in order, with the MFC lock held, until the predicate is
+    // satisfied, the queue is empty or the MFC stops
+    template <typename Predicate>
+    void runQueue(std::unique_lock<std::mutex>& lock, Predicate done);
+
+    // Command execution
+    void execute(const Command& command);
+    void transfer(U32 cmd, U32 lsa, U32 ea, U32 size);
+    void transferList(const Command& command);
+    void sendSignal(const Command& command);
+
+    // Commands executed by the SPU thread
+    void enqueue(const Command& command);
+    void executeAtomic(const Command& command);
+    U32 readTagStatus();
+
+    // Handle the control events of the SPU thread while blocked on a channel
+    // @return  False if the channel operation must be abandoned because the thread stopped
+    bool pollEvents();
+
+public:
+    // Constructor
+    MFC(mem::Memory* memory, SPUState& state);
+    ~MFC();
+
+    /**
+     * Set the guest address where the local storage of this SPU is mapped
+     * @param[in]  addr  Address inside SEG_SPU
+     */
+    void setLocalStorage(U32 addr);
+
+    // Get the guest address where the local storage of this SPU is mapped
+    U32 getLocalStorage() const {
+        return lsBase;
+    }
+
+    /**
+     * Get the version of a local storage page, advanced every time a command writes to it.
+     * Used to detect code overwritten by DMA without scanning local storage.
+     * @param[in]  page  Index of the page, from 0 to MFC::LS_PAGE_COUNT - 1
+     * @return           Current version of the page
+     */
+    U32 getPageVersion(U32 page) const {
+        return pageVersion[page].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Raise the interrupt flag of the SPU whenever a command writes to the given code pages
+     * @param[in]  codePages  Bitmask of pages holding the code being executed, or nullptr
+     */
+    void watchCode(const std::atomic<U64>* codePages) {
+        watchedCode.store(codePages, std::memory_order_release);
+    }
+
+    /**
+     * Set the handler delivering MFC_SNDSIG_CMD writes to signal notification registers
+     * @param[in]  handler  Called with the target effective address and the value, returns
+     *                      false if no signal notification register is mapped there
+     */
+    void setSignalHandler(std::function<bool(U32, U32)> handler) {
+        signalHandler = std::move(handler);
+    }
+
+    /**
+     * Wake up any waits, pending commands are discarded
+     */
+    void stop();
+
+    /**
+     * Wake up any waits so that they handle the events posted to the SPU thread
+     */
+    void interrupt();
+
+    /**
+     * Execute all queued DMA commands, must be called by the SPU thread
+     */
+    void sync();
+
+    /**
+     * SPU channel interface
+     */
+    U32 readChannel(U32 ch);
+    void writeChannel(U32 ch, U32 value);
+    U32 getChannelCount(U32 ch);
+
+    /**
+     * PPU-side interface to the problem state registers
+     */
+    bool writeInMbox(U32 value);
+    bool readOutMbox(U32& value);
+    bool readOutIntrMbox(U32& value);
+    void writeSignal(U32 index, U32 value, bool orMode = false);
+
+    // Get a snapshot of the DMA statistics
+    MFCStatistics getStatistics() const;
+};
+
+/**
+ * Channel helpers called from translated code
+ */
+U32 nucleusSPUReadChannel(U32 ch);
+void nucleusSPUWriteChannel(U32 ch, U32 value);
+U32 nucleusSPUChannelCount(U32 ch);
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -17,6 +17,17 @@ public:
     V128 s[128];  // Special-Purpose Registers
 
     U32 pc;       // Program Counter
+
+    // Pending control events, polled by translated code (see cpu::Thread::handleEvents)
+    U32 interrupt;
+
+    // MFC command parameters, written by translated code through channels 16 to 22
+    U32 mfcLSA;      // MFC_LSA: Local storage address
+    U32 mfcEAH;      // MFC_EAH: Effective address (high)
+    U32 mfcEAL;      // MFC_EAL: Effective address (low)
+    U32 mfcSize;     // MFC_Size: Transfer size
+    U32 mfcTagID;    // MFC_TagID: Tag group
+    U32 mfcTagMask;  // MFC_WrTagMask: Tag groups queried by MFC_RdTagStat
 };
 
 }  // namespace spu
@@ -5,56 +5,177 @@
 
 #include "spu_thread.h"
 #include "nucleus/core/config.h"
+#include "nucleus/core/thread_policy.h"
 #include "nucleus/cpu/cell.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_cache.h"
 #include "nucleus/cpu/frontend/spu/spu_decoder.h"
 
+#include <algorithm>
+
 namespace cpu {
 namespace frontend {
 namespace spu {
 
 SPUThread::SPUThread(CPU* parent) : Thread(parent) {
     state = std::make_unique<SPUState>();
+    mfc = std::make_unique<MFC>(parent ? parent->memory.get() : nullptr, *state);
+    m_interrupt = &state->interrupt;
+}
+
+SPUThread::~SPUThread() {
+    for (const auto& loaded : modules) {
+        static_cast<Cell*>(parent)->spu_cache->release(loaded.module);
+    }
+}
+
+void SPUThread::addModule(Module* module) {
+    LoadedModule loaded;
+    loaded.module = module;
+    for (U32 page = 0; page < MFC::LS_PAGE_COUNT; page++) {
+        loaded.pageVersion[page] = mfc->getPageVersion(page);
+    }
+
+    // Replace any program previously loaded in the same range
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    auto replaced = std::remove_if(modules.begin(), modules.end(), [&](const LoadedModule& other) {
+        return module->address < other.module->address + other.module->size &&
+            other.module->address < module->address + module->size;
+    });
+    for (auto it = replaced; it != modules.end(); it++) {
+        static_cast<Cell*>(parent)->spu_cache->release(it->module);
+    }
+    modules.erase(replaced, modules.end());
+    modules.push_back(loaded);
+}
+
+SPUThread::LoadedModule SPUThread::loadModule(U32 lsa, U32 size) {
+    // Versions are read before the code, so that concurrent writes are detected later
+    LoadedModule loaded;
+    for (U32 page = 0; page < MFC::LS_PAGE_COUNT; page++) {
+        loaded.pageVersion[page] = mfc->getPageVersion(page);
+    }
+    auto* cell = static_cast<Cell*>(parent);
+    auto* code = parent->memory->ptr<U08>(mfc->getLocalStorage() + lsa);
+    loaded.module = cell->spu_cache->getModule(code, lsa, size);
+    return loaded;
+}
+
+bool SPUThread::isCurrent(const LoadedModule& loaded) const {
+    const U64 pages = loaded.module->codePages.load(std::memory_order_acquire);
+    for (U32 page = 0; page < MFC::LS_PAGE_COUNT; page++) {
+        if ((pages & (1ULL << page)) && mfc->getPageVersion(page) != loaded.pageVersion[page]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Module* SPUThread::getModule(U32 lsa) {
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    for (auto& loaded : modules) {
+        if (!loaded.module->contains(lsa)) {
+            continue;
+        }
+        // Code overlaid by DMA is reloaded, programs seen before are found in the cache
+        if (!isCurrent(loaded)) {
+            Module* stale = loaded.module;
+            loaded = loadModule(stale->address, stale->size);
+            static_cast<Cell*>(parent)->spu_cache->release(stale);
+        }
+        return loaded.module;
+    }
+
+    // Code was loaded by the program itself, snapshot the whole local storage
+    modules.push_back(loadModule(0, MFC::LS_SIZE));
+    return modules.back().module;
+}
+
+bool SPUThread::enterFunction(U32 lsa) {
+    if (!handleEvents()) {
+        return false;
+    }
+    mfc->sync();
+    Scheduler::yield();
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    for (const auto& loaded : modules) {
+        if (loaded.module->contains(lsa) && !isCurrent(loaded)) {
+            state->pc = lsa;
+            m_reload = true;
+            return false;
+        }
+    }
+    return true;
 }
 
 void SPUThread::start() {
+    if (parent->scheduler) {
+        schedulerTask = parent->scheduler->spawn(this, priority);
+        return;
+    }
     m_thread = std::thread([&](){
+        core::ThreadPolicy::registerThread(core::THREAD_ROLE_SPU, m_name.empty() ? "SPU Thread" : m_name, priority);
+        parent->setCurrentThread(this);
         task();
     });
 }
 
-void SPUThread::task() {
-     if (config.spuTranslator & CPU_TRANSLATOR_FUNCTION) {
-        for (auto* spu_segment : static_cast<Cell*>(parent)->spu_modules) {
-            if (!spu_segment->contains(state->pc)) {
-                continue;
-            }
+void SPUThread::join() {
+    if (schedulerTask) {
+        parent->scheduler->join(schedulerTask);
+        schedulerTask = nullptr;
+        return;
+    }
+    Thread::join();
+}
 
-            auto* function = spu_segment->addFunction(state->pc);
+void SPUThread::task() {
+    m_status = NUCLEUS_STATUS_RUNNING;
+    if (config.spuTranslator & CPU_TRANSLATOR_FUNCTION) {
+        // Functions whose code is overwritten by DMA while running leave at their next entry,
+        // and are resumed from there on the reloaded program
+        do {
+            m_reload = false;
+            auto* module = getModule(state->pc);
+            auto* function = module->addFunction(state->pc);
             auto* hirFunction = function->hirFunction;
-            if (!(hirFunction->flags & hir::FUNCTION_IS_COMPILED)) {
-                parent->compiler->compile(hirFunction);
+            {
+                std::lock_guard<std::recursive_mutex> lock(module->mutex);
+                if (!(hirFunction->flags & hir::FUNCTION_IS_COMPILED)) {
+                    parent->compiler->compile(hirFunction);
+                }
             }
+            mfc->watchCode(&module->codePages);
             parent->compiler->call(hirFunction, state.get());
-            return;
-        }
+        } while (m_reload);
+        mfc->watchCode(nullptr);
     }
+
+    // Commands left in the queue by the program complete before the thread is joined
+    mfc->sync();
+}
+
+U32 nucleusHandleEventsSPU(U64 guestAddr) {
+    auto* thread = static_cast<SPUThread*>(CPU::getCurrentThread());
+    return thread->enterFunction(U32(guestAddr)) ? 1 : 0;
 }
 
 void SPUThread::run() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_RUN;
-    m_cv.notify_one();
+    postEvent(NUCLEUS_EVENT_RUN);
 }
 
 void SPUThread::pause() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_PAUSE;
+    postEvent(NUCLEUS_EVENT_PAUSE);
+
+    // Let the thread park itself if it is waiting on a channel
+    mfc->interrupt();
 }
 
 void SPUThread::stop() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_event = NUCLEUS_EVENT_STOP;
+    postEvent(NUCLEUS_EVENT_STOP);
+
+    // Wake up the thread if it is waiting on a channel
+    mfc->stop();
 }
 
 }  // namespace spu
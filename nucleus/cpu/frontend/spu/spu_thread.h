@@ -6,22 +6,46 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/cpu/scheduler.h"
 #include "nucleus/cpu/thread.h"
+#include "nucleus/cpu/frontend/spu/spu_mfc.h"
+
+#include <mutex>
+#include <vector>
 
 namespace cpu {
 namespace frontend {
 namespace spu {
 
 // Forward declarations
+class Module;
 class SPUState;
 
 class SPUThread : public Thread {
 public:
     std::unique_ptr<SPUState> state;
+    std::unique_ptr<MFC> mfc;
+
+    // Scheduling priority of the thread group, lower values are scheduled first
+    S32 priority = 0;
 
     SPUThread(CPU* parent = nullptr);
     ~SPUThread();
 
+    /**
+     * Attach a program loaded into the local storage of this SPU
+     * @param[in]  module  Module obtained from the program cache, whose reference the thread takes over
+     */
+    void addModule(Module* module);
+
+    /**
+     * Handle pending events at the entry of a translated function
+     * @param[in]  lsa  Local storage address of the function
+     * @return          False if the function must return without running, either because the
+     *                  thread was stopped or because its code was overwritten meanwhile
+     */
+    bool enterFunction(U32 lsa);
+
     virtual void start() override;
     virtual void task() override;
 
@@ -29,8 +53,40 @@ public:
     virtual void run() override;
     virtual void pause() override;
     virtual void stop() override;
+
+    // Block caller thread until this thread finishes
+    virtual void join() override;
+
+private:
+    // Handle of the thread when running on the scheduler pool
+    Scheduler::Task* schedulerTask = nullptr;
+
+    // Program loaded in local storage, with the page versions at the time it was loaded
+    struct LoadedModule {
+        Module* module;
+        U32 pageVersion[MFC::LS_PAGE_COUNT];
+    };
+
+    // Programs currently loaded in local storage
+    std::mutex modulesMutex;
+    std::vector<LoadedModule> modules;
+
+    // Load the program in the given range of local storage through the program cache
+    LoadedModule loadModule(U32 lsa, U32 size);
+
+    // Check whether the code pages of a loaded program were not overwritten since it was loaded
+    bool isCurrent(const LoadedModule& loaded) const;
+
+    // Get the module containing a local storage address, reloading it if its code was overwritten
+    Module* getModule(U32 lsa);
+
+    // Set when a function left early because its code was overwritten, to resume it at SPUState::pc
+    bool m_reload = false;
 };
 
+// Called by translated code at function entries when the interrupt flag is set, returns 0 to leave
+U32 nucleusHandleEventsSPU(U64 guestAddr);
+
 }  // namespace ppu
 }  // namespace frontend
 }  // namespace cpu
@@ -5,7 +5,9 @@
 
 #include "spu_translator.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
 #include "nucleus/core/config.h"
+#include "nucleus/cpu/util.h"
 #include "nucleus/assert.h"
 
 namespace cpu {
@@ -14,7 +16,7 @@ namespace spu {
 
 using namespace cpu::hir;
 
-Translator::Translator(CPU* parent, spu::Function* function) : parent(parent), IRecompiler<U32>(function) {
+Translator::Translator(CPU* parent, spu::Function* function) : IRecompiler<U32>(function), parent(parent) {
 }
 
 hir::Value* Translator::getGPR(int index) {
@@ -59,6 +61,25 @@ void Translator::createEpilog() {
     }
 }
 
+void Translator::createInterruptCheck() {
+    Value* interrupt = builder.createCtxLoad(offsetof(SPUState, interrupt), TYPE_I32);
+    Value* pending = builder.createCmpNE(interrupt, builder.getConstantI32(0));
+
+    // Events are handled out of line, leaving through the epilog if the function must not run
+    hir::Block* current = builder.getInsertBlock();
+    hir::Block* resume = new hir::Block(function->hirFunction, current);
+    hir::Block* handler = new hir::Block(function->hirFunction);
+    builder.createBrCond(pending, handler, resume);
+
+    builder.setInsertPoint(handler);
+    hir::Function* eventsFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(nucleusHandleEventsSPU), TYPE_I32, {TYPE_I64});
+    Value* result = builder.createCall(eventsFunc, {builder.getConstantI64(currentAddress)}, CALL_EXTERN);
+    builder.createBrCond(builder.createCmpEQ(result, builder.getConstantI32(0)), epilog, resume);
+    builder.createBr(resume);
+
+    builder.setInsertPoint(resume);
+}
 
 }  // namespace spu
 }  // namespace frontend
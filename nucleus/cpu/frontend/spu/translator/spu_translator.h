@@ -36,6 +36,10 @@ public:
     void createProlog();
     void createEpilog();
 
+    // Poll the thread interrupt flag at the entry of the function, handling control events if
+    // it is set and returning early if the thread was stopped or the code was overwritten
+    void createInterruptCheck();
+
     // Recompiler status
     U32 currentAddress;
 
@@ -4,6 +4,8 @@
  */
 
 #include "spu_translator.h"
+#include "nucleus/cpu/frontend/spu/spu_mfc.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
 #include "nucleus/assert.h"
 
 namespace cpu {
@@ -17,20 +19,75 @@ using namespace cpu::hir;
  *  - Channel Instructions (Chapter 11)
  */
 
+namespace {
+
+// Offset of the SPUState register backing an MFC parameter channel, or 0 if the channel has side effects
+U32 getChannelOffset(U32 ch) {
+    switch (ch) {
+    case MFC_LSA:        return offsetof(SPUState, mfcLSA);
+    case MFC_EAH:        return offsetof(SPUState, mfcEAH);
+    case MFC_EAL:        return offsetof(SPUState, mfcEAL);
+    case MFC_Size:       return offsetof(SPUState, mfcSize);
+    case MFC_TagID:      return offsetof(SPUState, mfcTagID);
+    case MFC_WrTagMask:  return offsetof(SPUState, mfcTagMask);
+    case MFC_RdTagMask:  return offsetof(SPUState, mfcTagMask);
+    default:
+        return 0;
+    }
+}
+
+// Offset of the preferred word slot of a GPR
+U32 getPreferredSlot(U32 index) {
+    return offsetof(SPUState, r) + index * sizeof(V128) + 12;
+}
+
+}  // anonymous namespace
+
 // Channel Instructions (Chapter 11)
 void Translator::rchcnt(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* count;
+    if (getChannelOffset(code.ra)) {
+        count = builder.getConstantI32(1);
+    } else {
+        hir::Function* countFunc = builder.getExternFunction(
+            reinterpret_cast<void*>(nucleusSPUChannelCount), TYPE_I32, {TYPE_I32});
+        count = builder.createCall(countFunc, {builder.getConstantI32(code.ra)}, CALL_EXTERN);
+    }
+
+    // Result is placed in the preferred slot and the remaining slots are cleared
+    setGPR(code.rt, builder.getConstantV128(V128{}));
+    builder.createCtxStore(getPreferredSlot(code.rt), count);
 }
 
 void Translator::rdch(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* value;
+    if (const U32 offset = getChannelOffset(code.ra)) {
+        value = builder.createCtxLoad(offset, TYPE_I32);
+    } else {
+        hir::Function* readFunc = builder.getExternFunction(
+            reinterpret_cast<void*>(nucleusSPUReadChannel), TYPE_I32, {TYPE_I32});
+        value = builder.createCall(readFunc, {builder.getConstantI32(code.ra)}, CALL_EXTERN);
+    }
+
+    // Result is placed in the preferred slot and the remaining slots are cleared
+    setGPR(code.rt, builder.getConstantV128(V128{}));
+    builder.createCtxStore(getPreferredSlot(code.rt), value);
 }
 
 void Translator::wrch(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* rt = builder.createCtxLoad(getPreferredSlot(code.rt), TYPE_I32);
+
+    // MFC parameters are written to the state directly, only commands reach the MFC
+    if (const U32 offset = getChannelOffset(code.ra)) {
+        builder.createCtxStore(offset, rt);
+    } else {
+        hir::Function* writeFunc = builder.getExternFunction(
+            reinterpret_cast<void*>(nucleusSPUWriteChannel), TYPE_VOID, {TYPE_I32, TYPE_I32});
+        builder.createCall(writeFunc, {builder.getConstantI32(code.ra), rt}, CALL_EXTERN);
+    }
 }
 
 }  // namespace spu
@@ -0,0 +1,10 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+// Function analyses
+#include "nucleus/cpu/hir/analyses/dominator_analysis.h"
+#include "nucleus/cpu/hir/analyses/liveness_analysis.h"
@@ -0,0 +1,145 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "dominator_analysis.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/instruction.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace cpu {
+namespace hir {
+namespace analyses {
+
+constexpr AnalysisType DominatorAnalysis::type;
+constexpr size_t DominatorAnalysis::BLOCK_NONE;
+
+DominatorAnalysis::DominatorAnalysis(Function* function, AnalysisManager&) {
+    const size_t count = function->blocks.size();
+    preds.resize(count);
+    succs.resize(count);
+    children.resize(count);
+    idom.assign(count, BLOCK_NONE);
+
+    std::unordered_map<const Block*, size_t> index;
+    entry = 0;
+    for (size_t b = 0; b < count; b++) {
+        index[function->blocks[b]] = b;
+        if (function->blocks[b]->flags & BLOCK_IS_ENTRY) {
+            entry = b;
+        }
+    }
+    auto addEdge = [&](size_t from, size_t to) {
+        succs[from].push_back(to);
+        preds[to].push_back(from);
+    };
+
+    // Successors are explicit branch targets plus the next block on fall-through
+    for (size_t b = 0; b < count; b++) {
+        bool terminated = false;
+        for (const Instruction* i : function->blocks[b]->instructions) {
+            if (i->opcode == OPCODE_BR) {
+                addEdge(b, index.at(i->src1.block));
+                terminated = true;
+                break;
+            }
+            if (i->opcode == OPCODE_BRCOND) {
+                addEdge(b, index.at(i->src2.block));
+            }
+            if (i->opcode == OPCODE_RET) {
+                terminated = true;
+                break;
+            }
+        }
+        if (!terminated && b + 1 < count) {
+            addEdge(b, b + 1);
+        }
+    }
+
+    // Reverse postorder of reachable blocks
+    std::vector<size_t> rpoNumber(count, BLOCK_NONE);
+    std::vector<bool> visited(count, false);
+    std::vector<std::pair<size_t, size_t>> stack;
+    if (count) {
+        stack.emplace_back(entry, 0);
+        visited[entry] = true;
+    }
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        if (top.second < succs[top.first].size()) {
+            size_t next = succs[top.first][top.second++];
+            if (!visited[next]) {
+                visited[next] = true;
+                stack.emplace_back(next, 0);
+            }
+        } else {
+            order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    for (size_t n = 0; n < order.size(); n++) {
+        rpoNumber[order[n]] = n;
+    }
+
+    // Immediate dominators (Cooper, Harvey, Kennedy)
+    auto intersect = [&](size_t b1, size_t b2) {
+        while (b1 != b2) {
+            while (rpoNumber[b1] > rpoNumber[b2]) {
+                b1 = idom[b1];
+            }
+            while (rpoNumber[b2] > rpoNumber[b1]) {
+                b2 = idom[b2];
+            }
+        }
+        return b1;
+    };
+    if (count) {
+        idom[entry] = entry;
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b : order) {
+            if (b == entry) {
+                continue;
+            }
+            size_t newIdom = BLOCK_NONE;
+            for (size_t p : preds[b]) {
+                if (idom[p] == BLOCK_NONE) {
+                    continue;
+                }
+                newIdom = (newIdom == BLOCK_NONE) ? p : intersect(p, newIdom);
+            }
+            if (idom[b] != newIdom) {
+                idom[b] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    for (size_t b : order) {
+        if (b != entry) {
+            children[idom[b]].push_back(b);
+        }
+    }
+}
+
+bool DominatorAnalysis::dominates(size_t a, size_t b) const {
+    if (idom[a] == BLOCK_NONE || idom[b] == BLOCK_NONE) {
+        return false;
+    }
+    while (b != a) {
+        if (b == entry) {
+            return false;
+        }
+        b = idom[b];
+    }
+    return true;
+}
+
+}  // namespace analyses
+}  // namespace hir
+}  // namespace cpu
@@ -0,0 +1,62 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/analysis.h"
+
+#include <vector>
+
+namespace cpu {
+namespace hir {
+namespace analyses {
+
+/**
+ * Dominator Analysis
+ * ==================
+ * Builds the control flow graph of the target function and its dominator tree.
+ * Blocks are referred by their index in Function::blocks. Successors of a block are
+ * the targets of its BR/BRCOND instructions, plus the next block if the block does
+ * not end with an unconditional BR or a RET (fall-through).
+ *
+ * Notes:
+ * - Unreachable blocks have no immediate dominator (BLOCK_NONE) and are not
+ *   part of the dominator tree nor the reverse postorder.
+ */
+class DominatorAnalysis : public Analysis {
+public:
+    static constexpr AnalysisType type = ANALYSIS_DOMINATORS;
+    static constexpr size_t BLOCK_NONE = size_t(-1);
+
+    // Control flow graph
+    std::vector<std::vector<size_t>> preds;
+    std::vector<std::vector<size_t>> succs;
+
+    // Dominator tree
+    std::vector<std::vector<size_t>> children;
+    std::vector<size_t> idom;
+
+    // Reachable blocks in reverse postorder
+    std::vector<size_t> order;
+
+    // Index of the entry block
+    size_t entry;
+
+    // Constructor
+    DominatorAnalysis(Function* function, AnalysisManager& analysisManager);
+
+    /**
+     * Check whether a block dominates another one
+     * @param[in]  a  Index of the dominating block
+     * @param[in]  b  Index of the dominated block
+     * @return        True if every path from the entry to b goes through a
+     */
+    bool dominates(size_t a, size_t b) const;
+};
+
+}  // namespace analyses
+}  // namespace hir
+}  // namespace cpu
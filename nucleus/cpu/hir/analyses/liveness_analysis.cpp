@@ -0,0 +1,71 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "liveness_analysis.h"
+#include "nucleus/cpu/hir/analyses/dominator_analysis.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/instruction.h"
+
+namespace cpu {
+namespace hir {
+namespace analyses {
+
+constexpr AnalysisType LivenessAnalysis::type;
+
+LivenessAnalysis::LivenessAnalysis(Function* function, AnalysisManager& analysisManager) {
+    const auto& cfg = analysisManager.get<DominatorAnalysis>();
+    const size_t count = function->blocks.size();
+    liveIn.resize(count);
+    liveOut.resize(count);
+
+    // Upward-exposed uses and definitions of each block
+    std::vector<std::unordered_set<Value*>> defs(count);
+    for (size_t b = 0; b < count; b++) {
+        auto& uses = liveIn[b];
+        for (const Instruction* i : function->blocks[b]->instructions) {
+            const auto& info = opcodeInfo[i->opcode];
+            const Instruction::Operand* operands[3] = { &i->src1, &i->src2, &i->src3 };
+            const U08 signatures[3] = { info.getSignatureSrc1(), info.getSignatureSrc2(), info.getSignatureSrc3() };
+            for (int n = 0; n < 3; n++) {
+                Value* value = operands[n]->value;
+                if (signatures[n] != OPCODE_SIG_TYPE_V && (signatures[n] != OPCODE_SIG_TYPE_M || !value)) {
+                    continue;
+                }
+                if (!value->isConstant() && !defs[b].count(value)) {
+                    uses.insert(value);
+                }
+            }
+            if (i->dest) {
+                defs[b].insert(i->dest);
+            }
+        }
+    }
+
+    // Backward dataflow: liveOut(b) = U liveIn(s), liveIn(b) = uses(b) U (liveOut(b) - defs(b))
+    // Sets only grow, so comparing sizes is enough to detect changes
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = cfg.order.rbegin(); it != cfg.order.rend(); ++it) {
+            const size_t b = *it;
+            for (size_t s : cfg.succs[b]) {
+                liveOut[b].insert(liveIn[s].begin(), liveIn[s].end());
+            }
+            const size_t size = liveIn[b].size();
+            for (Value* value : liveOut[b]) {
+                if (!defs[b].count(value)) {
+                    liveIn[b].insert(value);
+                }
+            }
+            if (liveIn[b].size() != size) {
+                changed = true;
+            }
+        }
+    }
+}
+
+}  // namespace analyses
+}  // namespace hir
+}  // namespace cpu
@@ -0,0 +1,52 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/analysis.h"
+#include "nucleus/cpu/hir/value.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace cpu {
+namespace hir {
+namespace analyses {
+
+/**
+ * Liveness Analysis
+ * =================
+ * Computes the set of non-constant values that are live at the entry and at the exit
+ * of each block, i.e. values that might be used later without being redefined.
+ * Blocks are referred by their index in Function::blocks.
+ *
+ * Notes:
+ * - This analysis depends on DominatorAnalysis for the control flow graph.
+ */
+class LivenessAnalysis : public Analysis {
+public:
+    static constexpr AnalysisType type = ANALYSIS_LIVENESS;
+
+    std::vector<std::unordered_set<Value*>> liveIn;
+    std::vector<std::unordered_set<Value*>> liveOut;
+
+    // Constructor
+    LivenessAnalysis(Function* function, AnalysisManager& analysisManager);
+
+    /**
+     * Check whether a value is still needed after leaving a block
+     * @param[in]  block  Index of the block
+     * @param[in]  value  Value to check
+     * @return            True if the value is live at the exit of the block
+     */
+    bool isLiveOut(size_t block, Value* value) const {
+        return liveOut[block].count(value) != 0;
+    }
+};
+
+}  // namespace analyses
+}  // namespace hir
+}  // namespace cpu
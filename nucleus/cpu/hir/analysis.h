@@ -0,0 +1,84 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/function.h"
+
+#include <memory>
+
+namespace cpu {
+namespace hir {
+
+// Forward declarations
+class AnalysisManager;
+
+enum AnalysisType {
+    ANALYSIS_DOMINATORS,  // Control flow graph and dominator tree
+    ANALYSIS_LIVENESS,    // Live values at the boundaries of each block
+
+    ANALYSIS_COUNT,
+};
+
+// Sets of analyses, used by passes to report which results are still valid after changing a function
+enum AnalysisSet {
+    ANALYSIS_SET_NONE        = 0,
+    ANALYSIS_SET_DOMINATORS  = (1 << ANALYSIS_DOMINATORS),
+    ANALYSIS_SET_LIVENESS    = (1 << ANALYSIS_LIVENESS),
+    ANALYSIS_SET_ALL         = (1 << ANALYSIS_COUNT) - 1,
+};
+
+class Analysis {
+public:
+    virtual ~Analysis() = default;
+};
+
+/**
+ * Analysis Manager
+ * ================
+ * Computes function analyses on demand and caches the results until a pass that
+ * modifies the function invalidates them. Analyses are constructed with the signature
+ * T(Function*, AnalysisManager&) and may request other analyses from the manager.
+ */
+class AnalysisManager {
+    Function* function;
+
+    // Cached results, indexed by AnalysisType
+    std::unique_ptr<Analysis> results[ANALYSIS_COUNT];
+
+public:
+    // Statistics
+    U64 hits = 0;
+    U64 misses = 0;
+
+    // Constructor
+    AnalysisManager(Function* function) : function(function) {}
+
+    /**
+     * Get the result of an analysis, computing it if no valid result is cached
+     * @return  Analysis result for the managed function
+     */
+    template <typename T>
+    T& get() {
+        auto& result = results[T::type];
+        if (result) {
+            hits += 1;
+        } else {
+            misses += 1;
+            result = std::make_unique<T>(function, *this);
+        }
+        return static_cast<T&>(*result);
+    }
+
+    /**
+     * Discard all cached results except the preserved ones
+     * @param[in]  preserved  Set of analyses still valid, as AnalysisSet flags
+     */
+    void invalidate(U32 preserved = ANALYSIS_SET_NONE);
+};
+
+}  // namespace hir
+}  // namespace cpu
@@ -32,8 +32,12 @@ public:
 
     U32 flags;
 
-    // Constructor
-    Block(Function* parent);
+    /**
+     * Create a block at the end of a function, or right after another block of it
+     * @param[in]  parent  Function containing the block
+     * @param[in]  after   Block falling through to the new one, or nullptr to append it
+     */
+    Block(Function* parent, Block* after = nullptr);
     ~Block();
 
     // Get ID of this block
@@ -30,6 +30,8 @@ public:
      */
     void setInsertPoint(Block* block);
     void setInsertPoint(Block* block, std::list<Instruction*>::iterator ip);
+    Block* getInsertBlock() const { return ib; }
+    std::list<Instruction*>::iterator getInsertPoint() const { return ip; }
 
     // HIR values
     Value* allocValue(Type type);
@@ -120,6 +122,7 @@ public:
     Value* createFAdd(Value* lhs, Value* rhs);
     Value* createFSub(Value* lhs, Value* rhs);
     Value* createFMul(Value* lhs, Value* rhs);
+    Value* createFMA(Value* lhs, Value* rhs, Value* addend);
     Value* createFDiv(Value* lhs, Value* rhs);
     Value* createFNeg(Value* value);
 
@@ -129,6 +132,19 @@ public:
     Value* createVMul(Value* lhs, Value* rhs, OpcodeFlags flags);
     Value* createVAvg(Value* lhs, Value* rhs, OpcodeFlags flags);
     Value* createVAbs(Value* value, OpcodeFlags flags);
+
+    /**
+     * Narrow the signed components given by the flags to half their width, saturating to the
+     * signed range, or to the unsigned range if ARITHMETIC_UNSIGNED is set.
+     * The lower half of the result comes from lhs.
+     */
+    Value* createVPack(Value* lhs, Value* rhs, OpcodeFlags flags);
+
+    /**
+     * Replace the denormal floating-point components given by the flags with a zero of the
+     * same sign, only in the components where mask has all bits set.
+     */
+    Value* createVFlush(Value* value, Value* mask, OpcodeFlags flags);
     Value* createVCmpEQ(Value* lhs, Value* rhs, OpcodeFlags flags);
     Value* createVCmpNE(Value* lhs, Value* rhs, OpcodeFlags flags);
     Value* createVCmpFLT(Value* lhs, Value* rhs, OpcodeFlags flags);
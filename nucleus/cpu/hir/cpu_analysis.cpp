@@ -0,0 +1,20 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "analysis.h"
+
+namespace cpu {
+namespace hir {
+
+void AnalysisManager::invalidate(U32 preserved) {
+    for (int type = 0; type < ANALYSIS_COUNT; type++) {
+        if (!(preserved & (1 << type))) {
+            results[type].reset();
+        }
+    }
+}
+
+}  // namespace hir
+}  // namespace cpu
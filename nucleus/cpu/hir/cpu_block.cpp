@@ -7,14 +7,21 @@
 #include "nucleus/cpu/hir/function.h"
 #include "nucleus/cpu/hir/instruction.h"
 
+#include <algorithm>
+
 namespace cpu {
 namespace hir {
 
-Block::Block(Function* parent) : parent(parent), flags(0) {
+Block::Block(Function* parent, Block* after) : parent(parent), flags(0) {
     if (parent->flags & FUNCTION_IS_DECLARED) {
         parent->flags |= FUNCTION_IS_DEFINING;
     }
-    parent->blocks.push_back(this);
+    auto it = std::find(parent->blocks.begin(), parent->blocks.end(), after);
+    if (it != parent->blocks.end()) {
+        parent->blocks.insert(it + 1, this);
+    } else {
+        parent->blocks.push_back(this);
+    }
 }
 
 Block::~Block() {
@@ -125,8 +125,12 @@ Function* Builder::getExternFunction(void* hostAddr, Type typeOut, const std::ve
         externFunc = new Function(parModule, TYPE_VOID, {});
     } else if (hostAddr == nucleusHook) {
         externFunc = new Function(parModule, TYPE_VOID, {TYPE_I32});
+    } else if (hostAddr == nucleusHookDirect) {
+        externFunc = new Function(parModule, TYPE_VOID, {TYPE_I64, TYPE_I32});
     } else if (hostAddr == nucleusLog) {
         externFunc = new Function(parModule, TYPE_VOID, {TYPE_I64});
+    } else if (hostAddr == nucleusHandleEvents) {
+        externFunc = new Function(parModule, TYPE_I32, {});
     } else if (hostAddr == nucleusTime) {
         externFunc = new Function(parModule, TYPE_I64, {});
     } else {
@@ -746,6 +750,19 @@ Value* Builder::createFMul(Value* lhs, Value* rhs) {
     return i->dest;
 }
 
+Value* Builder::createFMA(Value* lhs, Value* rhs, Value* addend) {
+    ASSERT_TYPE_FLOAT(lhs);
+    ASSERT_TYPE_EQUAL(lhs, rhs);
+    ASSERT_TYPE_EQUAL(lhs, addend);
+
+    // Product and sum are rounded once
+    Instruction* i = appendInstr(OPCODE_FMA, 0, allocValue(lhs->type));
+    i->src1.setValue(lhs);
+    i->src2.setValue(rhs);
+    i->src3.setValue(addend);
+    return i->dest;
+}
+
 Value* Builder::createFDiv(Value* lhs, Value* rhs) {
     ASSERT_TYPE_FLOAT(lhs);
     ASSERT_TYPE_EQUAL(lhs, rhs);
@@ -806,7 +823,7 @@ Value* Builder::createVMul(Value* lhs, Value* rhs, OpcodeFlags flags) {
     ASSERT_TYPE_VECTOR(rhs);
     ASSERT_TYPE_EQUAL(lhs, rhs);
 
-    Instruction* i = appendInstr(OPCODE_VSUB, flags, allocValue(lhs->type));
+    Instruction* i = appendInstr(OPCODE_VMUL, flags, allocValue(lhs->type));
     i->src1.setValue(lhs);
     i->src2.setValue(rhs);
     return i->dest;
@@ -823,6 +840,27 @@ Value* Builder::createVAvg(Value* lhs, Value* rhs, OpcodeFlags flags) {
     return i->dest;
 }
 
+Value* Builder::createVPack(Value* lhs, Value* rhs, OpcodeFlags flags) {
+    ASSERT_TYPE_VECTOR(lhs);
+    ASSERT_TYPE_VECTOR(rhs);
+    ASSERT_TYPE_EQUAL(lhs, rhs);
+
+    Instruction* i = appendInstr(OPCODE_VPACK, flags, allocValue(lhs->type));
+    i->src1.setValue(lhs);
+    i->src2.setValue(rhs);
+    return i->dest;
+}
+
+Value* Builder::createVFlush(Value* value, Value* mask, OpcodeFlags flags) {
+    ASSERT_TYPE_VECTOR(value);
+    ASSERT_TYPE_VECTOR(mask);
+
+    Instruction* i = appendInstr(OPCODE_VFLUSH, flags, allocValue(value->type));
+    i->src1.setValue(value);
+    i->src2.setValue(mask);
+    return i->dest;
+}
+
 Value* Builder::createVAbs(Value* value, OpcodeFlags flags) {
     ASSERT_TYPE_VECTOR(value);
 
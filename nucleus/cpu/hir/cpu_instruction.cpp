@@ -114,8 +114,11 @@ std::string Instruction::dump() const {
         // Vector flags
         case OPCODE_VADD:
         case OPCODE_VSUB:
+        case OPCODE_VMUL:
         case OPCODE_VAVG:
         case OPCODE_VCMP:
+        case OPCODE_VPACK:
+        case OPCODE_VFLUSH:
             if (flags == COMPONENT_I8) { output += "i8"; }
             if (flags == COMPONENT_I16) { output += "i16"; }
             if (flags == COMPONENT_I32) { output += "i32"; }
@@ -0,0 +1,149 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "pass_manager.h"
+#include "nucleus/filesystem/filesystem_host.h"
+#include "nucleus/logger/logger.h"
+
+#include "externals/rapidjson/prettywriter.h"
+#include "externals/rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace cpu {
+namespace hir {
+
+void PassManager::addPass(std::unique_ptr<Pass> pass) {
+    std::lock_guard<std::mutex> lock(countersMutex);
+
+    // Counters are merged by name, so replacing a pipeline keeps the history of its passes
+    const char* name = pass->name();
+    auto it = std::find_if(counters.begin(), counters.end(), [&](const PassCounters& entry) {
+        return entry.name == name;
+    });
+    PassCounters* entry;
+    if (it != counters.end()) {
+        entry = &*it;
+    } else {
+        counters.emplace_back();
+        entry = &counters.back();
+        entry->name = name;
+    }
+    passes.push_back({ std::move(pass), entry });
+}
+
+void PassManager::clearPasses() {
+    passes.clear();
+}
+
+bool PassManager::run(Function* function) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    AnalysisManager analysisManager(function);
+    bool success = true;
+    for (auto& entry : passes) {
+        auto& pass = entry.pass;
+        auto& stats = *entry.counters;
+        const auto start = Clock::now();
+        const PassResult result = pass->run(function, analysisManager);
+        const auto end = Clock::now();
+        const U64 time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        stats.runs += 1;
+        stats.totalTime += time;
+        U64 maxTime = stats.maxTime.load(std::memory_order_relaxed);
+        while (time > maxTime && !stats.maxTime.compare_exchange_weak(maxTime, time, std::memory_order_relaxed)) {
+        }
+        if (result == PASS_FAILED) {
+            stats.failed += 1;
+            logger.error(LOG_CPU, "Could not run pass: %s", pass->name());
+            success = false;
+            break;
+        }
+        if (result == PASS_CHANGED) {
+            stats.changed += 1;
+            analysisManager.invalidate(pass->preserves());
+        } else {
+            stats.unchanged += 1;
+        }
+    }
+
+    functions += 1;
+    analysisHits += analysisManager.hits;
+    analysisMisses += analysisManager.misses;
+    return success;
+}
+
+std::vector<PassStatistics> PassManager::getStatistics() {
+    std::lock_guard<std::mutex> lock(countersMutex);
+
+    std::vector<PassStatistics> statistics;
+    for (const auto& entry : counters) {
+        PassStatistics stats;
+        stats.name = entry.name;
+        stats.runs = entry.runs;
+        stats.changed = entry.changed;
+        stats.unchanged = entry.unchanged;
+        stats.failed = entry.failed;
+        stats.totalTime = entry.totalTime;
+        stats.maxTime = entry.maxTime;
+        statistics.push_back(stats);
+    }
+    return statistics;
+}
+
+bool PassManager::saveReport(const std::string& path) {
+    const auto statistics = getStatistics();
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.String("functions");
+    writer.Uint64(functions);
+    writer.String("analyses");
+    writer.StartObject();
+    writer.String("hits");
+    writer.Uint64(analysisHits);
+    writer.String("misses");
+    writer.Uint64(analysisMisses);
+    writer.EndObject();
+    writer.String("passes");
+    writer.StartArray();
+    for (const auto& stats : statistics) {
+        writer.StartObject();
+        writer.String("name");
+        writer.String(stats.name.c_str());
+        writer.String("runs");
+        writer.Uint64(stats.runs);
+        writer.String("changed");
+        writer.Uint64(stats.changed);
+        writer.String("unchanged");
+        writer.Uint64(stats.unchanged);
+        writer.String("failed");
+        writer.Uint64(stats.failed);
+        writer.String("totalTimeNs");
+        writer.Uint64(stats.totalTime);
+        writer.String("maxTimeNs");
+        writer.Uint64(stats.maxTime);
+        writer.String("averageTimeNs");
+        writer.Uint64(stats.runs ? stats.totalTime / stats.runs : 0);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    auto file = fs::HostFileSystem::openFile(path, fs::Write);
+    const fs::Size size = buffer.GetSize();
+    if (!file || file->write(buffer.GetString(), size) != size) {
+        logger.warning(LOG_CPU, "Could not save pass report to: %s", path.c_str());
+        return false;
+    }
+    logger.notice(LOG_CPU, "Saved pass report to: %s", path.c_str());
+    return true;
+}
+
+}  // namespace hir
+}  // namespace cpu
@@ -43,6 +43,9 @@ public:
     // Function flags
     U32 flags;
 
+    // Symbol name of the function, used to identify generated code in profilers
+    std::string name;
+
     // Return and argument types
     TypeOut typeOut;
     TypeIn typeIn;
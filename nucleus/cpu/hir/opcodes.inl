@@ -44,9 +44,13 @@ OPCODE(FADD,      "fadd",      OPCODE_SIG_V_V_V)   // Floating-point addition
 OPCODE(FSUB,      "fsub",      OPCODE_SIG_V_V_V)   // Floating-point subtraction
 OPCODE(FMUL,      "fmul",      OPCODE_SIG_V_V_V)   // Floating-point multiplication
 OPCODE(FDIV,      "fdiv",      OPCODE_SIG_V_V_V)   // Floating-point division
+OPCODE(FMA,       "fma",       OPCODE_SIG_V_V_V_V) // Floating-point fused multiply-add
 OPCODE(FNEG,      "fneg",      OPCODE_SIG_V_V)     // Floating-point negation
 OPCODE(VADD,      "vadd",      OPCODE_SIG_V_V_V)   // Vector addition
 OPCODE(VSUB,      "vsub",      OPCODE_SIG_V_V_V)   // Vector subtraction
+OPCODE(VMUL,      "vmul",      OPCODE_SIG_V_V_V)   // Vector multiplication
 OPCODE(VABS,      "vabs",      OPCODE_SIG_V_V)     // Vector absolute value
 OPCODE(VAVG,      "vavg",      OPCODE_SIG_V_V_V)   // Vector average
 OPCODE(VCMP,      "vcmp",      OPCODE_SIG_V_V_V)   // Vector compare
+OPCODE(VPACK,     "vpack",     OPCODE_SIG_V_V_V)   // Vector pack with saturation
+OPCODE(VFLUSH,    "vflush",    OPCODE_SIG_V_V_V)   // Vector flush of denormals to zero
@@ -6,25 +6,50 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/cpu/hir/analysis.h"
 #include "nucleus/cpu/hir/function.h"
 
 namespace cpu {
 namespace hir {
 
+enum PassResult {
+    PASS_FAILED,     // Pass could not be applied, the function should not be compiled
+    PASS_UNCHANGED,  // Pass was applied without modifying the function
+    PASS_CHANGED,    // Pass was applied and modified the function
+};
+
+/**
+ * Pass
+ * ====
+ * Transformation applied to HIR functions. A single pass object might process several
+ * functions concurrently, so any state needed while processing a function must be kept
+ * per run, never in the pass object itself.
+ */
 class Pass {
 public:
+    virtual ~Pass() = default;
+
     /**
      * Get the name of this pass
      * @return               Name of this pass
      */
     virtual const char* name() = 0;
 
+    /**
+     * Get the analyses that remain valid after this pass modifies a function
+     * @return               Set of preserved analyses, as AnalysisSet flags
+     */
+    virtual U32 preserves() {
+        return ANALYSIS_SET_NONE;
+    }
+
     /**
      * Apply this pass on a function
-     * @param[in]  function  Function to be processed
-     * @return               True on success
+     * @param[in]  function         Function to be processed
+     * @param[in]  analysisManager  Cached analyses of the function
+     * @return                      Result of the pass
      */
-    virtual bool run(Function* function) = 0;
+    virtual PassResult run(Function* function, AnalysisManager& analysisManager) = 0;
 };
 
 }  // namespace hir
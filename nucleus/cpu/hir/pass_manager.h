@@ -0,0 +1,107 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/analysis.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/hir/pass.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cpu {
+namespace hir {
+
+// Cumulative statistics of a pass
+struct PassStatistics {
+    std::string name;
+    U64 runs = 0;
+    U64 changed = 0;
+    U64 unchanged = 0;
+    U64 failed = 0;
+    U64 totalTime = 0;  // Wall time in nanoseconds
+    U64 maxTime = 0;    // Wall time in nanoseconds
+};
+
+/**
+ * Pass Manager
+ * ============
+ * Runs a sequence of passes on functions, sharing an AnalysisManager between them.
+ * After each pass that changes the function, every analysis not preserved by that pass
+ * is invalidated. The wall time and result of each pass are accumulated over all runs.
+ *
+ * Notes:
+ * - Several functions can be processed concurrently. Analyses are owned by each run
+ *   and statistics are updated atomically, so no lock is held while passes run.
+ * - The pipeline must not be modified while functions are being processed.
+ */
+class PassManager {
+    struct PassCounters {
+        std::string name;
+        std::atomic<U64> runs{0};
+        std::atomic<U64> changed{0};
+        std::atomic<U64> unchanged{0};
+        std::atomic<U64> failed{0};
+        std::atomic<U64> totalTime{0};
+        std::atomic<U64> maxTime{0};
+    };
+
+    struct PassEntry {
+        std::unique_ptr<Pass> pass;
+        PassCounters* counters;
+    };
+
+    std::vector<PassEntry> passes;
+
+    // Counters are never removed, so that pointers to them remain valid
+    std::deque<PassCounters> counters;
+    std::mutex countersMutex;
+
+    // Global statistics
+    std::atomic<U64> functions{0};
+    std::atomic<U64> analysisHits{0};
+    std::atomic<U64> analysisMisses{0};
+
+public:
+    /**
+     * Append a pass to the pipeline
+     * @param[in]  pass      Pass to be appended
+     */
+    void addPass(std::unique_ptr<Pass> pass);
+
+    /**
+     * Remove all passes from the pipeline, keeping their statistics
+     */
+    void clearPasses();
+
+    /**
+     * Run all passes on a function, stopping at the first failure
+     * @param[in]  function  Function to be processed
+     * @return               True on success
+     */
+    bool run(Function* function);
+
+    /**
+     * Get a copy of the cumulative statistics of every pass that ever ran
+     * @return               Statistics in order of first registration
+     */
+    std::vector<PassStatistics> getStatistics();
+
+    /**
+     * Save a JSON report of the cumulative statistics
+     * @param[in]  path      Host path of the report
+     * @return               True on success
+     */
+    bool saveReport(const std::string& path);
+};
+
+}  // namespace hir
+}  // namespace cpu
@@ -7,6 +7,7 @@
 
 // Optimization passes
 #include "nucleus/cpu/hir/passes/dead_code_elimination_pass.h"
+#include "nucleus/cpu/hir/passes/global_value_numbering_pass.h"
 
 // Mandatory passes
 #include "nucleus/cpu/hir/passes/register_allocation_pass.h"
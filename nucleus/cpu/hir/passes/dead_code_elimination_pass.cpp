@@ -4,18 +4,74 @@
  */
 
 #include "dead_code_elimination_pass.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/instruction.h"
+
+#include <iterator>
 
 namespace cpu {
 namespace hir {
 namespace passes {
 
-bool DeadCodeEliminationPass::run(Function* function) {
-    // Check function flags
-    if (!function || !(function->flags & FUNCTION_IS_DEFINED)) {
+namespace {
+
+// Check whether an instruction can be removed if its result is unused
+bool isRemovable(const Instruction* i) {
+    switch (i->opcode) {
+    case OPCODE_LOAD:
+    case OPCODE_STORE:
+    case OPCODE_CTXSTORE:
+    case OPCODE_MEMFENCE:
+    case OPCODE_BR:
+    case OPCODE_BRCOND:
+    case OPCODE_ARG:
+    case OPCODE_CALL:
+    case OPCODE_CALLCOND:
+    case OPCODE_RET:
         return false;
+    default:
+        return i->dest && i->dest->usage == 0;
     }
+}
 
-    return true;
+}  // anonymous namespace
+
+PassResult DeadCodeEliminationPass::run(Function* function, AnalysisManager&) {
+    bool changed = false;
+
+    // Walking each block backwards removes whole chains of dead instructions in one sweep,
+    // repeat only if a removal made values defined in other blocks dead
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        for (auto& block : function->blocks) {
+            auto& instructions = block->instructions;
+            for (auto it = instructions.rbegin(); it != instructions.rend(); ) {
+                Instruction* i = *it;
+                if (!isRemovable(i)) {
+                    ++it;
+                    continue;
+                }
+                const auto& opInfo = opcodeInfo[i->opcode];
+                const U08 sigTypes[3] = {
+                    opInfo.getSignatureSrc1(),
+                    opInfo.getSignatureSrc2(),
+                    opInfo.getSignatureSrc3(),
+                };
+                Instruction::Operand* operands[3] = { &i->src1, &i->src2, &i->src3 };
+                for (int k = 0; k < 3; k++) {
+                    if (sigTypes[k] == OPCODE_SIG_TYPE_V) {
+                        operands[k]->value->usage -= 1;
+                    }
+                }
+                delete i;
+                it = decltype(it)(instructions.erase(std::next(it).base()));
+                removed = true;
+            }
+        }
+        changed |= removed;
+    }
+    return changed ? PASS_CHANGED : PASS_UNCHANGED;
 }
 
 }  // namespace passes
@@ -12,18 +12,31 @@ namespace cpu {
 namespace hir {
 namespace passes {
 
+/**
+ * Dead Code Elimination Pass
+ * ==========================
+ * This optimization pass removes every instruction without side effects whose result
+ * is never used. Removing an instruction releases its operands, which might turn the
+ * instructions defining them into dead code as well.
+ *
+ * Notes:
+ * - Guest memory loads are kept, since they might target memory-mapped I/O.
+ * - This pass uses and updates Value::usage. It must run before register allocation.
+ */
 class DeadCodeEliminationPass : public Pass {
 public:
-    // Constructor
-    DeadCodeEliminationPass();
-
     // Get the name of this pass
     const char* name() override {
         return "Dead Code Elimination";
     }
 
+    // Control flow is never modified
+    U32 preserves() override {
+        return ANALYSIS_SET_DOMINATORS;
+    }
+
     // Apply this pass on a function
-    bool run(Function* function) override;
+    PassResult run(Function* function, AnalysisManager& analysisManager) override;
 };
 
 }  // namespace passes
@@ -0,0 +1,422 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "global_value_numbering_pass.h"
+#include "nucleus/cpu/hir/analyses/dominator_analysis.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/instruction.h"
+#include "nucleus/assert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace cpu {
+namespace hir {
+namespace passes {
+
+namespace {
+
+// Size in bytes of a value of the given type
+U32 getTypeSize(Type type) {
+    switch (type) {
+    case TYPE_I8:   return 1;
+    case TYPE_I16:  return 2;
+    case TYPE_I32:  return 4;
+    case TYPE_I64:  return 8;
+    case TYPE_F32:  return 4;
+    case TYPE_F64:  return 8;
+    case TYPE_V128: return 16;
+    case TYPE_V256: return 32;
+    default:
+        assert_always("Wrong type");
+        return 0;
+    }
+}
+
+// Instructions whose result only depends on their operands
+bool isPure(Opcode opcode) {
+    switch (opcode) {
+    case OPCODE_ADD:
+    case OPCODE_SUB:
+    case OPCODE_MUL:
+    case OPCODE_MULH:
+    case OPCODE_DIV:
+    case OPCODE_NEG:
+    case OPCODE_ZEXT:
+    case OPCODE_SEXT:
+    case OPCODE_TRUNC:
+    case OPCODE_CAST:
+    case OPCODE_CONVERT:
+    case OPCODE_CTLZ:
+    case OPCODE_NOT:
+    case OPCODE_AND:
+    case OPCODE_OR:
+    case OPCODE_XOR:
+    case OPCODE_SHL:
+    case OPCODE_SHR:
+    case OPCODE_SHRA:
+    case OPCODE_ROL:
+    case OPCODE_ROR:
+    case OPCODE_SQRT:
+    case OPCODE_ABS:
+    case OPCODE_SELECT:
+    case OPCODE_CMP:
+    case OPCODE_FADD:
+    case OPCODE_FSUB:
+    case OPCODE_FMUL:
+    case OPCODE_FDIV:
+    case OPCODE_FMA:
+    case OPCODE_FNEG:
+    case OPCODE_VADD:
+    case OPCODE_VSUB:
+    case OPCODE_VMUL:
+    case OPCODE_VABS:
+    case OPCODE_VAVG:
+    case OPCODE_VCMP:
+    case OPCODE_VPACK:
+    case OPCODE_VFLUSH:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions whose first two operands can be swapped
+bool isCommutative(const Instruction* i) {
+    switch (i->opcode) {
+    case OPCODE_ADD:
+    case OPCODE_MUL:
+    case OPCODE_MULH:
+    case OPCODE_AND:
+    case OPCODE_OR:
+    case OPCODE_XOR:
+    case OPCODE_FADD:
+    case OPCODE_FMUL:
+    case OPCODE_VADD:
+    case OPCODE_VMUL:
+    case OPCODE_VAVG:
+        return true;
+    case OPCODE_CMP:
+        return i->flags == COMPARE_EQ || i->flags == COMPARE_NE;
+    default:
+        return false;
+    }
+}
+
+// Call a function on every value operand of an instruction
+template <typename F>
+void forEachValueOperand(Instruction* i, F func) {
+    const auto& opInfo = opcodeInfo[i->opcode];
+    const U08 sigTypes[3] = {
+        opInfo.getSignatureSrc1(),
+        opInfo.getSignatureSrc2(),
+        opInfo.getSignatureSrc3(),
+    };
+    Instruction::Operand* operands[3] = { &i->src1, &i->src2, &i->src3 };
+    for (int k = 0; k < 3; k++) {
+        if (sigTypes[k] == OPCODE_SIG_TYPE_V ||
+           (sigTypes[k] == OPCODE_SIG_TYPE_M && operands[k]->value != nullptr)) {
+            func(*operands[k]);
+        }
+    }
+}
+
+/**
+ * Expression keys
+ */
+struct OperandKey {
+    enum Kind : U32 {
+        KIND_NONE = 0,
+        KIND_VALUE,
+        KIND_CONSTANT,
+        KIND_IMMEDIATE,
+    };
+
+    U32 kind;
+    U32 type;
+    U64 data[4];
+
+    bool operator==(const OperandKey& rhs) const {
+        return kind == rhs.kind && type == rhs.type && !memcmp(data, rhs.data, sizeof(data));
+    }
+    bool operator<(const OperandKey& rhs) const {
+        if (kind != rhs.kind) {
+            return kind < rhs.kind;
+        }
+        if (type != rhs.type) {
+            return type < rhs.type;
+        }
+        return memcmp(data, rhs.data, sizeof(data)) < 0;
+    }
+};
+
+struct ExpressionKey {
+    Opcode opcode;
+    OpcodeFlags flags;
+    Type type;
+    OperandKey src[3];
+
+    bool operator==(const ExpressionKey& rhs) const {
+        return opcode == rhs.opcode && flags == rhs.flags && type == rhs.type &&
+            src[0] == rhs.src[0] && src[1] == rhs.src[1] && src[2] == rhs.src[2];
+    }
+};
+
+struct ExpressionKeyHash {
+    size_t operator()(const ExpressionKey& key) const {
+        U64 hash = 0xCBF29CE484222325ULL;
+        auto combine = [&](U64 word) {
+            hash ^= word;
+            hash *= 0x100000001B3ULL;
+        };
+        combine(key.opcode);
+        combine(key.flags);
+        combine(key.type);
+        for (const auto& src : key.src) {
+            combine(src.kind | (U64(src.type) << 32));
+            for (const auto& word : src.data) {
+                combine(word);
+            }
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+OperandKey getOperandKey(const Instruction::Operand& operand, U08 sigType) {
+    OperandKey key = {};
+    if (sigType == OPCODE_SIG_TYPE_I) {
+        key.kind = OperandKey::KIND_IMMEDIATE;
+        key.data[0] = operand.immediate;
+    }
+    else if (sigType == OPCODE_SIG_TYPE_V || (sigType == OPCODE_SIG_TYPE_M && operand.value)) {
+        const Value* value = operand.value;
+        key.type = value->type;
+        if (value->isConstant()) {
+            key.kind = OperandKey::KIND_CONSTANT;
+            memcpy(key.data, &value->constant, getTypeSize(value->type));
+        } else {
+            key.kind = OperandKey::KIND_VALUE;
+            key.data[0] = reinterpret_cast<U64>(value);
+        }
+    }
+    return key;
+}
+
+ExpressionKey getExpressionKey(const Instruction* i) {
+    const auto& opInfo = opcodeInfo[i->opcode];
+
+    ExpressionKey key;
+    key.opcode = i->opcode;
+    key.flags = i->flags;
+    key.type = i->dest->type;
+    key.src[0] = getOperandKey(i->src1, opInfo.getSignatureSrc1());
+    key.src[1] = getOperandKey(i->src2, opInfo.getSignatureSrc2());
+    key.src[2] = getOperandKey(i->src3, opInfo.getSignatureSrc3());
+    if (isCommutative(i) && key.src[1] < key.src[0]) {
+        std::swap(key.src[0], key.src[1]);
+    }
+    return key;
+}
+
+/**
+ * Available loads
+ */
+struct ContextEntry {
+    U32 offset;
+    Type type;
+    Value* value;
+};
+
+struct MemoryEntry {
+    Value* address;
+    Type type;
+    OpcodeFlags flags;
+    Value* value;
+};
+
+struct MemoryState {
+    std::vector<ContextEntry> context;
+    std::vector<MemoryEntry> memory;
+
+    Value* findContext(U32 offset, Type type) const {
+        for (const auto& entry : context) {
+            if (entry.offset == offset && entry.type == type) {
+                return entry.value;
+            }
+        }
+        return nullptr;
+    }
+
+    Value* findMemory(Value* address, Type type, OpcodeFlags flags) const {
+        for (const auto& entry : memory) {
+            if (entry.address == address && entry.type == type && entry.flags == flags) {
+                return entry.value;
+            }
+        }
+        return nullptr;
+    }
+
+    void clobberContext(U32 offset, U32 size) {
+        context.erase(std::remove_if(context.begin(), context.end(), [&](const ContextEntry& entry) {
+            return entry.offset < offset + size && offset < entry.offset + getTypeSize(entry.type);
+        }), context.end());
+    }
+};
+
+}  // anonymous namespace
+
+PassResult GlobalValueNumberingPass::run(Function* function, AnalysisManager& analysisManager) {
+    if (function->blocks.empty()) {
+        return PASS_UNCHANGED;
+    }
+
+    const auto& domTree = analysisManager.get<analyses::DominatorAnalysis>();
+    bool changed = false;
+    std::unordered_map<ExpressionKey, Value*, ExpressionKeyHash> available;
+    std::unordered_map<Value*, Value*> replacements;
+
+    auto resolve = [&](Value* value) {
+        auto it = replacements.find(value);
+        while (it != replacements.end()) {
+            value = it->second;
+            it = replacements.find(value);
+        }
+        return value;
+    };
+    auto rewriteOperands = [&](Instruction* i) {
+        forEachValueOperand(i, [&](Instruction::Operand& operand) {
+            Value* leader = resolve(operand.value);
+            if (leader != operand.value) {
+                changed = true;
+                operand.value->usage -= 1;
+                operand.setValue(leader);
+            }
+        });
+    };
+
+    struct Frame {
+        size_t block;
+        size_t nextChild;
+        std::vector<ExpressionKey> keys;
+        MemoryState memory;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({ domTree.entry, 0, {}, {} });
+
+    // Visit blocks in dominator tree preorder, processing each block once on entry
+    bool entering = true;
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (entering) {
+            Block* block = function->blocks[frame.block];
+            auto& memory = frame.memory;
+            for (auto it = block->instructions.begin(); it != block->instructions.end(); ) {
+                Instruction* i = *it;
+                rewriteOperands(i);
+
+                Value* leader = nullptr;
+                switch (i->opcode) {
+                case OPCODE_CTXLOAD:
+                    leader = memory.findContext(U32(i->src1.immediate), i->dest->type);
+                    if (!leader) {
+                        memory.context.push_back({ U32(i->src1.immediate), i->dest->type, i->dest });
+                    }
+                    break;
+
+                case OPCODE_CTXSTORE:
+                    memory.clobberContext(U32(i->src1.immediate), getTypeSize(i->src2.value->type));
+                    // Forwarding constants might produce operand combinations without x86 sequences
+                    if (!i->src2.value->isConstant()) {
+                        memory.context.push_back({ U32(i->src1.immediate), i->src2.value->type, i->src2.value });
+                    }
+                    break;
+
+                case OPCODE_LOAD:
+                    leader = memory.findMemory(i->src1.value, i->dest->type, i->flags);
+                    if (!leader) {
+                        memory.memory.push_back({ i->src1.value, i->dest->type, i->flags, i->dest });
+                    }
+                    break;
+
+                case OPCODE_STORE:
+                    memory.memory.clear();
+                    if (!i->src2.value->isConstant()) {
+                        memory.memory.push_back({ i->src1.value, i->src2.value->type, i->flags, i->src2.value });
+                    }
+                    break;
+
+                case OPCODE_MEMFENCE:
+                    memory.memory.clear();
+                    break;
+
+                case OPCODE_CALL:
+                case OPCODE_CALLCOND:
+                    memory.context.clear();
+                    memory.memory.clear();
+                    break;
+
+                default:
+                    if (isPure(i->opcode) && i->dest) {
+                        auto key = getExpressionKey(i);
+                        auto found = available.find(key);
+                        if (found != available.end()) {
+                            leader = found->second;
+                        } else {
+                            available.emplace(key, i->dest);
+                            frame.keys.push_back(key);
+                        }
+                    }
+                }
+
+                if (leader && leader->type == i->dest->type) {
+                    replacements[i->dest] = leader;
+                    forEachValueOperand(i, [](Instruction::Operand& operand) {
+                        operand.value->usage -= 1;
+                    });
+                    delete i;
+                    it = block->instructions.erase(it);
+                    changed = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // Descend into the next dominated block
+        const auto& children = domTree.children[frame.block];
+        if (frame.nextChild < children.size()) {
+            size_t child = children[frame.nextChild++];
+            Frame next = { child, 0, {}, {} };
+            const auto& preds = domTree.preds[child];
+            if (preds.size() == 1 && preds[0] == frame.block) {
+                next.memory = frame.memory;
+            }
+            stack.push_back(std::move(next));
+            entering = true;
+            continue;
+        }
+
+        // Leave the scope of this block
+        for (const auto& key : frame.keys) {
+            available.erase(key);
+        }
+        stack.pop_back();
+        entering = false;
+    }
+
+    // Rewrite uses not dominated by their definition (e.g. PHI or unreachable blocks)
+    for (auto& block : function->blocks) {
+        for (auto& i : block->instructions) {
+            rewriteOperands(i);
+        }
+    }
+    return changed ? PASS_CHANGED : PASS_UNCHANGED;
+}
+
+}  // namespace passes
+}  // namespace hir
+}  // namespace cpu
@@ -0,0 +1,57 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/pass.h"
+
+namespace cpu {
+namespace hir {
+namespace passes {
+
+/**
+ * Global Value Numbering Pass
+ * ===========================
+ * This optimization pass walks the dominator tree of the target function and removes
+ * every instruction that recomputes a value already available in a dominating position.
+ * Uses of the removed instruction are redirected to the earlier equivalent value.
+ *
+ * Redundancies detected:
+ * - Pure instructions (arithmetic, logical, conversion, comparison, etc.) with the
+ *   same opcode, flags, type and operands. Commutative operands are canonicalized.
+ * - CTXLOAD instructions reading a context range that has not been written since
+ *   a previous CTXLOAD/CTXSTORE of the same offset and type.
+ * - LOAD instructions reading an address that has not been written since a previous
+ *   LOAD/STORE of the same address value, type and endianness.
+ *
+ * Notes:
+ * - Memory state is only inherited by blocks whose single predecessor is their immediate
+ *   dominator. Any other block starts with no available loads.
+ * - CALL/CALLCOND clobber both guest context and memory, MEMFENCE clobbers memory, and any
+ *   STORE clobbers all memory loads except the stored location (no address alias analysis).
+ * - This pass uses and updates Value::usage. It must run before register allocation, which
+ *   keeps registers over the live intervals of values reused across blocks.
+ * - This pass requires DominatorAnalysis.
+ */
+class GlobalValueNumberingPass : public Pass {
+public:
+    // Get the name of this pass
+    const char* name() override {
+        return "Global Value Numbering";
+    }
+
+    // Control flow is never modified
+    U32 preserves() override {
+        return ANALYSIS_SET_DOMINATORS;
+    }
+
+    // Apply this pass on a function
+    PassResult run(Function* function, AnalysisManager& analysisManager) override;
+};
+
+}  // namespace passes
+}  // namespace hir
+}  // namespace cpu
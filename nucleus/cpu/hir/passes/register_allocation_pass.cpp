@@ -4,23 +4,20 @@
  */
 
 #include "register_allocation_pass.h"
+#include "nucleus/cpu/hir/analyses/liveness_analysis.h"
 #include "nucleus/cpu/hir/block.h"
 #include "nucleus/cpu/hir/instruction.h"
 #include "nucleus/assert.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace cpu {
 namespace hir {
 namespace passes {
 
 RegisterAllocationPass::RegisterAllocationPass(const backend::TargetInfo& targetInfo)
     : targetInfo(targetInfo) {
-    for (const auto& regSet : targetInfo.regSets) {
-        RegSetUsage regUsage;
-        regUsage.regs.reset();
-        regUsage.count = regSet.valueIndex.size();
-        regUsage.types = regSet.types;
-        regUsages.push_back(regUsage);
-    }
 }
 
 void RegisterAllocationPass::allocArgumentReg(int index, Value* arg) {
@@ -35,7 +32,7 @@ void RegisterAllocationPass::allocArgumentReg(int index, Value* arg) {
     }
 }
 
-bool RegisterAllocationPass::tryAllocValueReg(Value* value) {
+bool RegisterAllocationPass::tryAllocValueReg(RegUsages& regUsages, Value* value) {
     // Nothing to alloc if value is unused
     if (value->usage == 0) {
         return true;
@@ -56,29 +53,26 @@ bool RegisterAllocationPass::tryAllocValueReg(Value* value) {
     return false;
 }
 
-bool RegisterAllocationPass::tryFreeValueReg(Value* value) {
-    // Nothing to free if value is constant
-    if (value->isConstant()) {
-        return true;
-    }
-    value->usage -= 1;
-    if (value->usage == 0) {
-        for (auto& regUsage : regUsages) {
-            if (regUsage.types & backend::RegisterSet::TYPE_INT && value->isTypeInteger() ||
-                regUsage.types & backend::RegisterSet::TYPE_FLOAT && value->isTypeFloat() ||
-                regUsage.types & backend::RegisterSet::TYPE_VECTOR && value->isTypeVector()) {
-                regUsage.regs[value->reg] = 0;
-                return true;
-            }
+void RegisterAllocationPass::freeValueReg(RegUsages& regUsages, Value* value) {
+    for (auto& regUsage : regUsages) {
+        if (regUsage.types & backend::RegisterSet::TYPE_INT && value->isTypeInteger() ||
+            regUsage.types & backend::RegisterSet::TYPE_FLOAT && value->isTypeFloat() ||
+            regUsage.types & backend::RegisterSet::TYPE_VECTOR && value->isTypeVector()) {
+            regUsage.regs[value->reg] = 0;
+            return;
         }
     }
-    return false;
 }
 
-bool RegisterAllocationPass::run(Function* function) {
-    // Reset register usage
-    for (auto& regUsage : regUsages) {
+PassResult RegisterAllocationPass::run(Function* function, AnalysisManager& analysisManager) {
+    // Register usage
+    RegUsages regUsages;
+    for (const auto& regSet : targetInfo.regSets) {
+        RegSetUsage regUsage;
         regUsage.regs.reset();
+        regUsage.count = regSet.valueIndex.size();
+        regUsage.types = regSet.types;
+        regUsages.push_back(regUsage);
     }
 
     // Arguments
@@ -94,35 +88,85 @@ bool RegisterAllocationPass::run(Function* function) {
         }
     }
 
-    // CFG values
+    // Live intervals, as positions of the instructions in block order
+    struct Interval {
+        Size start;
+        Size end;
+    };
+    std::unordered_map<Value*, Interval> intervals;
+    auto extendInterval = [&](Value* value, Size position) {
+        auto it = intervals.find(value);
+        if (it == intervals.end()) {
+            intervals.emplace(value, Interval{ position, position });
+        } else {
+            it->second.start = std::min(it->second.start, position);
+            it->second.end = std::max(it->second.end, position);
+        }
+    };
+
+    const auto& liveness = analysisManager.get<analyses::LivenessAnalysis>();
+    std::vector<Value*> allocatable;
+    Size position = 0;
+    for (size_t b = 0; b < function->blocks.size(); b++) {
+        const Size blockStart = position;
+        for (Value* value : liveness.liveIn[b]) {
+            extendInterval(value, blockStart);
+        }
+        for (auto& i : function->blocks[b]->instructions) {
+            auto opInfo = opcodeInfo[i->opcode];
+            const Instruction::Operand* operands[3] = { &i->src1, &i->src2, &i->src3 };
+            const U08 signatures[3] = { opInfo.getSignatureSrc1(), opInfo.getSignatureSrc2(), opInfo.getSignatureSrc3() };
+            for (int n = 0; n < 3; n++) {
+                Value* value = operands[n]->value;
+                if (signatures[n] != OPCODE_SIG_TYPE_V && (signatures[n] != OPCODE_SIG_TYPE_M || !value)) {
+                    continue;
+                }
+                if (!value->isConstant()) {
+                    extendInterval(value, position);
+                }
+            }
+            // Call arguments and returns are placed in fixed registers
+            if (opInfo.getSignatureDest() == OPCODE_SIG_TYPE_V && i->opcode != OPCODE_ARG &&
+                i->opcode != OPCODE_CALL && i->opcode != OPCODE_CALLCOND) {
+                extendInterval(i->dest, position);
+                allocatable.push_back(i->dest);
+            }
+            position++;
+        }
+        const Size blockEnd = std::max(blockStart, position - 1);
+        for (Value* value : liveness.liveOut[b]) {
+            extendInterval(value, blockEnd);
+        }
+    }
+
+    // Values starting and ending at each position
+    std::vector<std::vector<Value*>> starts(position + 1);
+    std::vector<std::vector<Value*>> ends(position + 1);
+    for (Value* value : allocatable) {
+        if (value->usage == 0) {
+            continue;
+        }
+        const auto& interval = intervals[value];
+        starts[interval.start].push_back(value);
+        ends[interval.end].push_back(value);
+    }
+
+    // CFG values: destinations never share a register with the sources of their instruction
+    position = 0;
     for (auto& block : function->blocks) {
         for (auto& i : block->instructions) {
-            // Handle call arguments
             if (i->opcode == OPCODE_ARG) {
                 allocArgumentReg(i->src1.immediate, i->dest);
-                tryFreeValueReg(i->src2.value);
-                continue;
             }
-            // Handle call returns
-            if (i->opcode == OPCODE_CALL || i->opcode == OPCODE_CALLCOND) {
-                continue;
-            }
-            // Handle everything else
-            auto opInfo = opcodeInfo[i->opcode];
-            if (opInfo.getSignatureDest() == OPCODE_SIG_TYPE_V) {
-                if (!tryAllocValueReg(i->dest)) {
+            for (Value* value : starts[position]) {
+                if (!tryAllocValueReg(regUsages, value)) {
                     assert_always("This pass does not support placing values in the stack yet");
                 }
             }
-            if (opInfo.getSignatureSrc1() == OPCODE_SIG_TYPE_V) {
-                tryFreeValueReg(i->src1.value);
-            }
-            if (opInfo.getSignatureSrc2() == OPCODE_SIG_TYPE_V) {
-                tryFreeValueReg(i->src2.value);
-            }
-            if (opInfo.getSignatureSrc3() == OPCODE_SIG_TYPE_V) {
-                tryFreeValueReg(i->src3.value);
+            for (Value* value : ends[position]) {
+                freeValueReg(regUsages, value);
             }
+            position++;
         }
     }
 
@@ -149,7 +193,7 @@ bool RegisterAllocationPass::run(Function* function) {
     }
 
     function->flags |= FUNCTION_IS_COMPILABLE;
-    return true;
+    return PASS_CHANGED;
 }
 
 }  // namespace passes
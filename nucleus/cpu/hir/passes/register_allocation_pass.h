@@ -10,6 +10,7 @@
 #include "nucleus/cpu/hir/pass.h"
 
 #include <bitset>
+#include <vector>
 
 namespace cpu {
 namespace hir {
@@ -25,8 +26,13 @@ namespace passes {
  *
  * Notes:
  * - This pass should be the last one to apply to a function.
- * - This pass uses Value::usage to determine when a value is no longer needed
- *   and the corresponding register can be. Value::usage will be modified.
+ * - Registers are held over the live interval of each value: from its first to its last
+ *   position in Function::blocks order where it is defined, used or live (LivenessAnalysis).
+ *   Values reused across blocks and loops, e.g. after GVN, keep their register until they
+ *   are no longer needed in any later block or loop iteration.
+ * - Values with no uses (Value::usage of zero) get no register.
+ * - Register usage is kept per run, so this pass can process several functions concurrently.
+ * - This pass requires LivenessAnalysis.
  */
 class RegisterAllocationPass : public Pass {
 private:
@@ -35,13 +41,11 @@ private:
         U32 count;
         std::bitset<32> regs;
     };
+    using RegUsages = std::vector<RegSetUsage>;
 
     // Target information
     const backend::TargetInfo& targetInfo;
 
-    // Register usage
-    std::vector<RegSetUsage> regUsages;
-
     /**
      * Handle call arguments
      * @param[in]  index  Index of the argument in the function
@@ -51,17 +55,18 @@ private:
 
     /**
      * Try to allocate a register for a value
-     * @param[in]  value  Value to allocate a register for
-     * @return            True if an available register was found
+     * @param[in]  regUsages  Register usage of the current run
+     * @param[in]  value      Value to allocate a register for
+     * @return                True if an available register was found
      */
-    bool tryAllocValueReg(Value* value);
+    bool tryAllocValueReg(RegUsages& regUsages, Value* value);
 
     /**
-     * Try to free a register from a value
-     * @param[in]  value  Value to allocate a register for
-     * @return            True if an available register was found
+     * Free the register of a value
+     * @param[in]  regUsages  Register usage of the current run
+     * @param[in]  value      Value whose register is no longer needed
      */
-    bool tryFreeValueReg(Value* value);
+    void freeValueReg(RegUsages& regUsages, Value* value);
 
 public:
     // Constructor
@@ -72,8 +77,13 @@ public:
         return "Register Allocation";
     }
 
+    // Only registers are assigned, instructions are left untouched
+    U32 preserves() override {
+        return ANALYSIS_SET_ALL;
+    }
+
     // Apply this pass on a function
-    bool run(Function* function) override;
+    PassResult run(Function* function, AnalysisManager& analysisManager) override;
 };
 
 }  // namespace passes
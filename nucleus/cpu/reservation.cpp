@@ -0,0 +1,113 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "reservation.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace cpu {
+
+constexpr Size Reservation::LINE_SIZE;
+
+namespace {
+
+constexpr Size TABLE_SIZE = 1 << 16;
+
+// Version of each group of lines, odd values denote a locked line
+std::atomic<U64> reservationTable[TABLE_SIZE];
+
+std::atomic<U64>& getEntry(U32 addr) {
+    return reservationTable[(addr / Reservation::LINE_SIZE) % TABLE_SIZE];
+}
+
+// Wait until the line is unlocked and return its version
+U64 readVersion(std::atomic<U64>& entry) {
+    U64 version = entry.load(std::memory_order_acquire);
+    while (version & 1) {
+        std::this_thread::yield();
+        version = entry.load(std::memory_order_acquire);
+    }
+    return version;
+}
+
+// Lock the line, waiting for other writers if necessary, and return its version
+U64 lockLine(std::atomic<U64>& entry) {
+    while (true) {
+        U64 version = readVersion(entry);
+        if (entry.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+            return version;
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void Reservation::acquire(U32 addr, const void* host, void* dst, Size size) {
+    auto& entry = getEntry(addr);
+    const U08* line = static_cast<const U08*>(host) - (addr % LINE_SIZE);
+    while (true) {
+        version = readVersion(entry);
+        if (size == 4) {
+            reinterpret_cast<U32*>(data)[0] = reinterpret_cast<const std::atomic<U32>*>(host)->load();
+        } else if (size == 8) {
+            reinterpret_cast<U64*>(data)[0] = reinterpret_cast<const std::atomic<U64>*>(host)->load();
+        } else {
+            memcpy(data, line, LINE_SIZE);
+        }
+
+        // Retry if a conditional store happened while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.load(std::memory_order_relaxed) == version) {
+            break;
+        }
+    }
+    memcpy(dst, data, size);
+    this->addr = addr;
+    valid = true;
+}
+
+bool Reservation::store(U32 addr, void* host, const void* src, Size size) {
+    if (!valid || this->addr != addr) {
+        valid = false;
+        return false;
+    }
+    valid = false;
+
+    // Lock the line only if nobody stored to it since it was reserved
+    auto& entry = getEntry(addr);
+    U64 expected = version;
+    if (!entry.compare_exchange_strong(expected, version + 1, std::memory_order_acquire)) {
+        return false;
+    }
+
+    bool success;
+    if (size == 4) {
+        U32 value = reinterpret_cast<U32*>(data)[0];
+        success = reinterpret_cast<std::atomic<U32>*>(host)->compare_exchange_strong(value, *static_cast<const U32*>(src));
+    } else if (size == 8) {
+        U64 value = reinterpret_cast<U64*>(data)[0];
+        success = reinterpret_cast<std::atomic<U64>*>(host)->compare_exchange_strong(value, *static_cast<const U64*>(src));
+    } else {
+        success = !memcmp(host, data, LINE_SIZE);
+        if (success) {
+            memcpy(host, src, LINE_SIZE);
+        }
+    }
+
+    // Publish a new version only if memory changed, failures leave other reservations intact
+    entry.store(success ? version + 2 : version, std::memory_order_release);
+    return success;
+}
+
+void Reservation::storeLine(U32 addr, void* host, const void* src) {
+    auto& entry = getEntry(addr);
+    const U64 version = lockLine(entry);
+    memcpy(host, src, LINE_SIZE);
+    entry.store(version + 2, std::memory_order_release);
+}
+
+}  // namespace cpu
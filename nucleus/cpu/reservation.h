@@ -0,0 +1,82 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+namespace cpu {
+
+/**
+ * Reservation
+ * ===========
+ * Load-reserve/store-conditional emulation shared by the PPU (lwarx, ldarx, stwcx., stdcx.)
+ * and the SPU MFC (GETLLAR, PUTLLC, PUTLLUC). Each guest thread owns a Reservation object.
+ *
+ * Reservation table:
+ * - Every 128-byte line of guest memory is hashed into a global table of 64-bit words,
+ *   holding a version number (even) or a lock (odd). Conditional stores lock the line by
+ *   moving its version from the one observed when reserving, write, and publish a new
+ *   version. Any conditional store to a line therefore invalidates every reservation on it,
+ *   for both PPU and SPU threads, without host mutexes.
+ * - 4 and 8-byte conditional stores are additionally performed with a host cmpxchg against
+ *   the reserved value, so they also fail if a plain store modified the reserved word.
+ * - 128-byte conditional stores compare the whole line against the reserved snapshot.
+ *
+ * Notes:
+ * - Data is kept in guest (big-endian) byte order, callers are responsible for swapping.
+ * - Table entries are shared by several lines, collisions only cause spurious failures,
+ *   which guests handle by retrying.
+ */
+class Reservation {
+public:
+    static constexpr Size LINE_SIZE = 128;
+
+private:
+    bool valid = false;
+    U32 addr = 0;
+    U64 version = 0;
+    alignas(16) U08 data[LINE_SIZE];
+
+public:
+    /**
+     * Read data and acquire a reservation on the line containing it
+     * @param[in]   addr  Guest address, naturally aligned to the size
+     * @param[in]   host  Host pointer to the guest address
+     * @param[out]  dst   Buffer receiving the data read
+     * @param[in]   size  Size of the data: 4, 8 or Reservation::LINE_SIZE bytes
+     */
+    void acquire(U32 addr, const void* host, void* dst, Size size);
+
+    /**
+     * Write data if the reservation is still held, releasing it in any case
+     * @param[in]  addr  Guest address, must match the one passed to Reservation::acquire
+     * @param[in]  host  Host pointer to the guest address
+     * @param[in]  src   Data to write
+     * @param[in]  size  Size of the data, must match the one passed to Reservation::acquire
+     * @return           True if the data was written
+     */
+    bool store(U32 addr, void* host, const void* src, Size size);
+
+    /**
+     * Write a whole line, invalidating any reservations on it
+     * @param[in]  addr  Guest address aligned to Reservation::LINE_SIZE
+     * @param[in]  host  Host pointer to the guest address
+     * @param[in]  src   Data to write
+     */
+    static void storeLine(U32 addr, void* host, const void* src);
+
+    // Check whether a reservation is held
+    bool isValid() const {
+        return valid;
+    }
+
+    // Release the reservation, if any
+    void clear() {
+        valid = false;
+    }
+};
+
+}  // namespace cpu
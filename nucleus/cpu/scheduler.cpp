@@ -0,0 +1,257 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "scheduler.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/core/thread_policy.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/thread.h"
+
+#include <algorithm>
+
+namespace cpu {
+
+enum TaskState {
+    TASK_RUNNABLE,
+    TASK_PARKING,  // Switched back to the worker, which decides whether to park it
+    TASK_PARKED,
+    TASK_DONE,
+};
+
+struct Scheduler::Task {
+    Scheduler* scheduler;
+    Thread* thread;
+    S32 priority;
+    std::unique_ptr<core::Fiber> fiber;
+
+    // Worker that runs (or last ran) this task
+    Worker* worker = nullptr;
+    U32 workerIndex = 0;
+
+    TaskState state = TASK_RUNNABLE;
+    std::atomic<U32>* parkWord = nullptr;
+    U32 parkValue = 0;
+    std::atomic<U32> done;
+
+    Task() : done(0) {}
+};
+
+namespace {
+
+thread_local Scheduler::Task* gCurrentTask = nullptr;
+
+// Parked tasks are distributed over a fixed set of buckets, hashed by address
+struct ParkingBucket {
+    std::mutex mutex;
+    std::vector<Scheduler::Task*> tasks;
+};
+ParkingBucket parkingBuckets[64];
+
+ParkingBucket& getBucket(const void* addr) {
+    return parkingBuckets[(reinterpret_cast<uintptr_t>(addr) >> 2) % 64];
+}
+
+}  // anonymous namespace
+
+Scheduler::Scheduler(Size workerCount) : stopping(false), nextWorker(0), workEvent(0), idleWorkers(0),
+    statContextSwitches(0), statSteals(0), statParks(0), statYields(0), statRunnable(0) {
+    workerCount = std::max<Size>(workerCount, 1);
+    for (Size i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (Size i = 0; i < workerCount; i++) {
+        workers[i]->thread = std::thread([this, i]{
+            core::ThreadPolicy::registerThread(core::THREAD_ROLE_SPU, "SPU Worker " + std::to_string(i));
+            workerLoop(U32(i));
+        });
+    }
+}
+
+Scheduler::~Scheduler() {
+    stopping = true;
+    workEvent.fetch_add(1);
+    core::futexWakeAll(workEvent);
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+Scheduler::Task* Scheduler::spawn(Thread* thread, S32 priority) {
+    auto* task = new Task();
+    task->scheduler = this;
+    task->thread = thread;
+    task->priority = priority;
+    task->fiber = std::make_unique<core::Fiber>([task]{
+        task->thread->task();
+        task->state = TASK_DONE;
+        core::Fiber::switchTo(*task->fiber, *task->worker->fiber);
+    });
+    push(task, nextWorker.fetch_add(1) % workers.size());
+    return task;
+}
+
+void Scheduler::join(Task* task) {
+    while (!task->done.load()) {
+        core::futexWait(task->done, 0);
+    }
+    delete task;
+}
+
+void Scheduler::push(Task* task, U32 index) {
+    auto& worker = *workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(task);
+    }
+    statRunnable += 1;
+    workEvent.fetch_add(1);
+    if (idleWorkers.load()) {
+        core::futexWakeAll(workEvent);
+    }
+}
+
+Scheduler::Task* Scheduler::take(U32 index) {
+    auto& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.queue.empty()) {
+        return nullptr;
+    }
+    auto best = worker.queue.begin();
+    for (auto it = best + 1; it != worker.queue.end(); it++) {
+        if ((*it)->priority < (*best)->priority) {
+            best = it;
+        }
+    }
+    Task* task = *best;
+    worker.queue.erase(best);
+    statRunnable -= 1;
+    return task;
+}
+
+Scheduler::Task* Scheduler::steal(U32 index) {
+    for (Size i = 1; i < workers.size(); i++) {
+        Task* task = take(U32((index + i) % workers.size()));
+        if (task) {
+            statSteals += 1;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Scheduler::workerLoop(U32 index) {
+    Worker& worker = *workers[index];
+    core::Fiber fiber;
+    worker.fiber = &fiber;
+
+    while (!stopping) {
+        const U32 event = workEvent.load();
+        Task* task = take(index);
+        if (!task) {
+            task = steal(index);
+        }
+        if (task) {
+            task->workerIndex = index;
+            resume(worker, task);
+            continue;
+        }
+
+        // Nothing to run, sleep until a task is queued
+        idleWorkers += 1;
+        if (!stopping) {
+            core::futexWait(workEvent, event);
+        }
+        idleWorkers -= 1;
+    }
+    worker.fiber = nullptr;
+}
+
+void Scheduler::resume(Worker& worker, Task* task) {
+    task->worker = &worker;
+    gCurrentTask = task;
+    CPU::setCurrentThread(task->thread);
+    statContextSwitches += 1;
+    core::Fiber::switchTo(*worker.fiber, *task->fiber);
+    CPU::setCurrentThread(nullptr);
+    gCurrentTask = nullptr;
+
+    switch (task->state) {
+    case TASK_DONE:
+        task->done.store(1);
+        core::futexWakeAll(task->done);
+        break;
+
+    case TASK_PARKING: {
+        // Park only if no wake-up happened since the task decided to wait
+        auto& bucket = getBucket(task->parkWord);
+        std::unique_lock<std::mutex> lock(bucket.mutex);
+        if (task->parkWord->load() == task->parkValue) {
+            task->state = TASK_PARKED;
+            bucket.tasks.push_back(task);
+            statParks += 1;
+        } else {
+            lock.unlock();
+            task->state = TASK_RUNNABLE;
+            push(task, task->workerIndex);
+        }
+        break;
+    }
+
+    default:
+        push(task, task->workerIndex);
+    }
+}
+
+bool Scheduler::park(std::atomic<U32>& word, U32 expected) {
+    Task* task = gCurrentTask;
+    if (!task) {
+        return false;
+    }
+    task->parkWord = &word;
+    task->parkValue = expected;
+    task->state = TASK_PARKING;
+    core::Fiber::switchTo(*task->fiber, *task->worker->fiber);
+    return true;
+}
+
+void Scheduler::unpark(std::atomic<U32>& word) {
+    auto& bucket = getBucket(&word);
+    std::vector<Task*> woken;
+    {
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        auto it = std::partition(bucket.tasks.begin(), bucket.tasks.end(), [&](Task* task) {
+            return task->parkWord != &word;
+        });
+        woken.assign(it, bucket.tasks.end());
+        bucket.tasks.erase(it, bucket.tasks.end());
+    }
+    for (auto* task : woken) {
+        task->state = TASK_RUNNABLE;
+        task->scheduler->push(task, task->workerIndex);
+    }
+}
+
+void Scheduler::yield() {
+    Task* task = gCurrentTask;
+    if (!task || task->scheduler->statRunnable.load() <= 0) {
+        return;
+    }
+    task->scheduler->statYields += 1;
+    task->state = TASK_RUNNABLE;
+    core::Fiber::switchTo(*task->fiber, *task->worker->fiber);
+}
+
+SchedulerStatistics Scheduler::getStatistics() const {
+    SchedulerStatistics stats;
+    stats.contextSwitches = statContextSwitches;
+    stats.steals = statSteals;
+    stats.parks = statParks;
+    stats.yields = statYields;
+    stats.runnable = U32(std::max<S32>(statRunnable, 0));
+    stats.workers = U32(workers.size());
+    return stats;
+}
+
+}  // namespace cpu
@@ -0,0 +1,135 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/core/fiber.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cpu {
+
+// Forward declarations
+class Thread;
+
+struct SchedulerStatistics {
+    U64 contextSwitches = 0;  // Times a worker resumed a guest thread
+    U64 steals = 0;           // Guest threads taken from the queue of another worker
+    U64 parks = 0;            // Guest threads that blocked on a wait
+    U64 yields = 0;           // Guest threads that gave up their worker to other runnable ones
+    U32 runnable = 0;         // Guest threads waiting in the run queues
+    U32 workers = 0;          // Host threads in the pool
+};
+
+/**
+ * Scheduler
+ * =========
+ * Runs guest threads (SPU threads) as fibers on a bounded pool of host worker threads,
+ * so that the number of host threads does not grow with the number of guest threads.
+ *
+ * Scheduling:
+ * - Each worker owns a run queue. Workers run the queued thread with the highest priority
+ *   (lowest value, as in LV2), in FIFO order among equal priorities. Workers with an empty
+ *   queue take a thread from the queues of the other workers, choosing the same way.
+ * - Run queues are plain deques guarded by a mutex per worker, not lock-free work-stealing
+ *   deques: picking by priority needs to scan the whole queue, and queues stay short.
+ * - Scheduling is cooperative: guest threads give up their worker when they block on
+ *   a channel (see Scheduler::park), when they are paused, when they finish, and at the
+ *   yield points of SPU threads (see Scheduler::yield) if other threads are runnable.
+ * - Parked and yielding threads are queued again on the worker they last ran on.
+ */
+class Scheduler {
+public:
+    struct Task;
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<Task*> queue;
+        core::Fiber* fiber = nullptr;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopping;
+    std::atomic<U32> nextWorker;
+
+    // Advanced when tasks are queued, idle workers wait on it
+    std::atomic<U32> workEvent;
+    std::atomic<U32> idleWorkers;
+
+    // Statistics
+    std::atomic<U64> statContextSwitches;
+    std::atomic<U64> statSteals;
+    std::atomic<U64> statParks;
+    std::atomic<U64> statYields;
+    std::atomic<S32> statRunnable;
+
+    // Queue a task on the given worker and wake up an idle worker
+    void push(Task* task, U32 index);
+
+    // Take the task with the highest priority from the queue of a worker
+    Task* take(U32 index);
+
+    // Take a task from the queues of the other workers
+    Task* steal(U32 index);
+
+    void workerLoop(U32 index);
+    void resume(Worker& worker, Task* task);
+
+public:
+    /**
+     * Create the scheduler and start its workers
+     * @param[in]  workerCount  Number of host threads in the pool
+     */
+    Scheduler(Size workerCount);
+    ~Scheduler();
+
+    /**
+     * Run a guest thread on the pool, calling Thread::task on a new fiber
+     * @param[in]  thread    Guest thread to run
+     * @param[in]  priority  Scheduling priority, lower values are scheduled first
+     * @return               Handle to be passed to Scheduler::join
+     */
+    Task* spawn(Thread* thread, S32 priority);
+
+    /**
+     * Block the caller until the task finishes and release it
+     * @param[in]  task  Handle returned by Scheduler::spawn
+     */
+    void join(Task* task);
+
+    /**
+     * Park the calling guest thread while the word holds the expected value. The worker
+     * continues with other guest threads until Scheduler::unpark is called on the word.
+     * @param[in]  word      Atomic word to wait on
+     * @param[in]  expected  Value the word is expected to hold
+     * @return               False if the caller is not running on a scheduler fiber
+     */
+    static bool park(std::atomic<U32>& word, U32 expected);
+
+    /**
+     * Resume all guest threads parked on the word, must be called after modifying it
+     * @param[in]  word  Atomic word threads are parked on
+     */
+    static void unpark(std::atomic<U32>& word);
+
+    /**
+     * Give up the worker if other guest threads are waiting to run, queueing the calling
+     * guest thread behind them. Does nothing outside a scheduler fiber.
+     */
+    static void yield();
+
+    // Get a snapshot of the scheduling statistics
+    SchedulerStatistics getStatistics() const;
+};
+
+}  // namespace cpu
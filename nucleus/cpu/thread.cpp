@@ -4,14 +4,71 @@
  */
 
 #include "thread.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/scheduler.h"
 
 namespace cpu {
 
-Thread::Thread(CPU* parent) : parent(parent) {
+Thread::Thread(CPU* parent) : m_event(NUCLEUS_EVENT_NONE), m_status(NUCLEUS_STATUS_UNKNOWN), parent(parent) {
 }
 
 void Thread::join() {
     m_thread.join();
 }
 
+void Thread::postEvent(EmulatorEvent event) {
+    m_event.store(event);
+    if (m_interrupt) {
+        reinterpret_cast<std::atomic<U32>*>(m_interrupt)->store(1, std::memory_order_release);
+    }
+    core::futexWakeAll(m_event);
+    Scheduler::unpark(m_event);
+}
+
+bool Thread::handleEvents() {
+    if (m_interrupt) {
+        reinterpret_cast<std::atomic<U32>*>(m_interrupt)->store(0, std::memory_order_relaxed);
+    }
+    while (true) {
+        U32 event = m_event.load();
+        switch (event) {
+        case NUCLEUS_EVENT_PAUSE:
+            if (m_status != NUCLEUS_STATUS_PAUSED) {
+                m_status = NUCLEUS_STATUS_PAUSED;
+                if (parent) {
+                    parent->notifyPaused(1);
+                }
+            }
+            // Paused fibers yield their worker to other guest threads
+            if (!Scheduler::park(m_event, event)) {
+                core::futexWait(m_event, event);
+            }
+            continue;
+
+        case NUCLEUS_EVENT_STOP:
+            if (m_status == NUCLEUS_STATUS_PAUSED && parent) {
+                parent->notifyPaused(-1);
+            }
+            m_status = NUCLEUS_STATUS_STOPPED;
+
+            // Keep the flag raised, so that every caller leaves at its next poll
+            if (m_interrupt) {
+                reinterpret_cast<std::atomic<U32>*>(m_interrupt)->store(1, std::memory_order_relaxed);
+            }
+            return false;
+
+        case NUCLEUS_EVENT_RUN:
+            m_event.compare_exchange_strong(event, NUCLEUS_EVENT_NONE);
+            break;
+        }
+        break;
+    }
+    if (m_status == NUCLEUS_STATUS_PAUSED && parent) {
+        parent->notifyPaused(-1);
+    }
+    m_status = NUCLEUS_STATUS_RUNNING;
+    return true;
+}
+
 }  // namespace cpu
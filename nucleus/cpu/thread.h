@@ -7,8 +7,7 @@
 
 #include "nucleus/common.h"
 
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include <string>
 #include <thread>
 
@@ -23,16 +22,31 @@ enum ThreadType {
     THREAD_TYPE_RAWSPU,
 };
 
+/**
+ * Thread
+ * ======
+ * Guest thread executed by the CPU.
+ *
+ * Control events:
+ * - Run, pause and stop requests are posted to an atomic event word, without locks, and
+ *   raise the interrupt flag stored in the guest state (Thread::m_interrupt).
+ * - Translated code polls the interrupt flag at function entries and loop back-edges,
+ *   calling Thread::handleEvents when it is set. Paused threads are parked on a futex.
+ */
 class Thread {
 protected:
     // Thread status and management
-    std::mutex m_mutex;
-    std::condition_variable m_cv;
     std::string m_name;
     std::thread m_thread;
 
-    EmulatorEvent m_event = NUCLEUS_EVENT_NONE;
-    EmulatorStatus m_status = NUCLEUS_STATUS_UNKNOWN;
+    std::atomic<U32> m_event;   // Pending EmulatorEvent
+    std::atomic<U32> m_status;  // Current EmulatorStatus
+
+    // Interrupt flag in the guest state, to be set by frontends
+    U32* m_interrupt = nullptr;
+
+    // Post a control event and raise the interrupt flag
+    void postEvent(EmulatorEvent event);
 
 public:
     CPU* parent;
@@ -52,7 +66,32 @@ public:
     virtual void stop() = 0;
 
     // Block caller thread until this thread finishes
-    void join();
+    virtual void join();
+
+    /**
+     * Handle pending control events, must be called by the thread itself.
+     * Blocks while the thread is paused. Once stopped, the interrupt flag stays raised.
+     * @return  False if the thread has been requested to stop
+     */
+    bool handleEvents();
+
+    // Check whether a control event is waiting for Thread::handleEvents
+    bool hasPendingEvents() const {
+        return m_event.load() != NUCLEUS_EVENT_NONE;
+    }
+
+    // Get the current execution status
+    EmulatorStatus getStatus() const {
+        return static_cast<EmulatorStatus>(m_status.load());
+    }
+
+    // Name given by the guest, also used to name the host thread when it starts
+    const std::string& getName() const {
+        return m_name;
+    }
+    void setName(const std::string& name) {
+        m_name = name;
+    }
 };
 
 }  // namespace cpu
@@ -6,7 +6,9 @@
 #include "util.h"
 #include "nucleus/emulator.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/core/timebase.h"
 #include "nucleus/system/scei/cellos/lv2.h"
+#include "nucleus/system/scei/cellos/call_statistics.h"
 #include "nucleus/cpu/cpu.h"
 #include "nucleus/cpu/hir/function.h"
 #include "nucleus/cpu/frontend/ppu/ppu_decoder.h"
@@ -14,10 +16,6 @@
 #include "nucleus/cpu/frontend/ppu/ppu_tables.h"
 #include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 
-#ifdef NUCLEUS_TARGET_WINDOWS
-#include <Windows.h>
-#endif
-
 namespace cpu {
 
 void nucleusTranslate(void* guestFunc, U64 guestAddr) {
@@ -54,6 +52,18 @@ void nucleusHook(U32 fnid) {
 #endif
 }
 
+void nucleusHookDirect(U64 function, U32 fnid) {
+#if !defined(NUCLEUS_BUILD_TEST)
+    auto* state = static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread())->state.get();
+    sys::CallStatistics::Scope scope(sys::CALL_TYPE_FUNCTION, fnid);
+    reinterpret_cast<Syscall*>(function)->call(*state, nucleus.memory->getBaseAddr());
+#endif
+}
+
+U32 nucleusHandleEvents() {
+    return CPU::getCurrentThread()->handleEvents() ? 1 : 0;
+}
+
 void nucleusLog(U64 guestAddr) {
     auto* state = static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread())->state.get();
     frontend::ppu::Instruction instr { CPU::getCurrentThread()->parent->memory->read32(guestAddr) };
@@ -63,24 +73,7 @@ void nucleusLog(U64 guestAddr) {
 }
 
 U64 nucleusTime() {
-#ifdef NUCLEUS_TARGET_WINDOWS
-    static struct PerformanceFreqHolder {
-        U64 value;
-        PerformanceFreqHolder() {
-            LARGE_INTEGER freq;
-            QueryPerformanceFrequency(&freq);
-            value = freq.QuadPart;
-        }
-    } freq;
-
-    LARGE_INTEGER cycle;
-    QueryPerformanceCounter(&cycle);
-    const U64 sec = cycle.QuadPart / freq.value;
-    return sec * 79800000 + (cycle.QuadPart % freq.value) * 79800000 / freq.value;
-#else
-    logger.error(LOG_CPU, "Could not get the Timebase value");
-    return 0;
-#endif
+    return core::Timebase::get().getTicks();
 }
 
 }  // namespace cpu
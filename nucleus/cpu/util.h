@@ -40,6 +40,22 @@ void nucleusSysCall();
  */
 void nucleusHook(U32 fnid);
 
+/**
+ * HLE functions bound at link time are called through this function, avoiding the
+ * lookup of the FNID in the module manager.
+ * @param[in]  function  Host address of the HLE function object (Syscall*)
+ * @param[in]  fnid      FNID of the function, for call statistics
+ */
+void nucleusHookDirect(U64 function, U32 fnid);
+
+/**
+ * Translated code polls the interrupt flag of the thread state at function entries, loop
+ * back-edges and after calls, and calls this function when it is set to handle pause/stop
+ * requests. Paused threads block inside this function until they are resumed.
+ * @return  Zero if the thread was stopped, in which case translated code returns
+ */
+U32 nucleusHandleEvents();
+
 /**
  * This is just an utility function that can be placed between guest instructions to
  * obtain information in real-time about the thread state.
@@ -5,6 +5,7 @@
 
 #include "emulator.h"
 #include "nucleus/core/config.h"
+#include "nucleus/core/thread_policy.h"
 #include "nucleus/audio/backend/list.h"
 #include "nucleus/graphics/backend/list.h"
 #include "nucleus/filesystem/filesystem_host.h"
@@ -19,6 +20,9 @@
 #include "nucleus/system/scei/self.h"
 #include "nucleus/system/scei/orbisos/orbis_self.h"
 #include "nucleus/system/list.h"
+#include "nucleus/system/scei/cellos/call_statistics.h"
+#include "nucleus/system/scei/cellos/lv2/sys_process.h"
+#include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
 
 #if !defined(NUCLEUS_BUILD_TEST)
 
@@ -158,6 +162,20 @@ bool Emulator::initialize(const gfx::BackendParameters& params) {
 }
 
 bool Emulator::load(const std::string& filepath) {
+    // Host scheduling policy of the emulator threads
+    const std::pair<core::ThreadRole, const std::string*> plans[] = {
+        { core::THREAD_ROLE_PPU, &config.ppuAffinity },
+        { core::THREAD_ROLE_SPU, &config.spuAffinity },
+        { core::THREAD_ROLE_RSX, &config.rsxAffinity },
+        { core::THREAD_ROLE_COMPILER, &config.compilerAffinity },
+    };
+    for (const auto& plan : plans) {
+        if (!core::ThreadPolicy::setAffinity(plan.first, *plan.second)) {
+            logger.warning(LOG_COMMON, "Invalid list of host cores: %s", plan.second->c_str());
+        }
+    }
+    core::ThreadPolicy::setPriorityMode(config.hostPriority);
+
     switch (detectPlatform(filepath)) {
     case core::PLATFORM_PS3:
         return load_ps3(filepath);
@@ -174,13 +192,77 @@ void Emulator::run() {
 }
 
 void Emulator::pause() {
-    cpu->pause();
+    // Threads blocked in syscalls or channels only acknowledge the pause once they resume
+    if (!cpu->pause(100000)) {
+        logger.warning(LOG_CPU, "Some threads did not pause within 100 ms");
+        return;
+    }
+    logger.notice(LOG_CPU, "Paused all threads in %llu us", cpu->getPauseLatency());
 }
 
 void Emulator::stop() {
     cpu->stop();
 }
 
+void Emulator::saveReports() {
+    if (!cpu) {
+        return;
+    }
+    if (!config.passReport.empty()) {
+        cpu->compiler->passManager.saveReport(config.passReport);
+    }
+    if (!config.hleReport.empty()) {
+        sys::CallStatistics::saveReport(config.hleReport);
+    }
+
+    const auto arena = cpu->compiler->codeArena.getStatistics();
+    logger.notice(LOG_CPU, "Code arena: %llu/%llu bytes used (%.1f%% occupancy, %.1f%% fragmentation), "
+        "%llu allocations, %llu reused, %llu evictions, %llu failures",
+        U64(arena.used), U64(arena.capacity), 100.0 * arena.occupancy(), 100.0 * arena.fragmentation(),
+        arena.allocations, arena.reused, arena.evictions, arena.failures);
+
+    if (cpu->scheduler) {
+        const auto sched = cpu->scheduler->getStatistics();
+        logger.notice(LOG_CPU, "Scheduler: %u workers, %u runnable, %llu context switches, "
+            "%llu steals, %llu parks, %llu yields",
+            sched.workers, sched.runnable, sched.contextSwitches, sched.steals, sched.parks, sched.yields);
+    }
+
+    // Blocking LV2 synchronization objects, as counted by their wait queues
+    const std::pair<U32, const char*> waitObjects[] = {
+        { sys::SYS_MUTEX_OBJECT, "mutex" },
+        { sys::SYS_COND_OBJECT, "cond" },
+        { sys::SYS_LWMUTEX_OBJECT, "lwmutex" },
+        { sys::SYS_LWCOND_OBJECT, "lwcond" },
+        { sys::SYS_SEMAPHORE_OBJECT, "semaphore" },
+        { sys::SYS_EVENT_FLAG_OBJECT, "event flag" },
+    };
+    for (const auto& object : waitObjects) {
+        const auto wait = sys::WaitQueue::getStatistics(object.first);
+        if (!wait.waits) {
+            continue;
+        }
+        logger.notice(LOG_HLE, "Waits on %s: %llu waits, %llu timeouts, %.3f ms average (%.3f ms max), "
+            "%llu wakeups, %.3f us average wake latency (%.3f us max)",
+            object.second, wait.waits, wait.timeouts,
+            wait.waitTime / (1e6 * wait.waits), wait.waitTimeMax / 1e6, wait.wakeups,
+            wait.wakeups ? wait.wakeLatency / (1e3 * wait.wakeups) : 0.0, wait.wakeLatencyMax / 1e3);
+    }
+
+    const char* roleNames[core::THREAD_ROLE_COUNT] = { "PPU", "SPU", "RSX", "Compiler", "Timer" };
+    const auto policy = core::ThreadPolicy::getStatistics();
+    for (U32 role = 0; role < core::THREAD_ROLE_COUNT; role++) {
+        const auto& stats = policy.roles[role];
+        if (!stats.timeslices && !stats.runTime) {
+            continue;
+        }
+        logger.notice(LOG_COMMON, "%s threads: %u registered, %.3f s running, %.3f s waiting in runqueues, "
+            "%llu timeslices", roleNames[role], stats.threads, stats.runTime / 1e9, stats.waitTime / 1e9,
+            stats.timeslices);
+    }
+    logger.notice(LOG_COMMON, "Thread policy: %llu priority or affinity requests rejected", policy.rejected);
+}
+
 void Emulator::idle() {
     while (true) {
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -192,12 +274,14 @@ void Emulator::idle() {
             cpu->run();
             break;
         case NUCLEUS_EVENT_PAUSE:
-            cpu->pause();
+            pause();
             break;
         case NUCLEUS_EVENT_STOP:
             cpu->stop();
+            saveReports();
             return;
         case NUCLEUS_EVENT_CLOSE:
+            saveReports();
             return;
         default:
             logger.warning(LOG_COMMON, "Unknown event");
@@ -31,6 +31,9 @@ class Emulator {
     bool load_ps3(const std::string& path);
     bool load_ps4(const std::string& path);
 
+    // Save the statistics reports requested in the configuration
+    void saveReports();
+
 public:
     std::shared_ptr<audio::Backend> audio;
     std::shared_ptr<gfx::IBackend> graphics;
@@ -8,6 +8,7 @@
 #include "nucleus/logger/logger.h"
 #include "nucleus/memory/memory.h"
 #include "nucleus/core/config.h"
+#include "nucleus/core/thread_policy.h"
 #include "nucleus/system/scei/cellos/lv1/lv1_gpu.h"
 
 #include "nucleus/gpu/rsx/rsx_dma.h"
@@ -70,6 +71,7 @@ RSX::RSX(std::shared_ptr<mem::Memory> mem, std::shared_ptr<gfx::IBackend> graphi
     dma_control->put = 0;
 
     m_pfifo_thread = new std::thread([&](){
+        core::ThreadPolicy::registerThread(core::THREAD_ROLE_RSX, "RSX PFIFO");
         task();
     });
 }
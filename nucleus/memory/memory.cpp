@@ -6,6 +6,7 @@
 #include "memory.h"
 #include "nucleus/common.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/memory/shared_memory.h"
 
 #ifdef NUCLEUS_TARGET_WINDOWS
 #include <Windows.h>
@@ -20,12 +21,37 @@
 
 namespace mem {
 
-Memory::Memory() {
+constexpr U32 Memory::MAP_WINDOW_START;
+constexpr U32 Memory::MAP_WINDOW_SIZE;
+
+// Pages of the mapping window are reserved and mapped in units of this size
+#define MAP_GRANULARITY 0x10000
+
+Memory::Memory() : m_pages(new std::atomic<U08>[0x100000]()) {
     // Reserve 4 GB of memory for any 32-bit pointer in the PS3 memory
 #if defined(NUCLEUS_TARGET_UWP)
     m_base = nullptr;
 #elif defined(NUCLEUS_TARGET_WINDOWS)
-    m_base = VirtualAlloc(nullptr, 0x100000000ULL, MEM_RESERVE, PAGE_NOACCESS);
+    // Views of file mappings cannot be placed inside a reservation, so the mapping window
+    // is reserved separately. Retry if another thread grabs part of the range meanwhile.
+    const U64 windowEnd = U64(MAP_WINDOW_START) + MAP_WINDOW_SIZE;
+    m_base = nullptr;
+    for (U32 attempt = 0; attempt < 16 && !m_base; attempt++) {
+        U08* base = static_cast<U08*>(VirtualAlloc(nullptr, 0x100000000ULL, MEM_RESERVE, PAGE_NOACCESS));
+        if (!base) {
+            break;
+        }
+        VirtualFree(base, 0, MEM_RELEASE);
+        void* lower = VirtualAlloc(base, MAP_WINDOW_START, MEM_RESERVE, PAGE_NOACCESS);
+        void* upper = VirtualAlloc(base + windowEnd, 0x100000000ULL - windowEnd, MEM_RESERVE, PAGE_NOACCESS);
+        m_base = base;
+        if (lower == base && upper == base + windowEnd && reserveWindow(MAP_WINDOW_START, MAP_WINDOW_SIZE)) {
+            break;
+        }
+        if (lower) VirtualFree(lower, 0, MEM_RELEASE);
+        if (upper) VirtualFree(upper, 0, MEM_RELEASE);
+        m_base = nullptr;
+    }
 #elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
     m_base = ::mmap(nullptr, 0x100000000ULL, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
 #endif
@@ -53,15 +79,40 @@ Memory::~Memory() {
 #if defined(NUCLEUS_TARGET_UWP)
     success = false;
 #elif defined(NUCLEUS_TARGET_WINDOWS)
-    success = SUCCEEDED(VirtualFree(m_base, 0, MEM_RELEASE));
+    const U64 windowEnd = U64(MAP_WINDOW_START) + MAP_WINDOW_SIZE;
+    for (const auto& mapping : m_mappings) {
+        UnmapViewOfFile(ptr(mapping.first));
+        setPageFlags(mapping.first, mapping.second, 0);
+    }
+    for (U64 addr = MAP_WINDOW_START; addr < windowEnd; addr += MAP_GRANULARITY) {
+        VirtualFree(ptr(U32(addr)), 0, MEM_RELEASE);
+    }
+    success = VirtualFree(m_base, 0, MEM_RELEASE) &&
+        VirtualFree(ptr<U08>(0) + windowEnd, 0, MEM_RELEASE);
 #elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
-    success = munmap(m_base, 0x100000000ULL);
+    success = munmap(m_base, 0x100000000ULL) == 0;
 #endif
     if (!success) {
         logger.error(LOG_MEMORY, "Could not release memory");
     }
 }
 
+#if defined(NUCLEUS_TARGET_WINDOWS)
+bool Memory::reserveWindow(U32 addr, U32 size) {
+    for (U32 offset = 0; offset < size; offset += MAP_GRANULARITY) {
+        void* piece = ptr(addr + offset);
+        if (VirtualAlloc(piece, MAP_GRANULARITY, MEM_RESERVE, PAGE_NOACCESS) != piece) {
+            while (offset) {
+                offset -= MAP_GRANULARITY;
+                VirtualFree(ptr(addr + offset), 0, MEM_RELEASE);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
 U32 Memory::alloc(U32 size, U32 align) {
     return m_segments[SEG_USER_MEMORY].alloc(size, align);
 }
@@ -74,6 +125,76 @@ bool Memory::check(U32 addr) {
     return true;
 }
 
+bool Memory::map(U32 addr, SharedMemory& shm, U32 flags) {
+    const U32 size = shm.getSize();
+    const U64 end = U64(addr) + size;
+    if (!size || (addr % MAP_GRANULARITY) || (size % MAP_GRANULARITY) ||
+        addr < MAP_WINDOW_START || end > U64(MAP_WINDOW_START) + MAP_WINDOW_SIZE) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mapMutex);
+
+    // Check overlaps with the closest mappings on both sides
+    auto next = m_mappings.lower_bound(addr);
+    if (next != m_mappings.end() && next->first < end) {
+        return false;
+    }
+    if (next != m_mappings.begin()) {
+        auto prev = std::prev(next);
+        if (U64(prev->first) + prev->second > addr) {
+            return false;
+        }
+    }
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    for (U32 offset = 0; offset < size; offset += MAP_GRANULARITY) {
+        VirtualFree(ptr(addr + offset), 0, MEM_RELEASE);
+    }
+    if (!shm.mapAt(ptr(addr), (flags & PAGE_WRITABLE) != 0)) {
+        reserveWindow(addr, size);
+        return false;
+    }
+#else
+    if (!shm.mapAt(ptr(addr), (flags & PAGE_WRITABLE) != 0)) {
+        return false;
+    }
+#endif
+
+    m_mappings[addr] = size;
+    setPageFlags(addr, size, flags | PAGE_SHARED);
+    return true;
+}
+
+bool Memory::unmap(U32 addr) {
+    std::lock_guard<std::mutex> lock(m_mapMutex);
+
+    auto it = m_mappings.find(addr);
+    if (it == m_mappings.end()) {
+        return false;
+    }
+    const U32 size = it->second;
+
+    // Clear the flags first, so that no thread sees the pages as mapped once they are gone
+    setPageFlags(addr, size, 0);
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    UnmapViewOfFile(ptr(addr));
+    reserveWindow(addr, size);
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    // Replace the mapping with inaccessible anonymous memory, keeping the range reserved
+    ::mmap(ptr(addr), size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+#endif
+    m_mappings.erase(it);
+    return true;
+}
+
+void Memory::setPageFlags(U32 addr, U32 size, U32 flags) {
+    const U64 end = (U64(addr) + size + 4095) >> 12;
+    for (U64 page = addr >> 12; page < end; page++) {
+        m_pages[page].store(U08(flags), std::memory_order_release);
+    }
+}
+
 /**
  * Read memory reversing endianness if necessary
  */
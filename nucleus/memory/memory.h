@@ -8,8 +8,16 @@
 #include "nucleus/common.h"
 #include "nucleus/memory/segment.h"
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace mem {
 
+// Forward declarations
+class SharedMemory;
+
 enum {
     // Memory segments
     SEG_MAIN_MEMORY = 0,   // 0x00010000 to 0x2FFFFFFF
@@ -24,11 +32,36 @@ enum {
     _SEG_COUNT,
 };
 
+enum {
+    // Page flags
+    PAGE_READABLE  = (1 << 0),
+    PAGE_WRITABLE  = (1 << 1),
+    PAGE_SHARED    = (1 << 2),  // Mapped from a SharedMemory object
+    PAGE_SIZE_64K  = (1 << 3),  // Guest page size, 4 KB if none is set
+    PAGE_SIZE_1M   = (1 << 4),
+};
+
 class Memory {
     void* m_base;
     Segment m_segments[_SEG_COUNT];
 
+    // Flags of each 4 KB page, readable without locking from any thread
+    std::unique_ptr<std::atomic<U08>[]> m_pages;
+
+    // Shared memory mappings (guest address to size), protected by the mutex
+    std::mutex m_mapMutex;
+    std::map<U32, U32> m_mappings;
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    // Reserve the mmapper window in pieces of 64 KB that can be released to map views
+    bool reserveWindow(U32 addr, U32 size);
+#endif
+
 public:
+    // Guest address range where shared memory can be mapped
+    static constexpr U32 MAP_WINDOW_START = 0xB0000000;
+    static constexpr U32 MAP_WINDOW_SIZE = 0x10000000;
+
     Memory();
     ~Memory();
 
@@ -36,6 +69,36 @@ public:
     void free(U32 addr);
     bool check(U32 addr);
 
+    /**
+     * Map a shared memory object at a guest address, without copying its contents
+     * @param[in]  addr   Guest address inside the mapping window, aligned to 64 KB
+     * @param[in]  shm    Shared memory object
+     * @param[in]  flags  Page flags of the mapping, PAGE_SHARED is added. Host pages are
+     *                    mapped read-only unless PAGE_WRITABLE is set
+     * @return            False if the range is invalid, overlaps a mapping or the host failed
+     */
+    bool map(U32 addr, SharedMemory& shm, U32 flags);
+
+    /**
+     * Unmap a shared memory object, releasing the host pages of the range immediately
+     * @param[in]  addr  Guest address where the object was mapped
+     * @return           False if no object was mapped at that address
+     */
+    bool unmap(U32 addr);
+
+    /**
+     * Set the flags of the pages of a range
+     * @param[in]  addr   Guest address
+     * @param[in]  size   Size in bytes
+     * @param[in]  flags  Page flags, or 0 for unmapped pages
+     */
+    void setPageFlags(U32 addr, U32 size, U32 flags);
+
+    // Get the flags of the page containing a guest address
+    U32 getPageFlags(U32 addr) const {
+        return m_pages[addr >> 12].load(std::memory_order_acquire);
+    }
+
     U08 read8(U32 addr);
     U16 read16(U32 addr);
     U32 read32(U32 addr);
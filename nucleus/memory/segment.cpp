@@ -93,6 +93,7 @@ U32 Segment::alloc(U32 size, U32 align) {
         }
 
         m_allocated.emplace_back(m_parent->getBaseAddr(), addr, size);
+        m_parent->setPageFlags(addr, size, PAGE_READABLE | PAGE_WRITABLE);
         return addr;
     }
 
@@ -116,6 +117,7 @@ U32 Segment::allocFixed(U32 addr, U32 size) {
     }
 
     m_allocated.emplace_back(m_parent->getBaseAddr(), addr, size);
+    m_parent->setPageFlags(addr, size, PAGE_READABLE | PAGE_WRITABLE);
     return addr;
 }
 
@@ -0,0 +1,90 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "shared_memory.h"
+#include "nucleus/logger/logger.h"
+
+#ifdef NUCLEUS_TARGET_WINDOWS
+#include <Windows.h>
+#endif
+#if defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include <atomic>
+#include <cstdio>
+
+namespace mem {
+
+SharedMemory::SharedMemory(U32 size) : m_size(size) {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    m_handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, nullptr);
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+#if defined(NUCLEUS_TARGET_LINUX)
+    m_handle = memfd_create("nucleus-shm", MFD_CLOEXEC);
+#endif
+    if (m_handle < 0) {
+        // Anonymous POSIX shared memory object, unlinked right after creation
+        static std::atomic<U32> counter(0);
+        char name[64];
+        snprintf(name, sizeof(name), "/nucleus-shm-%d-%u", int(getpid()), counter++);
+        m_handle = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        shm_unlink(name);
+    }
+    if (m_handle >= 0 && ftruncate(m_handle, size) != 0) {
+        close(m_handle);
+        m_handle = -1;
+    }
+#endif
+    if (!isValid()) {
+        logger.error(LOG_MEMORY, "Could not create a shared memory object of %d bytes", size);
+    }
+}
+
+SharedMemory::~SharedMemory() {
+    if (!isValid()) {
+        return;
+    }
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    CloseHandle(m_handle);
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    close(m_handle);
+#endif
+}
+
+bool SharedMemory::isValid() const {
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    return m_handle != nullptr;
+#else
+    return m_handle >= 0;
+#endif
+}
+
+bool SharedMemory::mapAt(void* addr, bool writable) {
+    if (!isValid()) {
+        return false;
+    }
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    // The address range must be free: see Memory::map
+    const DWORD access = writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ;
+    void* view = MapViewOfFileEx(m_handle, access, 0, 0, m_size, addr);
+    if (view != addr) {
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        return false;
+    }
+    return true;
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    return ::mmap(addr, m_size, prot, MAP_SHARED | MAP_FIXED, m_handle, 0) == addr;
+#else
+    return false;
+#endif
+}
+
+}  // namespace mem
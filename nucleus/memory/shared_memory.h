@@ -0,0 +1,58 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+namespace mem {
+
+/**
+ * Shared memory
+ * =============
+ * Host memory object that can be mapped at several guest addresses at once (see Memory::map).
+ * All mappings alias the same host pages, so no data is copied between them.
+ *
+ * Notes:
+ * - Backed by a memfd on Linux, an unlinked POSIX shared memory object on OSX and a
+ *   pagefile-backed section on Windows. Pages are allocated on first access.
+ * - Host pages are released when the object is destroyed and no mapping of it remains.
+ */
+class SharedMemory {
+    U32 m_size = 0;
+
+    // Host handle of the shared memory object
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    void* m_handle = nullptr;
+#else
+    int m_handle = -1;
+#endif
+
+public:
+    /**
+     * Create a shared memory object
+     * @param[in]  size  Size in bytes, multiple of 64 KB
+     */
+    SharedMemory(U32 size);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Whether the host object could be created
+    bool isValid() const;
+
+    U32 getSize() const { return m_size; }
+
+    /**
+     * Map the object at a fixed host address, replacing whatever was mapped there
+     * @param[in]  addr      Host address, aligned to 64 KB
+     * @param[in]  writable  Whether the host pages of this mapping can be written
+     * @return               False on failure
+     */
+    bool mapAt(void* addr, bool writable = true);
+};
+
+}  // namespace mem
@@ -55,6 +55,23 @@ int nucleusInitialize(int argc, char **argv) {
             << "  --console      Avoids the Nucleus UI window, disabling GPU backends.\n"
             << "  --debugger     Create a Nerve backend debugging server.\n"
             << "                 More information at: http://alexaltea.github.io/nerve/ \n"
+            << "  --cpu-pipeline=<fast|balanced|max>\n"
+            << "                 Select the HIR optimization passes (default: balanced).\n"
+            << "  --ppu-fpscr=<exact|sticky|none>\n"
+            << "                 Select how precisely PPU floating-point instructions update FPSCR (default: none).\n"
+            << "  --pass-report=<path>\n"
+            << "                 Save a JSON report of the HIR pass costs at shutdown.\n"
+            << "  --hle-report=<path>\n"
+            << "                 Save call counts and latency histograms of LV2 syscalls and HLE functions\n"
+            << "                 at shutdown, as CSV if the path ends in .csv and as JSON otherwise.\n"
+            << "  --perf-map     Write /tmp/perf-<pid>.map so that Linux perf can symbolize generated code.\n"
+            << "  --jitdump      Write /tmp/jit-<pid>.dump for use with 'perf inject --jit'.\n"
+            << "  --spu-workers=<n>\n"
+            << "                 Run SPU threads on a pool of n host threads, 0 for one host thread each (default: 6).\n"
+            << "  --host-priority=<none|nice|realtime>\n"
+            << "                 Map guest thread priorities to host priorities (default: nice).\n"
+            << "  --ppu-affinity=<cpus>, --spu-affinity=<cpus>, --rsx-affinity=<cpus>, --compiler-affinity=<cpus>\n"
+            << "                 Restrict each kind of thread to a list of host cores, e.g. 0-3,8 (default: any core).\n"
             << std::endl;
     }
 
@@ -0,0 +1,285 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "object.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Maximum number of host threads simultaneously holding epoch records
+constexpr U32 EPOCH_RECORDS = 1024;
+
+struct EpochRecord {
+    // Epoch observed when entering the outermost guard, or 0 if not inside a guard
+    std::atomic<U64> epoch;
+    std::atomic<bool> used;
+};
+
+std::atomic<U64> g_epoch(1);
+std::atomic<U32> g_recordCount(0);
+EpochRecord g_records[EPOCH_RECORDS];
+
+struct ThreadEpoch {
+    EpochRecord* record = nullptr;
+    U32 depth = 0;
+
+    // Objects pinned by blocking scopes, released when leaving the outermost guard
+    std::vector<ObjectBase*> pinned;
+
+    ~ThreadEpoch() {
+        if (record) {
+            record->used.store(false, std::memory_order_release);
+        }
+    }
+
+    EpochRecord* acquire() {
+        while (!record) {
+            for (U32 i = 0; i < EPOCH_RECORDS; i++) {
+                bool expected = false;
+                if (!g_records[i].used.load(std::memory_order_relaxed) &&
+                    g_records[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    record = &g_records[i];
+                    U32 count = g_recordCount.load(std::memory_order_relaxed);
+                    while (count < i + 1 && !g_recordCount.compare_exchange_weak(count, i + 1)) {}
+                    break;
+                }
+            }
+            if (!record) {
+                std::this_thread::yield();
+            }
+        }
+        return record;
+    }
+};
+
+thread_local ThreadEpoch t_epoch;
+
+}  // namespace
+
+ObjectManager::Guard::Guard() {
+    if (t_epoch.depth++ == 0) {
+        EpochRecord* record = t_epoch.acquire();
+        record->epoch.store(g_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+ObjectManager::Guard::~Guard() {
+    if (--t_epoch.depth == 0) {
+        t_epoch.record->epoch.store(0, std::memory_order_release);
+        for (ObjectBase* object : t_epoch.pinned) {
+            object->pins.fetch_sub(1, std::memory_order_release);
+        }
+        t_epoch.pinned.clear();
+    }
+}
+
+ObjectManager::BlockingScope::BlockingScope(ObjectManager& manager, std::initializer_list<U32> ids) {
+    if (!t_epoch.depth) {
+        return;
+    }
+    for (U32 id : ids) {
+        ObjectBase* object = manager.lookup(id);
+        if (!object) {
+            return;
+        }
+        // Pins must be visible to reclaim before the epoch is cleared, see ObjectManager::reclaim
+        object->pins.fetch_add(1, std::memory_order_seq_cst);
+        t_epoch.pinned.push_back(object);
+    }
+
+    // Leave the guard, letting nested guards enter a new epoch without releasing the pins
+    m_depth = t_epoch.depth;
+    m_pinned.swap(t_epoch.pinned);
+    t_epoch.depth = 0;
+    t_epoch.record->epoch.store(0, std::memory_order_seq_cst);
+}
+
+ObjectManager::BlockingScope::~BlockingScope() {
+    if (!m_depth) {
+        return;
+    }
+    t_epoch.depth = m_depth;
+    t_epoch.pinned.insert(t_epoch.pinned.end(), m_pinned.begin(), m_pinned.end());
+    t_epoch.record->epoch.store(g_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+ObjectManager::Iterator::Iterator(const ObjectManager* manager, U32 index) : m_manager(manager), m_index(index) {
+    skipEmpty();
+}
+
+void ObjectManager::Iterator::skipEmpty() {
+    const U32 count = m_manager->m_slotCount.load(std::memory_order_acquire);
+    while (m_index < count) {
+        const Slot* slot = m_manager->getSlot(m_index);
+        if (slot && slot->object.load(std::memory_order_acquire)) {
+            break;
+        }
+        m_index++;
+    }
+}
+
+std::pair<U32, ObjectBase*> ObjectManager::Iterator::operator*() const {
+    ObjectBase* object = m_manager->getSlot(m_index)->object.load(std::memory_order_acquire);
+    return { object ? object->id : 0, object };
+}
+
+ObjectManager::Iterator& ObjectManager::Iterator::operator++() {
+    m_index++;
+    skipEmpty();
+    return *this;
+}
+
+ObjectManager::ObjectManager() : m_slotCount(0), m_freeHead(0) {
+    for (auto& chunk : m_chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ObjectManager::~ObjectManager() {
+    for (auto& chunk : m_chunks) {
+        Chunk* slots = chunk.load(std::memory_order_acquire);
+        if (!slots) {
+            continue;
+        }
+        for (auto& slot : slots->slots) {
+            delete slot.object.load(std::memory_order_relaxed);
+        }
+        delete slots;
+    }
+    for (const auto& retired : m_retired) {
+        delete retired.object;
+    }
+}
+
+ObjectManager::Slot* ObjectManager::getSlot(U32 index) const {
+    if (index >= CHUNK_SLOTS * CHUNK_COUNT) {
+        return nullptr;
+    }
+    Chunk* chunk = m_chunks[index / CHUNK_SLOTS].load(std::memory_order_acquire);
+    if (!chunk) {
+        return nullptr;
+    }
+    return &chunk->slots[index % CHUNK_SLOTS];
+}
+
+U32 ObjectManager::allocSlot() {
+    // Reuse a free slot
+    U64 head = m_freeHead.load(std::memory_order_acquire);
+    while (U32(head)) {
+        const U32 index = U32(head) - 1;
+        const U32 next = getSlot(index)->next.load(std::memory_order_relaxed);
+        const U64 newHead = (((head >> 32) + 1) << 32) | next;
+        if (m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return index;
+        }
+    }
+
+    // Otherwise take a fresh one, allocating its chunk if needed
+    const U32 index = m_slotCount.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= CHUNK_SLOTS * CHUNK_COUNT) {
+        m_slotCount.fetch_sub(1, std::memory_order_relaxed);
+        return ~0U;
+    }
+    auto& chunk = m_chunks[index / CHUNK_SLOTS];
+    if (!chunk.load(std::memory_order_acquire)) {
+        Chunk* expected = nullptr;
+        Chunk* newChunk = new Chunk();
+        if (!chunk.compare_exchange_strong(expected, newChunk, std::memory_order_acq_rel)) {
+            delete newChunk;
+        }
+    }
+    return index;
+}
+
+void ObjectManager::freeSlot(U32 index) {
+    Slot* slot = getSlot(index);
+    U64 head = m_freeHead.load(std::memory_order_relaxed);
+    do {
+        slot->next.store(U32(head), std::memory_order_relaxed);
+    } while (!m_freeHead.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | (index + 1),
+        std::memory_order_acq_rel, std::memory_order_relaxed));
+}
+
+U32 ObjectManager::insert(ObjectBase* object, U32 type) {
+    const U32 index = allocSlot();
+    if (index == ~0U) {
+        delete object;
+        return 0;
+    }
+
+    // Generation 0 is skipped, so that no valid handle is 0
+    Slot* slot = getSlot(index);
+    U32 generation = slot->generation.load(std::memory_order_relaxed);
+    if ((generation & 0xFF) == 0) {
+        generation += 1;
+        slot->generation.store(generation, std::memory_order_relaxed);
+    }
+
+    object->id = ((type & 0xFF) << 24) | ((generation & 0xFF) << 16) | index;
+    slot->object.store(object, std::memory_order_release);
+    return object->id;
+}
+
+ObjectBase* ObjectManager::lookup(U32 id) const {
+    const Slot* slot = getSlot(id & 0xFFFF);
+    if (!slot) {
+        return nullptr;
+    }
+    ObjectBase* object = slot->object.load(std::memory_order_acquire);
+    if (!object || object->id != id) {
+        return nullptr;
+    }
+    return object;
+}
+
+bool ObjectManager::remove(const U32 id) {
+    const U32 index = id & 0xFFFF;
+    Slot* slot = getSlot(index);
+    if (!slot) {
+        return false;
+    }
+
+    // Unpublish the object, only one of several concurrent removals succeeds
+    ObjectBase* object = slot->object.load(std::memory_order_acquire);
+    do {
+        if (!object || object->id != id) {
+            return false;
+        }
+    } while (!slot->object.compare_exchange_weak(object, nullptr, std::memory_order_seq_cst));
+
+    slot->generation.fetch_add(1, std::memory_order_relaxed);
+    freeSlot(index);
+
+    // Retire the object: it is deleted once every guard entered before now has been left
+    std::lock_guard<std::mutex> lock(m_retiredMutex);
+    m_retired.push_back({ object, g_epoch.fetch_add(1, std::memory_order_seq_cst) });
+    reclaim();
+    return true;
+}
+
+void ObjectManager::reclaim() {
+    // Epochs are read before pins: a thread entering a blocking scope pins its objects
+    // before clearing its epoch, so one of both keeps them alive
+    U64 minEpoch = ~0ULL;
+    const U32 count = g_recordCount.load(std::memory_order_acquire);
+    for (U32 i = 0; i < count; i++) {
+        const U64 epoch = g_records[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch) {
+            minEpoch = std::min(minEpoch, epoch);
+        }
+    }
+
+    auto it = std::partition(m_retired.begin(), m_retired.end(), [=](const Retired& retired) {
+        return retired.epoch >= minEpoch || retired.object->pins.load(std::memory_order_seq_cst);
+    });
+    for (auto retired = it; retired != m_retired.end(); retired++) {
+        delete retired->object;
+    }
+    m_retired.erase(it, m_retired.end());
+}
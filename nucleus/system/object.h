@@ -7,15 +7,26 @@
 
 #include "nucleus/common.h"
 
+#include <atomic>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class ObjectBase
 {
-    void* m_data;
-    U32 m_type;
-
 public:
+    // Handle of this object in its ObjectManager
+    U32 id = 0;
+
+    // Blocking scopes keeping this object alive outside of guards (see ObjectManager::BlockingScope)
+    std::atomic<U32> pins{0};
+
+    // Identifier of the data type of this object (see Object<T>::getTypeTag)
+    const void* typeTag = nullptr;
+
+    virtual ~ObjectBase() {}
     virtual void* getData()=0;
     virtual U32 getType()=0;
 };
@@ -31,6 +42,14 @@ public:
     {
         m_type = type;
         m_data = data;
+        typeTag = getTypeTag();
+    }
+
+    // Address unique to the data type T
+    static const void* getTypeTag()
+    {
+        static const char tag = 0;
+        return &tag;
     }
 
     ~Object()
@@ -49,65 +68,140 @@ public:
     }
 };
 
+/**
+ * Object Manager
+ * ==============
+ * Table of kernel objects indexed by handle. Handles encode the object type in bits 24-31,
+ * the generation of the slot in bits 16-23 and the slot index in bits 0-15, so stale
+ * handles to destroyed objects are rejected even after their slot has been reused.
+ *
+ * Notes:
+ * - Slots live in chunks that are never freed, so lookups are wait-free: a single atomic
+ *   load of the slot followed by a comparison of the handle stored in the object.
+ * - Removed objects are retired and deleted once no thread can still be using them,
+ *   using epoch-based reclamation. Pointers returned by `get` remain valid while the
+ *   calling thread is inside an `ObjectManager::Guard`; LV2 enters one for every syscall.
+ * - Syscalls that block leave their guard meanwhile through `ObjectManager::BlockingScope`,
+ *   so that a thread waiting for a long time does not delay the deletion of any object
+ *   other than the ones it waits on.
+ */
 class ObjectManager {
-    std::unordered_map<U32, ObjectBase*> m_objects;
-    std::mutex m_mutex;
-    U32 m_current_id = 1;
+    static constexpr U32 CHUNK_SLOTS = 256;
+    static constexpr U32 CHUNK_COUNT = 256;
+
+    struct Slot {
+        std::atomic<ObjectBase*> object;
+        std::atomic<U32> generation;
+        std::atomic<U32> next;
+    };
+    struct Chunk {
+        Slot slots[CHUNK_SLOTS];
+    };
+    struct Retired {
+        ObjectBase* object;
+        U64 epoch;
+    };
+
+    std::atomic<Chunk*> m_chunks[CHUNK_COUNT];
+    std::atomic<U32> m_slotCount;
+
+    // Free slots as a stack: index+1 in bits 0-31 (0 if empty), ABA tag in bits 32-63
+    std::atomic<U64> m_freeHead;
+
+    std::mutex m_retiredMutex;
+    std::vector<Retired> m_retired;
+
+    Slot* getSlot(U32 index) const;
+    U32 allocSlot();
+    void freeSlot(U32 index);
+
+    // Delete retired objects that no thread inside a guard can reference anymore
+    void reclaim();
+
+    U32 insert(ObjectBase* object, U32 type);
+    ObjectBase* lookup(U32 id) const;
 
 public:
-    ~ObjectManager()
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
+    /**
+     * Epoch guard: objects obtained through `get` are not deleted while it is alive.
+     * Guards can be nested.
+     */
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /**
+     * Scope in which the calling thread leaves its guard, e.g. to block. The objects of the
+     * given handles are pinned: they are not deleted until the outermost guard is left, even
+     * if they are removed meanwhile. Pointers to any other object obtained through `get` must
+     * not be used after the scope is entered. Must be created inside a guard, and not nested.
+     * If some handle is no longer valid, the guard is kept for the whole scope instead.
+     */
+    class BlockingScope {
+        U32 m_depth = 0;
+        std::vector<ObjectBase*> m_pinned;
+
+    public:
+        BlockingScope(ObjectManager& manager, std::initializer_list<U32> ids = {});
+        ~BlockingScope();
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+    };
+
+    class Iterator {
+        const ObjectManager* m_manager;
+        U32 m_index;
+
+        void skipEmpty();
+
+    public:
+        Iterator(const ObjectManager* manager, U32 index);
+
+        std::pair<U32, ObjectBase*> operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const {
+            return m_index != other.m_index;
+        }
+    };
 
-        m_objects.clear();
-    }
+    ObjectManager();
+    ~ObjectManager();
+
+    ObjectManager(const ObjectManager&) = delete;
+    ObjectManager& operator=(const ObjectManager&) = delete;
 
     // Iterator
-    std::unordered_map<U32, ObjectBase*>::const_iterator begin() { return m_objects.begin(); }
-    std::unordered_map<U32, ObjectBase*>::const_iterator end() { return m_objects.end(); }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, m_slotCount.load(std::memory_order_acquire)); }
 
-    // Add a new object to the set and return the generated ID
+    // Add a new object to the set and return the generated ID, or 0 if the table is full
     template <typename T>
     U32 add(T* data, const U32 type)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        m_objects[m_current_id] = new Object<T>(data, type);
-        return m_current_id++;
+        return insert(new Object<T>(data, type), type);
     }
 
-    // Get a pointer to the object data of a certain ID
+    // Get a pointer to the object data of a certain ID, or nullptr if its data is not a T
     template <typename T>
     T* get(const U32 id)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        if (m_objects.find(id) == m_objects.end()) {
+        ObjectBase* object = lookup(id);
+        if (!object || object->typeTag != Object<T>::getTypeTag()) {
             return nullptr;
         }
-
-        return (T*)m_objects[id]->getData();
+        return static_cast<T*>(object->getData());
     }
 
-    // Remove an object from the set given its ID (deleting the object data)
-    bool remove(const U32 id)
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        if (m_objects.find(id) == m_objects.end()) {
-            return false;
-        }
-
-        auto item = m_objects.find(id);
-        m_objects.erase(item);
-        return true;
-    }
+    // Remove an object from the set given its ID (deleting the object data once unused)
+    bool remove(const U32 id);
 
     // Test if a certain ID is present
     bool check(const U32 id)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        return m_objects.find(id) != m_objects.end();
+        return lookup(id) != nullptr;
     }
 };
@@ -0,0 +1,245 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "call_statistics.h"
+#include "nucleus/core/timebase.h"
+#include "nucleus/filesystem/filesystem_host.h"
+#include "nucleus/logger/logger.h"
+
+#include "externals/rapidjson/prettywriter.h"
+#include "externals/rapidjson/stringbuffer.h"
+
+#if defined(NUCLEUS_COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+namespace sys {
+
+namespace {
+
+struct LocalEntry {
+    U64 calls = 0;
+    U64 totalTime = 0;
+    U64 maxTime = 0;
+    U64 histogram[CallEntry::HISTOGRAM_BUCKETS] = {};
+};
+
+struct GlobalTable {
+    std::mutex mutex;
+    std::unordered_map<U64, CallEntry> entries;
+    std::unordered_map<U64, std::string> names;
+};
+
+GlobalTable& getGlobalTable() {
+    static GlobalTable table;
+    return table;
+}
+
+U64 makeKey(CallType type, U32 key) {
+    return (U64(type) << 32) | key;
+}
+
+U32 getBucket(U64 elapsed) {
+    if (elapsed == 0) {
+        return 0;
+    }
+#if defined(NUCLEUS_COMPILER_MSVC) && defined(NUCLEUS_ARCH_X86_64BITS)
+    unsigned long index;
+    _BitScanReverse64(&index, elapsed);
+    const U32 bucket = index;
+#elif defined(NUCLEUS_COMPILER_MSVC)
+    U32 bucket = 0;
+    while (elapsed >>= 1) {
+        bucket++;
+    }
+#else
+    const U32 bucket = 63 - __builtin_clzll(elapsed);
+#endif
+    return std::min(bucket, CallEntry::HISTOGRAM_BUCKETS - 1);
+}
+
+struct ThreadCounters {
+    std::unordered_map<U64, LocalEntry> entries;
+    U32 pending = 0;
+    U64 lastFlush = core::Timebase::readHostClock();
+
+    ~ThreadCounters() {
+        flush();
+    }
+
+    void flush() {
+        if (pending == 0) {
+            return;
+        }
+        auto& table = getGlobalTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        for (auto& item : entries) {
+            auto& local = item.second;
+            if (local.calls == 0) {
+                continue;
+            }
+            auto& entry = table.entries[item.first];
+            entry.type = CallType(item.first >> 32);
+            entry.key = U32(item.first);
+            entry.calls += local.calls;
+            entry.totalTime += local.totalTime;
+            entry.maxTime = std::max(entry.maxTime, local.maxTime);
+            for (U32 i = 0; i < CallEntry::HISTOGRAM_BUCKETS; i++) {
+                entry.histogram[i] += local.histogram[i];
+            }
+            local = LocalEntry();
+        }
+        pending = 0;
+    }
+};
+
+thread_local ThreadCounters t_counters;
+
+// Record a call that ended at the given host time, publishing the counters when due
+void recordCall(CallType type, U32 key, U64 elapsed, U64 now) {
+    auto& counters = t_counters;
+    auto& local = counters.entries[makeKey(type, key)];
+    local.calls += 1;
+    local.totalTime += elapsed;
+    local.maxTime = std::max(local.maxTime, elapsed);
+    local.histogram[getBucket(elapsed)] += 1;
+
+    // The end time may precede the creation of the counters of a new thread
+    counters.pending += 1;
+    if (counters.pending >= CallStatistics::FLUSH_CALLS ||
+        now >= counters.lastFlush + CallStatistics::FLUSH_INTERVAL) {
+        counters.flush();
+        counters.lastFlush = now;
+    }
+}
+
+}  // namespace
+
+CallStatistics::Scope::Scope(CallType type, U32 key) : type(type), key(key) {
+    start = core::Timebase::readHostClock();
+}
+
+CallStatistics::Scope::~Scope() {
+    // Reuse the end of the call as the current time
+    const U64 now = core::Timebase::readHostClock();
+    recordCall(type, key, now - start, now);
+}
+
+void CallStatistics::record(CallType type, U32 key, U64 elapsed) {
+    recordCall(type, key, elapsed, core::Timebase::readHostClock());
+}
+
+void CallStatistics::flush() {
+    t_counters.flush();
+    t_counters.lastFlush = core::Timebase::readHostClock();
+}
+
+void CallStatistics::setName(CallType type, U32 key, const char* name) {
+    auto& table = getGlobalTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.names[makeKey(type, key)] = name;
+}
+
+std::vector<CallEntry> CallStatistics::getStatistics() {
+    std::vector<CallEntry> result;
+    {
+        auto& table = getGlobalTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        for (const auto& item : table.entries) {
+            result.push_back(item.second);
+            const auto name = table.names.find(item.first);
+            if (name != table.names.end()) {
+                result.back().name = name->second;
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const CallEntry& a, const CallEntry& b) {
+        return a.totalTime > b.totalTime;
+    });
+    return result;
+}
+
+std::string CallStatistics::toJSON(const std::vector<CallEntry>& entries) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.String("calls");
+    writer.StartArray();
+    for (const auto& entry : entries) {
+        writer.StartObject();
+        writer.String("type");
+        writer.String(entry.type == CALL_TYPE_SYSCALL ? "syscall" : "function");
+        writer.String(entry.type == CALL_TYPE_SYSCALL ? "id" : "fnid");
+        writer.Uint(entry.key);
+        writer.String("name");
+        writer.String(entry.name.c_str());
+        writer.String("calls");
+        writer.Uint64(entry.calls);
+        writer.String("totalTimeNs");
+        writer.Uint64(entry.totalTime);
+        writer.String("maxTimeNs");
+        writer.Uint64(entry.maxTime);
+        writer.String("averageTimeNs");
+        writer.Uint64(entry.calls ? entry.totalTime / entry.calls : 0);
+        writer.String("histogram");
+        writer.StartArray();
+        for (U32 i = 0; i < CallEntry::HISTOGRAM_BUCKETS; i++) {
+            writer.Uint64(entry.histogram[i]);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+std::string CallStatistics::toCSV(const std::vector<CallEntry>& entries) {
+    std::string csv = "type,key,name,calls,total_ns,max_ns,average_ns";
+    for (U32 i = 0; i < CallEntry::HISTOGRAM_BUCKETS; i++) {
+        csv += ",bucket" + std::to_string(i);
+    }
+    csv += "\n";
+
+    char key[16];
+    for (const auto& entry : entries) {
+        snprintf(key, sizeof(key), "0x%X", entry.key);
+        csv += (entry.type == CALL_TYPE_SYSCALL) ? "syscall," : "function,";
+        csv += key;
+        csv += "," + entry.name;
+        csv += "," + std::to_string(entry.calls);
+        csv += "," + std::to_string(entry.totalTime);
+        csv += "," + std::to_string(entry.maxTime);
+        csv += "," + std::to_string(entry.calls ? entry.totalTime / entry.calls : 0);
+        for (U32 i = 0; i < CallEntry::HISTOGRAM_BUCKETS; i++) {
+            csv += "," + std::to_string(entry.histogram[i]);
+        }
+        csv += "\n";
+    }
+    return csv;
+}
+
+bool CallStatistics::saveReport(const std::string& path) {
+    flush();
+    const auto entries = getStatistics();
+    const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    const std::string report = csv ? toCSV(entries) : toJSON(entries);
+
+    auto file = fs::HostFileSystem::openFile(path, fs::Write);
+    const fs::Size size = report.size();
+    if (!file || file->write(report.data(), size) != size) {
+        logger.warning(LOG_HLE, "Could not save HLE call report to: %s", path.c_str());
+        return false;
+    }
+    logger.notice(LOG_HLE, "Saved HLE call report to: %s", path.c_str());
+    return true;
+}
+
+}  // namespace sys
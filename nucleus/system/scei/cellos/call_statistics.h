@@ -0,0 +1,97 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <string>
+#include <vector>
+
+namespace sys {
+
+enum CallType {
+    CALL_TYPE_SYSCALL,   // LV2 syscall, keyed by syscall number
+    CALL_TYPE_FUNCTION,  // HLE library function, keyed by FNID
+};
+
+// Cumulative statistics of a syscall or HLE function
+struct CallEntry {
+    // Latency histogram: bucket i counts calls taking [2^i, 2^(i+1)) nanoseconds
+    static constexpr U32 HISTOGRAM_BUCKETS = 40;
+
+    CallType type;
+    U32 key;
+    std::string name;
+    U64 calls = 0;
+    U64 totalTime = 0;  // Wall time in nanoseconds
+    U64 maxTime = 0;    // Wall time in nanoseconds
+    U64 histogram[HISTOGRAM_BUCKETS] = {};
+};
+
+/**
+ * Call statistics
+ * ===============
+ * Always-on counters of HLE calls: number of calls, wall time and a log-scale latency
+ * histogram for every LV2 syscall and HLE function, to find where HLE time is spent.
+ *
+ * Notes:
+ * - Calls are recorded into counters private to each host thread, without atomics nor
+ *   locks. Each thread publishes them into the global table every FLUSH_CALLS calls, at
+ *   the first call after FLUSH_INTERVAL nanoseconds, and when it exits.
+ * - Statistics of calls still running, or recorded by a thread that has not published
+ *   them yet, are not reported.
+ */
+class CallStatistics {
+public:
+    static constexpr U32 FLUSH_CALLS = 1024;
+    static constexpr U64 FLUSH_INTERVAL = 100000000;
+
+    // Measures the wall time of a call during its lifetime
+    class Scope {
+        CallType type;
+        U32 key;
+        U64 start;
+
+    public:
+        Scope(CallType type, U32 key);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * Record a call made by the current thread
+     * @param[in]  type     Type of call
+     * @param[in]  key      Syscall number or FNID
+     * @param[in]  elapsed  Wall time of the call in nanoseconds
+     */
+    static void record(CallType type, U32 key, U64 elapsed);
+
+    // Publish the counters of the current thread into the global table
+    static void flush();
+
+    // Set the name reported for a syscall or HLE function
+    static void setName(CallType type, U32 key, const char* name);
+
+    /**
+     * Get the statistics published so far
+     * @return  Entries ordered by descending total time
+     */
+    static std::vector<CallEntry> getStatistics();
+
+    /**
+     * Save the statistics published so far to a file
+     * @param[in]  path  File path, written as CSV if it ends in ".csv" and as JSON otherwise
+     * @return           True on success
+     */
+    static bool saveReport(const std::string& path);
+
+    // Convert the statistics to JSON or CSV
+    static std::string toJSON(const std::vector<CallEntry>& entries);
+    static std::string toCSV(const std::vector<CallEntry>& entries);
+};
+
+}  // namespace sys
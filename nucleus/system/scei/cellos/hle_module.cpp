@@ -5,6 +5,7 @@
 
 #include "module.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/system/scei/cellos/call_statistics.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 
 #include "modules/libsysutil.h"
@@ -22,20 +23,27 @@ ModuleManager::ModuleManager(LV2* parent) : parent(parent) {
     modules.emplace_back(Module("cellSysutilAvconfExt", {
         {0x655A0364, wrap(cellVideoOutGetGamma)},
     }));
+
+    for (const auto& module : modules) {
+        for (const auto& function : module.functions) {
+            if (!functionTable.emplace(function.first, function.second).second) {
+                logger.warning(LOG_HLE, "Duplicate Function ID: 0x%X in %s", function.first, module.name.c_str());
+            }
+        }
+    }
 }
 
-bool ModuleManager::find(const std::string& libraryName, U32 functionId) {
+Syscall* ModuleManager::find(const std::string& libraryName, U32 functionId) {
     for (const auto& module : modules) {
         if (module.name != libraryName) {
             continue;
         }
-        for (const auto& function : module.functions) {
-            if (function.first == functionId) {
-                return true;
-            }
+        const auto function = module.functions.find(functionId);
+        if (function != module.functions.end()) {
+            return function->second;
         }
     }
-    return false;
+    return nullptr;
 }
 
 void ModuleManager::call(cpu::frontend::ppu::PPUState& state) {
@@ -44,13 +52,11 @@ void ModuleManager::call(cpu::frontend::ppu::PPUState& state) {
 }
 
 void ModuleManager::call(cpu::frontend::ppu::PPUState& state, U32 fnid) {
-    for (const auto& module : modules) {
-        for (const auto& function : module.functions) {
-            if (function.first == fnid) {
-                function.second->call(state, parent->memory->getBaseAddr());
-                return;
-            }
-        }
+    const auto function = functionTable.find(fnid);
+    if (function != functionTable.end()) {
+        CallStatistics::Scope scope(CALL_TYPE_FUNCTION, fnid);
+        function->second->call(state, parent->memory->getBaseAddr());
+        return;
     }
     logger.warning(LOG_HLE, "Unknown Function ID: 0x%X", fnid);
 }
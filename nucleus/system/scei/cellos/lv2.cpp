@@ -5,8 +5,10 @@
 
 #include "lv2.h"
 #include "nucleus/emulator.h"
+#include "nucleus/cpu/cpu.h"
 #include "nucleus/filesystem/filesystem_app.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/system/scei/cellos/call_statistics.h"
 #include "nucleus/system/scei/cellos/callback.h"
 
 #include "lv2/sys_cond.h"
@@ -34,10 +36,18 @@
 
 #include <cstring>
 
-#define SYSCALL(name, flags) { wrap(name), #name, flags }
+#define SYSCALL(name, flags) { wrap(name), #name, flags, syscallThunk<decltype(&name), &name> }
 
 namespace sys {
 
+template <typename F, F func>
+static void syscallThunk(U32 id) {
+    auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+    ObjectManager::Guard guard;
+    CallStatistics::Scope scope(CALL_TYPE_SYSCALL, id);
+    SyscallThunk<F, func>::call(*thread->state, nucleus.memory->getBaseAddr());
+}
+
 LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(memory)), modules(this) {
     // Initialize syscall table
     memset(syscalls, 0, sizeof(syscalls));
@@ -51,10 +61,18 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         syscalls[0x01E] = SYSCALL(sys_process_get_paramsfo, LV2_NONE);
         syscalls[0x029] = SYSCALL(sys_ppu_thread_exit, LV2_NONE);
         syscalls[0x02C] = SYSCALL(sys_ppu_thread_join, LV2_NONE);
+        syscalls[0x02F] = SYSCALL(sys_ppu_thread_set_priority, LV2_NONE);
         syscalls[0x030] = SYSCALL(sys_ppu_thread_get_priority, LV2_NONE);
         syscalls[0x031] = SYSCALL(sys_ppu_thread_get_stack_information, LV2_NONE);
         syscalls[0x034] = SYSCALL(sys_ppu_thread_create, LV2_NONE);
         syscalls[0x035] = SYSCALL(sys_ppu_thread_start, LV2_NONE);
+        syscalls[0x046] = SYSCALL(sys_timer_create, LV2_NONE);
+        syscalls[0x047] = SYSCALL(sys_timer_destroy, LV2_NONE);
+        syscalls[0x048] = SYSCALL(sys_timer_get_information, LV2_NONE);
+        syscalls[0x049] = SYSCALL(sys_timer_start, LV2_NONE);
+        syscalls[0x04A] = SYSCALL(sys_timer_stop, LV2_NONE);
+        syscalls[0x04B] = SYSCALL(sys_timer_connect_event_queue, LV2_NONE);
+        syscalls[0x04C] = SYSCALL(sys_timer_disconnect_event_queue, LV2_NONE);
         syscalls[0x052] = SYSCALL(sys_event_flag_create, LV2_NONE);
         syscalls[0x053] = SYSCALL(sys_event_flag_destroy, LV2_NONE);
         syscalls[0x055] = SYSCALL(sys_event_flag_wait, LV2_NONE);
@@ -100,6 +118,7 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         syscalls[0x08E] = SYSCALL(sys_timer_sleep, LV2_NONE);
         syscalls[0x090] = SYSCALL(sys_time_get_timezone, LV2_NONE);
         syscalls[0x091] = SYSCALL(sys_time_get_current_time, LV2_NONE);
+        syscalls[0x092] = SYSCALL(sys_time_get_system_time, LV2_NONE);
         syscalls[0x093] = SYSCALL(sys_time_get_timebase_frequency, LV2_NONE);
         //syscalls[0x096] = SYSCALL(sys_raw_spu_create_interrupt_tag, LV2_NONE);
         //syscalls[0x097] = SYSCALL(sys_raw_spu_set_int_mask, LV2_NONE);
@@ -131,12 +150,12 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         //syscalls[0x0B4] = SYSCALL(sys_spu_thread_group_get_priority, LV2_NONE);
         //syscalls[0x0B5] = SYSCALL(sys_spu_thread_write_ls, LV2_NONE);
         syscalls[0x0B6] = SYSCALL(sys_spu_thread_read_ls, LV2_NONE);
-        //syscalls[0x0B8] = SYSCALL(sys_spu_thread_write_snr, LV2_NONE);
+        syscalls[0x0B8] = SYSCALL(sys_spu_thread_write_snr, LV2_NONE);
         syscalls[0x0B9] = SYSCALL(sys_spu_thread_group_connect_event, LV2_NONE);
         //syscalls[0x0BA] = SYSCALL(sys_spu_thread_group_disconnect_event, LV2_NONE);
-        //syscalls[0x0BB] = SYSCALL(sys_spu_thread_set_spu_cfg, LV2_NONE);
-        //syscalls[0x0BC] = SYSCALL(sys_spu_thread_get_spu_cfg, LV2_NONE);
-        //syscalls[0x0BE] = SYSCALL(sys_spu_thread_write_spu_mb, LV2_NONE);
+        syscalls[0x0BB] = SYSCALL(sys_spu_thread_set_spu_cfg, LV2_NONE);
+        syscalls[0x0BC] = SYSCALL(sys_spu_thread_get_spu_cfg, LV2_NONE);
+        syscalls[0x0BE] = SYSCALL(sys_spu_thread_write_spu_mb, LV2_NONE);
         //syscalls[0x0BF] = SYSCALL(sys_spu_thread_connect_event, LV2_NONE);
         //syscalls[0x0C0] = SYSCALL(sys_spu_thread_disconnect_event, LV2_NONE);
         //syscalls[0x0C1] = SYSCALL(sys_spu_thread_bind_queue, LV2_NONE);
@@ -148,7 +167,12 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         syscalls[0x0FB] = SYSCALL(sys_spu_thread_group_connect_event_all_threads, LV2_NONE);
         //syscalls[0x0FC] = SYSCALL(sys_spu_thread_group_disconnect_event_all_threads, LV2_NONE);
         syscalls[0x14A] = SYSCALL(sys_mmapper_allocate_address, LV2_NONE);
+        syscalls[0x14B] = SYSCALL(sys_mmapper_free_address, LV2_NONE);
         syscalls[0x14C] = SYSCALL(sys_mmapper_allocate_shared_memory, LV2_NONE);
+        syscalls[0x14E] = SYSCALL(sys_mmapper_map_shared_memory, LV2_NONE);
+        syscalls[0x14F] = SYSCALL(sys_mmapper_unmap_shared_memory, LV2_NONE);
+        syscalls[0x151] = SYSCALL(sys_mmapper_search_and_map, LV2_NONE);
+        syscalls[0x154] = SYSCALL(sys_mmapper_free_shared_memory, LV2_NONE);
         syscalls[0x15C] = SYSCALL(sys_memory_allocate, LV2_NONE);
         syscalls[0x15D] = SYSCALL(sys_memory_free, LV2_NONE);
         syscalls[0x155] = SYSCALL(sys_memory_container_create2, LV2_NONE);
@@ -195,6 +219,12 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         // TODO: No syscalls for now
     }
 
+    for (U32 id = 0; id < 1024; id++) {
+        if (syscalls[id].func) {
+            CallStatistics::setName(CALL_TYPE_SYSCALL, id, syscalls[id].name);
+        }
+    }
+
     // Initialize global filesystem devices
     const fs::Path& nucleusPath = fs::AppFileSystem::getPath(fs::APP_LOCATION_LOCAL);
     vfs.registerDevice(new fs::HostPathDevice("/dev_flash", nucleusPath + "platforms/ps3/dev_flash"));
@@ -231,6 +261,13 @@ bool LV2::init(U32 entry) {
     return true;
 }
 
+LV2SyscallThunk LV2::getThunk(U32 id) const {
+    if (id >= 1024) {
+        return nullptr;
+    }
+    return syscalls[id].thunk;
+}
+
 void LV2::call(cpu::frontend::ppu::PPUState& state) {
     const U32 id = static_cast<U32>(state.r[11]);
 
@@ -239,6 +276,8 @@ void LV2::call(cpu::frontend::ppu::PPUState& state) {
         return;
     }
     //logger.notice(LOG_HLE, "LV2 Syscall %d (0x%x: %s) called", id, id, syscalls[id].name);
+    ObjectManager::Guard guard;
+    CallStatistics::Scope scope(CALL_TYPE_SYSCALL, id);
     syscalls[id].func->call(state, memory->getBaseAddr());
 }
 
@@ -14,6 +14,7 @@
 #include "nucleus/system/object.h"
 #include "nucleus/system/system.h"
 
+#include "lv2/sys_mmapper.h"
 #include "lv2/sys_process.h"
 #include "lv2/sys_prx.h"
 #include "lv2/sys_rsx.h"
@@ -98,10 +99,14 @@ enum {
     LV2_DECR  = (1 << 2),
 };
 
+// Direct entry point of a syscall given its ID, fetching the state of the current PPU thread
+using LV2SyscallThunk = void(*)(U32 id);
+
 struct LV2Syscall {
     Syscall* func;
     const char* name;
     U32 flags;
+    LV2SyscallThunk thunk;
 };
 
 class LV2 : public System {
@@ -115,6 +120,7 @@ public:
 
     // Kernel information
     sys_process_t proc;
+    sys_mmapper_t mmapper;
     sys_rsx_device_t rsx_device[16];
     sys_rsx_context_t rsx_context[4];
 
@@ -125,6 +131,13 @@ public:
 
     // Get LV2 SysCall ID from the current thread and call it
     void call(cpu::frontend::ppu::PPUState& state);
+
+    /**
+     * Get the direct entry point of a syscall, for translated code with a known syscall ID
+     * @param[in]  id  Syscall ID
+     * @return         Entry point, or nullptr if the syscall is not implemented
+     */
+    LV2SyscallThunk getThunk(U32 id) const;
 };
 
 }  // namespace sys
@@ -7,6 +7,8 @@
 #include "sys_mutex.h"
 #include "nucleus/emulator.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 
 namespace sys {
@@ -32,10 +34,15 @@ S32 sys_cond_create(BE<U32>* cond_id, U32 mutex_id, sys_cond_attribute_t* attr)
         logger.warning(LOG_HLE, "Process-shareable semaphores are not supported");
     }
 
-    // Create condition variable
-    auto* cond = new sys_cond_t();
+    // Create condition variable, waiters are released following the mutex protocol
+    auto* cond = new sys_cond_t(mutex->attr.protocol);
     cond->mutex = mutex;
+    cond->mutex_id = mutex_id;
     cond->attr = *attr;
+    {
+        std::unique_lock<std::mutex> lock(mutex->queue.mutex());
+        mutex->cond_count++;
+    }
 
     *cond_id = lv2.objects.add(cond, SYS_COND_OBJECT);
     return CELL_OK;
@@ -44,9 +51,22 @@ S32 sys_cond_create(BE<U32>* cond_id, U32 mutex_id, sys_cond_attribute_t* attr)
 S32 sys_cond_destroy(U32 cond_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* cond = lv2.objects.get<sys_cond_t>(cond_id);
+
+    // Check requisites
+    if (!cond) {
+        return CELL_ESRCH;
+    }
+
+    std::unique_lock<std::mutex> lock(cond->queue.mutex());
+    if (!cond->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(cond_id)) {
         return CELL_ESRCH;
     }
+    std::unique_lock<std::mutex> mutexGuard(cond->mutex->queue.mutex());
+    cond->mutex->cond_count--;
     return CELL_OK;
 }
 
@@ -60,7 +80,8 @@ S32 sys_cond_signal(U32 cond_id) {
         return CELL_ESRCH;
     }
 
-    cond->cv.notify_one();
+    std::unique_lock<std::mutex> lock(cond->queue.mutex());
+    cond->queue.wakeOne();
     return CELL_OK;
 }
 
@@ -74,7 +95,8 @@ S32 sys_cond_signal_all(U32 cond_id) {
         return CELL_ESRCH;
     }
 
-    cond->cv.notify_all();
+    std::unique_lock<std::mutex> lock(cond->queue.mutex());
+    cond->queue.wakeAll();
     return CELL_OK;
 }
 
@@ -88,8 +110,12 @@ S32 sys_cond_signal_to(U32 cond_id, U32 thread_id) {
         return CELL_ESRCH;
     }
 
-    // TODO: This is wrong
-    cond->cv.notify_all();
+    std::unique_lock<std::mutex> lock(cond->queue.mutex());
+    auto* waiter = cond->queue.find(thread_id);
+    if (!waiter) {
+        return CELL_EPERM;
+    }
+    cond->queue.wake(waiter);
     return CELL_OK;
 }
 
@@ -108,15 +134,34 @@ S32 sys_cond_wait(U32 cond_id, U64 timeout) {
         timeout = 0xFFFFFFFFFFFFULL;
     }
 
-    std::unique_lock<std::mutex> lock((std::mutex&)cond->mutex->mutex);
-    if (timeout == 0) {
-        cond->cv.wait(lock);
-    } else {
-        auto rel_time = std::chrono::microseconds(timeout);
-        cond->cv.wait_for(lock, rel_time);
+    // Release the mutex completely while holding the condition variable, so that no signal
+    // issued after the release is missed
+    auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+    auto* mutex = cond->mutex;
+    ObjectManager::BlockingScope scope(lv2.objects, { cond_id, cond->mutex_id });
+    std::unique_lock<std::mutex> lock(cond->queue.mutex());
+    U32 recursiveCount;
+    {
+        std::unique_lock<std::mutex> mutexGuard(mutex->queue.mutex());
+        if (mutex->owner != thread->id) {
+            return CELL_EPERM;
+        }
+        recursiveCount = mutex->recursive_count;
+        mutex->recursive_count = 0;
+        mutexRelease(mutex);
     }
 
-    return CELL_OK;
+    WaitQueue::Waiter waiter(thread->id, thread->priority);
+    const bool signaled = cond->queue.wait(lock, waiter, timeout);
+    lock.unlock();
+
+    // Reacquire the mutex with its previous recursion depth
+    const S32 result = mutexLock(mutex, thread->id, thread->priority, 0);
+    if (result != CELL_OK) {
+        return result;
+    }
+    mutex->recursive_count = recursiveCount;
+    return signaled ? CELL_OK : CELL_ETIMEDOUT;
 }
 
 }  // namespace sys
@@ -8,8 +8,6 @@
 #include "nucleus/common.h"
 #include "sys_mutex.h"
 
-#include <condition_variable>
-
 namespace sys {
 
 // Classes
@@ -24,9 +22,13 @@ struct sys_cond_attribute_t
 // Auxiliary classes
 struct sys_cond_t
 {
-    std::condition_variable cv;
+    // Lock order: the queue mutex of the condition variable before the one of its mutex
+    WaitQueue queue;
     sys_mutex_t* mutex;
+    U32 mutex_id;
     sys_cond_attribute_t attr;
+
+    sys_cond_t(U32 protocol) : queue(protocol, SYS_COND_OBJECT) {}
 };
 
 // SysCalls
@@ -7,21 +7,35 @@
 #include "sys_mutex.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 #include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/emulator.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/core/timebase.h"
+#include "nucleus/core/timer_wheel.h"
 
-// Avoid <Windows.h> macro collisions with std::min and std::max
-#if defined(NUCLEUS_TARGET_UWP) || defined(NUCLEUS_TARGET_WINDOWS)
-#undef min
-#undef max
-#endif
-
-#include <algorithm>
 
 namespace sys {
 
 /**
  * LV2: Event flags
  */
+static bool eventFlagTest(U64 value, U64 bitptn, U32 mode) {
+    if (mode & SYS_EVENT_FLAG_WAIT_AND) {
+        return (value & bitptn) == bitptn;
+    } else {
+        return (value & bitptn) != 0;
+    }
+}
+
+static void eventFlagClear(U64& value, U64 bitptn, U32 mode) {
+    if (mode & SYS_EVENT_FLAG_WAIT_CLEAR) {
+        value &= ~bitptn;
+    }
+    if (mode & SYS_EVENT_FLAG_WAIT_CLEAR_ALL) {
+        value = 0;
+    }
+}
+
 S32 sys_event_flag_create(BE<U32>* eflag_id, sys_event_flag_attr_t* attr, U64 init) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -34,7 +48,7 @@ S32 sys_event_flag_create(BE<U32>* eflag_id, sys_event_flag_attr_t* attr, U64 in
     }
 
     // Create event flag
-    auto* eflag = new sys_event_flag_t();
+    auto* eflag = new sys_event_flag_t(attr->protocol);
     eflag->attr = *attr;
     eflag->value = init;
 
@@ -45,6 +59,17 @@ S32 sys_event_flag_create(BE<U32>* eflag_id, sys_event_flag_attr_t* attr, U64 in
 S32 sys_event_flag_destroy(U32 eflag_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* eflag = lv2.objects.get<sys_event_flag_t>(eflag_id);
+
+    // Check requisites
+    if (!eflag) {
+        return CELL_ESRCH;
+    }
+
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
+    if (!eflag->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(eflag_id)) {
         return CELL_ESRCH;
     }
@@ -64,47 +89,33 @@ S32 sys_event_flag_wait(U32 eflag_id, U64 bitptn, U32 mode, BE<U64>* result, U64
         return CELL_EINVAL;
     }
 
-    std::unique_lock<std::mutex> lock(eflag->mutex);
-    bool validCondition;
-
-    // Check if the condition is met, otherwise wait until condition or timeout happens
-    if (((mode & SYS_EVENT_FLAG_WAIT_AND) && ((eflag->value & bitptn) == bitptn)) ||
-        ((mode & SYS_EVENT_FLAG_WAIT_OR) && (eflag->value & bitptn))) {
-        validCondition = true;
-    }
-    else if (timeout == 0) {
-        validCondition = true;
-        if (mode & SYS_EVENT_FLAG_WAIT_AND) {
-            eflag->cv.wait(lock, [&]{ return (eflag->value & bitptn) == bitptn; });
+    ObjectManager::BlockingScope scope(lv2.objects, { eflag_id });
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
+
+    // Check if the condition is met, otherwise wait until sys_event_flag_set meets it
+    U64 value = eflag->value;
+    S32 error = CELL_OK;
+    if (eventFlagTest(eflag->value, bitptn, mode)) {
+        eventFlagClear(eflag->value, bitptn, mode);
+    } else {
+        auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+        WaitQueue::Waiter waiter(thread->id, thread->priority);
+        waiter.args[0] = bitptn;
+        waiter.args[1] = mode;
+        if (eflag->queue.wait(lock, waiter, timeout)) {
+            value = waiter.data;
+            error = waiter.result;
         } else {
-            eflag->cv.wait(lock, [&]{ return (eflag->value & bitptn); });
+            value = eflag->value;
+            error = CELL_ETIMEDOUT;
         }
     }
-    else {
-        auto rel_time = std::chrono::microseconds(timeout);
-        if (mode & SYS_EVENT_FLAG_WAIT_AND) {
-            validCondition = eflag->cv.wait_for(lock, rel_time, [&]{ return (eflag->value & bitptn) == bitptn; });
-        } else {
-            validCondition = eflag->cv.wait_for(lock, rel_time, [&]{ return (eflag->value & bitptn); });
-        }
-    }
-
-    // Save value if required and exit if timeout occurred
-    if (result !=  nucleus.memory->ptr(0)) {
-        *result = eflag->value;
-    }
-    if (!validCondition) {
-        return CELL_ETIMEDOUT;
-    }
 
-    // Clear the event flag if required
-    if (mode & SYS_EVENT_FLAG_WAIT_CLEAR) {
-        eflag->value &= ~bitptn;
-    }
-    if (mode & SYS_EVENT_FLAG_WAIT_CLEAR_ALL) {
-        eflag->value = 0;
+    // Save value if required
+    if (result != nucleus.memory->ptr(0)) {
+        *result = value;
     }
-    return CELL_OK;
+    return error;
 }
 
 S32 sys_event_flag_trywait(U32 eflag_id, U64 bitptn, U32 mode, BE<U64>* result) {
@@ -120,24 +131,16 @@ S32 sys_event_flag_trywait(U32 eflag_id, U64 bitptn, U32 mode, BE<U64>* result)
         return CELL_EINVAL;
     }
 
-    std::unique_lock<std::mutex> lock(eflag->mutex);
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
 
     // Save value if required
-    if (result ==  nucleus.memory->ptr(0)) {
+    if (result != nucleus.memory->ptr(0)) {
         *result = eflag->value;
     }
 
     // Check condition
-    if (((mode & SYS_EVENT_FLAG_WAIT_AND) && ((eflag->value & bitptn) == bitptn)) ||
-        ((mode & SYS_EVENT_FLAG_WAIT_OR) && (eflag->value & bitptn))) {
-
-        // Clear the event flag if required
-        if (mode & SYS_EVENT_FLAG_WAIT_CLEAR) {
-            eflag->value &= ~bitptn;
-        }
-        if (mode & SYS_EVENT_FLAG_WAIT_CLEAR_ALL) {
-            eflag->value = 0;
-        }
+    if (eventFlagTest(eflag->value, bitptn, mode)) {
+        eventFlagClear(eflag->value, bitptn, mode);
         return CELL_OK;
     }
     return CELL_EBUSY;
@@ -153,8 +156,21 @@ S32 sys_event_flag_set(U32 eflag_id, U64 bitptn) {
         return CELL_ESRCH;
     }
 
-    eflag->value = bitptn;
-    eflag->cv.notify_all();
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
+    eflag->value |= bitptn;
+
+    // Release only the waiters whose condition is met, clearing bits as each one requests
+    eflag->queue.wakeIf([&](WaitQueue::Waiter& waiter) {
+        const U64 pattern = waiter.args[0];
+        const U32 mode = U32(waiter.args[1]);
+        if (!eventFlagTest(eflag->value, pattern, mode)) {
+            return false;
+        }
+        waiter.data = eflag->value;
+        waiter.result = CELL_OK;
+        eventFlagClear(eflag->value, pattern, mode);
+        return true;
+    });
     return CELL_OK;
 }
 
@@ -168,7 +184,7 @@ S32 sys_event_flag_clear(U32 eflag_id, U64 bitptn) {
         return CELL_ESRCH;
     }
 
-    std::unique_lock<std::mutex> lock(eflag->mutex);
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
     eflag->value &= bitptn;
     return CELL_OK;
 }
@@ -180,12 +196,14 @@ S32 sys_event_flag_cancel(U32 eflag_id, BE<U32>* num) {
 
     // Check requisites
     if (!eflag) {
-        if (num == nucleus.memory->ptr(0)) {
-            num = 0;
-        }
         return CELL_ESRCH;
     }
 
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
+    const U32 count = eflag->queue.wakeAll(eflag->value, CELL_ECANCELED);
+    if (num != nucleus.memory->ptr(0)) {
+        *num = count;
+    }
     return CELL_OK;
 }
 
@@ -202,6 +220,7 @@ S32 sys_event_flag_get(U32 eflag_id, BE<U64>* flags) {
         return CELL_ESRCH;
     }
 
+    std::unique_lock<std::mutex> lock(eflag->queue.mutex());
     *flags = eflag->value;
     return CELL_OK;
 }
@@ -248,11 +267,14 @@ S32 sys_event_port_connect_local(U32 eport_id, U32 equeue_id) {
     if (eport->type != SYS_EVENT_PORT_LOCAL) {
         return CELL_EINVAL;
     }
-    if (eport->equeue) {
-        return CELL_EISCONN;
-    }
 
-    eport->equeue = equeue;
+    // Ports connected to a destroyed queue count as disconnected
+    U32 expected = eport->equeue_id.load();
+    do {
+        if (expected && lv2.objects.check(expected)) {
+            return CELL_EISCONN;
+        }
+    } while (!eport->equeue_id.compare_exchange_weak(expected, equeue_id));
     return CELL_OK;
 }
 
@@ -266,7 +288,10 @@ S32 sys_event_port_disconnect(U32 eport_id) {
         return CELL_ESRCH;
     }
 
-    eport->equeue = nullptr;
+    const U32 equeue_id = eport->equeue_id.exchange(0);
+    if (!equeue_id || !lv2.objects.check(equeue_id)) {
+        return CELL_ENOTCONN;
+    }
     return CELL_OK;
 }
 
@@ -279,21 +304,65 @@ S32 sys_event_port_send(U32 eport_id, U64 data1, U64 data2, U64 data3) {
     if (!eport) {
         return CELL_ESRCH;
     }
+    auto* equeue = lv2.objects.get<sys_event_queue_t>(eport->equeue_id.load());
+    if (!equeue) {
+        return CELL_ENOTCONN;
+    }
 
     sys_event_t evt;
     evt.source = eport->name_value;
     evt.data1 = data1;
     evt.data2 = data2;
     evt.data3 = data3;
-
-    eport->equeue->queue.push(evt);
-    eport->equeue->cv.notify_one();
-    return CELL_OK;
+    return eventQueueSend(equeue, evt);
 }
 
 /**
  * LV2: Event queues
  */
+S32 eventQueueSend(sys_event_queue_t* equeue, const sys_event_t& event) {
+    if (!equeue->events.push(event)) {
+        return CELL_EBUSY;
+    }
+
+    // Pairs with the fence in eventQueueReceive: either the receiver sees the event before
+    // parking, or the sender sees the receiver and wakes it up
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (equeue->receivers.load(std::memory_order_relaxed)) {
+        equeue->signal.fetch_add(1, std::memory_order_release);
+        core::futexWake(equeue->signal);
+    }
+    return CELL_OK;
+}
+
+S32 eventQueueReceive(sys_event_queue_t* equeue, sys_event_t* events, U32 count, U32& number, U64 timeout) {
+    const U64 deadline = core::Timebase::readHostClock() + timeout * 1000;
+    while (true) {
+        number = equeue->events.pop(events, count);
+        if (number) {
+            return CELL_OK;
+        }
+
+        // Announce the receiver before checking the queue for the last time
+        const U32 signal = equeue->signal.load(std::memory_order_acquire);
+        equeue->receivers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        number = equeue->events.pop(events, count);
+        if (number || equeue->closed.load(std::memory_order_acquire)) {
+            equeue->receivers.fetch_sub(1, std::memory_order_relaxed);
+            return number ? CELL_OK : CELL_ECANCELED;
+        }
+
+        if (!timeout) {
+            core::futexWait(equeue->signal, signal);
+        } else if (!core::TimerWheel::get().waitUntil(equeue->signal, signal, deadline)) {
+            equeue->receivers.fetch_sub(1, std::memory_order_relaxed);
+            return CELL_ETIMEDOUT;
+        }
+        equeue->receivers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
 S32 sys_event_queue_create(BE<U32>* equeue_id, sys_event_queue_attr_t* attr, U64 event_queue_key, S32 size) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -306,7 +375,7 @@ S32 sys_event_queue_create(BE<U32>* equeue_id, sys_event_queue_attr_t* attr, U64
     }
 
     // Create event queue
-    auto* equeue = new sys_event_queue_t();
+    auto* equeue = new sys_event_queue_t(size);
     equeue->attr = *attr;
 
     *equeue_id = lv2.objects.add(equeue, SYS_EVENT_QUEUE_OBJECT);
@@ -316,10 +385,23 @@ S32 sys_event_queue_create(BE<U32>* equeue_id, sys_event_queue_attr_t* attr, U64
 S32 sys_event_queue_destroy(U32 equeue_id, S32 mode) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
-    // TODO: What's up with mode?
+    auto* equeue = lv2.objects.get<sys_event_queue_t>(equeue_id);
+
+    // Check requisites
+    if (!equeue) {
+        return CELL_ESRCH;
+    }
+
+    // Receivers are only woken up with an error when forcing destruction
+    if (equeue->receivers.load() && !(mode & SYS_EVENT_QUEUE_DESTROY_FORCE)) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(equeue_id)) {
         return CELL_ESRCH;
     }
+    equeue->closed.store(true, std::memory_order_release);
+    equeue->signal.fetch_add(1, std::memory_order_release);
+    core::futexWakeAll(equeue->signal);
     return CELL_OK;
 }
 
@@ -333,30 +415,21 @@ S32 sys_event_queue_receive(U32 equeue_id, sys_event_t* evt, U64 timeout) {
         return CELL_ESRCH;
     }
 
-    std::unique_lock<std::mutex> lock(equeue->mutex);
-
-    if (equeue->queue.empty()) {
-        // Wait until condition or timeout is met
-        if (timeout == 0) {
-            equeue->cv.wait(lock, [&]{ return equeue->queue.size(); });
-        } else {
-            auto rel_time = std::chrono::microseconds(timeout);
-            if (!equeue->cv.wait_for(lock, rel_time, [&]{ return equeue->queue.size(); })) {
-                return CELL_ETIMEDOUT;
-            }
-        }
+    sys_event_t event;
+    U32 number;
+    ObjectManager::BlockingScope scope(lv2.objects, { equeue_id });
+    const S32 result = eventQueueReceive(equeue, &event, 1, number, timeout);
+    if (result != CELL_OK) {
+        return result;
     }
-
-    // Get the last event
-    *evt = equeue->queue.front();
-    equeue->queue.pop();
+    *evt = event;
 
     // Event data is returned using registers
-    auto thread = (cpu::frontend::ppu::PPUThread*)nucleus.cpu->getCurrentThread();
-    thread->state->r[4] = evt->source;
-    thread->state->r[5] = evt->data1;
-    thread->state->r[6] = evt->data2;
-    thread->state->r[7] = evt->data3;
+    auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+    thread->state->r[4] = event.source;
+    thread->state->r[5] = event.data1;
+    thread->state->r[6] = event.data2;
+    thread->state->r[7] = event.data3;
     return CELL_OK;
 }
 
@@ -369,16 +442,12 @@ S32 sys_event_queue_tryreceive(U32 equeue_id, sys_event_t* event_array, S32 size
     if (!equeue) {
         return CELL_ESRCH;
     }
-
-    std::unique_lock<std::mutex> lock(equeue->mutex);
-
-    S32 eventsReceived = std::max((S32)equeue->queue.size(), size);
-    *number = eventsReceived;
-
-    for (U32 i = 0; i < eventsReceived; i++) {
-        event_array[i] = equeue->queue.front();
-        equeue->queue.pop();
+    if (size < 0) {
+        return CELL_EINVAL;
     }
+
+    // Claim all available events at once, up to the size of the array
+    *number = equeue->events.pop(event_array, size);
     return CELL_OK;
 }
 
@@ -392,6 +461,8 @@ S32 sys_event_queue_drain(U32 equeue_id) {
         return CELL_ESRCH;
     }
 
+    sys_event_t events[16];
+    while (equeue->events.pop(events, 16)) {}
     return CELL_OK;
 }
 
@@ -6,11 +6,11 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/core/bounded_queue.h"
+#include "nucleus/system/scei/cellos/lv2/sys_process.h"
 #include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
 
-#include <condition_variable>
-#include <mutex>
-#include <queue>
+#include <atomic>
 
 namespace sys {
 
@@ -25,6 +25,8 @@ enum {
 
     SYS_PPU_QUEUE                 = 0x01,
     SYS_SPU_QUEUE                 = 0x02,
+
+    SYS_EVENT_QUEUE_DESTROY_FORCE = 0x01,
 };
 
 // Classes
@@ -56,23 +58,34 @@ struct sys_event_queue_attr_t
 // Auxiliary classes
 struct sys_event_flag_t
 {
-    std::mutex mutex;
-    std::condition_variable cv;
+    // Waiters store the bit pattern in args[0] and the mode in args[1]
+    WaitQueue queue;
     sys_event_flag_attr_t attr;
     U64 value;
+
+    sys_event_flag_t(U32 protocol) : queue(protocol, SYS_EVENT_FLAG_OBJECT) {}
 };
 
 struct sys_event_queue_t
 {
-    std::mutex mutex;
-    std::condition_variable cv;
-    std::queue<sys_event_t> queue;
+    // Senders never lock: events are appended to a lock-free ring holding up to `size` events
+    core::BoundedQueue<sys_event_t> events;
     sys_event_queue_attr_t attr;
+
+    // Futex word incremented by senders, only when receivers are parked
+    std::atomic<U32> signal;
+    std::atomic<U32> receivers;
+
+    // Set when the queue is destroyed while receivers are waiting
+    std::atomic<bool> closed;
+
+    sys_event_queue_t(U32 size) : events(size), signal(0), receivers(0), closed(false) {}
 };
 
 struct sys_event_port_t
 {
-    sys_event_queue_t* equeue = nullptr;
+    // Connected queue, looked up on every send since the queue might be destroyed at any time
+    std::atomic<U32> equeue_id{0};
     U32 type;
     union {
         S08 name[8];
@@ -80,6 +93,25 @@ struct sys_event_port_t
     };
 };
 
+/**
+ * Send an event to the queue, waking up a parked receiver if there is any
+ * @param[in]  equeue  Event queue
+ * @param[in]  event   Event to send
+ * @return             CELL_OK on success, or CELL_EBUSY if the queue is full
+ */
+S32 eventQueueSend(sys_event_queue_t* equeue, const sys_event_t& event);
+
+/**
+ * Receive events from the queue, waiting for the first one if it is empty
+ * @param[in]   equeue   Event queue
+ * @param[out]  events   Array receiving the events
+ * @param[in]   count    Maximum number of events to receive
+ * @param[out]  number   Number of events received
+ * @param[in]   timeout  Maximum time to wait in microseconds, or 0 to wait indefinitely
+ * @return               CELL_OK on success, or the error to return to the guest
+ */
+S32 eventQueueReceive(sys_event_queue_t* equeue, sys_event_t* events, U32 count, U32& number, U64 timeout);
+
 // SysCalls
 S32 sys_event_flag_create(BE<U32>* eflag_id, sys_event_flag_attr_t* attr, U64 init);
 S32 sys_event_flag_destroy(U32 eflag_id);
@@ -6,12 +6,84 @@
 #include "sys_lwcond.h"
 #include "nucleus/emulator.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/system/scei/cellos/lv2.h"
-#include "nucleus/system/scei/cellos/lv2/sys_lwmutex.h"
+
+#include <atomic>
 
 namespace sys {
 
-S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_attribute_t* attr) {
+// Host view of a big-endian word in guest memory, accessed with byte-swapped values
+static std::atomic<U32>& atomicWord(BE<U32>& word) {
+    return reinterpret_cast<std::atomic<U32>&>(word);
+}
+
+static void atomicAdd(BE<U32>& word, S32 value) {
+    auto& atomic = atomicWord(word);
+    U32 current = atomic.load();
+    while (!atomic.compare_exchange_weak(current, SE32(SE32(current) + value))) {}
+}
+
+/**
+ * Reacquire the lightweight mutex after a wait. This ABI of _sys_lwcond_queue_wait returns
+ * with the mutex held, so the kernel locks it as userland would: count itself as a waiter,
+ * so that unlocking threads enter the kernel, and either claim a free owner word or sleep
+ * until the mutex is handed over through SYS_LWMUTEX_RESERVED.
+ */
+static S32 reacquire(sys_lwmutex_t* lwmutex, U32 tid, S32 priority) {
+    auto& owner = atomicWord(lwmutex->control->owner);
+    atomicAdd(lwmutex->control->waiter, 1);
+    U32 current = SE32(SYS_LWMUTEX_FREE);
+    S32 result = CELL_OK;
+    if (!owner.compare_exchange_strong(current, SE32(tid))) {
+        result = lwmutexLock(lwmutex, tid, priority, 0);
+        if (result == CELL_OK) {
+            owner.store(SE32(tid));
+        }
+    }
+    atomicAdd(lwmutex->control->waiter, -1);
+    return result;
+}
+
+S32 lwcondWait(sys_lwcond_t* lwcond, sys_lwmutex_t* lwmutex, U32 tid, S32 priority, U64 timeout) {
+    auto* control = lwmutex->control;
+    if (SE32(atomicWord(control->owner).load()) != tid) {
+        return CELL_EPERM;
+    }
+
+    // Release the mutex completely while holding the queue lock, so no signal is missed
+    std::unique_lock<std::mutex> lock(lwcond->queue.mutex());
+    const U32 recursiveCount = control->recursive_count;
+    control->recursive_count = 0;
+    lwmutexUnlock(lwmutex);
+
+    WaitQueue::Waiter waiter(tid, priority);
+    const S32 result = lwcond->queue.wait(lock, waiter, timeout) ? CELL_OK : CELL_ETIMEDOUT;
+    lock.unlock();
+
+    // Reacquire the mutex with its previous recursion depth
+    const S32 lockResult = reacquire(lwmutex, tid, priority);
+    if (lockResult != CELL_OK) {
+        return lockResult;
+    }
+    control->recursive_count = recursiveCount;
+    return result;
+}
+
+S32 lwcondSignal(sys_lwcond_t* lwcond) {
+    std::unique_lock<std::mutex> lock(lwcond->queue.mutex());
+    lwcond->queue.wakeOne();
+    return CELL_OK;
+}
+
+S32 lwcondSignalAll(sys_lwcond_t* lwcond) {
+    std::unique_lock<std::mutex> lock(lwcond->queue.mutex());
+    lwcond->queue.wakeAll();
+    return CELL_OK;
+}
+
+S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_control_t* control, U64 name) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
     auto* lwmutex = lv2.objects.get<sys_lwmutex_t>(lwmutex_id);
@@ -21,14 +93,15 @@ S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_attribute_t
         return CELL_ESRCH;
     }
     if ((lwcond_id == nucleus.memory->ptr(0)) ||
-        (attr == nucleus.memory->ptr(0))) {
+        (control == nucleus.memory->ptr(0))) {
         return CELL_EFAULT;
     }
 
     // Create condition variable
-    auto* lwcond = new sys_lwcond_t();
-    lwcond->lwmutex = lwmutex;
-    lwcond->attr = *attr;
+    auto* lwcond = new sys_lwcond_t(lwmutex->protocol);
+    lwcond->lwmutex_id = lwmutex_id;
+    lwcond->control = control;
+    lwcond->name = name;
 
     *lwcond_id = lv2.objects.add(lwcond, SYS_LWCOND_OBJECT);
     return CELL_OK;
@@ -37,6 +110,17 @@ S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_attribute_t
 S32 sys_lwcond_destroy(U32 lwcond_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* lwcond = lv2.objects.get<sys_lwcond_t>(lwcond_id);
+
+    // Check requisites
+    if (!lwcond) {
+        return CELL_ESRCH;
+    }
+
+    std::unique_lock<std::mutex> lock(lwcond->queue.mutex());
+    if (!lwcond->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(lwcond_id)) {
         return CELL_ESRCH;
     }
@@ -53,8 +137,7 @@ S32 sys_lwcond_signal(U32 lwcond_id) {
         return CELL_ESRCH;
     }
 
-    lwcond->cv.notify_one();
-    return CELL_OK;
+    return lwcondSignal(lwcond);
 }
 
 S32 sys_lwcond_signal_all(U32 lwcond_id) {
@@ -67,8 +150,7 @@ S32 sys_lwcond_signal_all(U32 lwcond_id) {
         return CELL_ESRCH;
     }
 
-    lwcond->cv.notify_all();
-    return CELL_OK;
+    return lwcondSignalAll(lwcond);
 }
 
 S32 sys_lwcond_queue_wait(U32 lwcond_id, U64 timeout) {
@@ -80,21 +162,19 @@ S32 sys_lwcond_queue_wait(U32 lwcond_id, U64 timeout) {
     if (!lwcond) {
         return CELL_ESRCH;
     }
+    auto* lwmutex = lv2.objects.get<sys_lwmutex_t>(lwcond->lwmutex_id);
+    if (!lwmutex) {
+        return CELL_ESRCH;
+    }
 
     // Maximum value is: 2^48-1
     if (timeout > 0xFFFFFFFFFFFFULL) {
         timeout = 0xFFFFFFFFFFFFULL;
     }
 
-    std::unique_lock<std::mutex> lock((std::mutex&)lwcond->lwmutex->lwmutex);
-    if (timeout == 0) {
-        lwcond->cv.wait(lock);
-    } else {
-        auto rel_time = std::chrono::microseconds(timeout);
-        lwcond->cv.wait_for(lock, rel_time);
-    }
-
-    return CELL_OK;
+    auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+    ObjectManager::BlockingScope scope(lv2.objects, { lwcond_id, lwcond->lwmutex_id });
+    return lwcondWait(lwcond, lwmutex, thread->id, thread->priority, timeout);
 }
 
 }  // namespace sys
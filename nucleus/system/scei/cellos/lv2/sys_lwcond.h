@@ -6,28 +6,52 @@
 #pragma once
 
 #include "nucleus/common.h"
-
-#include <condition_variable>
+#include "nucleus/system/scei/cellos/lv2/sys_lwmutex.h"
 
 namespace sys {
 
-// Forward declarations
-struct sys_lwmutex_t;
-
 // Classes
 struct sys_lwcond_attribute_t {
     S08 name[8];
 };
 
+// Lightweight condition variable as laid out in guest memory
+struct sys_lwcond_control_t {
+    BE<U32> lwmutex;
+    BE<U32> lwcond_queue;
+};
+
 // Auxiliary classes
 struct sys_lwcond_t {
-    std::condition_variable cv;
-    sys_lwmutex_t* lwmutex;
-    sys_lwcond_attribute_t attr;
+    // Lock order: the queue mutex of the condition variable before the one of its mutex
+    WaitQueue queue;
+    U32 lwmutex_id;
+    sys_lwcond_control_t* control;
+    U64 name;
+
+    sys_lwcond_t(U32 protocol) : queue(protocol, SYS_LWCOND_OBJECT) {}
 };
 
+/**
+ * Release the lightweight mutex held by a thread, wait for a signal and reacquire the
+ * mutex with its previous recursion depth.
+ * @param[in]  lwcond    Lightweight condition variable to wait on
+ * @param[in]  lwmutex   Lightweight mutex bound to the condition variable
+ * @param[in]  tid       ID of the calling thread
+ * @param[in]  priority  Priority of the calling thread
+ * @param[in]  timeout   Maximum time to wait in microseconds, or 0 to wait indefinitely
+ * @return               CELL_OK on success, or the error to return to the guest
+ */
+S32 lwcondWait(sys_lwcond_t* lwcond, sys_lwmutex_t* lwmutex, U32 tid, S32 priority, U64 timeout);
+
+// Wake up the next waiter by protocol
+S32 lwcondSignal(sys_lwcond_t* lwcond);
+
+// Wake up all waiters
+S32 lwcondSignalAll(sys_lwcond_t* lwcond);
+
 // SysCalls
-S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_attribute_t* attr);
+S32 sys_lwcond_create(BE<U32>* lwcond_id, U32 lwmutex_id, sys_lwcond_control_t* control, U64 name);
 S32 sys_lwcond_destroy(U32 lwcond_id);
 S32 sys_lwcond_queue_wait(U32 lwcond_id, U64 timeout);
 S32 sys_lwcond_signal(U32 lwcond_id);
@@ -6,20 +6,59 @@
 #include "sys_lwmutex.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 #include "nucleus/emulator.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
+
+#include <atomic>
 
 namespace sys {
 
-S32 sys_lwmutex_create(BE<U32>* lwmutex_id, sys_lwmutex_attribute_t* attr) {
+static cpu::frontend::ppu::PPUThread* getCurrentThread() {
+    return static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+}
+
+S32 lwmutexLock(sys_lwmutex_t* lwmutex, U32 tid, S32 priority, U64 timeout, bool wait) {
+    std::unique_lock<std::mutex> lock(lwmutex->queue.mutex());
+    if (lwmutex->signaled) {
+        lwmutex->signaled = false;
+        return CELL_OK;
+    }
+    if (!wait) {
+        return CELL_EBUSY;
+    }
+
+    // The unlocking thread sets the owner word to RESERVED before waking this one up
+    WaitQueue::Waiter waiter(tid, priority);
+    if (!lwmutex->queue.wait(lock, waiter, timeout)) {
+        return CELL_ETIMEDOUT;
+    }
+    return waiter.result;
+}
+
+S32 lwmutexUnlock(sys_lwmutex_t* lwmutex) {
+    std::unique_lock<std::mutex> lock(lwmutex->queue.mutex());
+    reinterpret_cast<std::atomic<U32>&>(lwmutex->control->owner).store(SE32(SYS_LWMUTEX_RESERVED));
+    if (!lwmutex->queue.wakeOne()) {
+        lwmutex->signaled = true;
+    }
+    return CELL_OK;
+}
+
+S32 sys_lwmutex_create(BE<U32>* lwmutex_id, U32 protocol, sys_lwmutex_control_t* control, U32 arg4, U64 name) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
     // Check requisites
-    if (lwmutex_id == nucleus.memory->ptr(0) || attr == nucleus.memory->ptr(0)) {
+    if (lwmutex_id == nucleus.memory->ptr(0) || control == nucleus.memory->ptr(0)) {
         return CELL_EFAULT;
     }
+    if (protocol != SYS_SYNC_FIFO && protocol != SYS_SYNC_PRIORITY && protocol != SYS_SYNC_RETRY) {
+        return CELL_EINVAL;
+    }
 
-    // Create lightweight mutex
-    auto* lwmutex = new sys_lwmutex_t();
-    //lwmutex->attr = *attr; It causes a segfault upon startup
+    // Create lightweight mutex, its state lives in the guest control block
+    auto* lwmutex = new sys_lwmutex_t(protocol);
+    lwmutex->control = control;
+    lwmutex->name = name;
 
     *lwmutex_id = lv2.objects.add(lwmutex, SYS_LWMUTEX_OBJECT);
     return CELL_OK;
@@ -28,6 +67,18 @@ S32 sys_lwmutex_create(BE<U32>* lwmutex_id, sys_lwmutex_attribute_t* attr) {
 S32 sys_lwmutex_destroy(U32 lwmutex_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* lwmutex = lv2.objects.get<sys_lwmutex_t>(lwmutex_id);
+
+    // Check requisites
+    if (!lwmutex) {
+        return CELL_ESRCH;
+    }
+
+    // Userland marks the owner word as dead once the kernel object is gone
+    std::unique_lock<std::mutex> lock(lwmutex->queue.mutex());
+    if (!lwmutex->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(lwmutex_id)) {
         return CELL_ESRCH;
     }
@@ -49,19 +100,9 @@ S32 sys_lwmutex_lock(U32 lwmutex_id, U64 timeout) {
         timeout = 0xFFFFFFFFFFFFULL;
     }
 
-    // Lock lightweight mutex
-    if (timeout == 0) {
-        lwmutex->lwmutex.lock();
-    } else {
-        auto rel_time = std::chrono::microseconds(timeout);
-#if defined(NUCLEUS_TARGET_ANDROID) && defined(NUCLEUS_COMPILER_GCC)
-        // TODO: Reimplement try_lock_for
-        lwmutex->lwmutex.try_lock();
-#else
-        lwmutex->lwmutex.try_lock_for(rel_time);
-#endif
-    }
-    return CELL_OK;
+    auto* thread = getCurrentThread();
+    ObjectManager::BlockingScope scope(lv2.objects, { lwmutex_id });
+    return lwmutexLock(lwmutex, thread->id, thread->priority, timeout);
 }
 
 S32 sys_lwmutex_trylock(U32 lwmutex_id) {
@@ -74,8 +115,8 @@ S32 sys_lwmutex_trylock(U32 lwmutex_id) {
         return CELL_ESRCH;
     }
 
-    lwmutex->lwmutex.try_lock();
-    return CELL_OK;
+    auto* thread = getCurrentThread();
+    return lwmutexLock(lwmutex, thread->id, thread->priority, 0, false);
 }
 
 S32 sys_lwmutex_unlock(U32 lwmutex_id) {
@@ -88,8 +129,7 @@ S32 sys_lwmutex_unlock(U32 lwmutex_id) {
         return CELL_ESRCH;
     }
 
-    lwmutex->lwmutex.unlock();
-    return CELL_OK;
+    return lwmutexUnlock(lwmutex);
 }
 
 }  // namespace sys
@@ -6,11 +6,18 @@
 #pragma once
 
 #include "nucleus/common.h"
-
-#include <mutex>
+#include "nucleus/system/scei/cellos/lv2/sys_process.h"
+#include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
 
 namespace sys {
 
+// Values of the owner word other than a thread ID
+enum : U32 {
+    SYS_LWMUTEX_FREE      = 0xFFFFFFFF,
+    SYS_LWMUTEX_DEAD      = 0xFFFFFFFE,
+    SYS_LWMUTEX_RESERVED  = 0xFFFFFFFD,
+};
+
 struct sys_lwmutex_attribute_t
 {
     BE<U32> protocol;
@@ -18,19 +25,59 @@ struct sys_lwmutex_attribute_t
     S08 name[8];
 };
 
+// Lightweight mutex as laid out in guest memory. Userland locks and unlocks it with
+// atomic operations on the owner and waiter words, and only enters the kernel under
+// contention: a contended unlock stores SYS_LWMUTEX_RESERVED in the owner word before
+// calling _sys_lwmutex_unlock, and the thread handed the mutex replaces it with its ID.
+struct sys_lwmutex_control_t
+{
+    BE<U32> owner;
+    BE<U32> waiter;
+    BE<U32> attribute;
+    BE<U32> recursive_count;
+    BE<U32> sleep_queue;
+    BE<U32> pad;
+};
+
 // Auxiliary classes
 struct sys_lwmutex_t
 {
-#if defined(NUCLEUS_TARGET_ANDROID) && defined(NUCLEUS_COMPILER_GCC)
-    std::mutex lwmutex;
-#else
-    std::timed_mutex lwmutex;
-#endif
-    sys_lwmutex_attribute_t attr;
+    // Sleep queue of the threads that found the mutex contended in userland
+    WaitQueue queue;
+    sys_lwmutex_control_t* control;
+    U32 protocol;
+    U64 name;
+
+    // Whether an unlock found no sleeping thread, so the next lock returns without sleeping.
+    // Protected by the queue mutex.
+    bool signaled = false;
+
+    sys_lwmutex_t(U32 protocol) : queue(protocol, SYS_LWMUTEX_OBJECT), protocol(protocol) {}
 };
 
+/**
+ * Kernel side of a contended lock: sleep until an unlock hands the mutex over. On success
+ * the owner word is SYS_LWMUTEX_RESERVED, and the caller claims it with its thread ID.
+ * @param[in]  lwmutex   Lightweight mutex to lock
+ * @param[in]  tid       ID of the calling thread
+ * @param[in]  priority  Priority of the calling thread
+ * @param[in]  timeout   Maximum time to wait in microseconds, or 0 to wait indefinitely
+ * @param[in]  wait      Whether to sleep at all if the mutex has not been handed over
+ * @return               CELL_OK on success, or the error to return to the guest
+ */
+S32 lwmutexLock(sys_lwmutex_t* lwmutex, U32 tid, S32 priority, U64 timeout, bool wait = true);
+
+/**
+ * Kernel side of a contended unlock: set the owner word to SYS_LWMUTEX_RESERVED and hand
+ * the mutex over to the next sleeping thread by protocol, or to the next locking thread
+ * if none is sleeping.
+ * @param[in]  lwmutex  Lightweight mutex to unlock
+ * @return              CELL_OK
+ */
+S32 lwmutexUnlock(sys_lwmutex_t* lwmutex);
+
 // SysCalls
-S32 sys_lwmutex_create(BE<U32>* lwmutex_id, sys_lwmutex_attribute_t* attr);
+S32 sys_lwmutex_create(BE<U32>* lwmutex_id, U32 protocol, sys_lwmutex_control_t* control, U32 arg4, U64 name);
 S32 sys_lwmutex_destroy(U32 lwmutex_id);
 S32 sys_lwmutex_lock(U32 lwmutex_id, U64 timeout);
 S32 sys_lwmutex_trylock(U32 lwmutex_id);
@@ -41,6 +41,8 @@ S32 sys_memory_allocate(U32 size, U64 flags, BE<U32>* alloc_addr) {
     if (!addr) {
         return CELL_ENOMEM;
     }
+    nucleus.memory->setPageFlags(addr, size, mem::PAGE_READABLE | mem::PAGE_WRITABLE |
+        ((flags == SYS_MEMORY_PAGE_SIZE_1M) ? mem::PAGE_SIZE_1M : mem::PAGE_SIZE_64K));
     *alloc_addr = addr;
     return CELL_OK;
 }
@@ -66,6 +68,19 @@ S32 sys_memory_free(U32 start_addr) {
 S32 sys_memory_get_page_attribute(U32 addr, sys_page_attr_t* attr) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    // Check requisites
+    if (attr == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+    const U32 flags = nucleus.memory->getPageFlags(addr);
+    if (!(flags & mem::PAGE_READABLE)) {
+        return CELL_EINVAL;
+    }
+
+    attr->attribute = (flags & mem::PAGE_WRITABLE) ? SYS_MEMORY_PROT_READ_WRITE : SYS_MEMORY_PROT_READ_ONLY;
+    attr->access_right = 0xF;
+    attr->page_size = (flags & mem::PAGE_SIZE_1M) ? 0x100000 : (flags & mem::PAGE_SIZE_64K) ? 0x10000 : 0x1000;
+    attr->pad = 0;
     return CELL_OK;
 }
 
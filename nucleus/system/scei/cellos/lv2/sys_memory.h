@@ -12,6 +12,11 @@ namespace sys {
 enum {
     SYS_MEMORY_PAGE_SIZE_1M  = 0x400,
     SYS_MEMORY_PAGE_SIZE_64K = 0x200,
+
+    // Access rights of mappings
+    SYS_MEMORY_PROT_READ_WRITE  = 0x40000,
+    SYS_MEMORY_PROT_READ_ONLY   = 0x80000,
+    SYS_MEMORY_PROT_MASK        = 0xF0000,
 };
 
 struct sys_memory_info_t
@@ -10,31 +10,260 @@
 
 namespace sys {
 
-S32 sys_mmapper_allocate_address(U32 size, U64 flags, U32 alignment, U32* alloc_addr) {
-    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+// Areas are allocated in multiples of 256 MB. The mapping window is the 256 MB mmapper
+// segment of the guest memory layout (see mem::Memory::MAP_WINDOW_START), so it holds one area.
+#define MMAPPER_AREA_SIZE 0x10000000
 
+// Get the guest page size selected by the page size flags, or 0 if they are invalid
+static U32 getPageSize(U64 flags) {
     switch (flags & (SYS_MEMORY_PAGE_SIZE_1M | SYS_MEMORY_PAGE_SIZE_64K)) {
-    /*case SYS_MEMORY_PAGE_SIZE_1M:
-        *alloc_addr = memory->alloc(size, 0x100000);
-        break;
-
+    case SYS_MEMORY_PAGE_SIZE_1M:
+        return 0x100000;
     case SYS_MEMORY_PAGE_SIZE_64K:
-        *alloc_addr = memory->alloc(size, 0x10000);
-        break;*/
+        return 0x10000;
+    default:
+        return 0;
+    }
+}
 
+// Find the area containing a guest range, must be called with the mmapper mutex held
+static sys_mmapper_area_t* findArea(sys_mmapper_t& mmapper, U32 addr, U32 size) {
+    for (auto& area : mmapper.areas) {
+        if (addr >= area.addr && U64(addr) + size <= U64(area.addr) + area.size) {
+            return &area;
+        }
+    }
+    return nullptr;
+}
+
+// Check whether a guest range is free of mappings, must be called with the mmapper mutex held
+static bool isRangeFree(sys_mmapper_t& mmapper, U32 addr, U32 size) {
+    auto next = mmapper.mappings.lower_bound(addr);
+    if (next != mmapper.mappings.end() && next->first < U64(addr) + size) {
+        return false;
+    }
+    if (next != mmapper.mappings.begin()) {
+        auto prev = std::prev(next);
+        if (U64(prev->first) + prev->second.size > addr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Get the page flags granting the access rights of a mapping, or 0 if they are invalid
+static U32 getAccessFlags(U64 flags) {
+    switch (flags & SYS_MEMORY_PROT_MASK) {
+    case 0:
+    case SYS_MEMORY_PROT_READ_WRITE:
+        return mem::PAGE_READABLE | mem::PAGE_WRITABLE;
+    case SYS_MEMORY_PROT_READ_ONLY:
+        return mem::PAGE_READABLE;
     default:
-        //logger.error(LOG_HLE, "sys_mmapper_allocate_address: Invalid flags");
+        return 0;
+    }
+}
+
+// Map the memory, must be called with the mmapper mutex held
+static S32 mapMemory(sys_mmapper_t& mmapper, U32 addr, U32 mem_id, sys_mmapper_memory_t* memory, U32 access) {
+    const U32 flags = access |
+        ((memory->flags & SYS_MEMORY_PAGE_SIZE_1M) ? mem::PAGE_SIZE_1M : mem::PAGE_SIZE_64K);
+    if (!nucleus.memory->map(addr, memory->shm, flags)) {
+        return CELL_ENOMEM;
+    }
+    mmapper.mappings[addr] = { memory->shm.getSize(), mem_id, memory };
+    memory->mappings += 1;
+    return CELL_OK;
+}
+
+S32 sys_mmapper_allocate_address(U32 size, U64 flags, U32 alignment, BE<U32>* alloc_addr) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // Check requisites
+    if (alloc_addr == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+    if (!getPageSize(flags)) {
+        return CELL_EINVAL;
+    }
+    if (!size || (size % MMAPPER_AREA_SIZE) || (alignment & (alignment - 1))) {
+        return CELL_EALIGN;
+    }
+    if (alignment < MMAPPER_AREA_SIZE) {
+        alignment = MMAPPER_AREA_SIZE;
+    }
+
+    // Find a free range inside the mapping window
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    const U64 windowEnd = U64(mem::Memory::MAP_WINDOW_START) + mem::Memory::MAP_WINDOW_SIZE;
+    for (U64 addr = mem::Memory::MAP_WINDOW_START; addr + size <= windowEnd; addr += alignment) {
+        bool overlaps = false;
+        for (const auto& area : lv2.mmapper.areas) {
+            if (addr < U64(area.addr) + area.size && area.addr < addr + size) {
+                overlaps = true;
+                break;
+            }
+        }
+        if (!overlaps) {
+            lv2.mmapper.areas.push_back({ U32(addr), size, flags });
+            *alloc_addr = U32(addr);
+            return CELL_OK;
+        }
+    }
+    return CELL_ENOMEM;
+}
+
+S32 sys_mmapper_free_address(U32 addr) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    for (auto it = lv2.mmapper.areas.begin(); it != lv2.mmapper.areas.end(); it++) {
+        if (it->addr != addr) {
+            continue;
+        }
+        if (!isRangeFree(lv2.mmapper, it->addr, it->size)) {
+            return CELL_EBUSY;
+        }
+        lv2.mmapper.areas.erase(it);
+        return CELL_OK;
+    }
+    return CELL_EINVAL;
+}
+
+S32 sys_mmapper_allocate_shared_memory(U64 ipc_key, U32 size, U64 flags, BE<U32>* mem_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // Check requisites
+    if (mem_id == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+    const U32 pageSize = getPageSize(flags);
+    if (!pageSize) {
         return CELL_EINVAL;
     }
+    if (!size || (size % pageSize)) {
+        return CELL_EALIGN;
+    }
+
+    // Create shared memory
+    auto* memory = new sys_mmapper_memory_t(size);
+    if (!memory->shm.isValid()) {
+        delete memory;
+        return CELL_ENOMEM;
+    }
+    memory->flags = flags;
+    memory->ipc_key = ipc_key;
 
+    *mem_id = lv2.objects.add(memory, SYS_MEM_OBJECT);
     return CELL_OK;
 }
 
-S32 sys_mmapper_allocate_shared_memory(U32 size, U64 flags, U32 alignment, U32* alloc_addr) {
+S32 sys_mmapper_free_shared_memory(U32 mem_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
-    *alloc_addr = nucleus.memory->alloc(size, alignment);
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    auto* memory = lv2.objects.get<sys_mmapper_memory_t>(mem_id);
+
+    // Check requisites
+    if (!memory) {
+        return CELL_ESRCH;
+    }
+    if (memory->mappings) {
+        return CELL_EBUSY;
+    }
+
+    if (!lv2.objects.remove(mem_id)) {
+        return CELL_ESRCH;
+    }
     return CELL_OK;
 }
 
+S32 sys_mmapper_map_shared_memory(U32 addr, U32 mem_id, U64 flags) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    auto* memory = lv2.objects.get<sys_mmapper_memory_t>(mem_id);
+
+    // Check requisites
+    if (!memory) {
+        return CELL_ESRCH;
+    }
+    const U32 access = getAccessFlags(flags);
+    if (!access) {
+        return CELL_EINVAL;
+    }
+    const U32 size = memory->shm.getSize();
+    if (!findArea(lv2.mmapper, addr, size)) {
+        return CELL_EINVAL;
+    }
+    if (addr % getPageSize(memory->flags)) {
+        return CELL_EALIGN;
+    }
+    if (!isRangeFree(lv2.mmapper, addr, size)) {
+        return CELL_EBUSY;
+    }
+
+    return mapMemory(lv2.mmapper, addr, mem_id, memory, access);
+}
+
+S32 sys_mmapper_unmap_shared_memory(U32 addr, BE<U32>* mem_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // Check requisites
+    if (mem_id == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    auto it = lv2.mmapper.mappings.find(addr);
+    if (it == lv2.mmapper.mappings.end()) {
+        return CELL_EINVAL;
+    }
+
+    nucleus.memory->unmap(addr);
+    it->second.memory->mappings -= 1;
+    *mem_id = it->second.mem_id;
+    lv2.mmapper.mappings.erase(it);
+    return CELL_OK;
+}
+
+S32 sys_mmapper_search_and_map(U32 start_addr, U32 mem_id, U64 flags, BE<U32>* alloc_addr) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // Check requisites
+    if (alloc_addr == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+
+    std::lock_guard<std::mutex> lock(lv2.mmapper.mutex);
+    auto* memory = lv2.objects.get<sys_mmapper_memory_t>(mem_id);
+    if (!memory) {
+        return CELL_ESRCH;
+    }
+    const U32 access = getAccessFlags(flags);
+    if (!access) {
+        return CELL_EINVAL;
+    }
+    const auto* area = findArea(lv2.mmapper, start_addr, 1);
+    if (!area || area->addr != start_addr) {
+        return CELL_EINVAL;
+    }
+
+    // First fit inside the area, at the page size of the memory
+    const U32 size = memory->shm.getSize();
+    const U32 pageSize = getPageSize(memory->flags);
+    const U64 areaEnd = U64(area->addr) + area->size;
+    for (U64 addr = area->addr; addr + size <= areaEnd; addr += pageSize) {
+        if (!isRangeFree(lv2.mmapper, U32(addr), size)) {
+            continue;
+        }
+        const S32 result = mapMemory(lv2.mmapper, U32(addr), mem_id, memory, access);
+        if (result == CELL_OK) {
+            *alloc_addr = U32(addr);
+        }
+        return result;
+    }
+    return CELL_ENOMEM;
+}
+
 }  // namespace sys
@@ -6,11 +6,56 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/memory/shared_memory.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace sys {
 
+// Auxiliary classes
+struct sys_mmapper_memory_t
+{
+    mem::SharedMemory shm;
+    U64 flags;
+    U64 ipc_key;
+
+    // Guest addresses where the memory is mapped, protected by the mmapper mutex
+    U32 mappings = 0;
+
+    sys_mmapper_memory_t(U32 size) : shm(size) {}
+};
+
+struct sys_mmapper_area_t
+{
+    U32 addr;
+    U32 size;
+    U64 flags;
+};
+
+struct sys_mmapper_mapping_t
+{
+    U32 size;
+    U32 mem_id;
+    sys_mmapper_memory_t* memory;
+};
+
+// Kernel state of the mmapper: address areas and the shared memory mapped inside them
+struct sys_mmapper_t
+{
+    std::mutex mutex;
+    std::vector<sys_mmapper_area_t> areas;
+    std::map<U32, sys_mmapper_mapping_t> mappings;
+};
+
 // SysCalls
-S32 sys_mmapper_allocate_address(U32 size, U64 flags, U32 alignment, U32* alloc_addr);
-S32 sys_mmapper_allocate_shared_memory(U32 size, U64 flags, U32 alignment, U32* alloc_addr);
+S32 sys_mmapper_allocate_address(U32 size, U64 flags, U32 alignment, BE<U32>* alloc_addr);
+S32 sys_mmapper_free_address(U32 addr);
+S32 sys_mmapper_allocate_shared_memory(U64 ipc_key, U32 size, U64 flags, BE<U32>* mem_id);
+S32 sys_mmapper_free_shared_memory(U32 mem_id);
+S32 sys_mmapper_map_shared_memory(U32 addr, U32 mem_id, U64 flags);
+S32 sys_mmapper_unmap_shared_memory(U32 addr, BE<U32>* mem_id);
+S32 sys_mmapper_search_and_map(U32 start_addr, U32 mem_id, U64 flags, BE<U32>* alloc_addr);
 
 }  // namespace sys
@@ -5,10 +5,67 @@
 
 #include "sys_mutex.h"
 #include "nucleus/system/scei/cellos/lv2.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/emulator.h"
 
 namespace sys {
 
+static cpu::frontend::ppu::PPUThread* getCurrentThread() {
+    return static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+}
+
+S32 mutexLock(sys_mutex_t* mutex, U32 tid, S32 priority, U64 timeout, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex->queue.mutex());
+    if (mutex->owner == 0) {
+        mutex->owner = tid;
+        return CELL_OK;
+    }
+    if (mutex->owner == tid) {
+        if (mutex->attr.recursive != SYS_SYNC_RECURSIVE) {
+            return CELL_EDEADLK;
+        }
+        if (mutex->recursive_count == 0xFFFFFFFF) {
+            return CELL_EKRESOURCE;
+        }
+        mutex->recursive_count++;
+        return CELL_OK;
+    }
+    if (!wait) {
+        return CELL_EBUSY;
+    }
+
+    // Ownership is set to this thread by the unlocking thread before waking it up
+    WaitQueue::Waiter waiter(tid, priority);
+    if (!mutex->queue.wait(lock, waiter, timeout)) {
+        return CELL_ETIMEDOUT;
+    }
+    return CELL_OK;
+}
+
+S32 mutexUnlock(sys_mutex_t* mutex, U32 tid) {
+    std::unique_lock<std::mutex> lock(mutex->queue.mutex());
+    if (mutex->owner != tid) {
+        return CELL_EPERM;
+    }
+    if (mutex->recursive_count) {
+        mutex->recursive_count--;
+        return CELL_OK;
+    }
+    mutexRelease(mutex);
+    return CELL_OK;
+}
+
+void mutexRelease(sys_mutex_t* mutex) {
+    auto* waiter = mutex->queue.front();
+    if (waiter) {
+        mutex->owner = waiter->threadId;
+        mutex->queue.wake(waiter);
+    } else {
+        mutex->owner = 0;
+    }
+}
+
 S32 sys_mutex_create(BE<U32>* mutex_id, sys_mutex_attribute_t* attr) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -21,7 +78,7 @@ S32 sys_mutex_create(BE<U32>* mutex_id, sys_mutex_attribute_t* attr) {
     }
 
     // Create mutex
-    auto* mutex = new sys_mutex_t();
+    auto* mutex = new sys_mutex_t(attr->protocol);
     mutex->attr = *attr;
 
     *mutex_id = lv2.objects.add(mutex, SYS_MUTEX_OBJECT);
@@ -31,6 +88,17 @@ S32 sys_mutex_create(BE<U32>* mutex_id, sys_mutex_attribute_t* attr) {
 S32 sys_mutex_destroy(U32 mutex_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* mutex = lv2.objects.get<sys_mutex_t>(mutex_id);
+
+    // Check requisites
+    if (!mutex) {
+        return CELL_ESRCH;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex->queue.mutex());
+    if (mutex->owner || mutex->cond_count || !mutex->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(mutex_id)) {
         return CELL_ESRCH;
     }
@@ -52,19 +120,9 @@ S32 sys_mutex_lock(U32 mutex_id, U64 timeout) {
         timeout = 0xFFFFFFFFFFFFULL;
     }
 
-    // Lock mutex
-    if (timeout == 0) {
-        mutex->mutex.lock();
-    } else {
-        auto rel_time = std::chrono::microseconds(timeout);
-#if defined(NUCLEUS_TARGET_ANDROID) && defined(NUCLEUS_COMPILER_GCC)
-        // TODO: Reimplement try_lock_for
-        mutex->mutex.try_lock();
-#else
-        mutex->mutex.try_lock_for(rel_time);
-#endif
-    }
-    return CELL_OK;
+    auto* thread = getCurrentThread();
+    ObjectManager::BlockingScope scope(lv2.objects, { mutex_id });
+    return mutexLock(mutex, thread->id, thread->priority, timeout);
 }
 
 S32 sys_mutex_trylock(U32 mutex_id) {
@@ -77,8 +135,8 @@ S32 sys_mutex_trylock(U32 mutex_id) {
         return CELL_ESRCH;
     }
 
-    mutex->mutex.try_lock();
-    return CELL_OK;
+    auto* thread = getCurrentThread();
+    return mutexLock(mutex, thread->id, thread->priority, 0, false);
 }
 
 S32 sys_mutex_unlock(U32 mutex_id) {
@@ -91,8 +149,7 @@ S32 sys_mutex_unlock(U32 mutex_id) {
         return CELL_ESRCH;
     }
 
-    mutex->mutex.unlock();
-    return CELL_OK;
+    return mutexUnlock(mutex, getCurrentThread()->id);
 }
 
 }  // namespace sys
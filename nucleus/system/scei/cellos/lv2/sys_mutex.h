@@ -6,8 +6,8 @@
 #pragma once
 
 #include "nucleus/common.h"
-
-#include <mutex>
+#include "nucleus/system/scei/cellos/lv2/sys_process.h"
+#include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
 
 namespace sys {
 
@@ -31,14 +31,44 @@ struct sys_mutex_attribute_t
 
 struct sys_mutex_t
 {
-#if defined(NUCLEUS_TARGET_ANDROID) && defined(NUCLEUS_COMPILER_GCC)
-    std::mutex mutex;
-#else
-    std::timed_mutex mutex;
-#endif
+    WaitQueue queue;
     sys_mutex_attribute_t attr;
+
+    // ID of the owner thread, or 0 if unlocked
+    U32 owner = 0;
+
+    // Number of times the owner locked the mutex again
+    U32 recursive_count = 0;
+
+    // Number of condition variables bound to this mutex
+    U32 cond_count = 0;
+
+    sys_mutex_t(U32 protocol) : queue(protocol, SYS_MUTEX_OBJECT) {}
 };
 
+/**
+ * Lock the mutex on behalf of a thread, waiting for the ownership to be handed over
+ * while it is held by other threads.
+ * @param[in]  mutex     Mutex to lock
+ * @param[in]  tid       ID of the calling thread
+ * @param[in]  priority  Priority of the calling thread
+ * @param[in]  timeout   Maximum time to wait in microseconds, or 0 to wait indefinitely
+ * @param[in]  wait      Whether to wait at all if the mutex is held by another thread
+ * @return               CELL_OK on success, or the error to return to the guest
+ */
+S32 mutexLock(sys_mutex_t* mutex, U32 tid, S32 priority, U64 timeout, bool wait = true);
+
+/**
+ * Unlock the mutex on behalf of a thread, handing it over to the next waiter
+ * @param[in]  mutex  Mutex to unlock
+ * @param[in]  tid    ID of the calling thread
+ * @return            CELL_OK on success, or the error to return to the guest
+ */
+S32 mutexUnlock(sys_mutex_t* mutex, U32 tid);
+
+// Hand the mutex over to the next waiter or leave it unlocked. The queue mutex must be held.
+void mutexRelease(sys_mutex_t* mutex);
+
 // SysCalls
 S32 sys_mutex_create(BE<U32>* mutex_id, sys_mutex_attribute_t* attr);
 S32 sys_mutex_destroy(U32 mutex_id);
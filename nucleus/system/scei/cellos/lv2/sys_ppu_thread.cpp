@@ -22,6 +22,10 @@ S32 sys_ppu_thread_create(BE<U64>* thread_id, sys_ppu_thread_attr_t* attr, U64 a
     ppu_thread->stack.size = stacksize;
     ppu_thread->stack.addr = nucleus.memory->getSegment(mem::SEG_STACK).alloc(stacksize, 0x100);
     ppu_thread->thread = static_cast<cpu::frontend::ppu::PPUThread*>(nucleus.cpu->addThread(cpu::THREAD_TYPE_PPU));
+    ppu_thread->thread->priority = prio;
+    if (threadname != nucleus.memory->ptr(0)) {
+        ppu_thread->thread->setName(reinterpret_cast<const char*>(threadname));
+    }
 
     // Set PPU thread initial UISA general-purpose registers
     auto* state = ppu_thread->thread->state.get();
@@ -40,7 +44,8 @@ S32 sys_ppu_thread_create(BE<U64>* thread_id, sys_ppu_thread_attr_t* attr, U64 a
     state->tb.TBL = 1;
     state->tb.TBU = 1;
 
-    *thread_id = lv2.objects.add(ppu_thread, SYS_PPU_THREAD_OBJECT);
+    ppu_thread->thread->id = lv2.objects.add(ppu_thread, SYS_PPU_THREAD_OBJECT);
+    *thread_id = ppu_thread->thread->id;
     return CELL_OK;
 }
 
@@ -67,7 +72,7 @@ S32 sys_ppu_thread_get_priority(U64 thread_id, BE<S32>* prio) {
         return CELL_ESRCH;
     }
 
-    // TODO: *prio = thread->prio;
+    *prio = ppu_thread->thread->priority;
     return CELL_OK;
 }
 
@@ -92,10 +97,28 @@ S32 sys_ppu_thread_join(U64 thread_id, BE<U64>* vptr) {
         return CELL_ESRCH;
     }
 
+    ObjectManager::BlockingScope scope(lv2.objects, { U32(thread_id) });
     ppu_thread->thread->join();
     return CELL_OK;
 }
 
+S32 sys_ppu_thread_set_priority(U64 thread_id, S32 prio) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* ppu_thread = lv2.objects.get<sys_ppu_thread_t>(thread_id);
+
+    // Check requisites
+    if (prio < 0 || prio > 3071) {
+        return CELL_EINVAL;
+    }
+    if (!ppu_thread) {
+        return CELL_ESRCH;
+    }
+
+    ppu_thread->thread->setPriority(prio);
+    return CELL_OK;
+}
+
 S32 sys_ppu_thread_start(U64 thread_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -81,7 +81,8 @@ S32 sys_prx_start_module(S32 id, U64 flags, sys_prx_start_module_option_t* pOpt)
                 const U32 fnid = nucleus.memory->read32(importedLibrary.fnid_addr + 4*i);
 
                 // Try to link to a native implementation (HLE)
-                if (lv2.modules.find(lib.name, fnid)) {
+                Syscall* function = lv2.modules.find(lib.name, fnid);
+                if (function) {
                     if (config.ppuTranslator == CPU_TRANSLATOR_INSTRUCTION) {
                         U32 hookAddr = nucleus.memory->alloc(20, 8);
                         nucleus.memory->write32(hookAddr + 0, 0x3D600000 | ((fnid >> 16) & 0xFFFF));  // lis  r11, fnid:hi
@@ -98,7 +99,7 @@ S32 sys_prx_start_module(S32 id, U64 flags, sys_prx_start_module_option_t* pOpt)
                         const U32 func_rtoc = nucleus.memory->read32(addr + 4);
                         for (auto& module : static_cast<cpu::Cell*>(nucleus.cpu.get())->ppu_modules) {
                             if (module->contains(func_addr)) {
-                                module->hook(func_addr, fnid);
+                                module->hook(func_addr, function, fnid);
                                 break;
                             }
                         }
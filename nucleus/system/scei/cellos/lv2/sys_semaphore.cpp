@@ -7,8 +7,18 @@
 #include "sys_mutex.h"
 #include "nucleus/emulator.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 
+// Avoid <Windows.h> macro collisions with std::min and std::max
+#if defined(NUCLEUS_TARGET_UWP) || defined(NUCLEUS_TARGET_WINDOWS)
+#undef min
+#undef max
+#endif
+
+#include <algorithm>
+
 namespace sys {
 
 S32 sys_semaphore_create(BE<U32>* sem_id, sys_semaphore_attribute_t* attr, S32 initial_count, S32 max_count) {
@@ -31,7 +41,7 @@ S32 sys_semaphore_create(BE<U32>* sem_id, sys_semaphore_attribute_t* attr, S32 i
     }
 
     // Create semaphore
-    auto* semaphore = new sys_semaphore_t();
+    auto* semaphore = new sys_semaphore_t(attr->protocol);
     semaphore->max_count = max_count;
     semaphore->count = initial_count;
     semaphore->attr = *attr;
@@ -43,6 +53,17 @@ S32 sys_semaphore_create(BE<U32>* sem_id, sys_semaphore_attribute_t* attr, S32 i
 S32 sys_semaphore_destroy(U32 sem_id) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
+    auto* semaphore = lv2.objects.get<sys_semaphore_t>(sem_id);
+
+    // Check requisites
+    if (!semaphore) {
+        return CELL_ESRCH;
+    }
+
+    std::unique_lock<std::mutex> lock(semaphore->queue.mutex());
+    if (!semaphore->queue.empty()) {
+        return CELL_EBUSY;
+    }
     if (!lv2.objects.remove(sem_id)) {
         return CELL_ESRCH;
     }
@@ -62,6 +83,7 @@ S32 sys_semaphore_get_value(U32 sem_id, BE<S32>* val) {
         return CELL_EFAULT;
     }
 
+    std::unique_lock<std::mutex> lock(semaphore->queue.mutex());
     *val = semaphore->count;
     return CELL_OK;
 }
@@ -78,17 +100,19 @@ S32 sys_semaphore_post(U32 sem_id, S32 val) {
     if (val < 0) {
         return CELL_EINVAL;
     }
-    if (semaphore->count + val > semaphore->max_count) {
+
+    // Units taken by waiting threads never reach the count
+    std::unique_lock<std::mutex> lock(semaphore->queue.mutex());
+    const S32 handoff = std::min<S32>(val, semaphore->queue.size());
+    if (semaphore->count + (val - handoff) > semaphore->max_count) {
         return CELL_EBUSY;
     }
 
-    // Wake up the threads
-    std::unique_lock<std::mutex> lock(semaphore->mutex);
-    while (val) {
-        semaphore->count++;
-        semaphore->cv.notify_one();
-        val--;
+    // Hand the units over to the waiting threads, then release the rest
+    for (S32 i = 0; i < handoff; i++) {
+        semaphore->queue.wakeOne();
     }
+    semaphore->count += val - handoff;
     return CELL_OK;
 }
 
@@ -103,7 +127,7 @@ S32 sys_semaphore_trywait(U32 sem_id) {
     }
 
     // If semaphore count is positive, decrement it and continue
-    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    std::unique_lock<std::mutex> lock(semaphore->queue.mutex());
     if (semaphore->count > 0) {
         semaphore->count--;
         return CELL_OK;
@@ -121,21 +145,19 @@ S32 sys_semaphore_wait(U32 sem_id, U64 timeout) {
         return CELL_ESRCH;
     }
 
-    std::unique_lock<std::mutex> lock(semaphore->mutex);
-
-    if (semaphore->count <= 0) {
-        // Wait until condition or timeout is met
-        if (timeout == 0) {
-            semaphore->cv.wait(lock, [&]{ return semaphore->count > 0; });
-        } else {
-            auto rel_time = std::chrono::microseconds(timeout);
-            if (!semaphore->cv.wait_for(lock, rel_time, [&]{ return semaphore->count > 0; })) {
-                return CELL_ETIMEDOUT;
-            }
-        }
+    ObjectManager::BlockingScope scope(lv2.objects, { sem_id });
+    std::unique_lock<std::mutex> lock(semaphore->queue.mutex());
+    if (semaphore->count > 0) {
+        semaphore->count--;
+        return CELL_OK;
     }
 
-    semaphore->count--;
+    // Wait until a unit is handed over by sys_semaphore_post or timeout is met
+    auto* thread = static_cast<cpu::frontend::ppu::PPUThread*>(cpu::CPU::getCurrentThread());
+    WaitQueue::Waiter waiter(thread->id, thread->priority);
+    if (!semaphore->queue.wait(lock, waiter, timeout)) {
+        return CELL_ETIMEDOUT;
+    }
     return CELL_OK;
 }
 
@@ -6,9 +6,8 @@
 #pragma once
 
 #include "nucleus/common.h"
-
-#include <condition_variable>
-#include <mutex>
+#include "nucleus/system/scei/cellos/lv2/sys_process.h"
+#include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
 
 namespace sys {
 
@@ -25,11 +24,12 @@ struct sys_semaphore_attribute_t
 // Auxiliary classes
 struct sys_semaphore_t
 {
-    std::mutex mutex;
-    std::condition_variable cv;
+    WaitQueue queue;
     sys_semaphore_attribute_t attr;
     S32 max_count;
     S32 count;
+
+    sys_semaphore_t(U32 protocol) : queue(protocol, SYS_SEMAPHORE_OBJECT) {}
 };
 
 // SysCalls
@@ -24,6 +24,24 @@ namespace sys {
 #define SPU_SNR2_OFFSET(spuNum) \
     (SYS_SPU_THREAD_OFFSET * (spuNum) + SYS_SPU_THREAD_BASE_LOW + SYS_SPU_THREAD_SNR2)
 
+// Deliver a MFC_SNDSIG_CMD issued by a thread of the group to the SNR1/SNR2 register of another
+static bool sendSignal(SPUThreadGroup* spuThreadGroup, U32 ea, U32 value) {
+    for (U32 spuNum = 0; spuNum < spuThreadGroup->threads.size(); spuNum++) {
+        auto* spuThread = spuThreadGroup->threads[spuNum];
+        if (!spuThread) {
+            continue;
+        }
+        for (S32 number = 0; number < 2; number++) {
+            if (ea == (number ? SPU_SNR2_OFFSET(spuNum) : SPU_SNR1_OFFSET(spuNum))) {
+                const bool orMode = (spuThread->cfg >> number) & 1;
+                spuThread->thread->mfc->writeSignal(number, value, orMode);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 S32 sys_spu_initialize(U32 max_usable_spu, U32 max_raw_spu) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -99,11 +117,16 @@ S32 sys_spu_thread_initialize(BE<U32>* thread, U32 group, U32 spu_num, sys_spu_i
 
     // Set SPU thread initial state
     auto* state = spuThread->thread->state.get();
-    state->pc = SPU_LS_OFFSET(spu_num) + img->entry_point;
+    state->pc = img->entry_point;
     state->r[3].u64[1] = arg->arg1;
     state->r[4].u64[1] = arg->arg2;
     state->r[5].u64[1] = arg->arg3;
     state->r[6].u64[1] = arg->arg4;
+    spuThread->thread->mfc->setLocalStorage(SPU_LS_OFFSET(spu_num));
+    spuThread->thread->mfc->setSignalHandler([spuThreadGroup](U32 ea, U32 value) {
+        return sendSignal(spuThreadGroup, ea, value);
+    });
+    spuThread->thread->priority = spuThreadGroup->prio;
 
     // Create SPU modules
     for (Size i = 0; i < img->nsegs; i++) {
@@ -112,11 +135,10 @@ S32 sys_spu_thread_initialize(BE<U32>* thread, U32 group, U32 spu_num, sys_spu_i
         void* srcAddr = nucleus.memory->ptr(seg.src.pa_start);
         if (seg.type == SYS_SPU_SEGMENT_TYPE_COPY) {
             memcpy(dstAddr, srcAddr, seg.size);
-            // Assuming the it contains executable code
-            auto segment = new cpu::frontend::spu::Module(nucleus.cpu.get());
-            segment->address = SPU_LS_OFFSET(spu_num) + seg.ls_start;
-            segment->size = seg.size;
-            static_cast<cpu::Cell*>(nucleus.cpu.get())->spu_modules.push_back(segment);
+            // Assuming the it contains executable code, shared with other SPUs loading the same program
+            auto* cell = static_cast<cpu::Cell*>(nucleus.cpu.get());
+            auto* module = cell->spu_cache->getModule(static_cast<const U08*>(srcAddr), seg.ls_start, seg.size);
+            spuThread->thread->addModule(module);
         }
         if (seg.type == SYS_SPU_SEGMENT_TYPE_FILL) {
             assert_always("Unimplemented");
@@ -174,6 +196,7 @@ S32 sys_spu_thread_group_join(U32 gid, BE<S32>* cause, BE<S32>* status) {
         return CELL_ESRCH;
     }
 
+    ObjectManager::BlockingScope scope(lv2.objects, { gid });
     for (auto* spuThread : spuThreadGroup->threads) {
         if (spuThread) {
             spuThread->thread->join();
@@ -205,6 +228,63 @@ S32 sys_spu_thread_read_ls(U32 id, U32 address, BE<U64>* value, U32 type) {
     return CELL_OK;
 }
 
+S32 sys_spu_thread_write_snr(U32 id, S32 number, U32 value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+    if (number != 0 && number != 1) {
+        return CELL_EINVAL;
+    }
+
+    // Wakes up the SPU thread if it is waiting on SPU_RdSigNotify1/2
+    const bool orMode = (spuThread->cfg >> number) & 1;
+    spuThread->thread->mfc->writeSignal(number, value, orMode);
+    return CELL_OK;
+}
+
+S32 sys_spu_thread_set_spu_cfg(U32 id, U64 value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+    if (value > 3) {
+        return CELL_EINVAL;
+    }
+    spuThread->cfg = value;
+    return CELL_OK;
+}
+
+S32 sys_spu_thread_get_spu_cfg(U32 id, BE<U64>* value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+    *value = spuThread->cfg;
+    return CELL_OK;
+}
+
+S32 sys_spu_thread_write_spu_mb(U32 id, U32 value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+
+    // Wakes up the SPU thread if it is waiting on SPU_RdInMbox
+    if (!spuThread->thread->mfc->writeInMbox(value)) {
+        return CELL_EBUSY;
+    }
+    return CELL_OK;
+}
+
 S32 sys_spu_thread_group_connect_event_all_threads(S32 group_id, U32 equeue_id, U64 req, U08* spup) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
@@ -116,6 +116,7 @@ struct SPUThread {
     SPUThreadGroup* parent;
     std::string name;
     cpu::frontend::spu::SPUThread* thread;
+    U64 cfg = 0;  // SPU configuration: signal notification modes
 };
 
 struct SPUThreadGroup {
@@ -0,0 +1,172 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "sys_synchronization.h"
+#include "nucleus/core/futex.h"
+#include "nucleus/core/timebase.h"
+#include "nucleus/core/timer_wheel.h"
+
+#include <algorithm>
+
+namespace sys {
+
+namespace {
+
+// Statistics of all the wait queues of an object type, indexed by type
+struct WaitQueueCounters {
+    std::atomic<U64> waits;
+    std::atomic<U64> timeouts;
+    std::atomic<U64> waitTime;
+    std::atomic<U64> waitTimeMax;
+    std::atomic<U64> wakeups;
+    std::atomic<U64> wakeLatency;
+    std::atomic<U64> wakeLatencyMax;
+};
+
+WaitQueueCounters g_counters[256];
+
+void updateMax(std::atomic<U64>& max, U64 value) {
+    U64 current = max.load(std::memory_order_relaxed);
+    while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+}  // namespace
+
+WaitQueue::WaitQueue(U32 protocol, U32 objectType) : m_protocol(protocol), m_objectType(objectType & 0xFF) {
+}
+
+bool WaitQueue::wait(std::unique_lock<std::mutex>& lock, Waiter& waiter, U64 timeout) {
+    waiter.state.store(0, std::memory_order_relaxed);
+    waiter.sequence = m_sequence++;
+    m_waiters.push_back(&waiter);
+
+    const U64 start = core::Timebase::readHostClock();
+    const U64 deadline = start + timeout * 1000;
+    lock.unlock();
+
+    // Park on the futex of this waiter until it is handed the object or the deadline passes
+    bool woken = true;
+    while (waiter.state.load(std::memory_order_acquire) == 0) {
+        if (!timeout) {
+            core::futexWait(waiter.state, 0);
+        } else if (!core::TimerWheel::get().waitUntil(waiter.state, 0, deadline)) {
+            woken = false;
+            break;
+        }
+    }
+    const U64 end = core::Timebase::readHostClock();
+    lock.lock();
+
+    // A waker might have dequeued this waiter after the deadline expired
+    if (!woken) {
+        if (waiter.state.load(std::memory_order_acquire)) {
+            woken = true;
+        } else {
+            remove(&waiter);
+        }
+    }
+
+    auto& counters = g_counters[m_objectType];
+    counters.waits.fetch_add(1, std::memory_order_relaxed);
+    counters.waitTime.fetch_add(end - start, std::memory_order_relaxed);
+    updateMax(counters.waitTimeMax, end - start);
+    if (woken) {
+        const U64 latency = (end > waiter.wakeTime) ? end - waiter.wakeTime : 0;
+        counters.wakeups.fetch_add(1, std::memory_order_relaxed);
+        counters.wakeLatency.fetch_add(latency, std::memory_order_relaxed);
+        updateMax(counters.wakeLatencyMax, latency);
+    } else {
+        counters.timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+    return woken;
+}
+
+void WaitQueue::remove(Waiter* waiter) {
+    auto it = std::find(m_waiters.begin(), m_waiters.end(), waiter);
+    if (it != m_waiters.end()) {
+        m_waiters.erase(it);
+    }
+}
+
+void WaitQueue::sortWaiters(std::vector<Waiter*>& waiters) const {
+    if (m_protocol == SYS_SYNC_PRIORITY || m_protocol == SYS_SYNC_PRIORITY_INHERIT) {
+        std::sort(waiters.begin(), waiters.end(), [](const Waiter* a, const Waiter* b) {
+            return (a->priority != b->priority) ? (a->priority < b->priority) : (a->sequence < b->sequence);
+        });
+    } else {
+        std::sort(waiters.begin(), waiters.end(), [](const Waiter* a, const Waiter* b) {
+            return a->sequence < b->sequence;
+        });
+    }
+}
+
+WaitQueue::Waiter* WaitQueue::front() const {
+    if (m_waiters.empty()) {
+        return nullptr;
+    }
+    // Waiters are kept in arrival order
+    if (m_protocol != SYS_SYNC_PRIORITY && m_protocol != SYS_SYNC_PRIORITY_INHERIT) {
+        return m_waiters.front();
+    }
+    Waiter* next = m_waiters.front();
+    for (Waiter* waiter : m_waiters) {
+        if (waiter->priority < next->priority) {
+            next = waiter;
+        }
+    }
+    return next;
+}
+
+WaitQueue::Waiter* WaitQueue::find(U32 threadId) const {
+    for (Waiter* waiter : m_waiters) {
+        if (waiter->threadId == threadId) {
+            return waiter;
+        }
+    }
+    return nullptr;
+}
+
+void WaitQueue::wake(Waiter* waiter, U64 data, S32 result) {
+    remove(waiter);
+    waiter->data = data;
+    waiter->result = result;
+    waiter->wakeTime = core::Timebase::readHostClock();
+
+    // The waiter cannot return before the queue mutex held by the caller is released
+    waiter->state.store(1, std::memory_order_release);
+    core::futexWake(waiter->state);
+}
+
+bool WaitQueue::wakeOne(U64 data, S32 result) {
+    Waiter* waiter = front();
+    if (!waiter) {
+        return false;
+    }
+    wake(waiter, data, result);
+    return true;
+}
+
+U32 WaitQueue::wakeAll(U64 data, S32 result) {
+    U32 count = 0;
+    while (wakeOne(data, result)) {
+        count++;
+    }
+    return count;
+}
+
+WaitQueueStatistics WaitQueue::getStatistics(U32 objectType) {
+    const auto& counters = g_counters[objectType & 0xFF];
+    WaitQueueStatistics stats;
+    stats.waits = counters.waits.load(std::memory_order_relaxed);
+    stats.timeouts = counters.timeouts.load(std::memory_order_relaxed);
+    stats.waitTime = counters.waitTime.load(std::memory_order_relaxed);
+    stats.waitTimeMax = counters.waitTimeMax.load(std::memory_order_relaxed);
+    stats.wakeups = counters.wakeups.load(std::memory_order_relaxed);
+    stats.wakeLatency = counters.wakeLatency.load(std::memory_order_relaxed);
+    stats.wakeLatencyMax = counters.wakeLatencyMax.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace sys
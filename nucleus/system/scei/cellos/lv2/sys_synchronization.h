@@ -7,10 +7,141 @@
 
 #include "nucleus/common.h"
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 // Constants
 enum {
     SYS_SYNC_FIFO              = 0x0001,
     SYS_SYNC_PRIORITY          = 0x0002,
     SYS_SYNC_PRIORITY_INHERIT  = 0x0003,
     SYS_SYNC_RETRY             = 0x0004,
+    SYS_SYNC_RECURSIVE         = 0x0010,
+    SYS_SYNC_NOT_RECURSIVE     = 0x0020,
+};
+
+namespace sys {
+
+struct WaitQueueStatistics {
+    U64 waits;           // Number of threads that blocked
+    U64 timeouts;        // Number of waits that timed out
+    U64 waitTime;        // Accumulated time spent blocked, in nanoseconds
+    U64 waitTimeMax;     // Longest time spent blocked, in nanoseconds
+    U64 wakeups;         // Number of targeted wakeups
+    U64 wakeLatency;     // Accumulated time from wakeup to resumption, in nanoseconds
+    U64 wakeLatencyMax;  // Longest time from wakeup to resumption, in nanoseconds
+};
+
+/**
+ * Wait queue
+ * ==========
+ * Queue of threads blocked on a LV2 synchronization object. The object state is protected
+ * by the queue mutex, and wakers hand the resource over to a specific waiter, which
+ * parks on a futex of its own, instead of waking every waiter to race for it.
+ *
+ * Notes:
+ * - Waiters are released in arrival order (SYS_SYNC_FIFO), or by thread priority with
+ *   arrival order among equal priorities (SYS_SYNC_PRIORITY). Lower values are higher
+ *   priorities, as in sys_ppu_thread.
+ * - All waker methods must be called with the queue mutex held.
+ */
+class WaitQueue {
+public:
+    struct Waiter {
+        // Futex word: 0 while blocked, 1 once woken
+        std::atomic<U32> state;
+
+        U32 threadId;
+        S32 priority;
+        U64 sequence = 0;
+
+        // Object-specific arguments of the wait, set by the waiter
+        U64 args[2] = {};
+        void* payload = nullptr;
+
+        // Results handed over by the waker
+        U64 data = 0;
+        S32 result = 0;
+
+        // Host time of the wakeup in nanoseconds
+        U64 wakeTime = 0;
+
+        Waiter(U32 threadId, S32 priority) : state(0), threadId(threadId), priority(priority) {}
+    };
+
+private:
+    std::mutex m_mutex;
+    std::vector<Waiter*> m_waiters;
+    U64 m_sequence = 0;
+    U32 m_protocol;
+    U32 m_objectType;
+
+    void remove(Waiter* waiter);
+
+public:
+    /**
+     * Create a wait queue
+     * @param[in]  protocol    Scheduling policy: SYS_SYNC_FIFO or SYS_SYNC_PRIORITY
+     * @param[in]  objectType  Type of the owning object, for statistics
+     */
+    WaitQueue(U32 protocol, U32 objectType);
+
+    std::mutex& mutex() { return m_mutex; }
+
+    bool empty() const { return m_waiters.empty(); }
+    Size size() const { return m_waiters.size(); }
+
+    /**
+     * Enqueue the waiter, release the lock and block until woken up or the timeout expires.
+     * The lock is held again on return.
+     * @param[in]  lock     Lock on the queue mutex
+     * @param[in]  waiter   Waiter of the calling thread
+     * @param[in]  timeout  Maximum time to wait in microseconds, or 0 to wait indefinitely
+     * @return              True if woken up, false if the timeout expired
+     */
+    bool wait(std::unique_lock<std::mutex>& lock, Waiter& waiter, U64 timeout);
+
+    // Waiter to be released next according to the protocol, or nullptr if none
+    Waiter* front() const;
+
+    // Waiter of a certain thread, or nullptr if the thread is not waiting
+    Waiter* find(U32 threadId) const;
+
+    // Dequeue and wake up a waiter, handing over the given results
+    void wake(Waiter* waiter, U64 data = 0, S32 result = 0);
+
+    // Wake up the next waiter, returning false if there was none
+    bool wakeOne(U64 data = 0, S32 result = 0);
+
+    // Wake up all waiters, returning their number
+    U32 wakeAll(U64 data = 0, S32 result = 0);
+
+    /**
+     * Wake up the waiters accepted by the predicate, visiting them in protocol order.
+     * The predicate may set the waiter results and update the object state.
+     * @param[in]  predicate  Function taking a Waiter& and returning whether to wake it
+     * @return                Number of waiters woken up
+     */
+    template <typename F>
+    U32 wakeIf(F predicate) {
+        U32 count = 0;
+        std::vector<Waiter*> ordered = m_waiters;
+        sortWaiters(ordered);
+        for (Waiter* waiter : ordered) {
+            if (predicate(*waiter)) {
+                wake(waiter, waiter->data, waiter->result);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Sort waiters in the order they would be released by the protocol
+    void sortWaiters(std::vector<Waiter*>& waiters) const;
+
+    // Get the wait statistics of all objects of a certain type
+    static WaitQueueStatistics getStatistics(U32 objectType);
 };
+
+}  // namespace sys
@@ -5,6 +5,7 @@
 
 #include "sys_time.h"
 #include "nucleus/system/scei/cellos/lv2.h"
+#include "nucleus/core/timebase.h"
 
 namespace sys {
 
@@ -15,13 +16,23 @@ S32 sys_time_get_timezone(BE<U32>* timezone, BE<U32>* summertime) {
 }
 
 S32 sys_time_get_current_time(BE<U64>* sec, BE<U64>* nsec) {
-    *sec = 1;
-    *nsec = 1;
+    U64 s, ns;
+    core::Timebase::get().getTime(s, ns);
+    *sec = s;
+    *nsec = ns;
     return CELL_OK;
 }
 
 U64 sys_time_get_timebase_frequency() {
-    return 79800000;
+    return core::Timebase::get().getFrequency();
+}
+
+U64 sys_time_get_system_time() {
+    // Microseconds elapsed on the guest timebase, split to avoid overflowing the product
+    auto& timebase = core::Timebase::get();
+    const U64 ticks = timebase.getTicks();
+    const U64 frequency = timebase.getFrequency();
+    return (ticks / frequency) * 1000000 + (ticks % frequency) * 1000000 / frequency;
 }
 
 }  // namespace sys
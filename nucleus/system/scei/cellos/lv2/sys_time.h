@@ -13,5 +13,6 @@ namespace sys {
 S32 sys_time_get_timezone(BE<U32>* timezone, BE<U32>* summertime);
 S32 sys_time_get_current_time(BE<U64>* sec, BE<U64>* nsec);
 U64 sys_time_get_timebase_frequency();
+U64 sys_time_get_system_time();
 
 }  // namespace sys
@@ -4,23 +4,230 @@
  */
 
 #include "sys_timer.h"
+#include "sys_event.h"
+#include "sys_process.h"
+#include "sys_time.h"
 #include "nucleus/system/scei/cellos/lv2.h"
+#include "nucleus/core/timebase.h"
+#include "nucleus/core/timer_wheel.h"
+#include "nucleus/emulator.h"
 
 namespace sys {
 
+sys_timer_t::~sys_timer_t() {
+    if (wheelTimer) {
+        core::TimerWheel::get().cancel(wheelTimer);
+    }
+}
+
+// Cancel the wheel timer, must be called with the timer mutex held
+static void timerStop(sys_timer_t* timer) {
+    if (timer->wheelTimer) {
+        core::TimerWheel::get().cancel(timer->wheelTimer);
+        timer->wheelTimer = 0;
+    }
+    timer->state.store(SYS_TIMER_STATE_STOP, std::memory_order_release);
+}
+
+S32 sys_timer_create(BE<U32>* timer_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // Check requisites
+    if (timer_id == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+
+    // Create timer
+    auto* timer = new sys_timer_t();
+
+    *timer_id = lv2.objects.add(timer, SYS_TIMER_OBJECT);
+    return CELL_OK;
+}
+
+S32 sys_timer_destroy(U32 timer_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+
+    // Check requisites
+    if (!timer) {
+        return CELL_ESRCH;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(timer->mutex);
+        if (timer->equeue_id) {
+            return CELL_EISCONN;
+        }
+        timerStop(timer);
+    }
+    if (!lv2.objects.remove(timer_id)) {
+        return CELL_ESRCH;
+    }
+    return CELL_OK;
+}
+
+S32 sys_timer_get_information(U32 timer_id, sys_timer_information_t* info) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+
+    // Check requisites
+    if (info == nucleus.memory->ptr(0)) {
+        return CELL_EFAULT;
+    }
+    if (!timer) {
+        return CELL_ESRCH;
+    }
+
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    const U32 state = timer->state.load(std::memory_order_acquire);
+    U64 next = timer->baseTime;
+    if (state == SYS_TIMER_STATE_RUN && timer->period) {
+        const U64 now = sys_time_get_system_time();
+        if (now >= next) {
+            next += ((now - next) / timer->period + 1) * timer->period;
+        }
+    }
+    info->next_expiration_time = next;
+    info->period = timer->period;
+    info->timer_state = state;
+    info->pad = 0;
+    return CELL_OK;
+}
+
+S32 sys_timer_start(U32 timer_id, S64 basetime, U64 period) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+
+    // Check requisites
+    if (!timer) {
+        return CELL_ESRCH;
+    }
+    if ((period == 0 && basetime <= 0) || (period != 0 && period < 100)) {
+        return CELL_EINVAL;
+    }
+
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    if (timer->state.load(std::memory_order_acquire) == SYS_TIMER_STATE_RUN) {
+        return CELL_EBUSY;
+    }
+    if (!timer->equeue_id) {
+        return CELL_ENOTCONN;
+    }
+
+    // Map the first expiration from guest system time to the host clock of the timer wheel
+    const U64 hostNow = core::Timebase::readHostClock();
+    const U64 now = sys_time_get_system_time();
+    const U64 base = (basetime > 0) ? basetime : now + period;
+    const U64 first = hostNow + ((base > now) ? (base - now) * 1000 : 0);
+
+    timer->baseTime = base;
+    timer->period = period;
+    timer->state.store(SYS_TIMER_STATE_RUN, std::memory_order_release);
+
+    // The callback runs on the wheel thread: it only uses copies of the connection and looks
+    // up the event queue by identifier, since it might be destroyed while the timer runs
+    const U32 equeue_id = timer->equeue_id;
+    const U64 name = timer->name;
+    const U64 data1 = timer->data1;
+    const U64 data2 = timer->data2;
+    timer->wheelTimer = core::TimerWheel::get().add(first, period * 1000, [=, &lv2](U64 deadline) {
+        // Single expirations stop the timer without its mutex, which the wheel thread never takes
+        if (!period) {
+            timer->state.store(SYS_TIMER_STATE_STOP, std::memory_order_release);
+        }
+        ObjectManager::Guard guard;
+        auto* equeue = lv2.objects.get<sys_event_queue_t>(equeue_id);
+        if (!equeue) {
+            return;
+        }
+        sys_event_t event;
+        event.source = name;
+        event.data1 = data1;
+        event.data2 = data2;
+        event.data3 = base + (deadline - first) / 1000;
+        eventQueueSend(equeue, event);
+    });
+    return CELL_OK;
+}
+
+S32 sys_timer_stop(U32 timer_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+
+    // Check requisites
+    if (!timer) {
+        return CELL_ESRCH;
+    }
+
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    timerStop(timer);
+    return CELL_OK;
+}
+
+S32 sys_timer_connect_event_queue(U32 timer_id, U32 queue_id, U64 name, U64 data1, U64 data2) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+    auto* equeue = lv2.objects.get<sys_event_queue_t>(queue_id);
+
+    // Check requisites
+    if (!timer || !equeue) {
+        return CELL_ESRCH;
+    }
+
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    if (timer->equeue_id) {
+        return CELL_EISCONN;
+    }
+    timer->equeue_id = queue_id;
+    timer->name = name ? name : (U64(sys_process_getpid()) << 32) | timer_id;
+    timer->data1 = data1;
+    timer->data2 = data2;
+    return CELL_OK;
+}
+
+S32 sys_timer_disconnect_event_queue(U32 timer_id) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* timer = lv2.objects.get<sys_timer_t>(timer_id);
+
+    // Check requisites
+    if (!timer) {
+        return CELL_ESRCH;
+    }
+
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    if (!timer->equeue_id) {
+        return CELL_ENOTCONN;
+    }
+    timerStop(timer);
+    timer->equeue_id = 0;
+    return CELL_OK;
+}
+
 S32 sys_timer_sleep(U32 sleep_time) {
-    // TODO: Use a condition variable to kill the thread while it sleeps
-    std::this_thread::sleep_for(std::chrono::seconds(sleep_time));
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    // TODO: Wake up the thread if it is killed while it sleeps
+    ObjectManager::BlockingScope scope(lv2.objects);
+    core::TimerWheel::get().sleepUntil(core::Timebase::readHostClock() + sleep_time * 1000000000ULL);
     return CELL_OK;
 }
 
 S32 sys_timer_usleep(U64 sleep_time) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
     // Maximum value is: 2^48-1
     if (sleep_time > 0xFFFFFFFFFFFFULL) {
         sleep_time = 0xFFFFFFFFFFFFULL;
     }
-    // TODO: Use a condition variable to kill the thread while it sleeps
-    std::this_thread::sleep_for(std::chrono::microseconds(sleep_time));
+    // TODO: Wake up the thread if it is killed while it sleeps
+    ObjectManager::BlockingScope scope(lv2.objects);
+    core::TimerWheel::get().sleepUntil(core::Timebase::readHostClock() + sleep_time * 1000);
     return CELL_OK;
 }
 
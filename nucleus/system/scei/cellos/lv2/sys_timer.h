@@ -7,15 +7,55 @@
 
 #include "nucleus/common.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace sys {
 
+// Constants
+enum {
+    SYS_TIMER_STATE_STOP = 0,
+    SYS_TIMER_STATE_RUN  = 1,
+};
+
 // Classes
 struct sys_timer_information_t
 {
-    S64 next_expiration_time;
-    U64 period;
-    U32 timer_state;
-    U32 pad;
+    BE<S64> next_expiration_time;
+    BE<U64> period;
+    BE<U32> timer_state;
+    BE<U32> pad;
+};
+
+// Auxiliary classes
+struct sys_timer_t
+{
+    // Serializes the syscalls operating on the timer, never taken by the wheel callback
+    std::mutex mutex;
+
+    // Written by the syscalls with the mutex held, and by the wheel callback of single
+    // expirations without it, so it is always accessed with explicit atomic operations
+    std::atomic<U32> state;
+
+    // Timer of core::TimerWheel while running
+    U64 wheelTimer = 0;
+
+    // Expiration period in microseconds, or 0 for a single expiration
+    U64 period = 0;
+
+    // First expiration in microseconds of guest system time
+    U64 baseTime = 0;
+
+    // Connected event queue and the event fields sent to it
+    U32 equeue_id = 0;
+    U64 name = 0;
+    U64 data1 = 0;
+    U64 data2 = 0;
+
+    sys_timer_t() : state(SYS_TIMER_STATE_STOP) {}
+
+    // Cancels the wheel timer, so that no callback runs once the object is deleted
+    ~sys_timer_t();
 };
 
 // SysCalls
@@ -30,11 +30,19 @@ class ModuleManager {
 
     std::vector<Module> modules;
 
+    // Functions of all modules indexed by FNID, for calls not bound at link time
+    std::unordered_map<U32, Syscall*> functionTable;
+
 public:
     ModuleManager(LV2* parent);
 
-    // Check if a certain library function is available for HLE
-    bool find(const std::string& libraryName, U32 functionId);
+    /**
+     * Get the HLE implementation of a library function, to bind imports at link time
+     * @param[in]  libraryName  Name of the library exporting the function
+     * @param[in]  functionId   FNID of the function
+     * @return                  HLE function, or nullptr if not available
+     */
+    Syscall* find(const std::string& libraryName, U32 functionId);
 
     // Get function ID from the current thread and call it
     void call(cpu::frontend::ppu::PPUState& state);
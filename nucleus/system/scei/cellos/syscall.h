@@ -8,6 +8,8 @@
 #include "nucleus/common.h"
 #include "nucleus/cpu/frontend/ppu/ppu_state.h"
 
+#include <utility>
+
 // Syscall arguments
 #define ARG_GPR(T,n) (T)(std::is_pointer<T>::value ? (U64)memoryBase + state.r[3+n] : state.r[3+n])
 
@@ -136,3 +138,20 @@ template <typename TR, typename... TA>
 Syscall* wrap(TR(*func)(TA...)) {
     return new SyscallBinder<TR, TA...>(func);
 }
+
+// Syscall handler specialized at compile time for a host function, callable without virtual dispatch
+template <typename F, F func>
+class SyscallThunk;
+
+template <typename TR, typename... TA, TR(*func)(TA...)>
+class SyscallThunk<TR(*)(TA...), func> {
+    template <size_t... I>
+    static void invoke(cpu::frontend::ppu::PPUState& state, void* memoryBase, std::index_sequence<I...>) {
+        state.r[3] = func(ARG_GPR(TA,I)...);
+    }
+
+public:
+    static void call(cpu::frontend::ppu::PPUState& state, void* memoryBase) {
+        invoke(state, memoryBase, std::index_sequence_for<TA...>{});
+    }
+};
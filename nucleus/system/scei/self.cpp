@@ -7,6 +7,7 @@
 #include "nucleus/common.h"
 #include "nucleus/core/config.h"
 #include "nucleus/emulator.h"
+#include "nucleus/format.h"
 #include "nucleus/cpu/cell.h"
 #include "nucleus/system/scei/cellos/lv2.h"
 #include "nucleus/cpu/frontend/ppu/ppu_decoder.h"
@@ -290,6 +291,16 @@ bool SELFLoader::load_prx(sys::sys_prx_t& prx)
             auto segment = new cpu::frontend::ppu::Module(nucleus.cpu.get());
             segment->address = prx_segment.addr;
             segment->size = prx_segment.size_file;
+
+            // Name the exported functions after their library and FNID, for debuggers and profilers
+            for (const auto& lib : prx.exported_libs) {
+                for (const auto& stub : lib.exports) {
+                    const U32 addr = nucleus.memory->read32(stub.second);
+                    if (segment->contains(addr)) {
+                        segment->symbols[addr] = format("%s_%08X", lib.name.c_str(), stub.first);
+                    }
+                }
+            }
             if (config.ppuTranslator & CPU_TRANSLATOR_MODULE) {
                 segment->analyze();
                 segment->recompile();
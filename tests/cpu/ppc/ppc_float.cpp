@@ -306,6 +306,14 @@ void PPCTestRunner::fmulx() {
     test_fmul( 0.0,  7.0,  0.0);
     test_fmul(-2.0,  0.0,  0.0);
     test_fmul(-2.0,  3.0, -6.0);
+
+    // Denormal results are kept after vector instructions, even in non-Java mode
+    state.v[0] = V128::from_u32(0x00010000, 0, 0, 0);
+    state.f[1] = 1e-300;
+    state.f[2] = 1e-10;
+    run({ a.mtvscr(v0); a.vaddfp(v1, v1, v1); a.fmul(f3, f1, f2); });
+    expect(state.f[3] != 0.0);
+    expect(state.f[3] == 1e-300 * 1e-10);
 }
 
 void PPCTestRunner::fmulsx() {
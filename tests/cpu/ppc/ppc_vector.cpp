@@ -57,6 +57,15 @@ void PPCTestRunner::mfvscr() {
 }
 
 void PPCTestRunner::mtvscr() {
+    TEST_INSTRUCTION(test_mtvscr, V1, NJ, {
+        state.v[1] = V1;
+        run({ a.mtvscr(v1); });
+        expect(state.vscr.VSCR == V1.u32[0]);
+        expect(state.vscr_nj == V128::from_u32(NJ, NJ, NJ, NJ));
+    });
+
+    test_mtvscr(V128::from_u32(0x00010000, 0, 0, 0), 0xFFFFFFFF);
+    test_mtvscr(V128::from_u32(0x00000001, 0, 0, 0), 0x00000000);
 }
 
 void PPCTestRunner::stvebx() {
@@ -90,6 +99,30 @@ void PPCTestRunner::vaddcuw() {
 }
 
 void PPCTestRunner::vaddfp() {
+    TEST_INSTRUCTION(test_vaddfp, VSCR, V1, V2, V3, {
+        state.v[0] = VSCR;
+        state.v[1] = V1;
+        state.v[2] = V2;
+        run({ a.mtvscr(v0); a.vaddfp(v3, v1, v2); });
+        expect(state.v[3] == V3);
+    });
+
+    const V128 java = V128::from_u32(0x00000000, 0, 0, 0);
+    const V128 nonJava = V128::from_u32(0x00010000, 0, 0, 0);
+    test_vaddfp(java,
+        V128::from(+1.0f, -1.5f, +2.0f, +0.0f),
+        V128::from(+1.0f, +0.5f, -3.0f, +1.0f),
+        V128::from(+2.0f, -1.0f, -1.0f, +1.0f));
+
+    // Denormal operands and results are flushed to zero only in non-Java mode
+    test_vaddfp(java,
+        V128::from_u32(0x00000001, 0x00400000, 0x3F800000, 0x80000001),
+        V128::from_u32(0x00000001, 0x00000000, 0x00000000, 0x00000000),
+        V128::from_u32(0x00000002, 0x00400000, 0x3F800000, 0x80000001));
+    test_vaddfp(nonJava,
+        V128::from_u32(0x00000001, 0x00400000, 0x3F800000, 0x80000001),
+        V128::from_u32(0x00000001, 0x00000000, 0x00000000, 0x80000000),
+        V128::from_u32(0x00000000, 0x00000000, 0x3F800000, 0x80000000));
 }
 
 void PPCTestRunner::vaddsbs() {
@@ -224,6 +257,11 @@ void PPCTestRunner::vmaddfp() {
         V128::from(+0.0f, +1.0f, +3.0f, +1.0f),
         V128::from(+1.0f, -1.0f, -1.0f, -7.0f),
         V128::from(+1.0f, +0.0f, +5.0f, -7.0f));
+    test_vmaddfp(
+        V128::from(-2.0f, +0.5f, +4.0f, -3.0f),
+        V128::from(+3.0f, +8.0f, +0.25f, -2.0f),
+        V128::from(+1.0f, +0.0f, -1.0f, +0.5f),
+        V128::from(-5.0f, +4.0f, +0.0f, +6.5f));
 }
 
 void PPCTestRunner::vmaxfp() {
@@ -559,7 +597,19 @@ void PPCTestRunner::vmulouh() {
 }
 
 void PPCTestRunner::vnmsubfp() {
-    // TODO
+    TEST_INSTRUCTION(test_vnmsubfp, V1, V2, V3, V4, {
+        state.v[1] = V1;
+        state.v[2] = V2;
+        state.v[3] = V3;
+        run({ a.vnmsubfp(v4, v1, v2, v3); });
+        expect(state.v[4] == V4);
+    });
+
+    test_vnmsubfp(
+        V128::from(+2.0f, +0.5f, -1.0f, +3.0f),
+        V128::from(+3.0f, +4.0f, +2.0f, +0.0f),
+        V128::from(+1.0f, +2.0f, +3.0f, +4.0f),
+        V128::from(-5.0f, +0.0f, +5.0f, +4.0f));
 }
 
 void PPCTestRunner::vnor() {
@@ -661,6 +711,10 @@ void PPCTestRunner::vpkshus() {
         V128::from_u32(0xFFFFFF80, 0x0000007F, 0xFFFEFF7F, 0x00010080),
         V128::from_u32(0xFFFDFF7E, 0x00020081, 0xFFFCFF7D, 0x00030082),
         V128::from_u32(0x0000007F, 0x00000180, 0x00000281, 0x00000382));
+    test_vpkshus(
+        V128::from_u32(0x01007FFF, 0x00FF8000, 0x00FE0001, 0x00801234),
+        V128::from_u32(0x00000000, 0x00000000, 0x00000000, 0x00000000),
+        V128::from_u32(0xFFFFFF00, 0xFE0180FF, 0x00000000, 0x00000000));
 }
 
 void PPCTestRunner::vpkswss() {
@@ -699,6 +753,10 @@ void PPCTestRunner::vpkswus() {
         V128::from_u32(0xFFFFFFFF, 0xFFFF8000, 0x00000000, 0x00007FFF),
         V128::from_u32(0xFFFFFFFE, 0xFFFF7FFF, 0x00000001, 0x00008000),
         V128::from_u32(0x00000000, 0x00007FFF, 0x00000000, 0x00018000));
+    test_vpkswus(
+        V128::from_u32(0x00010000, 0x7FFFFFFF, 0x0000FFFF, 0x80000000),
+        V128::from_u32(0x0000FFFE, 0x00008000, 0xFFFFFFFF, 0x00000001),
+        V128::from_u32(0xFFFFFFFF, 0xFFFF0000, 0xFFFE8000, 0x00000001));
 }
 
 void PPCTestRunner::vpkuhum() {
@@ -1213,14 +1271,14 @@ void PPCTestRunner::vsubcuw() {
 }
 
 void PPCTestRunner::vsubfp() {
-    TEST_INSTRUCTION(test_vsubuhm, V1, V2, V3, {
+    TEST_INSTRUCTION(test_vsubfp, V1, V2, V3, {
         state.v[1] = V1;
         state.v[2] = V2;
-        run({ a.vsubuhm(v3, v1, v2); });
+        run({ a.vsubfp(v3, v1, v2); });
         expect(state.v[3] == V3);
     });
 
-    test_vsubuhm(
+    test_vsubfp(
         V128::from(+10.0f, -10.0f, +15.0f, -15.0f),
         V128::from(-10.0f, -10.0f, +20.0f, +30.0f),
         V128::from(+20.0f,  +0.0f,  -5.0f, -45.0f));
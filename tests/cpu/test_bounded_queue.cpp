@@ -0,0 +1,84 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/core/bounded_queue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace core;
+
+TEST_CLASS(CoreBoundedQueueTests) {
+public:
+    TEST_METHOD(Core_BoundedQueue_Capacity) {
+        // Queues are embedded in kernel objects allocated with new, so they must not be over-aligned
+        Assert::IsTrue(alignof(BoundedQueue<U64>) <= alignof(std::max_align_t));
+
+        // Capacities need not be powers of two
+        BoundedQueue<U64> queue(5);
+        for (U64 round = 0; round < 3; round++) {
+            for (U64 i = 0; i < 5; i++) {
+                Assert::IsTrue(queue.push(round * 10 + i));
+            }
+            Assert::IsFalse(queue.push(0));
+            Assert::AreEqual(5U, queue.size());
+
+            U64 values[8];
+            Assert::AreEqual(3U, queue.pop(values, 3));
+            Assert::AreEqual(round * 10 + 2, values[2]);
+            Assert::AreEqual(2U, queue.pop(values, 8));
+            Assert::AreEqual(round * 10 + 4, values[1]);
+            Assert::AreEqual(0U, queue.pop(values, 8));
+        }
+    }
+
+    TEST_METHOD(Core_BoundedQueue_Producers) {
+        static constexpr U32 PRODUCERS = 4;
+        static constexpr U32 ITEMS = 100000;
+        BoundedQueue<U64> queue(127);
+
+        std::vector<std::thread> producers;
+        for (U32 p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&queue, p]{
+                for (U32 i = 0; i < ITEMS; i++) {
+                    while (!queue.push((U64(p) << 32) | i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        // Elements of each producer must arrive in order, without losses or duplicates
+        U32 next[PRODUCERS] = {};
+        bool ordered = true;
+        U32 received = 0;
+        while (received < PRODUCERS * ITEMS) {
+            U64 values[16];
+            const U32 count = queue.pop(values, 16);
+            if (!count) {
+                std::this_thread::yield();
+            }
+            for (U32 i = 0; i < count; i++) {
+                const U32 p = U32(values[i] >> 32);
+                ordered &= (U32(values[i]) == next[p]++);
+            }
+            received += count;
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        Assert::IsTrue(ordered);
+        Assert::AreEqual(0U, queue.size());
+    }
+};
@@ -0,0 +1,110 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/system/scei/cellos/call_statistics.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace sys;
+
+TEST_CLASS(SystemCallStatisticsTests) {
+    static CallEntry findEntry(CallType type, U32 key) {
+        for (const auto& entry : CallStatistics::getStatistics()) {
+            if (entry.type == type && entry.key == key) {
+                return entry;
+            }
+        }
+        return CallEntry();
+    }
+
+public:
+    TEST_METHOD(System_CallStatistics_Histogram) {
+        const auto before = findEntry(CALL_TYPE_FUNCTION, 0xF00DF00D);
+        CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DF00D, 0);
+        CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DF00D, 1000);
+        CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DF00D, 1023);
+        CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DF00D, 1024);
+        CallStatistics::flush();
+
+        const auto after = findEntry(CALL_TYPE_FUNCTION, 0xF00DF00D);
+        Assert::IsTrue(after.calls == before.calls + 4);
+        Assert::IsTrue(after.totalTime == before.totalTime + 3047);
+        Assert::IsTrue(after.maxTime >= 1024);
+        Assert::IsTrue(after.histogram[0] == before.histogram[0] + 1);
+        Assert::IsTrue(after.histogram[9] == before.histogram[9] + 2);
+        Assert::IsTrue(after.histogram[10] == before.histogram[10] + 1);
+    }
+
+    TEST_METHOD(System_CallStatistics_Threads) {
+        static constexpr U32 THREADS = 4;
+        static constexpr U32 CALLS = 5000;
+        const auto before = findEntry(CALL_TYPE_SYSCALL, 0xF0);
+
+        // Counters of each thread are published when the thread exits
+        std::thread threads[THREADS];
+        for (auto& thread : threads) {
+            thread = std::thread([]{
+                for (U32 i = 0; i < CALLS; i++) {
+                    CallStatistics::Scope scope(CALL_TYPE_SYSCALL, 0xF0);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CallStatistics::setName(CALL_TYPE_SYSCALL, 0xF0, "sys_test");
+
+        const auto after = findEntry(CALL_TYPE_SYSCALL, 0xF0);
+        Assert::IsTrue(after.calls == before.calls + THREADS * CALLS);
+        Assert::AreEqual(std::string("sys_test"), after.name);
+
+        // Ordering and reports
+        const auto entries = CallStatistics::getStatistics();
+        for (Size i = 1; i < entries.size(); i++) {
+            Assert::IsTrue(entries[i - 1].totalTime >= entries[i].totalTime);
+        }
+        Assert::IsTrue(CallStatistics::toCSV(entries).find("syscall,0xF0,sys_test,") != std::string::npos);
+        Assert::IsTrue(CallStatistics::toJSON(entries).find("\"sys_test\"") != std::string::npos);
+    }
+
+    TEST_METHOD(System_CallStatistics_Interval) {
+        const auto before = findEntry(CALL_TYPE_FUNCTION, 0xF00DBEEF);
+        std::atomic<U32> step(0);
+        std::thread thread([&]{
+            CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DBEEF, 100);
+            step = 1;
+            while (step != 2) {
+                std::this_thread::yield();
+            }
+            // A single call after the interval publishes the pending ones
+            std::this_thread::sleep_for(std::chrono::nanoseconds(U64(CallStatistics::FLUSH_INTERVAL)));
+            CallStatistics::record(CALL_TYPE_FUNCTION, 0xF00DBEEF, 100);
+            step = 3;
+            while (step != 4) {
+                std::this_thread::yield();
+            }
+        });
+        while (step != 1) {
+            std::this_thread::yield();
+        }
+        Assert::IsTrue(findEntry(CALL_TYPE_FUNCTION, 0xF00DBEEF).calls == before.calls);
+        step = 2;
+        while (step != 3) {
+            std::this_thread::yield();
+        }
+        Assert::IsTrue(findEntry(CALL_TYPE_FUNCTION, 0xF00DBEEF).calls == before.calls + 2);
+        step = 4;
+        thread.join();
+    }
+};
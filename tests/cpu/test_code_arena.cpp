@@ -0,0 +1,86 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/backend/code_arena.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu::backend;
+
+TEST_CLASS(CpuCodeArenaTests) {
+public:
+    TEST_METHOD(CPU_CodeArena_Views) {
+        CodeArena arena(64 * 1024);
+        U08* code = static_cast<U08*>(arena.alloc(100));
+        Assert::IsTrue(code != nullptr);
+        Assert::IsTrue(arena.contains(code));
+        Assert::AreEqual(Size(0), reinterpret_cast<Size>(code) % CodeArena::ALIGNMENT);
+
+        // Bytes written through the writable view are visible in the executable view
+        U08* data = static_cast<U08*>(arena.getWritable(code));
+        memset(data, 0xC3, 100);
+        Assert::AreEqual(U08(0xC3), code[0]);
+        Assert::AreEqual(U08(0xC3), code[99]);
+    }
+
+    TEST_METHOD(CPU_CodeArena_FreeLists) {
+        CodeArena arena(64 * 1024);
+        void* a = arena.alloc(100);
+        void* b = arena.alloc(10000);
+        arena.alloc(100);
+
+        // Evicted blocks are reused by allocations of the same size class
+        arena.free(a);
+        Assert::IsTrue(arena.alloc(97) == a);
+
+        // Large blocks are split
+        arena.free(b);
+        void* c = arena.alloc(5000);
+        Assert::IsTrue(c == b);
+        auto stats = arena.getStatistics();
+        Assert::AreEqual(U64(2), stats.evictions);
+        Assert::AreEqual(U64(2), stats.reused);
+        Assert::IsTrue(stats.free > 0);
+        Assert::IsTrue(stats.fragmentation() > 0.0);
+    }
+
+    TEST_METHOD(CPU_CodeArena_Eviction) {
+        CodeArena arena(64 * 1024);
+        std::vector<void*> blocks;
+        int evictions = 0;
+        arena.setEvictionHandler([&](CodeArena& full) {
+            evictions += 1;
+            for (void* block : blocks) {
+                full.free(block);
+            }
+            blocks.clear();
+        });
+
+        // Filling the arena lets its owner free code instead of failing
+        for (int i = 0; i < 20; i++) {
+            void* block = arena.alloc(8000);
+            Assert::IsTrue(block != nullptr);
+            blocks.push_back(block);
+        }
+        Assert::IsTrue(evictions > 0);
+        auto stats = arena.getStatistics();
+        Assert::IsTrue(stats.evictions >= U64(evictions));
+        Assert::AreEqual(U64(0), stats.failures);
+        Assert::IsTrue(stats.occupancy() <= 1.0);
+
+        // Without handler, allocations fail when the arena is full
+        arena.setEvictionHandler(nullptr);
+        Assert::IsTrue(arena.alloc(128 * 1024) == nullptr);
+        Assert::AreEqual(U64(1), arena.getStatistics().failures);
+    }
+};
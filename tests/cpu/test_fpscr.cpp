@@ -0,0 +1,217 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/core/config.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/backend/x86/x86_compiler.h"
+#include "nucleus/cpu/backend/ppc/ppc_assembler.h"
+#include "nucleus/cpu/frontend/ppu/ppu_fpscr.h"
+#include "nucleus/cpu/frontend/ppu/ppu_state.h"
+#include "nucleus/cpu/frontend/ppu/ppu_tables.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
+#include "nucleus/cpu/frontend/ppu/translator/ppu_translator.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/hir/module.h"
+#include "nucleus/cpu/hir/passes.h"
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu;
+using namespace cpu::backend::ppc;
+using namespace cpu::frontend::ppu;
+
+TEST_CLASS(CpuFPSCRTests) {
+    static U32 fprf(U32 fpscr) {
+        PPU_FPSCR reg;
+        reg.FPSCR = fpscr;
+        return reg.FPRF;
+    }
+
+    // Translate a loop body of dependent fmadd/fmul/fadd operations and measure it in ns/op
+    static double benchmark(ConfigCpuFPSCR accuracy) {
+        static constexpr U32 OPERATIONS = 96;
+        static constexpr U32 ITERATIONS = 10000;
+        const auto previous = config.ppuFPSCR;
+        config.ppuFPSCR = accuracy;
+
+        auto memory = std::make_shared<mem::Memory>();
+        auto cpu = std::make_shared<CPU>(memory);
+        PPUThread thread(cpu.get());
+        CPU::setCurrentThread(&thread);
+
+        hir::Module module;
+        hir::Function* function = new hir::Function(&module, hir::TYPE_VOID);
+        hir::Block* block = new hir::Block(function);
+        Translator translator(cpu.get(), nullptr);
+        translator.builder.setInsertPoint(block);
+        translator.currentAddress = 0x10000;
+
+        U32 buffer[OPERATIONS];
+        PPCAssembler a(sizeof(buffer), buffer);
+        for (U32 i = 0; i < OPERATIONS / 3; i++) {
+            a.fmadd(f1, f1, f2, f3);
+            a.fmul(f1, f1, f2);
+            a.fadd(f1, f1, f3);
+        }
+        for (Size i = 0; (i * sizeof(U32)) < a.curSize; i++) {
+            Instruction instr;
+            instr.value = buffer[i];
+            (translator.*get_entry(instr).recompile)(instr);
+        }
+        translator.builder.createRet();
+
+        backend::x86::X86Compiler compiler;
+        compiler.addPass(std::make_unique<hir::passes::RegisterAllocationPass>(compiler.targetInfo));
+        compiler.compile(function);
+
+        auto* state = thread.state.get();
+        state->f[1] = 1.0;
+        state->f[2] = 0.999;
+        state->f[3] = 0.001;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (U32 i = 0; i < ITERATIONS; i++) {
+            compiler.call(function, state);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        CPU::setCurrentThread(nullptr);
+        config.ppuFPSCR = previous;
+        return std::chrono::duration<double, std::nano>(end - start).count() / (OPERATIONS * ITERATIONS);
+    }
+
+    // Translate and run a single instruction with sticky FPSCR flags, returning the FPSCR
+    template <typename Emit>
+    static U32 sticky(Emit emit, F64 f1, F64 f2, F64 f3) {
+        const auto previous = config.ppuFPSCR;
+        config.ppuFPSCR = CPU_FPSCR_STICKY;
+
+        auto memory = std::make_shared<mem::Memory>();
+        auto cpu = std::make_shared<CPU>(memory);
+        PPUThread thread(cpu.get());
+
+        hir::Module module;
+        hir::Function* function = new hir::Function(&module, hir::TYPE_VOID);
+        hir::Block* block = new hir::Block(function);
+        Translator translator(cpu.get(), nullptr);
+        translator.builder.setInsertPoint(block);
+        translator.currentAddress = 0x10000;
+
+        U32 buffer[1];
+        PPCAssembler a(sizeof(buffer), buffer);
+        emit(a);
+        Instruction instr;
+        instr.value = buffer[0];
+        (translator.*get_entry(instr).recompile)(instr);
+        translator.builder.createRet();
+
+        backend::x86::X86Compiler compiler;
+        compiler.addPass(std::make_unique<hir::passes::RegisterAllocationPass>(compiler.targetInfo));
+        compiler.compile(function);
+
+        auto* state = thread.state.get();
+        state->f[1] = f1;
+        state->f[2] = f2;
+        state->f[3] = f3;
+        compiler.call(function, state);
+
+        config.ppuFPSCR = previous;
+        return state->fpscr.FPSCR;
+    }
+
+public:
+    TEST_METHOD(CPU_FPSCR_ResultClass) {
+        const F64 inf = std::numeric_limits<F64>::infinity();
+        Assert::AreEqual(U32(FPR_FPRF_PN), fprf(computeFPSCR(0, FP_OP_ADD, 2.0, 3.0)));
+        Assert::AreEqual(U32(FPR_FPRF_NN), fprf(computeFPSCR(0, FP_OP_SUB, 2.0, 3.0)));
+        Assert::AreEqual(U32(FPR_FPRF_PZ), fprf(computeFPSCR(0, FP_OP_SUB, 3.0, 3.0)));
+        Assert::AreEqual(U32(FPR_FPRF_NZ), fprf(computeFPSCR(0, FP_OP_MUL, -0.0, 3.0)));
+        Assert::AreEqual(U32(FPR_FPRF_PINF), fprf(computeFPSCR(0, FP_OP_ADD, inf, 1.0)));
+        Assert::AreEqual(U32(FPR_FPRF_NINF), fprf(computeFPSCR(0, FP_OP_MUL, inf, -1.0)));
+        Assert::AreEqual(U32(FPR_FPRF_PD), fprf(computeFPSCR(0, FP_OP_MUL, 1e-300, 1e-10)));
+        Assert::AreEqual(U32(FPR_FPRF_QNAN), fprf(computeFPSCR(0, FP_OP_SUB, inf, inf)));
+
+        // Single-precision results are classified in single format
+        Assert::AreEqual(U32(FPR_FPRF_PINF), fprf(computeFPSCR(0, FP_OP_MUL | FP_OP_SINGLE, 1e30, 1e30)));
+        Assert::AreEqual(U32(FPR_FPRF_PN), fprf(computeFPSCR(0, FP_OP_MUL, 1e30, 1e30)));
+    }
+
+    TEST_METHOD(CPU_FPSCR_Exceptions) {
+        const F64 inf = std::numeric_limits<F64>::infinity();
+
+        // Exact results do not raise exceptions
+        U32 fpscr = computeFPSCR(0, FP_OP_ADD, 1.0, 2.0);
+        Assert::AreEqual(0U, fpscr & (FPSCR_FX | FPSCR_XX | FPSCR_FR | FPSCR_FI));
+
+        // Inexact results, rounded up in magnitude
+        fpscr = computeFPSCR(0, FP_OP_DIV, 1.0, 10.0);
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_XX | FPSCR_FR | FPSCR_FI), fpscr & (FPSCR_FX | FPSCR_XX | FPSCR_FR | FPSCR_FI));
+        fpscr = computeFPSCR(0, FP_OP_DIV, 1.0, 3.0);
+        Assert::AreEqual(U32(FPSCR_XX | FPSCR_FI), fpscr & (FPSCR_XX | FPSCR_FR | FPSCR_FI));
+
+        // Invalid operations set their cause and the VX summary
+        fpscr = computeFPSCR(0, FP_OP_SUB, inf, inf);
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_VX | FPSCR_VXISI), fpscr & (FPSCR_FX | FPSCR_VX | FPSCR_VXISI));
+        fpscr = computeFPSCR(0, FP_OP_MADD, inf, 0.0, 1.0);
+        Assert::IsTrue((fpscr & FPSCR_VXIMZ) != 0);
+        fpscr = computeFPSCR(0, FP_OP_DIV, 0.0, 0.0);
+        Assert::AreEqual(U32(FPSCR_VXZDZ), fpscr & (FPSCR_VXZDZ | FPSCR_ZX));
+        fpscr = computeFPSCR(0, FP_OP_SQRT, -1.0);
+        Assert::IsTrue((fpscr & FPSCR_VXSQRT) != 0);
+
+        // Zero divide, overflow and underflow
+        Assert::IsTrue((computeFPSCR(0, FP_OP_DIV, 1.0, 0.0) & FPSCR_ZX) != 0);
+        Assert::IsTrue((computeFPSCR(0, FP_OP_MUL, 1e300, 1e300) & FPSCR_OX) != 0);
+        Assert::IsTrue((computeFPSCR(0, FP_OP_MUL, 1e-300, 1e-300) & FPSCR_UX) != 0);
+
+        // Exception bits are sticky, FX is only set when one of them changes
+        fpscr = computeFPSCR(0, FP_OP_DIV, 1.0, 0.0) & ~FPSCR_FX;
+        fpscr = computeFPSCR(fpscr, FP_OP_DIV, 1.0, 0.0);
+        Assert::AreEqual(0U, fpscr & FPSCR_FX);
+        fpscr = computeFPSCR(fpscr, FP_OP_ADD, 1.0, 1.0);
+        Assert::IsTrue((fpscr & FPSCR_ZX) != 0);
+    }
+
+    TEST_METHOD(CPU_FPSCR_Sticky) {
+        const F64 inf = std::numeric_limits<F64>::infinity();
+        const F64 nan = std::numeric_limits<F64>::quiet_NaN();
+        auto fadd = [](PPCAssembler& a) { a.fadd(f4, f1, f2); };
+        auto fdiv = [](PPCAssembler& a) { a.fdiv(f4, f1, f2); };
+        auto fmadd = [](PPCAssembler& a) { a.fmadd(f4, f1, f2, f3); };
+
+        // Special results generated from finite operands raise exceptions
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_OX), sticky(fadd, 1e308, 1e308, 0.0));
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_ZX), sticky(fdiv, 1.0, 0.0, 0.0));
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_VX), sticky(fadd, inf, -inf, 0.0));
+        Assert::AreEqual(U32(FPSCR_FX | FPSCR_VX), sticky(fmadd, inf, 0.0, 1.0));
+
+        // Special operands propagated to the result do not
+        Assert::AreEqual(0U, sticky(fadd, inf, 1.0, 0.0));
+        Assert::AreEqual(0U, sticky(fadd, nan, 1.0, 0.0));
+        Assert::AreEqual(0U, sticky(fdiv, inf, 0.0, 0.0));
+        Assert::AreEqual(0U, sticky(fmadd, 2.0, 3.0, nan));
+    }
+
+    TEST_METHOD(CPU_FPSCR_Benchmark) {
+        const double exact = benchmark(CPU_FPSCR_EXACT);
+        const double sticky = benchmark(CPU_FPSCR_STICKY);
+        const double none = benchmark(CPU_FPSCR_NONE);
+
+        const std::string message =
+            "FP loop: " + std::to_string(exact) + " ns/op (exact FPSCR), " +
+            std::to_string(sticky) + " ns/op (sticky flags), " +
+            std::to_string(none) + " ns/op (no FPSCR)\n";
+        Logger::WriteMessage(message.c_str());
+    }
+};
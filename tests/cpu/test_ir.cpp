@@ -14,12 +14,61 @@
 #include "nucleus/cpu/hir/passes.h"
 #include "nucleus/cpu/backend/x86/x86_compiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 // Target
 using namespace cpu::hir;
 using namespace cpu::backend;
 
+namespace {
+
+// Create a straight-line function that reads, combines and writes back many context fields
+Function* createBenchmarkFunction(Module* module) {
+    Function* function = new Function(module, TYPE_VOID);
+    Block* block = new Block(function);
+    block->flags |= BLOCK_IS_ENTRY;
+
+    Builder builder;
+    builder.setInsertPoint(block);
+    for (U32 offset = 0; offset < 0x800; offset += 0x10) {
+        Value* a = builder.createCtxLoad(offset + 0x0, TYPE_I64);
+        Value* b = builder.createCtxLoad(offset + 0x8, TYPE_I64);
+        Value* c = builder.createXor(builder.createAdd(a, b), builder.createAdd(b, a));
+        builder.createCtxStore(offset, builder.createShl(c, 1));
+    }
+    builder.createRet();
+    function->flags |= FUNCTION_IS_DEFINED;
+    return function;
+}
+
+// Compile functions with the given number of threads and return the elapsed time in milliseconds
+double compileFunctions(Compiler& compiler, const std::vector<Function*>& functions, size_t threadCount) {
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([&] {
+            for (size_t i = next++; i < functions.size(); i = next++) {
+                compiler.compile(functions[i]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // anonymous namespace
+
 TEST_CLASS(CpuIrTests) {
 
 public:
@@ -41,4 +90,37 @@ public:
         //auto result = function->call(3,4);
         //Assert::IsTrue(result == 28);
     }
+
+    TEST_METHOD(CPU_ParallelCompileBenchmark) {
+        const size_t count = 512;
+        const size_t threadCount = std::max(1U, std::thread::hardware_concurrency());
+
+        x86::X86Compiler compiler;
+        compiler.setPipeline(CPU_PIPELINE_BALANCED);
+
+        // Each run needs fresh functions, since passes modify them
+        Module serialModule;
+        Module parallelModule;
+        std::vector<Function*> serialFunctions;
+        std::vector<Function*> parallelFunctions;
+        for (size_t i = 0; i < count; i++) {
+            serialFunctions.push_back(createBenchmarkFunction(&serialModule));
+            parallelFunctions.push_back(createBenchmarkFunction(&parallelModule));
+        }
+
+        const double serialTime = compileFunctions(compiler, serialFunctions, 1);
+        const double parallelTime = compileFunctions(compiler, parallelFunctions, threadCount);
+        for (size_t i = 0; i < count; i++) {
+            Assert::IsTrue(serialFunctions[i]->flags & FUNCTION_IS_COMPILED);
+            Assert::IsTrue(parallelFunctions[i]->flags & FUNCTION_IS_COMPILED);
+            Assert::AreEqual(serialFunctions[i]->nativeSize, parallelFunctions[i]->nativeSize);
+        }
+
+        const std::string message =
+            "Compiled " + std::to_string(count) + " functions: " +
+            std::to_string(count * 1000.0 / serialTime) + " functions/s on 1 thread, " +
+            std::to_string(count * 1000.0 / parallelTime) + " functions/s on " + std::to_string(threadCount) +
+            " threads (speedup: " + std::to_string(serialTime / parallelTime) + "x)\n";
+        Logger::WriteMessage(message.c_str());
+    }
 };
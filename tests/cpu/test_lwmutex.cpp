@@ -0,0 +1,131 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/system/scei/cellos/lv2.h"
+#include "nucleus/system/scei/cellos/lv2/sys_lwcond.h"
+#include "nucleus/system/scei/cellos/lv2/sys_lwmutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace sys;
+
+TEST_CLASS(SystemLwMutexTests) {
+    static std::atomic<U32>& ownerWord(sys_lwmutex_control_t& control) {
+        return reinterpret_cast<std::atomic<U32>&>(control.owner);
+    }
+
+    // Userland side of a lock: claim a free owner word, otherwise sleep in the kernel.
+    // The waiter count is not kept since guestUnlock always enters the kernel.
+    static void guestLock(sys_lwmutex_t& lwmutex, U32 tid) {
+        U32 current = SE32(SYS_LWMUTEX_FREE);
+        if (!ownerWord(*lwmutex.control).compare_exchange_strong(current, SE32(tid))) {
+            Assert::AreEqual(S32(CELL_OK), lwmutexLock(&lwmutex, tid, 0, 0));
+            Assert::AreEqual(SE32(SYS_LWMUTEX_RESERVED), ownerWord(*lwmutex.control).exchange(SE32(tid)));
+        }
+    }
+
+    // Userland side of a contended unlock
+    static void guestUnlock(sys_lwmutex_t& lwmutex) {
+        ownerWord(*lwmutex.control).store(SE32(SYS_LWMUTEX_RESERVED));
+        lwmutexUnlock(&lwmutex);
+    }
+
+    static void waitForSleepers(WaitQueue& queue, Size count) {
+        while (true) {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            if (queue.size() == count) {
+                break;
+            }
+            lock.unlock();
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    TEST_METHOD(System_LwMutex_Contended) {
+        sys_lwmutex_control_t control = {};
+        control.owner = 1;
+        sys_lwmutex_t lwmutex(SYS_SYNC_FIFO);
+        lwmutex.control = &control;
+
+        // The second thread sleeps until the owner unlocks through the kernel
+        std::atomic<bool> locked(false);
+        std::thread thread([&]{
+            guestLock(lwmutex, 2);
+            locked = true;
+        });
+        waitForSleepers(lwmutex.queue, 1);
+        Assert::IsFalse(locked.load());
+        guestUnlock(lwmutex);
+        thread.join();
+        Assert::IsTrue(locked.load());
+        Assert::AreEqual(2U, U32(control.owner));
+        Assert::IsFalse(lwmutex.signaled);
+    }
+
+    TEST_METHOD(System_LwMutex_Reserved) {
+        sys_lwmutex_control_t control = {};
+        control.owner = 1;
+        sys_lwmutex_t lwmutex(SYS_SYNC_FIFO);
+        lwmutex.control = &control;
+
+        // Unlocking with no sleeping thread hands the mutex to the next locking thread
+        Assert::AreEqual(S32(CELL_EBUSY), lwmutexLock(&lwmutex, 2, 0, 0, false));
+        guestUnlock(lwmutex);
+        Assert::AreEqual(U32(SYS_LWMUTEX_RESERVED), U32(control.owner));
+        Assert::AreEqual(S32(CELL_OK), lwmutexLock(&lwmutex, 2, 0, 0, false));
+        Assert::AreEqual(S32(CELL_EBUSY), lwmutexLock(&lwmutex, 3, 0, 0, false));
+        Assert::AreEqual(S32(CELL_ETIMEDOUT), lwmutexLock(&lwmutex, 3, 0, 1000));
+    }
+
+    TEST_METHOD(System_LwCond_Signal) {
+        static constexpr U32 THREADS = 3;
+        sys_lwmutex_control_t control = {};
+        control.owner = SYS_LWMUTEX_FREE;
+        sys_lwmutex_t lwmutex(SYS_SYNC_FIFO);
+        lwmutex.control = &control;
+        sys_lwcond_t lwcond(SYS_SYNC_FIFO);
+
+        std::atomic<U32> woken(0);
+        std::vector<std::thread> threads;
+        for (U32 tid = 1; tid <= THREADS; tid++) {
+            threads.emplace_back([&, tid]{
+                guestLock(lwmutex, tid);
+                Assert::AreEqual(S32(CELL_OK), lwcondWait(&lwcond, &lwmutex, tid, 0, 0));
+                Assert::AreEqual(tid, U32(control.owner));
+                woken++;
+                guestUnlock(lwmutex);
+            });
+        }
+        waitForSleepers(lwcond.queue, THREADS);
+
+        // A signal releases exactly one of the queued waiters
+        lwcondSignal(&lwcond);
+        while (woken != 1) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Assert::AreEqual(1U, woken.load());
+        Assert::AreEqual(Size(THREADS - 1), lwcond.queue.size());
+
+        lwcondSignalAll(&lwcond);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        Assert::AreEqual(THREADS, woken.load());
+        Assert::IsTrue(lwcond.queue.empty());
+    }
+};
@@ -0,0 +1,174 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/system/object.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+TEST_CLASS(SystemObjectTests) {
+    // Object data counting its destructions
+    struct TestData {
+        static std::atomic<U32> destroyed;
+        U32 value;
+
+        TestData(U32 value) : value(value) {}
+        ~TestData() { destroyed++; }
+    };
+
+public:
+    TEST_METHOD(System_Object_Handles) {
+        TestData::destroyed = 0;
+        ObjectManager objects;
+
+        const U32 id = objects.add(new TestData(1), 0x85);
+        Assert::IsTrue(id != 0);
+        Assert::AreEqual(0x85U, id >> 24);
+        Assert::IsTrue(objects.check(id));
+        Assert::AreEqual(1U, objects.get<TestData>(id)->value);
+
+        // Handles are rejected when used as objects of another type
+        const U32 other = objects.add(new std::string("other"), 0x8D);
+        Assert::IsTrue(objects.get<TestData>(other) == nullptr);
+        Assert::IsTrue(objects.get<std::string>(id) == nullptr);
+        Assert::IsTrue(objects.get<TestData>((id & 0xFFFFFF) | 0x8D000000) == nullptr);
+        Assert::IsTrue(objects.remove(other));
+
+        // Handles of destroyed objects stay invalid after their slot is reused
+        Assert::IsTrue(objects.remove(id));
+        Assert::IsFalse(objects.remove(id));
+        const U32 reused = objects.add(new TestData(2), 0x85);
+        Assert::AreEqual(id & 0xFFFF, reused & 0xFFFF);
+        Assert::IsTrue(id != reused);
+        Assert::IsTrue(objects.get<TestData>(id) == nullptr);
+        Assert::AreEqual(2U, objects.get<TestData>(reused)->value);
+
+        U32 count = 0;
+        for (const auto& object : objects) {
+            Assert::AreEqual(reused, object.first);
+            count++;
+        }
+        Assert::AreEqual(1U, count);
+        Assert::AreEqual(1U, TestData::destroyed.load());
+    }
+
+    TEST_METHOD(System_Object_Reclamation) {
+        TestData::destroyed = 0;
+        ObjectManager objects;
+        const U32 id = objects.add(new TestData(1), 0x95);
+
+        // Objects are not deleted while a thread that might hold them is inside a guard
+        std::atomic<U32> stage(0);
+        std::thread reader([&]{
+            ObjectManager::Guard guard;
+            auto* data = objects.get<TestData>(id);
+            stage = 1;
+            while (stage != 2) {
+                std::this_thread::yield();
+            }
+            Assert::AreEqual(1U, data->value);
+        });
+        while (stage != 1) {
+            std::this_thread::yield();
+        }
+        Assert::IsTrue(objects.remove(id));
+        Assert::AreEqual(0U, TestData::destroyed.load());
+        stage = 2;
+        reader.join();
+
+        // Retired objects are deleted on later removals once no guard precedes them
+        objects.remove(objects.add(new TestData(2), 0x95));
+        Assert::AreEqual(2U, TestData::destroyed.load());
+    }
+
+    TEST_METHOD(System_Object_BlockingScope) {
+        TestData::destroyed = 0;
+        ObjectManager objects;
+        const U32 pinnedId = objects.add(new TestData(1), 0x95);
+        const U32 otherId = objects.add(new TestData(2), 0x95);
+
+        // Threads blocking inside a scope only keep the objects they pinned alive
+        std::atomic<U32> stage(0);
+        std::thread waiter([&]{
+            ObjectManager::Guard guard;
+            auto* data = objects.get<TestData>(pinnedId);
+            {
+                ObjectManager::BlockingScope scope(objects, { pinnedId });
+                stage = 1;
+                while (stage != 2) {
+                    std::this_thread::yield();
+                }
+            }
+            Assert::AreEqual(1U, data->value);
+        });
+        while (stage != 1) {
+            std::this_thread::yield();
+        }
+        Assert::IsTrue(objects.remove(otherId));
+        Assert::IsTrue(objects.remove(pinnedId));
+        Assert::AreEqual(1U, TestData::destroyed.load());
+        stage = 2;
+        waiter.join();
+
+        // Pins are released when leaving the outermost guard
+        objects.remove(objects.add(new TestData(3), 0x95));
+        Assert::AreEqual(3U, TestData::destroyed.load());
+    }
+
+    TEST_METHOD(System_Object_Benchmark) {
+        static constexpr U32 THREADS = 32;
+        static constexpr U32 OBJECTS = 64;
+        static constexpr U32 LOOKUPS = 1000000;
+
+        ObjectManager objects;
+        std::vector<U32> ids;
+        for (U32 i = 0; i < OBJECTS; i++) {
+            ids.push_back(objects.add(new TestData(i), 0x85));
+        }
+
+        std::atomic<U32> ready(0);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        for (U32 t = 0; t < THREADS; t++) {
+            threads.emplace_back([&, t]{
+                ready++;
+                while (ready != THREADS) {
+                    std::this_thread::yield();
+                }
+                ObjectManager::Guard guard;
+                for (U32 i = 0; i < LOOKUPS; i++) {
+                    const U32 index = (i + t) % OBJECTS;
+                    auto* data = objects.get<TestData>(ids[index]);
+                    if (!data || data->value != index) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+        const auto start = std::chrono::steady_clock::now();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        Assert::IsFalse(failed.load());
+
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        const std::string message = "ObjectManager::get: " +
+            std::to_string(ns / LOOKUPS) + " ns/lookup with " +
+            std::to_string(THREADS) + " threads\n";
+        Logger::WriteMessage(message.c_str());
+    }
+};
+
+std::atomic<U32> SystemObjectTests::TestData::destroyed(0);
@@ -0,0 +1,393 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/hir/analyses.h"
+#include "nucleus/cpu/hir/builder.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/hir/module.h"
+#include "nucleus/cpu/hir/pass_manager.h"
+#include "nucleus/cpu/hir/passes.h"
+#include "nucleus/cpu/backend/x86/x86_compiler.h"
+
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu::hir;
+
+using namespace cpu::hir::analyses;
+
+namespace {
+
+// Placeholder for calls to host functions
+void externFunction() {
+}
+
+Size countInstructions(Function* function) {
+    Size count = 0;
+    for (const auto& block : function->blocks) {
+        count += block->instructions.size();
+    }
+    return count;
+}
+
+}  // anonymous namespace
+
+TEST_CLASS(CpuPassesTests) {
+    Module* module;
+    Function* function;
+    Builder builder;
+
+    // Apply GVN and check the instruction count before and after the pass
+    void checkGVN(Size expectedBefore, Size expectedAfter) {
+        passes::GlobalValueNumberingPass pass;
+        AnalysisManager analysisManager(function);
+        Assert::AreEqual(expectedBefore, countInstructions(function));
+        Assert::IsTrue(pass.run(function, analysisManager) == PASS_CHANGED);
+        Assert::AreEqual(expectedAfter, countInstructions(function));
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(CPU_PassesInitialize) {
+        module = new Module();
+        function = new Function(module, TYPE_VOID);
+    }
+
+    TEST_METHOD_CLEANUP(CPU_PassesCleanup) {
+        delete module;
+    }
+
+    TEST_METHOD(CPU_GVN_EffectiveAddress) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+
+        // Two guest loads from the same effective address (ra + d)
+        Value* ra1 = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* ea1 = builder.createAdd(ra1, builder.getConstantI64(0x10));
+        Value* x = builder.createLoad(ea1, TYPE_I32, ENDIAN_BIG);
+        Value* ra2 = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* ea2 = builder.createAdd(ra2, builder.getConstantI64(0x10));
+        Value* y = builder.createLoad(ea2, TYPE_I32, ENDIAN_BIG);
+        builder.createCtxStore(0x20, builder.createAdd(x, y));
+        builder.createRet();
+
+        checkGVN(9, 6);
+        Assert::AreEqual(U32(1), ra1->usage);
+        Assert::AreEqual(U32(1), ea1->usage);
+        Assert::AreEqual(U32(2), x->usage);
+    }
+
+    TEST_METHOD(CPU_GVN_Commutative) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* b = builder.createCtxLoad(0x20, TYPE_I64);
+        builder.createCtxStore(0x28, builder.createAdd(a, b));
+        builder.createCtxStore(0x30, builder.createAdd(b, a));
+        builder.createCtxStore(0x38, builder.createSub(a, b));
+        builder.createCtxStore(0x40, builder.createSub(b, a));
+        builder.createRet();
+
+        checkGVN(11, 10);
+    }
+
+    TEST_METHOD(CPU_GVN_ContextStores) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+
+        // Store-to-load forwarding
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* b = builder.createNot(a);
+        builder.createCtxStore(0x20, b);
+        Value* c = builder.createCtxLoad(0x20, TYPE_I64);
+        builder.createCtxStore(0x28, c);
+
+        // Partially overlapping store clobbers the previous load
+        Value* d = builder.createCtxLoad(0x30, TYPE_I64);
+        builder.createCtxStore(0x34, builder.createTrunc(d, TYPE_I32));
+        Value* e = builder.createCtxLoad(0x30, TYPE_I64);
+        builder.createCtxStore(0x40, e);
+        builder.createRet();
+
+        checkGVN(11, 10);
+        Assert::AreEqual(U32(2), b->usage);
+    }
+
+    TEST_METHOD(CPU_GVN_MemoryStores) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+
+        Value* p = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* q = builder.createCtxLoad(0x20, TYPE_I64);
+        Value* v = builder.createCtxLoad(0x28, TYPE_I32);
+
+        // Unrelated store might alias: load is kept
+        builder.createLoad(p, TYPE_I32);
+        builder.createStore(q, v);
+        builder.createLoad(p, TYPE_I32);
+
+        // Stored value is forwarded to the load
+        builder.createStore(p, v);
+        Value* x = builder.createLoad(p, TYPE_I32);
+        builder.createCtxStore(0x30, x);
+        builder.createRet();
+
+        checkGVN(10, 9);
+    }
+
+    TEST_METHOD(CPU_GVN_FencesAndCalls) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+        Function* callee = builder.getExternFunction(reinterpret_cast<void*>(externFunction));
+
+        // Fences clobber memory but not the thread context
+        Value* p = builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createLoad(p, TYPE_I64);
+        builder.createMemFence();
+        builder.createLoad(p, TYPE_I64);
+        builder.createCtxLoad(0x18, TYPE_I64);
+
+        // Calls clobber both
+        builder.createCall(callee, {}, CALL_EXTERN);
+        builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createLoad(p, TYPE_I64);
+        builder.createRet();
+
+        checkGVN(9, 8);
+    }
+
+    TEST_METHOD(CPU_GVN_Dominance) {
+        Block* entry = new Block(function);
+        Block* left = new Block(function);
+        Block* right = new Block(function);
+        Block* join = new Block(function);
+        entry->flags |= BLOCK_IS_ENTRY;
+
+        // entry: computes (a + b) and branches to right
+        builder.setInsertPoint(entry);
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* b = builder.createCtxLoad(0x20, TYPE_I64);
+        Value* sum = builder.createAdd(a, b);
+        Value* cond = builder.createCmpEQ(sum, builder.getConstantI64(0));
+        builder.createBrCond(cond, right, left);
+
+        // left: single predecessor, everything is redundant
+        builder.setInsertPoint(left);
+        Value* a1 = builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createCtxStore(0x28, builder.createAdd(a1, b));
+        builder.createCtxStore(0x30, builder.createXor(a, b));
+        builder.createBr(join);
+
+        // right: sibling of left, so the XOR is not redundant
+        builder.setInsertPoint(right);
+        builder.createCtxStore(0x30, builder.createXor(a, b));
+        builder.createBr(join);
+
+        // join: multiple predecessors, context loads are kept, pure values are not
+        builder.setInsertPoint(join);
+        Value* a2 = builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createCtxStore(0x38, builder.createAdd(a2, builder.createAdd(b, a)));
+        builder.createRet();
+
+        checkGVN(19, 16);
+        Assert::AreEqual(U32(3), sum->usage);
+    }
+
+    TEST_METHOD(CPU_GVN_Loop) {
+        Block* entry = new Block(function);
+        Block* header = new Block(function);
+        Block* exit = new Block(function);
+        entry->flags |= BLOCK_IS_ENTRY;
+
+        builder.setInsertPoint(entry);
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* twice = builder.createShl(a, 1);
+        builder.createCtxStore(0x20, twice);
+
+        // Loop header has a back-edge: loads are kept, pure values dominated by entry are not
+        builder.setInsertPoint(header);
+        Value* counter = builder.createCtxLoad(0x20, TYPE_I64);
+        builder.createCtxStore(0x20, builder.createSub(counter, builder.createShl(a, 1)));
+        Value* cond = builder.createCmpNE(builder.createCtxLoad(0x20, TYPE_I64), builder.getConstantI64(0));
+        builder.createBrCond(cond, header, exit);
+
+        builder.setInsertPoint(exit);
+        builder.createRet();
+
+        checkGVN(11, 9);
+    }
+
+    TEST_METHOD(CPU_GVN_LoopExecution) {
+        Block* entry = new Block(function);
+        Block* header = new Block(function);
+        Block* exit = new Block(function);
+        entry->flags |= BLOCK_IS_ENTRY;
+
+        builder.setInsertPoint(entry);
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createCtxStore(0x28, builder.createShl(a, 1));
+
+        // Value reused from entry must keep its register over every iteration
+        builder.setInsertPoint(header);
+        Value* sum = builder.createAdd(builder.createCtxLoad(0x28, TYPE_I64), builder.createShl(a, 1));
+        builder.createCtxStore(0x28, sum);
+        Value* counter = builder.createSub(builder.createCtxLoad(0x20, TYPE_I64), builder.getConstantI64(1));
+        builder.createCtxStore(0x20, counter);
+        builder.createBrCond(builder.createCmpNE(counter, builder.getConstantI64(0)), header, exit);
+
+        builder.setInsertPoint(exit);
+        builder.createRet();
+
+        cpu::backend::x86::X86Compiler compiler;
+        compiler.setPipeline(CPU_PIPELINE_BALANCED);
+        Assert::IsTrue(compiler.compile(function));
+        Assert::AreEqual(Size(12), countInstructions(function));
+
+        U64 context[6] = {};
+        context[0x18 / 8] = 3;
+        context[0x20 / 8] = 5;
+        Assert::IsTrue(compiler.call(function, context));
+        Assert::AreEqual(U64(0), context[0x20 / 8]);
+        Assert::AreEqual(U64(3 * 2 * 6), context[0x28 / 8]);
+    }
+
+    TEST_METHOD(CPU_DCE_Chains) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+
+        // Unused chain of pure values and context loads is removed entirely
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* b = builder.createCtxLoad(0x20, TYPE_I64);
+        builder.createNot(builder.createAdd(a, b));
+
+        // Memory loads and stores are kept
+        Value* p = builder.createCtxLoad(0x28, TYPE_I64);
+        builder.createLoad(p, TYPE_I32);
+        builder.createCtxStore(0x30, builder.createSub(a, b));
+        builder.createRet();
+
+        passes::DeadCodeEliminationPass pass;
+        AnalysisManager analysisManager(function);
+        Assert::AreEqual(Size(9), countInstructions(function));
+        Assert::IsTrue(pass.run(function, analysisManager) == PASS_CHANGED);
+        Assert::AreEqual(Size(7), countInstructions(function));
+        Assert::AreEqual(U32(1), a->usage);
+        Assert::IsTrue(pass.run(function, analysisManager) == PASS_UNCHANGED);
+    }
+
+    TEST_METHOD(CPU_Analysis_Caching) {
+        Block* entry = new Block(function);
+        Block* body = new Block(function);
+        Block* exit = new Block(function);
+        entry->flags |= BLOCK_IS_ENTRY;
+
+        builder.setInsertPoint(entry);
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        Value* cond = builder.createCmpEQ(a, builder.getConstantI64(0));
+        builder.createBrCond(cond, exit, body);
+        builder.setInsertPoint(body);
+        builder.createCtxStore(0x20, builder.createNot(a));
+        builder.setInsertPoint(exit);
+        builder.createRet();
+
+        AnalysisManager analysisManager(function);
+        const auto& dom = analysisManager.get<DominatorAnalysis>();
+        Assert::IsTrue(dom.dominates(0, 2));
+        Assert::IsFalse(dom.dominates(1, 2));
+        Assert::AreEqual(U64(0), analysisManager.hits);
+        Assert::AreEqual(U64(1), analysisManager.misses);
+
+        // Liveness reuses the cached dominator analysis
+        const auto& live = analysisManager.get<LivenessAnalysis>();
+        Assert::IsTrue(live.isLiveOut(0, a));
+        Assert::IsFalse(live.isLiveOut(1, a));
+        Assert::AreEqual(U64(1), analysisManager.hits);
+        Assert::AreEqual(U64(2), analysisManager.misses);
+
+        // Only preserved analyses survive invalidation
+        analysisManager.invalidate(ANALYSIS_SET_DOMINATORS);
+        analysisManager.get<DominatorAnalysis>();
+        analysisManager.get<LivenessAnalysis>();
+        Assert::AreEqual(U64(3), analysisManager.hits);
+        Assert::AreEqual(U64(3), analysisManager.misses);
+    }
+
+    TEST_METHOD(CPU_PassManager_Statistics) {
+        Block* block = new Block(function);
+        builder.setInsertPoint(block);
+        Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+        builder.createCtxStore(0x20, builder.createNot(a));
+        builder.createCtxStore(0x28, builder.createNot(a));
+        builder.createRet();
+
+        PassManager manager;
+        manager.addPass(std::make_unique<passes::GlobalValueNumberingPass>());
+        manager.addPass(std::make_unique<passes::DeadCodeEliminationPass>());
+        Assert::IsTrue(manager.run(function));
+        Assert::IsTrue(manager.run(function));
+
+        const auto statistics = manager.getStatistics();
+        Assert::AreEqual(Size(2), statistics.size());
+        Assert::AreEqual(U64(2), statistics[0].runs);
+        Assert::AreEqual(U64(1), statistics[0].changed);
+        Assert::AreEqual(U64(1), statistics[0].unchanged);
+        Assert::AreEqual(U64(2), statistics[1].unchanged);
+        Assert::IsTrue(statistics[0].maxTime <= statistics[0].totalTime);
+
+        // Replacing the pipeline keeps the cumulative statistics
+        manager.clearPasses();
+        manager.addPass(std::make_unique<passes::DeadCodeEliminationPass>());
+        Assert::IsTrue(manager.run(function));
+        Assert::AreEqual(U64(3), manager.getStatistics()[1].runs);
+    }
+
+    TEST_METHOD(CPU_PassManager_Concurrent) {
+        const size_t count = 64;
+        std::vector<Function*> functions;
+        for (size_t n = 0; n < count; n++) {
+            Function* f = new Function(module, TYPE_VOID);
+            Block* block = new Block(f);
+            builder.setInsertPoint(block);
+            Value* a = builder.createCtxLoad(0x18, TYPE_I64);
+            builder.createCtxStore(0x20, builder.createNot(a));
+            builder.createCtxStore(0x28, builder.createNot(a));
+            builder.createNot(builder.createCtxLoad(0x30, TYPE_I64));
+            builder.createRet();
+            functions.push_back(f);
+        }
+
+        // All functions go through the same passes at the same time
+        PassManager manager;
+        manager.addPass(std::make_unique<passes::GlobalValueNumberingPass>());
+        manager.addPass(std::make_unique<passes::DeadCodeEliminationPass>());
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&, t] {
+                for (size_t n = t; n < count; n += 4) {
+                    manager.run(functions[n]);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const auto statistics = manager.getStatistics();
+        Assert::AreEqual(U64(count), statistics[0].runs);
+        Assert::AreEqual(U64(count), statistics[0].changed);
+        Assert::AreEqual(U64(count), statistics[1].changed);
+        for (Function* f : functions) {
+            Assert::AreEqual(Size(5), countInstructions(f));
+        }
+    }
+};
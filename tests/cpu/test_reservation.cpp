@@ -0,0 +1,104 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/reservation.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu;
+
+TEST_CLASS(CpuReservationTests) {
+    // Guest memory line, the address only selects the reservation table entry
+    static constexpr U32 ADDR = 0x10000;
+    alignas(128) U08 line[Reservation::LINE_SIZE] = {};
+
+public:
+    TEST_METHOD(CPU_Reservation_Word) {
+        Reservation a, b;
+        U32* word = reinterpret_cast<U32*>(&line[8]);
+        U32 value, data;
+
+        // Reservations are consumed by the conditional store
+        a.acquire(ADDR + 8, word, &value, 4);
+        data = value + 1;
+        Assert::IsTrue(a.store(ADDR + 8, word, &data, 4));
+        Assert::IsFalse(a.store(ADDR + 8, word, &data, 4));
+        Assert::AreEqual(U32(1), *word);
+
+        // Conditional stores to any word of the line invalidate other reservations
+        a.acquire(ADDR + 8, word, &value, 4);
+        b.acquire(ADDR + 16, &line[16], &data, 4);
+        Assert::IsTrue(b.store(ADDR + 16, &line[16], &data, 4));
+        data = 5;
+        Assert::IsFalse(a.store(ADDR + 8, word, &data, 4));
+        Assert::AreEqual(U32(1), *word);
+
+        // Plain stores to the reserved word make the conditional store fail
+        a.acquire(ADDR + 8, word, &value, 4);
+        *word = 7;
+        Assert::IsFalse(a.store(ADDR + 8, word, &data, 4));
+        Assert::AreEqual(U32(7), *word);
+    }
+
+    TEST_METHOD(CPU_Reservation_Line) {
+        Reservation ppu, spu;
+        alignas(16) U08 snapshot[Reservation::LINE_SIZE];
+        alignas(16) U08 update[Reservation::LINE_SIZE];
+        U64 value, data = 0x1234;
+        memset(update, 0xAB, sizeof(update));
+
+        // Line stores invalidate doubleword reservations, and the other way around
+        ppu.acquire(ADDR, line, &value, 8);
+        spu.acquire(ADDR, line, snapshot, Reservation::LINE_SIZE);
+        Assert::IsTrue(spu.store(ADDR, line, update, Reservation::LINE_SIZE));
+        Assert::IsFalse(ppu.store(ADDR, line, &data, 8));
+        Assert::AreEqual(0, memcmp(line, update, Reservation::LINE_SIZE));
+
+        spu.acquire(ADDR, line, snapshot, Reservation::LINE_SIZE);
+        ppu.acquire(ADDR + 64, &line[64], &value, 8);
+        Assert::IsTrue(ppu.store(ADDR + 64, &line[64], &data, 8));
+        Assert::IsFalse(spu.store(ADDR, line, update, Reservation::LINE_SIZE));
+
+        // Unconditional line stores invalidate everything
+        ppu.acquire(ADDR, line, &value, 8);
+        Reservation::storeLine(ADDR, line, update);
+        Assert::IsFalse(ppu.store(ADDR, line, &data, 8));
+    }
+
+    TEST_METHOD(CPU_Reservation_Contention) {
+        static constexpr U32 THREADS = 8;
+        static constexpr U32 INCREMENTS = 20000;
+        U32* counter = reinterpret_cast<U32*>(&line[0]);
+        *counter = 0;
+
+        // Guest-style atomic increments: lwarx/add/stwcx. retried until success
+        std::vector<std::thread> threads;
+        for (U32 i = 0; i < THREADS; i++) {
+            threads.emplace_back([&]{
+                Reservation reservation;
+                for (U32 j = 0; j < INCREMENTS; j++) {
+                    U32 value;
+                    do {
+                        reservation.acquire(ADDR, counter, &value, 4);
+                        value += 1;
+                    } while (!reservation.store(ADDR, counter, &value, 4));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        Assert::AreEqual(THREADS * INCREMENTS, *counter);
+    }
+};
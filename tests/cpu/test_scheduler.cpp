@@ -0,0 +1,160 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/scheduler.h"
+#include "nucleus/cpu/thread.h"
+#include "nucleus/cpu/frontend/spu/spu_channel.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu;
+
+TEST_CLASS(CpuSchedulerTests) {
+    // Guest thread running an arbitrary function
+    class TestThread : public Thread {
+        std::function<void()> function;
+
+    public:
+        TestThread(std::function<void()> function) : function(std::move(function)) {}
+
+        virtual void start() override {}
+        virtual void task() override { function(); }
+        virtual void run() override {}
+        virtual void pause() override {}
+        virtual void stop() override {}
+    };
+
+public:
+    TEST_METHOD(CPU_Scheduler_Channels) {
+        static constexpr U32 PAIRS = 32;
+        static constexpr U32 MESSAGES = 100;
+        Scheduler scheduler(2);
+
+        // Many more communicating threads than workers, progress requires parking
+        std::vector<std::unique_ptr<frontend::spu::SPUChannel<1>>> channels;
+        std::vector<std::unique_ptr<TestThread>> threads;
+        std::vector<Scheduler::Task*> tasks;
+        std::atomic<U32> received(0);
+        for (U32 i = 0; i < PAIRS; i++) {
+            channels.push_back(std::make_unique<frontend::spu::SPUChannel<1>>());
+            auto* channel = channels.back().get();
+            threads.push_back(std::make_unique<TestThread>([=]{
+                for (U32 j = 1; j <= MESSAGES; j++) {
+                    channel->push(j);
+                }
+            }));
+            threads.push_back(std::make_unique<TestThread>([=, &received]{
+                for (U32 j = 1; j <= MESSAGES; j++) {
+                    received += channel->pop();
+                }
+            }));
+        }
+        for (auto& thread : threads) {
+            tasks.push_back(scheduler.spawn(thread.get(), 0));
+        }
+        for (auto* task : tasks) {
+            scheduler.join(task);
+        }
+        Assert::AreEqual(U32(PAIRS * MESSAGES * (MESSAGES + 1) / 2), received.load());
+
+        const auto stats = scheduler.getStatistics();
+        Assert::AreEqual(U32(2), stats.workers);
+        Assert::AreEqual(U32(0), stats.runnable);
+        Assert::IsTrue(stats.parks > 0);
+        Assert::IsTrue(stats.contextSwitches >= 2 * PAIRS);
+    }
+
+    TEST_METHOD(CPU_Scheduler_Priority) {
+        Scheduler scheduler(1);
+
+        // Occupy the only worker until all threads are queued
+        std::mutex gate;
+        std::atomic<bool> started(false);
+        gate.lock();
+        TestThread blocker([&]{
+            started = true;
+            std::lock_guard<std::mutex> lock(gate);
+        });
+        auto* blockerTask = scheduler.spawn(&blocker, 0);
+        while (!started) {
+            std::this_thread::yield();
+        }
+
+        std::vector<S32> order;
+        std::vector<std::unique_ptr<TestThread>> threads;
+        std::vector<Scheduler::Task*> tasks;
+        for (S32 priority : {200, 100, 150}) {
+            threads.push_back(std::make_unique<TestThread>([=, &order]{
+                order.push_back(priority);
+            }));
+            tasks.push_back(scheduler.spawn(threads.back().get(), priority));
+        }
+        Assert::AreEqual(U32(3), scheduler.getStatistics().runnable);
+        gate.unlock();
+
+        scheduler.join(blockerTask);
+        for (auto* task : tasks) {
+            scheduler.join(task);
+        }
+        Assert::AreEqual(Size(3), order.size());
+        Assert::AreEqual(100, order[0]);
+        Assert::AreEqual(150, order[1]);
+        Assert::AreEqual(200, order[2]);
+    }
+
+    TEST_METHOD(CPU_Scheduler_Yield) {
+        static constexpr U32 ROUNDS = 50;
+        Scheduler scheduler(1);
+
+        // Occupy the only worker until both threads are queued
+        std::mutex gate;
+        std::atomic<bool> started(false);
+        gate.lock();
+        TestThread blocker([&]{
+            started = true;
+            std::lock_guard<std::mutex> lock(gate);
+        });
+        auto* blockerTask = scheduler.spawn(&blocker, 0);
+        while (!started) {
+            std::this_thread::yield();
+        }
+
+        // Threads that never block still take turns on the worker at their yield points
+        std::vector<char> order;
+        std::vector<std::unique_ptr<TestThread>> threads;
+        std::vector<Scheduler::Task*> tasks;
+        for (char name : {'A', 'B'}) {
+            threads.push_back(std::make_unique<TestThread>([=, &order]{
+                for (U32 i = 0; i < ROUNDS; i++) {
+                    order.push_back(name);
+                    Scheduler::yield();
+                }
+            }));
+            tasks.push_back(scheduler.spawn(threads.back().get(), 0));
+        }
+        gate.unlock();
+
+        scheduler.join(blockerTask);
+        for (auto* task : tasks) {
+            scheduler.join(task);
+        }
+        Assert::AreEqual(Size(2 * ROUNDS), order.size());
+        for (Size i = 0; i < order.size(); i++) {
+            Assert::AreEqual(i % 2 ? 'B' : 'A', order[i]);
+        }
+        Assert::IsTrue(scheduler.getStatistics().yields >= 2 * ROUNDS - 1);
+    }
+};
@@ -0,0 +1,62 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/shared_memory.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace mem;
+
+TEST_CLASS(MemorySharedMemoryTests) {
+    static constexpr U32 ADDR = Memory::MAP_WINDOW_START;
+
+public:
+    TEST_METHOD(Memory_SharedMemory_Alias) {
+        Memory memory;
+        SharedMemory shm(0x20000);
+        Assert::IsTrue(shm.isValid());
+
+        // Both mappings alias the same pages
+        Assert::IsTrue(memory.map(ADDR, shm, PAGE_READABLE | PAGE_WRITABLE));
+        Assert::IsTrue(memory.map(ADDR + 0x100000, shm, PAGE_READABLE));
+        memory.write32(ADDR + 0x10004, 0x12345678);
+        Assert::AreEqual(0x12345678U, memory.read32(ADDR + 0x110004));
+        Assert::AreEqual(U32(PAGE_READABLE | PAGE_WRITABLE | PAGE_SHARED), memory.getPageFlags(ADDR + 0x1FFFF));
+        Assert::AreEqual(U32(PAGE_READABLE | PAGE_SHARED), memory.getPageFlags(ADDR + 0x100000));
+        Assert::AreEqual(0U, memory.getPageFlags(ADDR + 0x20000));
+
+        // Unmapping one mapping keeps the contents visible through the other ones
+        Assert::IsTrue(memory.unmap(ADDR));
+        Assert::IsFalse(memory.unmap(ADDR));
+        Assert::AreEqual(0U, memory.getPageFlags(ADDR));
+        Assert::AreEqual(0x12345678U, memory.read32(ADDR + 0x110004));
+        Assert::IsTrue(memory.map(ADDR + 0x20000, shm, PAGE_READABLE | PAGE_WRITABLE));
+        Assert::AreEqual(0x12345678U, memory.read32(ADDR + 0x30004));
+        Assert::IsTrue(memory.unmap(ADDR + 0x20000));
+        Assert::IsTrue(memory.unmap(ADDR + 0x100000));
+    }
+
+    TEST_METHOD(Memory_SharedMemory_Invalid) {
+        Memory memory;
+        SharedMemory shm(0x20000);
+
+        // Mappings must be aligned, inside the window and not overlap other mappings
+        Assert::IsFalse(memory.map(ADDR + 0x1000, shm, PAGE_READABLE));
+        Assert::IsFalse(memory.map(0x10000000, shm, PAGE_READABLE));
+        Assert::IsFalse(memory.map(ADDR + Memory::MAP_WINDOW_SIZE - 0x10000, shm, PAGE_READABLE));
+        Assert::IsTrue(memory.map(ADDR + 0x10000, shm, PAGE_READABLE));
+        Assert::IsFalse(memory.map(ADDR, shm, PAGE_READABLE));
+        Assert::IsFalse(memory.map(ADDR + 0x20000, shm, PAGE_READABLE));
+        Assert::IsTrue(memory.map(ADDR + 0x30000, shm, PAGE_READABLE));
+        Assert::IsTrue(memory.unmap(ADDR + 0x10000));
+        Assert::IsTrue(memory.unmap(ADDR + 0x30000));
+    }
+};
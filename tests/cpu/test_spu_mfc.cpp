@@ -0,0 +1,312 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/frontend/spu/spu_mfc.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/memory/memory.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu::frontend::spu;
+
+TEST_CLASS(CpuSpuMfcTests) {
+    static constexpr U32 LS_ADDR = 0xF0000000;
+
+    // Issue a command through the MFC channels, as translated code does
+    static void command(MFC& mfc, U32 cmd, U32 lsa, U32 ea, U32 size, U32 tag) {
+        mfc.writeChannel(MFC_LSA, lsa);
+        mfc.writeChannel(MFC_EAH, 0);
+        mfc.writeChannel(MFC_EAL, ea);
+        mfc.writeChannel(MFC_Size, size);
+        mfc.writeChannel(MFC_TagID, tag);
+        mfc.writeChannel(MFC_Cmd, cmd);
+    }
+
+    // Wait for the completion of the given tag groups
+    static U32 waitTags(MFC& mfc, U32 mask) {
+        mfc.writeChannel(MFC_WrTagMask, mask);
+        mfc.writeChannel(MFC_WrTagUpdate, MFC_TAG_UPDATE_ALL);
+        return mfc.readChannel(MFC_RdTagStat);
+    }
+
+public:
+    TEST_METHOD(CPU_SPU_MFC_GetPut) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        const U32 src = memory.alloc(0x4000, 128);
+        const U32 dst = memory.alloc(0x4000, 128);
+        for (U32 i = 0; i < 0x4000; i++) {
+            memory.write8(src + i, U08(i * 7));
+        }
+
+        command(mfc, MFC_GET_CMD, 0x1000, src, 0x4000, 3);
+        Assert::AreEqual(U32(1 << 3), waitTags(mfc, 1 << 3));
+        Assert::AreEqual(0, memcmp(memory.ptr(LS_ADDR + 0x1000), memory.ptr(src), 0x4000));
+
+        command(mfc, MFC_PUTF_CMD, 0x1000, dst, 0x4000, 5);
+        Assert::AreEqual(U32(1 << 5), waitTags(mfc, 1 << 5));
+        Assert::AreEqual(0, memcmp(memory.ptr(dst), memory.ptr(src), 0x4000));
+
+        const auto stats = mfc.getStatistics();
+        Assert::AreEqual(U64(2), stats.commands);
+        Assert::AreEqual(U64(0x4000), stats.bytesGet);
+        Assert::AreEqual(U64(0x4000), stats.bytesPut);
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_PageVersion) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        // Only transfers into local storage advance the versions of the pages written
+        const U32 ea = memory.alloc(0x2000, 128);
+        command(mfc, MFC_GET_CMD, 0x3800, ea, 0x1000, 0);
+        waitTags(mfc, 1 << 0);
+        Assert::AreEqual(U32(0), mfc.getPageVersion(2));
+        Assert::AreEqual(U32(1), mfc.getPageVersion(3));
+        Assert::AreEqual(U32(1), mfc.getPageVersion(4));
+        Assert::AreEqual(U32(0), mfc.getPageVersion(5));
+
+        command(mfc, MFC_PUT_CMD, 0x3800, ea, 0x1000, 0);
+        waitTags(mfc, 1 << 0);
+        Assert::AreEqual(U32(1), mfc.getPageVersion(3));
+
+        command(mfc, MFC_GETLLAR_CMD, 0x5F80, ea, 128, 0);
+        mfc.readChannel(MFC_RdAtomicStat);
+        Assert::AreEqual(U32(1), mfc.getPageVersion(5));
+        Assert::AreEqual(U32(0), mfc.getPageVersion(6));
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_WatchCode) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        // Only writes to the watched code pages interrupt the SPU, the flag raised when
+        // enqueuing is cleared before the commands run
+        std::atomic<U64> codePages(1ULL << 4);
+        mfc.watchCode(&codePages);
+        const U32 ea = memory.alloc(0x1000, 128);
+        command(mfc, MFC_GET_CMD, 0x3000, ea, 0x1000, 0);
+        state.interrupt = 0;
+        waitTags(mfc, 1 << 0);
+        Assert::AreEqual(U32(0), state.interrupt);
+
+        command(mfc, MFC_GET_CMD, 0x4000, ea, 0x1000, 0);
+        state.interrupt = 0;
+        waitTags(mfc, 1 << 0);
+        Assert::AreEqual(U32(1), state.interrupt);
+
+        mfc.watchCode(nullptr);
+        command(mfc, MFC_GET_CMD, 0x4000, ea, 0x1000, 0);
+        state.interrupt = 0;
+        waitTags(mfc, 1 << 0);
+        Assert::AreEqual(U32(0), state.interrupt);
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_List) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        const U32 src = memory.alloc(0x1000, 128);
+        for (U32 i = 0; i < 0x1000; i++) {
+            memory.write8(src + i, U08(i));
+        }
+
+        // List with three elements gathered from different places
+        const U32 list = 0x8000;
+        const U32 elements[3][2] = { {0x20, src + 0x100}, {0x40, src + 0x800}, {0x10, src} };
+        for (U32 i = 0; i < 3; i++) {
+            memory.write32(LS_ADDR + list + 8*i + 0, elements[i][0]);
+            memory.write32(LS_ADDR + list + 8*i + 4, elements[i][1]);
+        }
+        command(mfc, MFC_GETL_CMD, 0x0, list, 3 * 8, 0);
+        waitTags(mfc, 1 << 0);
+
+        Assert::AreEqual(0, memcmp(memory.ptr(LS_ADDR + 0x00), memory.ptr(src + 0x100), 0x20));
+        Assert::AreEqual(0, memcmp(memory.ptr(LS_ADDR + 0x20), memory.ptr(src + 0x800), 0x40));
+        Assert::AreEqual(0, memcmp(memory.ptr(LS_ADDR + 0x60), memory.ptr(src), 0x10));
+        Assert::AreEqual(U64(3), mfc.getStatistics().listElements);
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_Queue) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+        Assert::AreEqual(U32(MFC::QUEUE_SIZE), mfc.getChannelCount(MFC_Cmd));
+
+        // More commands than queue entries, spread over several tag groups
+        const U32 src = memory.alloc(0x10000, 128);
+        for (U32 i = 0; i < 64; i++) {
+            command(mfc, MFC_GET_CMD, i * 0x400, src + i * 0x400, 0x400, i % 4);
+        }
+        Assert::AreEqual(U32(0xF), waitTags(mfc, 0xF));
+        Assert::AreEqual(U32(MFC::QUEUE_SIZE), mfc.getChannelCount(MFC_Cmd));
+        Assert::AreEqual(U64(64 * 0x400), mfc.getStatistics().bytesGet);
+
+        // Commands run on the issuing thread, so immediate polls must see them complete too
+        command(mfc, MFC_GET_CMD, 0, src, 0x400, 7);
+        mfc.writeChannel(MFC_WrTagMask, 1 << 7);
+        mfc.writeChannel(MFC_WrTagUpdate, MFC_TAG_UPDATE_IMMEDIATE);
+        Assert::AreEqual(U32(1 << 7), mfc.readChannel(MFC_RdTagStat));
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_Atomic) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        const U32 ea = memory.alloc(128, 128);
+        memory.write32(ea, 1);
+
+        // Successful reservation
+        command(mfc, MFC_GETLLAR_CMD, 0x100, ea, 128, 0);
+        Assert::AreEqual(U32(MFC_GETLLAR_STATUS), mfc.readChannel(MFC_RdAtomicStat));
+        Assert::AreEqual(U32(1), memory.read32(LS_ADDR + 0x100));
+        memory.write32(LS_ADDR + 0x100, 2);
+        command(mfc, MFC_PUTLLC_CMD, 0x100, ea, 128, 0);
+        Assert::AreEqual(U32(0), mfc.readChannel(MFC_RdAtomicStat));
+        Assert::AreEqual(U32(2), memory.read32(ea));
+
+        // Reservation lost after the data was modified by another agent
+        command(mfc, MFC_GETLLAR_CMD, 0x100, ea, 128, 0);
+        mfc.readChannel(MFC_RdAtomicStat);
+        memory.write32(ea, 3);
+        memory.write32(LS_ADDR + 0x100, 4);
+        command(mfc, MFC_PUTLLC_CMD, 0x100, ea, 128, 0);
+        Assert::AreEqual(U32(MFC_PUTLLC_STATUS), mfc.readChannel(MFC_RdAtomicStat));
+        Assert::AreEqual(U32(3), memory.read32(ea));
+
+        const auto stats = mfc.getStatistics();
+        Assert::AreEqual(U64(1), stats.atomicSuccess);
+        Assert::AreEqual(U64(1), stats.atomicFailure);
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_Mailbox) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+
+        // Reader blocks until the PPU writes the inbound mailbox
+        U32 received = 0;
+        std::thread reader([&]{
+            received = mfc.readChannel(SPU_RdInMbox);
+            received += mfc.readChannel(SPU_RdInMbox);
+        });
+        Assert::IsTrue(mfc.writeInMbox(0x100));
+        Assert::IsTrue(mfc.writeInMbox(0x23));
+        reader.join();
+        Assert::AreEqual(U32(0x123), received);
+        Assert::AreEqual(U32(0), mfc.getChannelCount(SPU_RdInMbox));
+
+        // Inbound mailbox holds up to four entries
+        for (U32 i = 0; i < 4; i++) {
+            Assert::IsTrue(mfc.writeInMbox(i));
+        }
+        Assert::IsFalse(mfc.writeInMbox(4));
+        Assert::AreEqual(U32(4), mfc.getChannelCount(SPU_RdInMbox));
+
+        // Outbound mailbox writer blocks until the PPU reads the previous value
+        U32 value;
+        std::thread writer([&]{
+            mfc.writeChannel(SPU_WrOutMbox, 1);
+            mfc.writeChannel(SPU_WrOutMbox, 2);
+        });
+        for (U32 expected = 1; expected <= 2; expected++) {
+            while (!mfc.readOutMbox(value)) {
+                std::this_thread::yield();
+            }
+            Assert::AreEqual(expected, value);
+        }
+        writer.join();
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_Signal) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+
+        // Logical OR mode accumulates signals until they are read
+        mfc.writeSignal(0, 0x1, true);
+        mfc.writeSignal(0, 0x4, true);
+        Assert::AreEqual(U32(1), mfc.getChannelCount(SPU_RdSigNotify1));
+        Assert::AreEqual(U32(0x5), mfc.readChannel(SPU_RdSigNotify1));
+        Assert::AreEqual(U32(0), mfc.getChannelCount(SPU_RdSigNotify1));
+
+        // Stopping the MFC releases blocked readers
+        std::thread reader([&]{
+            mfc.readChannel(SPU_RdSigNotify2);
+        });
+        mfc.stop();
+        reader.join();
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_Progress) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        // Enqueued commands raise the interrupt flag, so that the SPU drains them soon
+        const U32 ea = memory.alloc(0x100, 128);
+        memory.write32(LS_ADDR + 0x200, 0x1234);
+        command(mfc, MFC_PUT_CMD, 0x200, ea, 0x10, 0);
+        Assert::AreEqual(U32(1), state.interrupt);
+        Assert::AreEqual(U32(0), memory.read32(ea));
+
+        // Pending commands complete before the SPU blocks on the inbound mailbox
+        U32 received = 0;
+        std::thread reader([&]{
+            received = mfc.readChannel(SPU_RdInMbox);
+        });
+        while (memory.read32(ea) != 0x1234) {
+            std::this_thread::yield();
+        }
+        Assert::IsTrue(mfc.writeInMbox(1));
+        reader.join();
+        Assert::AreEqual(U32(1), received);
+    }
+
+    TEST_METHOD(CPU_SPU_MFC_SendSignal) {
+        mem::Memory memory;
+        SPUState state = {};
+        MFC mfc(&memory, state);
+        mfc.setLocalStorage(LS_ADDR);
+
+        // The handler resolves the signal notification register mapped at the target address
+        SPUState targetState = {};
+        MFC target(&memory, targetState);
+        mfc.setSignalHandler([&](U32 ea, U32 value) {
+            if (ea != 0xF005400C) {
+                return false;
+            }
+            target.writeSignal(0, value);
+            return true;
+        });
+        memory.write32(LS_ADDR + 0x10C, 0xCAFE);
+        command(mfc, MFC_SNDSIG_CMD, 0x10C, 0xF005400C, 4, 2);
+        Assert::AreEqual(U32(1 << 2), waitTags(mfc, 1 << 2));
+        Assert::AreEqual(U32(1), target.getChannelCount(SPU_RdSigNotify1));
+        Assert::AreEqual(U32(0xCAFE), target.readChannel(SPU_RdSigNotify1));
+    }
+};
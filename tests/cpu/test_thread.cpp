@@ -0,0 +1,124 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/cpu/thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace cpu;
+
+TEST_CLASS(CpuThreadTests) {
+    // Guest thread polling its interrupt flag like translated code does at back-edges
+    class TestThread : public Thread {
+        U32 interrupt = 0;
+
+    public:
+        std::atomic<U64> iterations;
+
+        TestThread() : iterations(0) {
+            m_interrupt = &interrupt;
+        }
+
+        virtual void start() override {
+            m_thread = std::thread([this]{ task(); });
+        }
+        virtual void task() override {
+            m_status = NUCLEUS_STATUS_RUNNING;
+            while (true) {
+                if (reinterpret_cast<std::atomic<U32>&>(interrupt).load(std::memory_order_acquire) && !handleEvents()) {
+                    break;
+                }
+                iterations.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        virtual void run() override { postEvent(NUCLEUS_EVENT_RUN); }
+        virtual void pause() override { postEvent(NUCLEUS_EVENT_PAUSE); }
+        virtual void stop() override { postEvent(NUCLEUS_EVENT_STOP); }
+
+        bool isInterrupted() const { return interrupt != 0; }
+    };
+
+    static bool waitStatus(const std::vector<std::unique_ptr<TestThread>>& threads, EmulatorStatus status) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        for (const auto& thread : threads) {
+            while (thread->getStatus() != status) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+public:
+    TEST_METHOD(CPU_Thread_PauseResume) {
+        static constexpr U32 THREADS = 8;
+        std::vector<std::unique_ptr<TestThread>> threads;
+        for (U32 i = 0; i < THREADS; i++) {
+            threads.push_back(std::make_unique<TestThread>());
+            threads.back()->start();
+        }
+        Assert::IsTrue(waitStatus(threads, NUCLEUS_STATUS_RUNNING));
+
+        // Pausing all threads is acknowledged quickly and stops guest progress
+        const auto start = std::chrono::steady_clock::now();
+        for (auto& thread : threads) {
+            thread->pause();
+        }
+        Assert::IsTrue(waitStatus(threads, NUCLEUS_STATUS_PAUSED));
+        const auto latency = std::chrono::steady_clock::now() - start;
+        Assert::IsTrue(latency < std::chrono::milliseconds(100));
+
+        std::vector<U64> snapshot;
+        for (auto& thread : threads) {
+            snapshot.push_back(thread->iterations.load());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (U32 i = 0; i < THREADS; i++) {
+            Assert::AreEqual(snapshot[i], threads[i]->iterations.load());
+        }
+
+        // Resumed threads make progress again
+        for (auto& thread : threads) {
+            thread->run();
+        }
+        Assert::IsTrue(waitStatus(threads, NUCLEUS_STATUS_RUNNING));
+        for (U32 i = 0; i < THREADS; i++) {
+            while (threads[i]->iterations.load() == snapshot[i]) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Stop requests are observed by running and paused threads alike
+        threads[0]->pause();
+        while (threads[0]->getStatus() != NUCLEUS_STATUS_PAUSED) {
+            std::this_thread::yield();
+        }
+        for (auto& thread : threads) {
+            thread->stop();
+        }
+        for (auto& thread : threads) {
+            thread->join();
+        }
+        Assert::IsTrue(waitStatus(threads, NUCLEUS_STATUS_STOPPED));
+
+        // Stopped threads keep their flag raised, so that the polls of every caller fail
+        for (auto& thread : threads) {
+            Assert::IsTrue(thread->isInterrupted());
+        }
+    }
+};
@@ -0,0 +1,87 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/core/thread_policy.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace core;
+
+TEST_CLASS(CoreThreadPolicyTests) {
+public:
+    TEST_METHOD(Core_ThreadPolicy_CpuList) {
+        std::vector<U32> cpus;
+        Assert::IsTrue(ThreadPolicy::parseCpuList("8,0-3,2,10-11", cpus));
+        Assert::IsTrue(cpus == std::vector<U32>({ 0, 1, 2, 3, 8, 10, 11 }));
+        Assert::IsTrue(ThreadPolicy::parseCpuList("", cpus));
+        Assert::IsTrue(cpus.empty());
+
+        // Malformed lists leave the output untouched
+        cpus = { 5 };
+        Assert::IsFalse(ThreadPolicy::parseCpuList("3-1", cpus));
+        Assert::IsFalse(ThreadPolicy::parseCpuList("0,,1", cpus));
+        Assert::IsFalse(ThreadPolicy::parseCpuList("0-", cpus));
+        Assert::IsFalse(ThreadPolicy::parseCpuList("ppu", cpus));
+        Assert::IsTrue(cpus == std::vector<U32>({ 5 }));
+    }
+
+    TEST_METHOD(Core_ThreadPolicy_Priority) {
+        auto nice = [](ThreadRole role, S32 priority) {
+            return ThreadPolicy::getHostPriority(HOST_PRIORITY_NICE, role, priority);
+        };
+        Assert::AreEqual(-5, nice(THREAD_ROLE_PPU, 0).value);
+        Assert::AreEqual(0, nice(THREAD_ROLE_PPU, 1000).value);
+        Assert::AreEqual(10, nice(THREAD_ROLE_PPU, 3071).value);
+        Assert::AreEqual(10, nice(THREAD_ROLE_PPU, 9999).value);
+        Assert::AreEqual(-2, nice(THREAD_ROLE_RSX, 0).value);
+        Assert::AreEqual(-5, nice(THREAD_ROLE_TIMER, 3071).value);
+        Assert::IsTrue(nice(THREAD_ROLE_COMPILER, 0).type == HostPriority::CLASS_BATCH);
+
+        // Higher guest priorities never map to lower real-time priorities
+        S32 last = 100;
+        for (S32 priority = 0; priority <= 3071; priority++) {
+            const auto host = ThreadPolicy::getHostPriority(HOST_PRIORITY_REALTIME, THREAD_ROLE_PPU, priority);
+            Assert::IsTrue(host.type == HostPriority::CLASS_REALTIME);
+            Assert::IsTrue(host.value >= 1 && host.value <= last);
+            last = host.value;
+        }
+        Assert::IsTrue(ThreadPolicy::getHostPriority(HOST_PRIORITY_NONE, THREAD_ROLE_PPU, 0).type == HostPriority::CLASS_DEFAULT);
+    }
+
+    TEST_METHOD(Core_ThreadPolicy_Register) {
+        const auto before = ThreadPolicy::getStatistics();
+        std::atomic<U32> step(0);
+        std::thread thread([&]{
+            ThreadPolicy::registerThread(THREAD_ROLE_COMPILER, "Compiler Test");
+            step = 1;
+            while (step != 2) {
+                std::this_thread::yield();
+            }
+        });
+        while (step != 1) {
+            std::this_thread::yield();
+        }
+
+        // Registered threads are counted while alive, and can be found by identifier
+        const auto during = ThreadPolicy::getStatistics();
+        Assert::AreEqual(before.roles[THREAD_ROLE_COMPILER].threads + 1, during.roles[THREAD_ROLE_COMPILER].threads);
+        Assert::IsTrue(ThreadPolicy::setPriority(thread.get_id(), 0));
+        step = 2;
+        thread.join();
+
+        const auto after = ThreadPolicy::getStatistics();
+        Assert::AreEqual(before.roles[THREAD_ROLE_COMPILER].threads, after.roles[THREAD_ROLE_COMPILER].threads);
+        Assert::IsTrue(after.roles[THREAD_ROLE_COMPILER].runTime >= during.roles[THREAD_ROLE_COMPILER].runTime);
+        Assert::IsFalse(ThreadPolicy::setPriority(std::this_thread::get_id(), 0));
+    }
+};
@@ -0,0 +1,78 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+#include "tests/common.h"
+
+// Target
+#include "nucleus/core/timebase.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace core;
+
+TEST_CLASS(CoreTimebaseTests) {
+public:
+    TEST_METHOD(Core_Timebase_Monotonic) {
+        static constexpr U32 THREADS = 4;
+        Timebase timebase;
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        for (U32 i = 0; i < THREADS; i++) {
+            threads.emplace_back([&]{
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+                U64 last = timebase.getTicks();
+                while (std::chrono::steady_clock::now() < deadline) {
+                    const U64 ticks = timebase.getTicks();
+                    if (ticks < last) {
+                        failed = true;
+                    }
+                    last = ticks;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        Assert::IsFalse(failed.load());
+    }
+
+    // Runs for a minute: excluded from quick runs with the "Long Tests" category
+    TEST_METHOD_CATEGORY(Core_Timebase_Drift, L"Long Tests") {
+        // Ticks must track the host monotonic clock within 1 ppm over a minute
+        Timebase timebase;
+        const U64 ticks0 = timebase.getTicks();
+        const U64 host0 = Timebase::readHostClock();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (std::chrono::steady_clock::now() < deadline) {
+            timebase.getTicks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const U64 ticks1 = timebase.getTicks();
+        const U64 host1 = Timebase::readHostClock();
+
+        const F64 expected = F64(host1 - host0) * 1e-9 * F64(timebase.getFrequency());
+        const F64 drift = std::abs(F64(ticks1 - ticks0) - expected) / expected;
+        Assert::IsTrue(drift < 1e-6);
+    }
+
+    TEST_METHOD(Core_Timebase_WallClock) {
+        Timebase timebase;
+        U64 sec, nsec;
+        timebase.getTime(sec, nsec);
+        const S64 host = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        Assert::IsTrue(nsec < 1000000000);
+        Assert::IsTrue(std::abs(S64(sec) - host) <= 1);
+    }
+};
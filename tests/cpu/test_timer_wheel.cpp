@@ -0,0 +1,93 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/core/timer_wheel.h"
+#include "nucleus/core/timebase.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace core;
+
+TEST_CLASS(CoreTimerWheelTests) {
+public:
+    TEST_METHOD(Core_TimerWheel_Order) {
+        TimerWheel wheel;
+        std::mutex mutex;
+        std::vector<U32> order;
+        std::atomic<U32> late(0);
+
+        // Deadlines spread over the first three levels, added in reverse order
+        const U64 delays[] = { 300000000, 40000000, 8000000, 1000000, 200000 };
+        const U64 start = Timebase::readHostClock();
+        for (U32 i = 0; i < 5; i++) {
+            wheel.add(start + delays[i], 0, [&, i](U64 deadline) {
+                if (Timebase::readHostClock() < deadline) {
+                    late = 1;
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(i);
+            });
+        }
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (order.size() == 5) {
+                break;
+            }
+        }
+        Assert::IsTrue(order == std::vector<U32>({ 4, 3, 2, 1, 0 }));
+        Assert::AreEqual(0U, late.load());
+        Assert::IsTrue(wheel.getStatistics().fired == 5);
+    }
+
+    TEST_METHOD(Core_TimerWheel_Periodic) {
+        TimerWheel wheel;
+        std::atomic<U32> count(0);
+        const U64 id = wheel.add(Timebase::readHostClock(), 2000000, [&](U64) {
+            count++;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        Assert::IsTrue(wheel.cancel(id));
+        const U32 fired = count;
+        Assert::IsTrue(fired >= 5 && fired <= 14);
+
+        // No invocations after the timer is cancelled
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        Assert::AreEqual(fired, count.load());
+        Assert::IsFalse(wheel.cancel(id));
+    }
+
+    TEST_METHOD(Core_TimerWheel_Cancel) {
+        TimerWheel wheel;
+        std::atomic<U32> count(0);
+        const U64 start = Timebase::readHostClock();
+        const U64 id = wheel.add(start + 5000000, 0, [&](U64) { count++; });
+        wheel.add(start + 10000000, 0, [&](U64) { count += 2; });
+        Assert::IsTrue(wheel.cancel(id));
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        Assert::AreEqual(2U, count.load());
+    }
+
+    TEST_METHOD(Core_TimerWheel_Sleep) {
+        TimerWheel wheel;
+        for (U64 delay : { 20000ULL, 500000ULL, 3000000ULL }) {
+            const U64 start = Timebase::readHostClock();
+            wheel.sleepUntil(start + delay);
+            const U64 elapsed = Timebase::readHostClock() - start;
+            Assert::IsTrue(elapsed >= delay);
+            Assert::IsTrue(elapsed < delay + 20000000);
+        }
+    }
+};
@@ -0,0 +1,128 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/system/scei/cellos/lv2/sys_synchronization.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Target
+using namespace sys;
+
+TEST_CLASS(SystemWaitQueueTests) {
+    // Block a thread on the queue and wait until it is enqueued
+    static std::thread startWaiter(WaitQueue& queue, U32 tid, S32 priority, std::vector<U32>& order) {
+        std::thread thread([&queue, &order, tid, priority]{
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            WaitQueue::Waiter waiter(tid, priority);
+            if (queue.wait(lock, waiter, 0)) {
+                order.push_back(tid);
+            }
+        });
+        while (true) {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            if (queue.find(tid)) {
+                break;
+            }
+            lock.unlock();
+            std::this_thread::yield();
+        }
+        return thread;
+    }
+
+public:
+    TEST_METHOD(System_WaitQueue_Fifo) {
+        WaitQueue queue(SYS_SYNC_FIFO, 0xF0);
+        std::vector<U32> order;
+        std::vector<std::thread> threads;
+        threads.push_back(startWaiter(queue, 1, 3000, order));
+        threads.push_back(startWaiter(queue, 2, 1000, order));
+        threads.push_back(startWaiter(queue, 3, 2000, order));
+
+        // Waiters are released by arrival regardless of priority
+        for (U32 tid = 1; tid <= 3; tid++) {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            Assert::AreEqual(tid, queue.front()->threadId);
+            queue.wakeOne();
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        Assert::AreEqual(Size(3), order.size());
+    }
+
+    TEST_METHOD(System_WaitQueue_Priority) {
+        WaitQueue queue(SYS_SYNC_PRIORITY, 0xF1);
+        const U64 wakeups = WaitQueue::getStatistics(0xF1).wakeups;
+        std::vector<U32> order;
+        std::vector<std::thread> threads;
+        threads.push_back(startWaiter(queue, 1, 3000, order));
+        threads.push_back(startWaiter(queue, 2, 1000, order));
+        threads.push_back(startWaiter(queue, 3, 2000, order));
+        threads.push_back(startWaiter(queue, 4, 1000, order));
+
+        // Waiters are released by priority, then by arrival
+        std::vector<U32> expected = { 2, 4, 3, 1 };
+        for (U32 tid : expected) {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            Assert::AreEqual(tid, queue.front()->threadId);
+            queue.wakeOne();
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        Assert::IsTrue(queue.empty());
+        Assert::IsTrue(WaitQueue::getStatistics(0xF1).wakeups == wakeups + 4);
+    }
+
+    TEST_METHOD(System_WaitQueue_Targeted) {
+        WaitQueue queue(SYS_SYNC_FIFO, 0xF2);
+        std::vector<U32> order;
+        auto thread1 = startWaiter(queue, 1, 0, order);
+        auto thread2 = startWaiter(queue, 2, 0, order);
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            queue.wake(queue.find(2), 0x1234);
+        }
+        thread2.join();
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex());
+            Assert::AreEqual(Size(1), queue.size());
+            Assert::IsTrue(queue.find(1) != nullptr);
+            queue.wakeAll();
+        }
+        thread1.join();
+        Assert::IsTrue(order == std::vector<U32>({ 2, 1 }));
+    }
+
+    TEST_METHOD(System_WaitQueue_Timeout) {
+        WaitQueue queue(SYS_SYNC_FIFO, 0xF3);
+        const auto before = WaitQueue::getStatistics(0xF3);
+        std::unique_lock<std::mutex> lock(queue.mutex());
+        WaitQueue::Waiter waiter(1, 0);
+        const auto start = std::chrono::steady_clock::now();
+        Assert::IsFalse(queue.wait(lock, waiter, 20000));
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        Assert::IsTrue(lock.owns_lock());
+        Assert::IsTrue(queue.empty());
+        Assert::IsTrue(elapsed >= std::chrono::milliseconds(20));
+        Assert::IsTrue(elapsed < std::chrono::milliseconds(500));
+
+        const auto after = WaitQueue::getStatistics(0xF3);
+        Assert::IsTrue(after.waits == before.waits + 1);
+        Assert::IsTrue(after.timeouts == before.timeouts + 1);
+        Assert::IsTrue(after.wakeups == before.wakeups);
+        Assert::IsTrue(after.waitTime - before.waitTime >= 20000000);
+    }
+};